@@ -0,0 +1,51 @@
+// ======================================================================
+// \title  ArenaAllocator.cpp
+// \author mustafa
+// \brief  Fw::MemAllocator handing out one preallocated block
+// ======================================================================
+
+#include "Components/BufferPool/ArenaAllocator.hpp"
+
+#include <Fw/Types/Assert.hpp>
+
+namespace Components {
+
+  ArenaAllocator ::
+    ArenaAllocator(void* storage, FwSizeType size) :
+      m_storage(static_cast<U8*>(storage)),
+      m_size(size),
+      m_used(0),
+      m_sealed(false)
+  {
+    FW_ASSERT(storage != nullptr);
+    FW_ASSERT(reinterpret_cast<PlatformPointerCastType>(storage) % ALIGNMENT == 0);
+  }
+
+  void* ArenaAllocator ::
+    allocate(const NATIVE_UINT_TYPE identifier, NATIVE_UINT_TYPE& size, bool& recoverable)
+  {
+    FW_ASSERT(!m_sealed, identifier, size);
+    recoverable = false;
+
+    const FwSizeType bytes = (static_cast<FwSizeType>(size) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    if (bytes > m_size - m_used) {
+      return nullptr;
+    }
+    void* const memory = m_storage + m_used;
+    m_used += bytes;
+    return memory;
+  }
+
+  void ArenaAllocator ::
+    deallocate(const NATIVE_UINT_TYPE identifier, void* ptr)
+  {
+    // Taken for the life of the process
+  }
+
+  void ArenaAllocator ::
+    seal()
+  {
+    m_sealed = true;
+  }
+
+}
@@ -0,0 +1,70 @@
+// ======================================================================
+// \title  ArenaAllocator.hpp
+// \author mustafa
+// \brief  Fw::MemAllocator handing out one preallocated block
+//
+// Allocations are carved off the front of the block in order and never
+// given back; deallocate does nothing. It backs the memory components
+// take while the topology is set up, so none of it comes from the heap,
+// and seal() turns any later allocation into an assert.
+// ======================================================================
+
+#ifndef Components_ArenaAllocator_HPP
+#define Components_ArenaAllocator_HPP
+
+#include <FpConfig.hpp>
+#include <Fw/Types/MemAllocator.hpp>
+
+#include <cstddef>
+
+namespace Components {
+
+  class ArenaAllocator :
+    public Fw::MemAllocator
+  {
+
+    public:
+
+      //! Every allocation starts on a multiple of this many bytes
+      static const FwSizeType ALIGNMENT = alignof(std::max_align_t);
+
+      ArenaAllocator(
+          void* storage, //!< Block to hand out, aligned to ALIGNMENT
+          FwSizeType size //!< Bytes in the block
+      );
+
+      //! Take size bytes off the block
+      //! \return the memory, nullptr if the block has no more room
+      void* allocate(
+          const NATIVE_UINT_TYPE identifier, //!< Unused
+          NATIVE_UINT_TYPE& size, //!< Bytes wanted, left as is
+          bool& recoverable //!< Set false, the memory is not kept across resets
+      ) override;
+
+      //! Nothing, the memory stays taken
+      void deallocate(
+          const NATIVE_UINT_TYPE identifier,
+          void* ptr
+      ) override;
+
+      //! Refuse every later allocation, once the components took their memory
+      void seal();
+
+      //! Bytes handed out, alignment included
+      FwSizeType used() const { return m_used; }
+
+      //! Bytes in the block
+      FwSizeType capacity() const { return m_size; }
+
+    private:
+
+      U8* m_storage;
+      FwSizeType m_size;
+      FwSizeType m_used;
+      bool m_sealed;
+
+  };
+
+}
+
+#endif
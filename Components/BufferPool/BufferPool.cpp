@@ -0,0 +1,220 @@
+// ======================================================================
+// \title  BufferPool.cpp
+// \author mustafa
+// \brief  cpp file for BufferPool component implementation class
+// ======================================================================
+
+#include "Components/BufferPool/BufferPool.hpp"
+
+#include <Fw/Types/Assert.hpp>
+
+namespace Components {
+
+  namespace {
+
+    //! Buffer context: bin in the upper half, buffer within the bin in the lower one
+    const U32 CONTEXT_BIN_SHIFT = 16;
+    const U32 CONTEXT_INDEX_MASK = 0xFFFF;
+
+  }
+
+  // ----------------------------------------------------------------------
+  // Component construction and destruction
+  // ----------------------------------------------------------------------
+
+  BufferPool ::
+    BufferPool(const char* const compName) :
+      BufferPoolComponentBase(compName),
+      m_allocator(nullptr),
+      m_memId(0),
+      m_memory(nullptr),
+      m_binCount(0),
+      m_totalBuffers(0),
+      m_inUse(0),
+      m_highWater(0),
+      m_noBuffs(0)
+  {
+    for (U32 i = 0; i < MAX_BUFFERS; i++) {
+      m_busy[i] = false;
+    }
+  }
+
+  BufferPool ::
+    ~BufferPool()
+  {
+
+  }
+
+  void BufferPool ::
+    setup(Fw::MemAllocator& allocator, NATIVE_UINT_TYPE memId, const BufferBins& bins)
+  {
+    FW_ASSERT(m_memory == nullptr);
+
+    FwSizeType bytes = 0;
+    U32 binCount = 0;
+    U32 buffers = 0;
+    while (binCount < MAX_BINS && bins.bins[binCount].numBuffers > 0) {
+      const Bin& bin = bins.bins[binCount];
+      FW_ASSERT(bin.bufferSize > 0 && bin.numBuffers <= CONTEXT_INDEX_MASK, bin.bufferSize, bin.numBuffers);
+      // First fit on increasing sizes is what makes a request take the smallest bin
+      FW_ASSERT(binCount == 0 || bin.bufferSize > bins.bins[binCount - 1].bufferSize, binCount, bin.bufferSize);
+      bytes += binBytes(bin.bufferSize, bin.numBuffers);
+      buffers += bin.numBuffers;
+      binCount++;
+    }
+    FW_ASSERT(binCount > 0);
+    FW_ASSERT(buffers <= MAX_BUFFERS, buffers);
+
+    NATIVE_UINT_TYPE size = static_cast<NATIVE_UINT_TYPE>(bytes);
+    bool recoverable = false;
+    U8* const memory = static_cast<U8*>(allocator.allocate(memId, size, recoverable));
+    FW_ASSERT(memory != nullptr);
+    FW_ASSERT(size >= bytes, size, bytes);
+
+    U8* storage = memory;
+    U32 first = 0;
+    for (U32 b = 0; b < binCount; b++) {
+      BinState& state = m_bins[b];
+      state.storage = storage;
+      state.bufferSize = bins.bins[b].bufferSize;
+      state.stride = static_cast<U32>(binBytes(state.bufferSize, 1));
+      state.numBuffers = bins.bins[b].numBuffers;
+      state.first = first;
+      state.freeCount = state.numBuffers;
+      // Lowest addresses on top of the stack, a quiet pool keeps reusing the same few buffers
+      for (U32 i = 0; i < state.numBuffers; i++) {
+        m_free[first + i] = static_cast<U16>(state.numBuffers - 1 - i);
+      }
+      storage += binBytes(state.bufferSize, state.numBuffers);
+      first += state.numBuffers;
+    }
+
+    m_lock.lock();
+    m_allocator = &allocator;
+    m_memId = memId;
+    m_memory = memory;
+    m_binCount = binCount;
+    m_totalBuffers = buffers;
+    m_lock.unLock();
+  }
+
+  void BufferPool ::
+    cleanup()
+  {
+    if (m_memory == nullptr) {
+      return;
+    }
+    m_allocator->deallocate(m_memId, m_memory);
+    m_memory = nullptr;
+    m_binCount = 0;
+    m_totalBuffers = 0;
+  }
+
+  // ----------------------------------------------------------------------
+  // Handler implementations for user-defined typed input ports
+  // ----------------------------------------------------------------------
+
+  Fw::Buffer BufferPool ::
+    bufferGetCallee_handler(
+        FwIndexType portNum,
+        U32 size
+    )
+  {
+    Fw::Buffer buffer;
+
+    m_lock.lock();
+    U32 fit = 0;
+    while (fit < m_binCount && m_bins[fit].bufferSize < size) {
+      fit++;
+    }
+    U32 bin = fit;
+    while (bin < m_binCount && m_bins[bin].freeCount == 0) {
+      bin++;
+    }
+    if (bin < m_binCount) {
+      BinState& state = m_bins[bin];
+      state.freeCount--;
+      const U32 index = m_free[state.first + state.freeCount];
+      FW_ASSERT(!m_busy[state.first + index], bin, index);
+      m_busy[state.first + index] = true;
+
+      m_inUse++;
+      if (m_inUse > m_highWater) {
+        m_highWater = m_inUse;
+      }
+      const U32 binInUse = state.numBuffers - state.freeCount;
+      if (binInUse > m_binHighWater[bin]) {
+        m_binHighWater[bin] = binInUse;
+      }
+      if (bin != fit) {
+        m_binSpills[fit]++;
+      }
+      buffer = Fw::Buffer(state.storage + index * state.stride, size, (bin << CONTEXT_BIN_SHIFT) | index);
+    } else {
+      if (fit < m_binCount) {
+        m_binFailures[fit]++;
+      }
+      m_noBuffs++;
+    }
+    m_lock.unLock();
+
+    if (buffer.getData() == nullptr) {
+      this->log_WARNING_HI_NoBuffers(size);
+    }
+    return buffer;
+  }
+
+  void BufferPool ::
+    bufferSendIn_handler(
+        FwIndexType portNum,
+        Fw::Buffer& fwBuffer
+    )
+  {
+    const U32 context = fwBuffer.getContext();
+    const U32 bin = context >> CONTEXT_BIN_SHIFT;
+    const U32 index = context & CONTEXT_INDEX_MASK;
+
+    m_lock.lock();
+    FW_ASSERT(bin < m_binCount, bin, context);
+    BinState& state = m_bins[bin];
+    FW_ASSERT(index < state.numBuffers, bin, index);
+    // Returned twice, or never handed out
+    FW_ASSERT(m_busy[state.first + index], bin, index);
+    m_busy[state.first + index] = false;
+    m_free[state.first + state.freeCount] = static_cast<U16>(index);
+    state.freeCount++;
+    m_inUse--;
+    m_lock.unLock();
+  }
+
+  void BufferPool ::
+    schedIn_handler(
+        FwIndexType portNum,
+        U32 context
+    )
+  {
+    BufferPoolBinCounts inUse;
+    m_lock.lock();
+    for (U32 b = 0; b < m_binCount; b++) {
+      inUse[b] = m_bins[b].numBuffers - m_bins[b].freeCount;
+    }
+    const U32 total = m_totalBuffers;
+    const U32 current = m_inUse;
+    const U32 highWater = m_highWater;
+    const U32 noBuffs = m_noBuffs;
+    const BufferPoolBinCounts binHighWater = m_binHighWater;
+    const BufferPoolBinCounts binSpills = m_binSpills;
+    const BufferPoolBinCounts binFailures = m_binFailures;
+    m_lock.unLock();
+
+    this->tlmWrite_TotalBuffs(total);
+    this->tlmWrite_CurrBuffs(current);
+    this->tlmWrite_HiBuffs(highWater);
+    this->tlmWrite_NoBuffs(noBuffs);
+    this->tlmWrite_BinInUse(inUse);
+    this->tlmWrite_BinHighWater(binHighWater);
+    this->tlmWrite_BinSpills(binSpills);
+    this->tlmWrite_BinFailures(binFailures);
+  }
+
+}
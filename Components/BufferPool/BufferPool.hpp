@@ -0,0 +1,131 @@
+// ======================================================================
+// \title  BufferPool.hpp
+// \author mustafa
+// \brief  hpp file for BufferPool component implementation class
+// ======================================================================
+
+#ifndef Components_BufferPool_HPP
+#define Components_BufferPool_HPP
+
+#include "Components/BufferPool/BufferPoolComponentAc.hpp"
+
+#include <Fw/Types/MemAllocator.hpp>
+#include <Os/Mutex.hpp>
+
+namespace Components {
+
+ class BufferPool :
+   public BufferPoolComponentBase
+ {
+
+   public:
+
+     //! Most bins
+     static const U32 MAX_BINS = BufferPoolBinCounts::SIZE;
+
+     //! Most buffers over all bins
+     static const U32 MAX_BUFFERS = 512;
+
+     //! Buffers start on multiples of this many bytes
+     static const U32 ALIGNMENT = 8;
+
+     //! Size and number of the buffers of one bin
+     struct Bin {
+       U32 bufferSize;
+       U32 numBuffers;
+     };
+
+     //! Bins by increasing buffer size, the ones after the last used bin have no buffers
+     struct BufferBins {
+       Bin bins[MAX_BINS];
+     };
+
+     //! Bytes a bin takes from the allocator
+     static constexpr FwSizeType binBytes(U32 bufferSize, U32 numBuffers) {
+       return static_cast<FwSizeType>((bufferSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT) * numBuffers;
+     }
+
+     // ----------------------------------------------------------------------
+     // Component construction and destruction
+     // ----------------------------------------------------------------------
+
+     //! Construct BufferPool object
+     BufferPool(
+         const char* const compName //!< The component name
+     );
+
+     //! Destroy BufferPool object
+     ~BufferPool();
+
+     //! Take the memory of every bin in one allocation
+     void setup(
+         Fw::MemAllocator& allocator, //!< Allocator, kept until cleanup
+         NATIVE_UINT_TYPE memId, //!< Identifier of the allocation
+         const BufferBins& bins //!< Bins by increasing buffer size
+     );
+
+     //! Give the memory back, buffers still out must not be touched any more
+     void cleanup();
+
+   private:
+
+     // ----------------------------------------------------------------------
+     // Handler implementations for user-defined typed input ports
+     // ----------------------------------------------------------------------
+
+     //! Handler implementation for bufferGetCallee
+     Fw::Buffer bufferGetCallee_handler(
+         FwIndexType portNum, //!< The port number
+         U32 size //!< The requested size
+     ) override;
+
+     //! Handler implementation for bufferSendIn
+     void bufferSendIn_handler(
+         FwIndexType portNum, //!< The port number
+         Fw::Buffer& fwBuffer //!< The buffer
+     ) override;
+
+     //! Handler implementation for schedIn
+     void schedIn_handler(
+         FwIndexType portNum, //!< The port number
+         U32 context //!< The call order
+     ) override;
+
+     // ----------------------------------------------------------------------
+     // Member variables
+     // ----------------------------------------------------------------------
+
+     //! A bin's buffers and its stack of free ones, a slice of m_free and m_busy
+     struct BinState {
+       U8* storage;
+       U32 bufferSize;
+       U32 stride; //!< bufferSize rounded up to ALIGNMENT
+       U32 numBuffers;
+       U32 first; //!< Index of the bin's first buffer over all bins
+       U32 freeCount;
+     };
+
+     Os::Mutex m_lock;
+
+     Fw::MemAllocator* m_allocator;
+     NATIVE_UINT_TYPE m_memId;
+     U8* m_memory;
+
+     BinState m_bins[MAX_BINS];
+     U32 m_binCount;
+     U16 m_free[MAX_BUFFERS]; //!< Free buffers of each bin, its first freeCount entries
+     bool m_busy[MAX_BUFFERS];
+
+     U32 m_totalBuffers;
+     U32 m_inUse;
+     U32 m_highWater;
+     U32 m_noBuffs;
+     BufferPoolBinCounts m_binHighWater;
+     BufferPoolBinCounts m_binSpills;
+     BufferPoolBinCounts m_binFailures;
+
+ };
+
+}
+
+#endif
@@ -0,0 +1,162 @@
+// ======================================================================
+// \title  CycleDriver.cpp
+// \author mustafa
+// \brief  cpp file for CycleDriver component implementation class
+// ======================================================================
+
+#include "Components/CycleDriver/CycleDriver.hpp"
+
+#include <Fw/Types/Assert.hpp>
+#include <Os/RawTime.hpp>
+
+#include <cerrno>
+#include <time.h>
+
+namespace Components {
+
+  namespace {
+
+    const U64 NSEC_PER_SEC = 1000000000ULL;
+    const U64 NSEC_PER_USEC = 1000ULL;
+
+    U64 toNs(const struct timespec& time)
+    {
+      return static_cast<U64>(time.tv_sec) * NSEC_PER_SEC + static_cast<U64>(time.tv_nsec);
+    }
+
+    struct timespec fromNs(U64 ns)
+    {
+      struct timespec time;
+      time.tv_sec = static_cast<time_t>(ns / NSEC_PER_SEC);
+      time.tv_nsec = static_cast<long>(ns % NSEC_PER_SEC);
+      return time;
+    }
+
+    U64 monotonicNs()
+    {
+      struct timespec now;
+      const int status = clock_gettime(CLOCK_MONOTONIC, &now);
+      FW_ASSERT(status == 0, errno);
+      return toNs(now);
+    }
+
+    U32 clampUs(U64 ns)
+    {
+      const U64 us = ns / NSEC_PER_USEC;
+      return (us > 0xFFFFFFFFULL) ? 0xFFFFFFFFU : static_cast<U32>(us);
+    }
+
+  }
+
+  // ----------------------------------------------------------------------
+  // Component construction and destruction
+  // ----------------------------------------------------------------------
+
+  CycleDriver ::
+    CycleDriver(const char* const compName) :
+      CycleDriverComponentBase(compName),
+      m_stop(false),
+      m_periodUs(0),
+      m_cycles(0),
+      m_skipped(0),
+      m_maxJitterUs(0),
+      m_jitter(JITTER_FIRST_EDGE_US),
+      m_overruns(OVERRUN_FIRST_EDGE_US)
+  {
+
+  }
+
+  CycleDriver ::
+    ~CycleDriver()
+  {
+
+  }
+
+  void CycleDriver ::
+    cycle(U32 periodUs)
+  {
+    FW_ASSERT(periodUs > 0);
+    const U64 periodNs = static_cast<U64>(periodUs) * NSEC_PER_USEC;
+
+    m_lock.lock();
+    m_periodUs = periodUs;
+    m_lock.unLock();
+
+    U64 deadlineNs = monotonicNs();
+    while (!m_stop.load()) {
+      deadlineNs += periodNs;
+      const struct timespec deadline = fromNs(deadlineNs);
+      // Signals interrupt the sleep, stop is looked at before going back to it
+      int status = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr);
+      while (status == EINTR && !m_stop.load()) {
+        status = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr);
+      }
+      if (status == EINTR) {
+        break;
+      }
+      FW_ASSERT(status == 0, status);
+
+      const U64 wokeNs = monotonicNs();
+      Os::RawTime cycleStart;
+      (void)cycleStart.now();
+      this->CycleOut_out(0, cycleStart);
+      const U64 doneNs = monotonicNs();
+
+      const U32 jitterUs = clampUs((wokeNs > deadlineNs) ? wokeNs - deadlineNs : 0);
+      U32 skipped = 0;
+      const U64 nextNs = deadlineNs + periodNs;
+      if (doneNs >= nextNs) {
+        // Calling the lapsed deadlines back to back would only bunch the rate groups up
+        skipped = static_cast<U32>((doneNs - nextNs) / periodNs) + 1;
+        deadlineNs += static_cast<U64>(skipped) * periodNs;
+      }
+
+      m_lock.lock();
+      m_cycles++;
+      m_jitter.record(jitterUs);
+      if (jitterUs > m_maxJitterUs) {
+        m_maxJitterUs = jitterUs;
+      }
+      if (skipped > 0) {
+        m_overruns.record(clampUs(doneNs - nextNs));
+        m_skipped += skipped;
+      }
+      m_lock.unLock();
+    }
+  }
+
+  void CycleDriver ::
+    stop()
+  {
+    m_stop.store(true);
+  }
+
+  // ----------------------------------------------------------------------
+  // Handler implementations for user-defined typed input ports
+  // ----------------------------------------------------------------------
+
+  void CycleDriver ::
+    run_handler(
+        FwIndexType portNum,
+        U32 context
+    )
+  {
+    m_lock.lock();
+    const U32 periodUs = m_periodUs;
+    const U32 cycles = m_cycles;
+    const U32 skipped = m_skipped;
+    const U32 maxJitterUs = m_maxJitterUs;
+    m_maxJitterUs = 0;
+    const NRF24LatencyHistogram jitter = m_jitter.take();
+    const NRF24LatencyHistogram overruns = m_overruns.take();
+    m_lock.unLock();
+
+    this->tlmWrite_CyclePeriodUs(periodUs);
+    this->tlmWrite_Cycles(cycles);
+    this->tlmWrite_CycleJitter(jitter);
+    this->tlmWrite_CycleMaxJitterUs(maxJitterUs);
+    this->tlmWrite_CycleOverruns(overruns);
+    this->tlmWrite_CyclesSkipped(skipped);
+  }
+
+}
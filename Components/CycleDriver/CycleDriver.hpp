@@ -0,0 +1,86 @@
+// ======================================================================
+// \title  CycleDriver.hpp
+// \author mustafa
+// \brief  hpp file for CycleDriver component implementation class
+// ======================================================================
+
+#ifndef Components_CycleDriver_HPP
+#define Components_CycleDriver_HPP
+
+#include "Components/CycleDriver/CycleDriverComponentAc.hpp"
+#include "Components/NRF24Driver/NRF24TimeHistogram.hpp"
+
+#include <Os/Mutex.hpp>
+
+#include <atomic>
+
+namespace Components {
+
+ class CycleDriver :
+   public CycleDriverComponentBase
+ {
+
+   public:
+
+     //! Upper edge of the first CycleJitter bucket
+     static const U32 JITTER_FIRST_EDGE_US = 10;
+
+     //! Upper edge of the first CycleOverruns bucket
+     static const U32 OVERRUN_FIRST_EDGE_US = 100;
+
+     // ----------------------------------------------------------------------
+     // Component construction and destruction
+     // ----------------------------------------------------------------------
+
+     //! Construct CycleDriver object
+     CycleDriver(
+         const char* const compName //!< The component name
+     );
+
+     //! Destroy CycleDriver object
+     ~CycleDriver();
+
+     //! Call CycleOut once per period on the calling thread until stop. Each deadline is the previous
+     //! one plus the period, so time spent in CycleOut does not move the next one; a cycle that runs
+     //! past one or more deadlines skips them.
+     void cycle(
+         U32 periodUs //!< Period in microseconds
+     );
+
+     //! Make cycle return, also before it was called. Only sets a lock-free flag and may be called
+     //! from a signal handler.
+     void stop();
+
+   private:
+
+     // ----------------------------------------------------------------------
+     // Handler implementations for user-defined typed input ports
+     // ----------------------------------------------------------------------
+
+     //! Handler implementation for run
+     //!
+     //! Publish the histograms and counters gathered since the previous tick
+     void run_handler(
+         FwIndexType portNum, //!< The port number
+         U32 context //!< The call order
+     ) override;
+
+     // ----------------------------------------------------------------------
+     // Member variables
+     // ----------------------------------------------------------------------
+
+     std::atomic<bool> m_stop;
+
+     Os::Mutex m_lock; //!< Guards the measurements, shared between cycle and run
+     U32 m_periodUs;
+     U32 m_cycles;
+     U32 m_skipped;
+     U32 m_maxJitterUs; //!< Since the previous run tick
+     NRF24TimeHistogram m_jitter;
+     NRF24TimeHistogram m_overruns;
+
+ };
+
+}
+
+#endif
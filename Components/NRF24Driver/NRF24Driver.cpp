@@ -6,8 +6,63 @@
 
 #include "Components/NRF24Driver/NRF24Driver.hpp"
 
+#include <Fw/Types/Assert.hpp>
+#include <Fw/Types/Serializable.hpp>
+#include <Os/Task.hpp>
+
+#include <cstring>
+
 namespace Components {
 
+  namespace {
+
+    //! Address of pipe 0 of node 0, LSByte first; both ends of a point-to-point link are node 0.
+    //! Pipe n adds n to the LSByte and the node goes into the next byte, so pipes 2 to 5 share
+    //! the upper bytes of pipe 1 as the chip requires.
+    const U8 LINK_ADDRESS[NRF24::MAX_ADDRESS_WIDTH] = {0x31, 0x46, 0x52, 0x4C, 0x54};
+
+    //! Full address of a pipe of a node
+    void pipeAddress(U8 node, U8 pipe, U8 (&address)[NRF24::MAX_ADDRESS_WIDTH]) {
+      std::memcpy(address, LINK_ADDRESS, sizeof(LINK_ADDRESS));
+      address[0] = static_cast<U8>(address[0] + pipe);
+      address[1] = static_cast<U8>(address[1] ^ node);
+    }
+
+    //! CONFIG with the interrupt sources enabled and a 2 byte CRC
+    const U8 CONFIG_BASE = NRF24::CONFIG_EN_CRC | NRF24::CONFIG_CRCO;
+
+    //! 500 us retransmit delay, 15 retransmits
+    const U8 SETUP_RETR_DEFAULT = (1 << NRF24::SETUP_RETR_ARD_SHIFT) | 0x0F;
+
+    //! Writable configuration registers, kept in the shadow and scrubbed in this order.
+    //! STATUS, OBSERVE_TX, RPD and FIFO_STATUS change on their own and are always read from the chip.
+    const U8 SHADOWED_REGISTERS[] = {
+      NRF24::CONFIG,     NRF24::EN_AA,      NRF24::EN_RXADDR,  NRF24::SETUP_AW,   NRF24::SETUP_RETR,
+      NRF24::RF_CH,      NRF24::RF_SETUP,   NRF24::RX_ADDR_P0, NRF24::RX_ADDR_P1, NRF24::RX_ADDR_P2,
+      NRF24::RX_ADDR_P3, NRF24::RX_ADDR_P4, NRF24::RX_ADDR_P5, NRF24::TX_ADDR,    NRF24::RX_PW_P0,
+      NRF24::RX_PW_P1,   NRF24::RX_PW_P2,   NRF24::RX_PW_P3,   NRF24::RX_PW_P4,   NRF24::RX_PW_P5,
+      NRF24::DYNPD,      NRF24::FEATURE
+    };
+
+    //! Upper edge of the first SpiBatchTime bucket
+    const U32 SPI_BATCH_FIRST_EDGE_US = 16;
+
+    //! Upper edge of the first TxQueueLatency bucket
+    const U32 TX_QUEUE_FIRST_EDGE_US = 100;
+
+    const U32 SHADOWED_REGISTER_COUNT = sizeof(SHADOWED_REGISTERS) / sizeof(SHADOWED_REGISTERS[0]);
+
+    bool isShadowed(U8 reg) {
+      for (U32 i = 0; i < SHADOWED_REGISTER_COUNT; i++) {
+        if (SHADOWED_REGISTERS[i] == reg) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+  }
+
   // ----------------------------------------------------------------------
   // Component construction and destruction
   // ----------------------------------------------------------------------
@@ -19,9 +74,51 @@ namespace Components {
       NRF24DriverComponentBase(compName),
       m_currentChannel(0),
       m_currentPower(0),
-      m_isInitialized(false)
+      m_currentRate(NRF24DataRate::RATE_1MBPS),
+      m_state(NRF24RadioState::UNINITIALIZED),
+      m_hardwareChipSelect(false),
+      m_spiTransfers(0),
+      m_busOps(0),
+      m_scrubIndex(0),
+      m_writesSkipped(0),
+      m_registerDrifts(0),
+      m_packetsSent(0),
+      m_packetsDropped(0),
+      m_spiOpsPerPacket(0),
+      m_rxEnabled(false),
+      m_streaming(false),
+      m_noAck(false),
+      m_txRing(nullptr),
+      m_rxRing(nullptr),
+      m_txPendingHead(0),
+      m_txPendingCount(0),
+      m_txFifoFree(NRF24::FIFO_DEPTH),
+      m_node(0),
+      m_txPipe(0),
+      m_txNode(0),
+      m_txPipeSwitches(0),
+      m_txUnderruns(0),
+      m_txFailures(0),
+      m_txRetransmits(0),
+      m_ackedSent(0),
+      m_statsAckedSent(0),
+      m_statsRetransmits(0),
+      m_statsFailures(0),
+      m_rateStartPackets(0),
+      m_rateStartTxBytes(0),
+      m_rateStartRxBytes(0),
+      m_rateStartValid(false),
+      m_txBytes(0),
+      m_rxBytes(0),
+      m_framesReceived(0),
+      m_rxFifoOverflows(0),
+      m_rxDropped(0),
+      m_irqPolledDrains(0),
+      m_spiBatchTime(SPI_BATCH_FIRST_EDGE_US),
+      m_txQueueLatency(TX_QUEUE_FIRST_EDGE_US),
+      m_traceRingSeen(0)
   {
-
+    this->invalidateShadow();
   }
 
   void NRF24Driver ::
@@ -36,52 +133,359 @@ namespace Components {
 
   }
 
+  void NRF24Driver ::
+    configure(const bool hardwareChipSelect, const U8 channel)
+  {
+    FW_ASSERT(channel <= NRF24::MAX_CHANNEL, channel);
+    m_hardwareChipSelect = hardwareChipSelect;
+    m_currentChannel = channel;
+  }
+
+  void NRF24Driver ::
+    attachRings(NRF24FrameRing& txRing, NRF24FrameRing& rxRing)
+  {
+    m_txRing = &txRing;
+    m_rxRing = &rxRing;
+  }
+
+  I32 NRF24Driver ::
+    openTrace(const char* path, U32 records)
+  {
+    return m_trace.open(path, records, m_hardwareChipSelect, m_currentChannel);
+  }
+
   // ----------------------------------------------------------------------
-  // Command handler implementations
+  // Handler implementations for user-defined typed input ports
   // ----------------------------------------------------------------------
 
   void NRF24Driver ::
-  INIT_cmdHandler(const FwOpcodeType opCode,
-                  const U32 cmdSeq)
+    run_handler(
+        FwIndexType portNum,
+        U32 context
+    )
   {
-    // TODO: Initialize NRF24 module 
-    // 1. Configure SPI settings
-    // 2. Reset radio
-    // 3. Configure basic settings
-    // 4. Set initial channel and power
+    m_trace.input(NRF24TraceRecord::RUN);
+    // Once a run period the trace goes to the file, what a crash loses is at most that old
+    m_trace.flush();
+    publishTelemetry();
+    if (m_state == NRF24RadioState::UNINITIALIZED) {
+      return;
+    }
+
+    reportLinkStats();
 
-    m_isInitialized = true;
-    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK); 
+    // Read back the next few shadowed registers in one batch
+    U8 registers[SCRUB_REGISTERS_PER_CYCLE];
+    U32 segments[SCRUB_REGISTERS_PER_CYCLE];
+    U32 count = 0;
+    m_batch.clear();
+    for (U32 visited = 0; visited < SHADOWED_REGISTER_COUNT && count < SCRUB_REGISTERS_PER_CYCLE; visited++) {
+      const U8 reg = SHADOWED_REGISTERS[m_scrubIndex];
+      m_scrubIndex = (m_scrubIndex + 1) % SHADOWED_REGISTER_COUNT;
+      if (!m_shadowValid[reg]) {
+        continue;
+      }
+      const bool queued = m_batch.readRegister(reg, NRF24::registerWidth(reg), segments[count]);
+      FW_ASSERT(queued);
+      registers[count] = reg;
+      count++;
+    }
+    if (count == 0) {
+      return;
+    }
+    transact(m_batch);
+
+    // Collect the drifted registers first, the restore reuses m_batch
+    U8 drifted[SCRUB_REGISTERS_PER_CYCLE];
+    U32 driftCount = 0;
+    for (U32 i = 0; i < count; i++) {
+      const U8 reg = registers[i];
+      if (std::memcmp(m_batch.response(segments[i]), m_shadow[reg], NRF24::registerWidth(reg)) != 0) {
+        drifted[driftCount] = reg;
+        driftCount++;
+      }
+    }
+    if (driftCount == 0) {
+      return;
+    }
+
+    // Put the shadow value back so the link keeps running on the intended configuration
+    m_batch.clear();
+    for (U32 i = 0; i < driftCount; i++) {
+      const U8 reg = drifted[i];
+      this->log_WARNING_HI_Error(ERROR_REGISTER_DRIFT | reg);
+      const bool queued = m_batch.writeRegister(reg, m_shadow[reg], NRF24::registerWidth(reg));
+      FW_ASSERT(queued);
+    }
+    transact(m_batch);
+    m_registerDrifts += driftCount;
+    this->tlmWrite_RegisterDrifts(m_registerDrifts);
   }
 
   void NRF24Driver ::
-    SEND_PACKET_cmdHandler(
-        const FwOpcodeType opCode,
-        const U32 cmdSeq,
-        const Fw::CmdStringArg& data //!< Data to transmit
+    irqIn_handler(
+        FwIndexType portNum,
+        Os::RawTime& cycleStart
+    )
+  {
+    m_trace.input(NRF24TraceRecord::IRQ);
+    this->drain(cycleStart);
+  }
+
+  void NRF24Driver ::
+    service_handler(
+        FwIndexType portNum,
+        U32 context
+    )
+  {
+    if (m_state == NRF24RadioState::UNINITIALIZED || !this->isConnected_irqRead_OutputPort(0)) {
+      return;
+    }
+    // Most ticks find the line high and change nothing, they stay out of the trace
+    Fw::Logic level = Fw::Logic::HIGH;
+    const bool asserted = (this->irqRead_out(0, level) == Drv::GpioStatus::OP_OK) && (level == Fw::Logic::LOW);
+    if (!asserted) {
+      return;
+    }
+    // The read goes ahead of the input, a replay answers it before it learns what the tick found
+    m_trace.level(NRF24TraceRecord::IRQ_LINE, false);
+    m_trace.input(NRF24TraceRecord::SERVICE);
+
+    // irqIn has the higher queue priority, an edge queued behind this tick is rare and its drain finds the FIFOs empty
+    m_irqPolledDrains++;
+    Os::RawTime now;
+    (void)now.now();
+    this->drain(now);
+  }
+
+  void NRF24Driver ::
+    bufferSendIn_handler(
+        FwIndexType portNum,
+        Fw::Buffer& fwBuffer
+    )
+  {
+    const FwSizeType length = fwBuffer.getSize();
+    const U32 context = fwBuffer.getContext();
+    m_trace.bufferSend(
+        static_cast<U8>((context & NRF24::TX_CONTEXT_PIPE_MASK) >> NRF24::TX_CONTEXT_PIPE_SHIFT),
+        static_cast<U8>((context & NRF24::TX_CONTEXT_NODE_MASK) >> NRF24::TX_CONTEXT_NODE_SHIFT),
+        (context & NRF24::TX_CONTEXT_NO_ACK) != 0,
+        fwBuffer.getData(),
+        static_cast<U8>(FW_MIN(length, static_cast<FwSizeType>(NRF24TraceRecord::DATA_SIZE))));
+    const bool ready = (m_state != NRF24RadioState::UNINITIALIZED);
+    if (!ready || length == 0 || length > NRF24::MAX_PAYLOAD_SIZE || m_txPendingCount == TX_PENDING_DEPTH) {
+      if (ready && m_txPendingCount < TX_PENDING_DEPTH) {
+        this->log_WARNING_HI_Error(ERROR_PAYLOAD_SIZE);
+      }
+      m_packetsDropped++;
+      this->deallocate_out(0, fwBuffer);
+      return;
+    }
+
+    // Buffers wait here until the TX FIFO has room; the payload is only copied by the SPI load
+    const U32 slot = (m_txPendingHead + m_txPendingCount) % TX_PENDING_DEPTH;
+    m_txPending[slot] = fwBuffer;
+    (void)m_txPendingAt[slot].now();
+    m_txPendingCount++;
+    serviceTx();
+  }
+
+  void NRF24Driver ::
+    txRingDoorbell_handler(
+        FwIndexType portNum,
+        U32 context
+    )
+  {
+    m_trace.input(NRF24TraceRecord::TX_DOORBELL);
+    FW_ASSERT(m_txRing != nullptr);
+    m_txRing->answerDoorbell();
+
+    // Like bufferSendIn, nothing waits for INIT
+    if (m_state == NRF24RadioState::UNINITIALIZED) {
+      const U32 frames = m_txRing->count();
+      m_packetsDropped += frames;
+      releaseRing(frames);
+      return;
+    }
+    serviceTx();
+  }
+
+  void NRF24Driver ::
+    surveyIn_handler(
+        FwIndexType portNum,
+        U8 dwells
     )
   {
-    if (!m_isInitialized) {
+    m_trace.input(NRF24TraceRecord::SURVEY, &dwells, 1);
+    if (!survey(dwells)) {
+      this->log_WARNING_HI_Error(ERROR_SURVEY_BUSY);
+    }
+  }
+
+  void NRF24Driver ::
+    tuneIn_handler(
+        FwIndexType portNum,
+        U8 channel,
+        const NRF24DataRate& rate,
+        U8 power
+    )
+  {
+    const U8 args[] = {channel, static_cast<U8>(rate.e), power};
+    m_trace.input(NRF24TraceRecord::TUNE, args, sizeof(args));
+    if (channel > NRF24::MAX_CHANNEL) {
+      this->log_WARNING_HI_Error(ERROR_TUNE_CHANNEL);
+      return;
+    }
+    if (power > NRF24::MAX_POWER_LEVEL) {
+      this->log_WARNING_HI_Error(ERROR_TUNE_POWER);
+      return;
+    }
+    m_currentChannel = channel;
+    m_currentRate = rate;
+    m_currentPower = power;
+    if (m_state != NRF24RadioState::UNINITIALIZED) {
+      retune();
+    }
+    this->tlmWrite_Channel(m_currentChannel);
+    this->tlmWrite_DataRate(m_currentRate);
+    this->tlmWrite_PowerLevel(m_currentPower);
+  }
+
+  void NRF24Driver ::
+    nodeAddressIn_handler(
+        FwIndexType portNum,
+        U8 node
+    )
+  {
+    m_trace.input(NRF24TraceRecord::NODE_ADDRESS, &node, 1);
+    if (node >= NRF24::MAX_NODES) {
+      this->log_WARNING_HI_Error(ERROR_NODE_ADDRESS);
+      return;
+    }
+    m_node = node;
+    if (m_state == NRF24RadioState::UNINITIALIZED) {
+      // INIT writes every address
+      return;
+    }
+
+    // Pipes 2 to 5 take their upper bytes from pipe 1, pipe 0 is set again on the way back to RX
+    U8 address[NRF24::MAX_ADDRESS_WIDTH];
+    pipeAddress(m_node, 1, address);
+    m_batch.clear();
+    const bool queued = queueWrite(NRF24::RX_ADDR_P1, address, sizeof(address));
+    FW_ASSERT(queued);
+    const bool listening = (m_state == NRF24RadioState::RECEIVE);
+    if (listening) {
+      setCE(false);
+    }
+    transact(m_batch);
+    if (listening) {
+      enterRx();
+    }
+  }
+
+  // ----------------------------------------------------------------------
+  // Command handler implementations
+  // ----------------------------------------------------------------------
+
+  void NRF24Driver ::
+  INIT_cmdHandler(const FwOpcodeType opCode,
+                  const U32 cmdSeq)
+  {
+    m_trace.input(NRF24TraceRecord::INIT);
+    setState(NRF24RadioState::UNINITIALIZED);
+    m_rxEnabled = false;
+    releasePending();
+    setCE(false);
+
+    // The chip may have been reset or swapped, so every register is written again and the
+    // shadow is rebuilt from these writes.
+    this->invalidateShadow();
+
+    // The whole power-down configuration goes out as one batch; addresses are written
+    // with a single multi-byte W_REGISTER each.
+    const U8 setup = rfSetupValue();
+    m_batch.clear();
+    bool queued = queueWrite(NRF24::CONFIG, CONFIG_BASE);
+    queued = queued && queueWrite(NRF24::SETUP_AW, 0x03);
+    queued = queued && queueWrite(NRF24::SETUP_RETR, SETUP_RETR_DEFAULT);
+    queued = queued && queueWrite(NRF24::RF_CH, m_currentChannel);
+    queued = queued && queueWrite(NRF24::RF_SETUP, setup);
+    queued = queued && queueWrite(NRF24::EN_AA, 0x3F);
+    queued = queued && queueWrite(NRF24::EN_RXADDR, 0x3F);
+    queued = queued && queueWrite(NRF24::FEATURE, NRF24::FEATURE_EN_DPL | NRF24::FEATURE_EN_DYN_ACK);
+    queued = queued && queueWrite(NRF24::DYNPD, 0x3F);
+    U8 ownAddress[NRF24::MAX_ADDRESS_WIDTH];
+    pipeAddress(m_node, 0, ownAddress);
+    queued = queued && queueWrite(NRF24::TX_ADDR, ownAddress, sizeof(ownAddress));
+    queued = queued && queueWrite(NRF24::RX_ADDR_P0, ownAddress, sizeof(ownAddress));
+    U8 address[NRF24::MAX_ADDRESS_WIDTH];
+    pipeAddress(m_node, 1, address);
+    queued = queued && queueWrite(NRF24::RX_ADDR_P1, address, sizeof(address));
+    for (U8 pipe = 2; pipe < NRF24::PIPE_COUNT; pipe++) {
+      pipeAddress(m_node, pipe, address);
+      queued = queued && queueWrite(static_cast<U8>(NRF24::RX_ADDR_P0 + pipe), address[0]);
+    }
+    queued = queued && m_batch.command(NRF24::FLUSH_TX);
+    queued = queued && m_batch.command(NRF24::FLUSH_RX);
+    queued = queued && m_batch.writeRegister(NRF24::STATUS, NRF24::STATUS_IRQ_MASK);
+    queued = queued && queueWrite(NRF24::CONFIG, CONFIG_BASE | NRF24::CONFIG_PWR_UP);
+    if (!queued) {
+      this->invalidateShadow();
+      this->log_WARNING_HI_Error(ERROR_BATCH_OVERFLOW);
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::EXECUTION_ERROR);
+      return;
+    }
+    transact(m_batch);
+
+    // Crystal start-up before the chip leaves power down
+    Os::Task::delay(Fw::TimeInterval(0, NRF24::POWER_UP_TIME_US));
+
+    // Read back in one batch to confirm the chip is present and accepted the writes
+    U32 configSeg = 0;
+    U32 channelSeg = 0;
+    U32 addressSeg = 0;
+    m_batch.clear();
+    queued = m_batch.readRegister(NRF24::CONFIG, 1, configSeg);
+    queued = queued && m_batch.readRegister(NRF24::RF_CH, 1, channelSeg);
+    queued = queued && m_batch.readRegister(NRF24::TX_ADDR, sizeof(ownAddress), addressSeg);
+    FW_ASSERT(queued);
+    transact(m_batch);
+
+    if (m_batch.response(configSeg)[0] != (CONFIG_BASE | NRF24::CONFIG_PWR_UP) ||
+        m_batch.response(channelSeg)[0] != m_currentChannel ||
+        std::memcmp(m_batch.response(addressSeg), ownAddress, sizeof(ownAddress)) != 0) {
+      this->log_WARNING_HI_Error(ERROR_INIT_VERIFY);
       this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::EXECUTION_ERROR);
       return;
     }
-    
-    // TODO: Implement send logic here
-    
+
+    m_txFifoFree = NRF24::FIFO_DEPTH;
+    m_txPipe = 0;
+    m_txNode = m_node;
+    setState(NRF24RadioState::STANDBY);
+    this->log_ACTIVITY_HI_InitComplete();
     this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
   }
 
   void NRF24Driver ::
-    START_RECEIVE_cmdHandler(const FwOpcodeType opCode, const U32 cmdSeq) 
+    START_RECEIVE_cmdHandler(const FwOpcodeType opCode, const U32 cmdSeq)
     {
-      if (!m_isInitialized) {
+      m_trace.input(NRF24TraceRecord::START_RECEIVE);
+      if (m_state == NRF24RadioState::UNINITIALIZED) {
         this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::EXECUTION_ERROR);
         return;
       }
 
+      // Frames are drained from irqIn from here on; a transmission in progress returns to RX when it ends
+      m_rxEnabled = true;
+      if (m_state == NRF24RadioState::STANDBY) {
+        enterRx();
+      }
+
       this-> cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
     }
-    
+
 
     void NRF24Driver ::
     CONFIGURE_cmdHandler(
@@ -91,23 +495,91 @@ namespace Components {
         const U8 power
     )
   {
-    if (channel > 125) {
+    const U8 args[] = {channel, power};
+    m_trace.input(NRF24TraceRecord::CONFIGURE, args, sizeof(args));
+    if (channel > NRF24::MAX_CHANNEL) {
       this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
       return;
     }
 
-    if (power > 3) {
+    if (power > NRF24::MAX_POWER_LEVEL) {
       this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
       return;
     }
 
-    // TODO: Configure radio parameters
-    // 1. Set RF channel
-    // 2. Set TX power level
-    
     m_currentChannel = channel;
     m_currentPower = power;
-    
+
+    // Before INIT the values are only recorded, INIT writes them
+    if (m_state != NRF24RadioState::UNINITIALIZED) {
+      retune();
+    }
+    this->tlmWrite_Channel(m_currentChannel);
+    this->tlmWrite_PowerLevel(m_currentPower);
+
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void NRF24Driver ::
+    SET_STREAMING_cmdHandler(
+        const FwOpcodeType opCode,
+        const U32 cmdSeq,
+        Fw::Enabled mode,
+        bool noAck
+    )
+  {
+    const U8 args[] = {static_cast<U8>(mode == Fw::Enabled::ENABLED), static_cast<U8>(noAck)};
+    m_trace.input(NRF24TraceRecord::SET_STREAMING, args, sizeof(args));
+    m_streaming = (mode == Fw::Enabled::ENABLED);
+    m_noAck = noAck;
+
+    if (!m_streaming && m_state == NRF24RadioState::STREAMING) {
+      // Whatever is still in the FIFO goes out with per payload pulses
+      setCE(false);
+      if (txFifoEmpty()) {
+        finishTx();
+      } else {
+        setState(NRF24RadioState::TRANSMIT);
+        pulseCE();
+      }
+    } else if (m_streaming && m_state == NRF24RadioState::TRANSMIT) {
+      setCE(true);
+      setState(NRF24RadioState::STREAMING);
+    }
+
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void NRF24Driver ::
+    SURVEY_CHANNELS_cmdHandler(
+        const FwOpcodeType opCode,
+        const U32 cmdSeq,
+        U8 dwells
+    )
+  {
+    m_trace.input(NRF24TraceRecord::SURVEY_CHANNELS, &dwells, 1);
+    if (dwells == 0) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    const bool surveyed = survey(dwells);
+    this->cmdResponse_out(opCode, cmdSeq, surveyed ? Fw::CmdResponse::OK : Fw::CmdResponse::EXECUTION_ERROR);
+  }
+
+  void NRF24Driver ::
+    SET_DATA_RATE_cmdHandler(
+        const FwOpcodeType opCode,
+        const U32 cmdSeq,
+        NRF24DataRate rate
+    )
+  {
+    const U8 args[] = {static_cast<U8>(rate.e)};
+    m_trace.input(NRF24TraceRecord::SET_DATA_RATE, args, sizeof(args));
+    m_currentRate = rate;
+    if (m_state != NRF24RadioState::UNINITIALIZED) {
+      retune();
+    }
+    this->tlmWrite_DataRate(m_currentRate);
     this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
   }
 
@@ -115,58 +587,690 @@ namespace Components {
   // Helper functions
   // ----------------------------------------------------------------------
 
+  void NRF24Driver ::
+    drain(Os::RawTime& cycleStart)
+  {
+    if (m_state == NRF24RadioState::UNINITIALIZED) {
+      return;
+    }
+
+    // Stamp frames with the IRQ edge rather than the time this handler got to run
+    Fw::Time timestamp = this->getTime();
+    Os::RawTime now;
+    U32 latencyUs = 0;
+    if (now.now() == Os::RawTime::OP_OK && now.getDiffUsec(cycleStart, latencyUs) == Os::RawTime::OP_OK) {
+      const Fw::Time latency(timestamp.getTimeBase(), timestamp.getContext(), latencyUs / 1000000, latencyUs % 1000000);
+      if (timestamp >= latency) {
+        timestamp = Fw::Time::sub(timestamp, latency);
+      }
+    }
+
+    U8 txFlags = 0;
+    U8 fifoStatus = 0;
+    bool flushRx = false;
+    for (U32 pass = 0; pass < MAX_DRAIN_PASSES && !flushRx; pass++) {
+      // All three FIFO levels are read speculatively in one batch. The STATUS byte clocked out
+      // on each R_RX_PL_WID shows the pipe of the head frame, or RX_P_NO_EMPTY once drained;
+      // the one clocked out on each R_RX_PAYLOAD shows whether that read popped a frame.
+      U32 widthSeg[NRF24::FIFO_DEPTH];
+      U32 payloadSeg[NRF24::FIFO_DEPTH];
+      U32 statusSeg = 0;
+      U32 fifoSeg = 0;
+      m_batch.clear();
+      bool queued = true;
+      for (U32 level = 0; level < NRF24::FIFO_DEPTH; level++) {
+        queued = queued && m_batch.read(NRF24::R_RX_PL_WID, 1, widthSeg[level]);
+        queued = queued && m_batch.read(NRF24::R_RX_PAYLOAD, NRF24::MAX_PAYLOAD_SIZE, payloadSeg[level]);
+      }
+      statusSeg = m_batch.segmentCount();
+      queued = queued && m_batch.writeRegister(NRF24::STATUS, NRF24::STATUS_IRQ_MASK);
+      queued = queued && m_batch.readRegister(NRF24::FIFO_STATUS, 1, fifoSeg);
+      FW_ASSERT(queued);
+      transact(m_batch);
+
+      U32 drained = 0;
+      for (U32 level = 0; level < NRF24::FIFO_DEPTH; level++) {
+        const U8 pipe = (m_batch.status(payloadSeg[level]) & NRF24::STATUS_RX_P_NO_MASK) >> NRF24::STATUS_RX_P_NO_SHIFT;
+        if (pipe == NRF24::RX_P_NO_EMPTY) {
+          // Nothing popped, a frame landing after this read is seen by the next level's width read
+          continue;
+        }
+        drained++;
+        const U8 widthPipe =
+            (m_batch.status(widthSeg[level]) & NRF24::STATUS_RX_P_NO_MASK) >> NRF24::STATUS_RX_P_NO_SHIFT;
+        if (widthPipe != pipe) {
+          // The frame landed between the width read and the payload read, which popped it without
+          // a width to deliver it with
+          m_rxDropped++;
+          continue;
+        }
+        const U8 width = m_batch.response(widthSeg[level])[0];
+        if (width == 0 || width > NRF24::MAX_PAYLOAD_SIZE) {
+          // Corrupt width, the datasheet requires the RX FIFO to be flushed
+          flushRx = true;
+          break;
+        }
+        deliverFrame(pipe, timestamp, m_batch.response(payloadSeg[level]), width);
+      }
+      m_rxFifoFill[drained]++;
+      if (drained == NRF24::FIFO_DEPTH) {
+        m_rxFifoOverflows++;
+      }
+
+      // STATUS as it was just before the flags were cleared
+      txFlags |= m_batch.status(statusSeg) & (NRF24::STATUS_TX_DS | NRF24::STATUS_MAX_RT);
+      fifoStatus = m_batch.response(fifoSeg)[0];
+
+      // Go again if frames arrived during the drain or the line is still asserted
+      const bool irqLow = this->isConnected_irqRead_OutputPort(0) && this->irqAsserted();
+      if ((fifoStatus & NRF24::FIFO_STATUS_RX_EMPTY) != 0 && !irqLow) {
+        break;
+      }
+    }
+
+    m_batch.clear();
+    // ARC_CNT only covers the payload that completed last, earlier ones in the same interrupt go uncounted
+    U32 observeSeg = 0;
+    if (txFlags != 0) {
+      const bool queued = m_batch.readRegister(NRF24::OBSERVE_TX, 1, observeSeg);
+      FW_ASSERT(queued);
+    }
+    if (flushRx) {
+      const bool queued = m_batch.command(NRF24::FLUSH_RX);
+      FW_ASSERT(queued);
+      m_rxDropped++;
+      this->log_WARNING_HI_Error(ERROR_RX_WIDTH);
+    }
+    const bool failed = (txFlags & NRF24::STATUS_MAX_RT) != 0;
+    if (failed) {
+      // The failed payload stays at the FIFO head and blocks the queue until flushed
+      const bool queued = m_batch.command(NRF24::FLUSH_TX);
+      FW_ASSERT(queued);
+      m_txFailures++;
+    }
+    transact(m_batch);
+
+    if (txFlags != 0) {
+      m_txRetransmits += m_batch.response(observeSeg)[0] & NRF24::OBSERVE_TX_ARC_CNT_MASK;
+      txComplete(failed, fifoStatus);
+    }
+  }
+
   bool NRF24Driver ::
-    writeRegister(U8 reg, U8 value)
+    queueWrite(U8 reg, U8 value)
   {
-    // TODO: Implement SPI register write
-    // 1. Set CSN low
-    // 2. Send write command + register address
-    // 3. Send data
-    // 4. Set CSN high
+    return queueWrite(reg, &value, 1);
+  }
+
+  bool NRF24Driver ::
+    queueWrite(U8 reg, const U8* data, U8 length)
+  {
+    FW_ASSERT(length <= NRF24::MAX_ADDRESS_WIDTH, length);
+
+    if (!isShadowed(reg)) {
+      return m_batch.writeRegister(reg, data, length);
+    }
+    if (m_shadowValid[reg] && std::memcmp(m_shadow[reg], data, length) == 0) {
+      m_writesSkipped++;
+      return true;
+    }
+    if (!m_batch.writeRegister(reg, data, length)) {
+      return false;
+    }
+    std::memcpy(m_shadow[reg], data, length);
+    m_shadowValid[reg] = true;
     return true;
   }
 
+  void NRF24Driver ::
+    invalidateShadow()
+  {
+    std::memset(m_shadow, 0, sizeof(m_shadow));
+    for (U32 reg = 0; reg < NRF24::REGISTER_COUNT; reg++) {
+      m_shadowValid[reg] = false;
+    }
+  }
+
+  void NRF24Driver ::
+    enterRx()
+  {
+    // Pipe 0 follows TX_ADDR while transmitting, to catch the ACKs, and listens on its own address here
+    U8 address[NRF24::MAX_ADDRESS_WIDTH];
+    pipeAddress(m_node, 0, address);
+    m_batch.clear();
+    bool queued = queueWrite(NRF24::RX_ADDR_P0, address, sizeof(address));
+    queued = queued && queueWrite(NRF24::CONFIG, CONFIG_BASE | NRF24::CONFIG_PWR_UP | NRF24::CONFIG_PRIM_RX);
+    FW_ASSERT(queued);
+    transact(m_batch);
+    setCE(true);
+    setState(NRF24RadioState::RECEIVE);
+  }
+
+  void NRF24Driver ::
+    retune()
+  {
+    // Repeating the current settings leaves the batch empty and costs no SPI traffic
+    m_batch.clear();
+    bool queued = queueWrite(NRF24::RF_CH, m_currentChannel);
+    queued = queued && queueWrite(NRF24::RF_SETUP, rfSetupValue());
+    FW_ASSERT(queued);
+    if (m_batch.segmentCount() > 0) {
+      // A receiver only relocks its PLL on the standby to RX transition
+      const bool listening = (m_state == NRF24RadioState::RECEIVE);
+      if (listening) {
+        setCE(false);
+      }
+      transact(m_batch);
+      if (listening) {
+        setCE(true);
+      }
+    }
+  }
+
   bool NRF24Driver ::
-    readRegister(U8 reg, U8& value)
-  {
-    // TODO: Implement SPI register read
-    // 1. Set CSN low  
-    // 2. Send read command + register address
-    // 3. Read data
-    // 4. Set CSN high
-    value = 0;
+    survey(U8 dwells)
+  {
+    if (dwells == 0 || (m_state != NRF24RadioState::STANDBY && m_state != NRF24RadioState::RECEIVE)) {
+      return false;
+    }
+
+    Os::RawTime start;
+    (void)start.now();
+    setCE(false);
+    setState(NRF24RadioState::SURVEYING);
+    m_batch.clear();
+    bool queued = queueWrite(NRF24::CONFIG, CONFIG_BASE | NRF24::CONFIG_PWR_UP | NRF24::CONFIG_PRIM_RX);
+    FW_ASSERT(queued);
+    transact(m_batch);
+
+    for (U32 channel = 0; channel < NRF24ChannelOccupancy::SIZE; channel++) {
+      m_occupancy[channel] = 0;
+    }
+
+    // RPD latches when CE falls, so each dwell costs one batch: read the RPD of the channel
+    // just left and tune the next. RF_CH is written around the shadow, which keeps the link
+    // channel, and the final batch puts it back.
+    const U32 steps = static_cast<U32>(dwells) * NRF24ChannelOccupancy::SIZE;
+    for (U32 step = 0; step <= steps; step++) {
+      const U8 next = (step < steps) ? static_cast<U8>(step % NRF24ChannelOccupancy::SIZE) : m_currentChannel;
+      U32 rpdSeg = 0;
+      m_batch.clear();
+      queued = (step == 0) || m_batch.readRegister(NRF24::RPD, 1, rpdSeg);
+      queued = queued && m_batch.writeRegister(NRF24::RF_CH, next);
+      FW_ASSERT(queued);
+      transact(m_batch);
+      if (step > 0 && (m_batch.response(rpdSeg)[0] & NRF24::RPD_RPD) != 0) {
+        m_occupancy[(step - 1) % NRF24ChannelOccupancy::SIZE]++;
+      }
+      if (step < steps) {
+        setCE(true);
+        Os::Task::delay(Fw::TimeInterval(0, NRF24::RPD_SETTLE_TIME_US));
+        setCE(false);
+      }
+    }
+
+    if (m_rxEnabled) {
+      enterRx();
+    } else {
+      m_batch.clear();
+      queued = queueWrite(NRF24::CONFIG, CONFIG_BASE | NRF24::CONFIG_PWR_UP);
+      FW_ASSERT(queued);
+      transact(m_batch);
+      setState(NRF24RadioState::STANDBY);
+    }
+
+    U32 cleanest = 0;
+    for (U32 channel = 1; channel < NRF24ChannelOccupancy::SIZE; channel++) {
+      if (m_occupancy[channel] < m_occupancy[cleanest]) {
+        cleanest = channel;
+      }
+    }
+    Os::RawTime end;
+    U32 durationUs = 0;
+    if (end.now() == Os::RawTime::OP_OK) {
+      (void)end.getDiffUsec(start, durationUs);
+    }
+    this->tlmWrite_ChannelOccupancy(m_occupancy);
+    this->log_ACTIVITY_HI_ChannelSurveyComplete(dwells, static_cast<U8>(cleanest), durationUs);
+    if (this->isConnected_surveyOut_OutputPort(0)) {
+      this->surveyOut_out(0, m_occupancy, dwells, m_currentChannel);
+    }
+
+    // Frames that queued up meanwhile
+    serviceTx();
     return true;
   }
 
   void NRF24Driver ::
-    setCE(bool state)
+    serviceTx()
   {
-    // Set CE pin state via GPIO port
-    this->cePin_out(0, state ? Fw::Logic::HIGH : Fw::Logic::LOW);
+    // Buffers from bufferSendIn go first, then the frames waiting in the TX ring
+    const U32 buffered = m_txPendingCount;
+    const U32 ringFrames = (m_txRing != nullptr) ? m_txRing->count() : 0;
+    const U32 pending = buffered + ringFrames;
+    if (m_state == NRF24RadioState::UNINITIALIZED || pending == 0 || m_txFifoFree == 0) {
+      return;
+    }
+
+    // The frames as the manager handed them over, a replay puts them back in the ring
+    if (m_trace.isOpen()) {
+      for (U32 index = m_traceRingSeen; index < ringFrames; index++) {
+        const NRF24FrameRing::Slot& slot = m_txRing->peek(index);
+        m_trace.frame(NRF24TraceRecord::TX_FRAME, slot.pipe, slot.node, slot.noAck, slot.data, slot.length);
+      }
+      m_traceRingSeen = ringFrames;
+    }
+
+    const U32 opsBefore = m_busOps;
+
+    // A receiving radio drops to standby and PTX, txComplete brings it back
+    if (m_state == NRF24RadioState::RECEIVE) {
+      setCE(false);
+    }
+
+    // Every payload that can fit goes out in one batch. In STREAMING with CE high the chip
+    // starts sending the first one while the rest are still being clocked in.
+    U32 segments[NRF24::FIFO_DEPTH];
+    bool acked[NRF24::FIFO_DEPTH];
+    U32 count = 0;
+    m_batch.clear();
+    bool queued = queueWrite(NRF24::CONFIG, CONFIG_BASE | NRF24::CONFIG_PWR_UP);
+
+    // TX_ADDR applies to every payload in the FIFO when it goes out, so it only moves to another
+    // pipe or node once the FIFO has drained. Pipe 0 must match it for the auto-ACKs; both writes
+    // are skipped by the shadow when nothing changed.
+    const U8 firstPipe = pendingPipe(0, buffered);
+    const U8 firstNode = pendingNode(0, buffered);
+    if ((firstPipe != m_txPipe || firstNode != m_txNode) && m_txFifoFree == NRF24::FIFO_DEPTH) {
+      m_txPipe = firstPipe;
+      m_txNode = firstNode;
+      m_txPipeSwitches++;
+    }
+    U8 address[NRF24::MAX_ADDRESS_WIDTH];
+    pipeAddress(m_txNode, m_txPipe, address);
+    queued = queued && queueWrite(NRF24::TX_ADDR, address, sizeof(address));
+    queued = queued && queueWrite(NRF24::RX_ADDR_P0, address, sizeof(address));
+
+    // Loading stops at the first payload for another pipe or node
+    while (queued && count < m_txFifoFree && count < pending && pendingPipe(count, buffered) == m_txPipe &&
+           pendingNode(count, buffered) == m_txNode) {
+      const U8* data = nullptr;
+      U8 length = 0;
+      bool noAck = m_noAck;
+      if (count < buffered) {
+        const Fw::Buffer& buffer = m_txPending[(m_txPendingHead + count) % TX_PENDING_DEPTH];
+        data = buffer.getData();
+        length = static_cast<U8>(buffer.getSize());
+        noAck = noAck || (buffer.getContext() & NRF24::TX_CONTEXT_NO_ACK) != 0;
+      } else {
+        // Loaded straight from the ring slot, the SPI batch is the only copy
+        const NRF24FrameRing::Slot& slot = m_txRing->peek(count - buffered);
+        data = slot.data;
+        length = slot.length;
+        noAck = noAck || slot.noAck;
+      }
+      const U8 command = noAck ? NRF24::W_TX_PAYLOAD_NOACK : NRF24::W_TX_PAYLOAD;
+      segments[count] = m_batch.segmentCount();
+      acked[count] = !noAck;
+      queued = m_batch.write(command, data, length);
+      count++;
+    }
+    FW_ASSERT(queued);
+    transact(m_batch);
+
+    // The STATUS byte clocked out with each W_TX_PAYLOAD shows whether the FIFO had room
+    // for it. Loading stops at the first full one; it and the rest stay pending.
+    U32 loaded = 0;
+    U32 ringLoaded = 0;
+    for (; loaded < count; loaded++) {
+      if ((m_batch.status(segments[loaded]) & NRF24::STATUS_TX_FULL) != 0) {
+        m_txFifoFree = 0;
+        break;
+      }
+      if (acked[loaded]) {
+        m_ackedSent++;
+      }
+      if (loaded < buffered) {
+        m_txBytes += static_cast<U32>(m_txPending[m_txPendingHead].getSize());
+        m_txQueueLatency.recordSince(m_txPendingAt[m_txPendingHead]);
+        this->deallocate_out(0, m_txPending[m_txPendingHead]);
+        m_txPendingHead = (m_txPendingHead + 1) % TX_PENDING_DEPTH;
+        m_txPendingCount--;
+      } else {
+        const NRF24FrameRing::Slot& slot = m_txRing->peek(ringLoaded);
+        m_txBytes += slot.length;
+        m_txQueueLatency.recordSince(slot.queuedAt);
+        ringLoaded++;
+      }
+    }
+    releaseRing(ringLoaded);
+    if (m_txFifoFree > 0) {
+      m_txFifoFree -= loaded;
+    }
+    if (loaded > 0) {
+      m_txFifoFill[NRF24::FIFO_DEPTH - m_txFifoFree]++;
+    }
+    if (loaded == 0) {
+      if (m_state == NRF24RadioState::RECEIVE) {
+        enterRx();
+      }
+      return;
+    }
+
+    if (m_streaming) {
+      if (m_state != NRF24RadioState::STREAMING) {
+        setCE(true);
+        setState(NRF24RadioState::STREAMING);
+      }
+    } else if (m_state != NRF24RadioState::TRANSMIT) {
+      // In TRANSMIT the next pulse is issued by txComplete
+      pulseCE();
+      setState(NRF24RadioState::TRANSMIT);
+    }
+
+    m_packetsSent += loaded;
+    m_spiOpsPerPacket = (m_busOps - opsBefore) / loaded;
+  }
+
+  U8 NRF24Driver ::
+    pendingPipe(U32 index, U32 buffered) const
+  {
+    U32 pipe = 0;
+    if (index < buffered) {
+      const U32 context = m_txPending[(m_txPendingHead + index) % TX_PENDING_DEPTH].getContext();
+      pipe = (context & NRF24::TX_CONTEXT_PIPE_MASK) >> NRF24::TX_CONTEXT_PIPE_SHIFT;
+    } else {
+      pipe = m_txRing->peek(index - buffered).pipe;
+    }
+    return (pipe < NRF24::PIPE_COUNT) ? static_cast<U8>(pipe) : 0;
+  }
+
+  U8 NRF24Driver ::
+    pendingNode(U32 index, U32 buffered) const
+  {
+    U32 node = 0;
+    if (index < buffered) {
+      const U32 context = m_txPending[(m_txPendingHead + index) % TX_PENDING_DEPTH].getContext();
+      node = (context & NRF24::TX_CONTEXT_NODE_MASK) >> NRF24::TX_CONTEXT_NODE_SHIFT;
+    } else {
+      node = m_txRing->peek(index - buffered).node;
+    }
+    return (node < NRF24::MAX_NODES) ? static_cast<U8>(node) : 0;
   }
 
   void NRF24Driver ::
-    setCSN(bool state)
+    txComplete(bool failed, U8 fifoStatus)
   {
-    // Set CSN pin state via GPIO port  
-    this->csnPin_out(0, state ? Fw::Logic::HIGH : Fw::Logic::LOW);
+    if (m_state != NRF24RadioState::TRANSMIT && m_state != NRF24RadioState::STREAMING) {
+      return;
+    }
+
+    // FIFO_STATUS has no fill level, so anything between empty and full counts as one slot taken
+    if (failed || (fifoStatus & NRF24::FIFO_STATUS_TX_EMPTY) != 0) {
+      m_txFifoFree = NRF24::FIFO_DEPTH;
+    } else if ((fifoStatus & NRF24::FIFO_STATUS_TX_FULL) != 0) {
+      m_txFifoFree = 0;
+    } else {
+      m_txFifoFree = NRF24::FIFO_DEPTH - 1;
+    }
+
+    serviceTx();
+    const bool fifoEmpty = (m_txFifoFree == NRF24::FIFO_DEPTH);
+
+    if (m_state == NRF24RadioState::TRANSMIT) {
+      if (fifoEmpty) {
+        finishTx();
+      } else {
+        pulseCE();
+      }
+    } else if (fifoEmpty) {
+      m_txUnderruns++;
+      // A streaming radio idles in standby-II with CE high unless it has to listen
+      if (!m_streaming || m_rxEnabled) {
+        finishTx();
+      }
+    }
   }
 
-}
+  void NRF24Driver ::
+    finishTx()
+  {
+    setCE(false);
+    if (m_rxEnabled) {
+      enterRx();
+    } else {
+      setState(NRF24RadioState::STANDBY);
+    }
+  }
+
+  bool NRF24Driver ::
+    txFifoEmpty()
+  {
+    U32 segment = 0;
+    m_batch.clear();
+    const bool queued = m_batch.readRegister(NRF24::FIFO_STATUS, 1, segment);
+    FW_ASSERT(queued);
+    transact(m_batch);
+    return (m_batch.response(segment)[0] & NRF24::FIFO_STATUS_TX_EMPTY) != 0;
+  }
+
+  void NRF24Driver ::
+    releasePending()
+  {
+    while (m_txPendingCount > 0) {
+      this->deallocate_out(0, m_txPending[m_txPendingHead]);
+      m_txPendingHead = (m_txPendingHead + 1) % TX_PENDING_DEPTH;
+      m_txPendingCount--;
+      m_packetsDropped++;
+    }
+    if (m_txRing != nullptr) {
+      const U32 frames = m_txRing->count();
+      m_packetsDropped += frames;
+      releaseRing(frames);
+    }
+  }
+
+  void NRF24Driver ::
+    releaseRing(U32 frames)
+  {
+    m_traceRingSeen = (frames >= m_traceRingSeen) ? 0 : m_traceRingSeen - frames;
+    if (frames > 0 && m_txRing->release(frames)) {
+      this->txRingSpace_out(0, 0);
+    }
+  }
 
+  void NRF24Driver ::
+    setState(NRF24RadioState state)
+  {
+    m_state = state;
+  }
 
+  void NRF24Driver ::
+    pulseCE()
+  {
+    setCE(true);
+    setCE(false);
+  }
 
+  void NRF24Driver ::
+    deliverFrame(U8 pipe, const Fw::Time& timestamp, const U8* data, U8 length)
+  {
+    m_trace.frame(NRF24TraceRecord::RX_FRAME, pipe, 0, false, data, length);
+    if (m_rxRing != nullptr) {
+      // The radio cannot be held off, a full ring loses the frame
+      NRF24FrameRing::Slot* slot = m_rxRing->claim();
+      if (slot == nullptr) {
+        m_rxDropped++;
+        return;
+      }
+      slot->pipe = pipe;
+      slot->noAck = false;
+      slot->length = length;
+      slot->timestamp = timestamp;
+      std::memcpy(slot->data, data, length);
+      m_framesReceived++;
+      m_rxBytes += length;
+      if (m_rxRing->publish()) {
+        this->rxRingDoorbell_out(0, 0);
+      }
+      return;
+    }
 
+    if (!this->isConnected_allocate_OutputPort(0) || !this->isConnected_dataOut_OutputPort(0)) {
+      m_rxDropped++;
+      return;
+    }
 
+    const U32 size = RX_HEADER_SIZE + length;
+    Fw::Buffer buffer = this->allocate_out(0, size);
+    if (buffer.getData() == nullptr || buffer.getSize() < size) {
+      if (buffer.getData() != nullptr) {
+        this->deallocate_out(0, buffer);
+      }
+      m_rxDropped++;
+      return;
+    }
 
+    Fw::ExternalSerializeBuffer serializer(buffer.getData(), buffer.getSize());
+    Fw::SerializeStatus status = serializer.serialize(pipe);
+    FW_ASSERT(status == Fw::FW_SERIALIZE_OK, status);
+    status = serializer.serialize(timestamp);
+    FW_ASSERT(status == Fw::FW_SERIALIZE_OK, status);
+    std::memcpy(buffer.getData() + RX_HEADER_SIZE, data, length);
+    buffer.setSize(size);
 
+    m_framesReceived++;
+    m_rxBytes += length;
+    this->dataOut_out(0, buffer);
+  }
 
+  void NRF24Driver ::
+    transact(NRF24SpiBatch& batch)
+  {
+    // The chip decodes one command per CSN low period, so each segment is its own
+    // transfer. With a hardware chip select the SPI controller frames each transfer and
+    // no GPIO writes are needed at all.
+    Os::RawTime start;
+    const bool timed = batch.segmentCount() > 0 && start.now() == Os::RawTime::OP_OK;
+    for (U32 segment = 0; segment < batch.segmentCount(); segment++) {
+      Fw::Buffer writeBuffer(batch.txData(segment), batch.length(segment));
+      Fw::Buffer readBuffer(batch.rxData(segment), batch.length(segment));
+      if (!m_hardwareChipSelect) {
+        setCSN(false);
+      }
+      this->spiOut_out(0, writeBuffer, readBuffer);
+      m_trace.spi(batch.txData(segment), batch.rxData(segment), batch.length(segment));
+      m_spiTransfers++;
+      m_busOps++;
+      if (!m_hardwareChipSelect) {
+        setCSN(true);
+      }
+    }
+    if (timed) {
+      m_spiBatchTime.recordSince(start);
+    }
+  }
 
+  void NRF24Driver ::
+    reportLinkStats()
+  {
+    if (!this->isConnected_linkStatsOut_OutputPort(0)) {
+      return;
+    }
+    this->linkStatsOut_out(0,
+        m_ackedSent - m_statsAckedSent,
+        m_txRetransmits - m_statsRetransmits,
+        m_txFailures - m_statsFailures,
+        m_currentChannel, m_currentRate, m_currentPower);
+    m_statsAckedSent = m_ackedSent;
+    m_statsRetransmits = m_txRetransmits;
+    m_statsFailures = m_txFailures;
+  }
 
+  void NRF24Driver ::
+    publishTelemetry()
+  {
+    Os::RawTime now;
+    if (now.now() == Os::RawTime::OP_OK) {
+      U32 elapsedUs = 0;
+      if (m_rateStartValid && now.getDiffUsec(m_rateStart, elapsedUs) == Os::RawTime::OP_OK && elapsedUs > 0) {
+        const F32 perSecond = 1000000.0f / static_cast<F32>(elapsedUs);
+        this->tlmWrite_TxPacketsPerSecond(static_cast<F32>(m_packetsSent - m_rateStartPackets) * perSecond);
+        this->tlmWrite_TxBytesPerSecond(static_cast<F32>(m_txBytes - m_rateStartTxBytes) * perSecond);
+        this->tlmWrite_RxBytesPerSecond(static_cast<F32>(m_rxBytes - m_rateStartRxBytes) * perSecond);
+      }
+      m_rateStart = now;
+      m_rateStartPackets = m_packetsSent;
+      m_rateStartTxBytes = m_txBytes;
+      m_rateStartRxBytes = m_rxBytes;
+      m_rateStartValid = true;
+    }
 
+    // Only counted where they happen, every hot path stays free of port calls for telemetry
+    this->tlmWrite_RadioState(m_state);
+    this->tlmWrite_SpiTransfers(m_spiTransfers);
+    this->tlmWrite_SpiOpsPerPacket(m_spiOpsPerPacket);
+    this->tlmWrite_PacketsSent(m_packetsSent);
+    this->tlmWrite_PacketsDropped(m_packetsDropped);
+    this->tlmWrite_TxUnderruns(m_txUnderruns);
+    this->tlmWrite_TxFailures(m_txFailures);
+    this->tlmWrite_TxRetransmits(m_txRetransmits);
+    this->tlmWrite_TxPipeSwitches(m_txPipeSwitches);
+    this->tlmWrite_FramesReceived(m_framesReceived);
+    this->tlmWrite_RxFifoOverflows(m_rxFifoOverflows);
+    this->tlmWrite_RxDropped(m_rxDropped);
+    this->tlmWrite_IrqPolledDrains(m_irqPolledDrains);
+    this->tlmWrite_RegisterWritesSkipped(m_writesSkipped);
+    this->tlmWrite_TraceRecords(static_cast<U32>(m_trace.written()));
 
+    this->tlmWrite_SpiBatchTime(m_spiBatchTime.take());
+    this->tlmWrite_TxQueueLatency(m_txQueueLatency.take());
+    this->tlmWrite_TxFifoFill(m_txFifoFill);
+    this->tlmWrite_RxFifoFill(m_rxFifoFill);
+    m_txFifoFill = NRF24FifoHistogram();
+    m_rxFifoFill = NRF24FifoHistogram();
+  }
 
+  U8 NRF24Driver ::
+    rfSetupValue() const
+  {
+    // RF_DR_LOW selects 250 kbps and takes precedence over RF_DR_HIGH, neither is 1 Mbps
+    U8 rate = 0;
+    if (m_currentRate == NRF24DataRate::RATE_250KBPS) {
+      rate = NRF24::RF_SETUP_RF_DR_LOW;
+    } else if (m_currentRate == NRF24DataRate::RATE_2MBPS) {
+      rate = NRF24::RF_SETUP_RF_DR_HIGH;
+    }
+    return static_cast<U8>(rate | ((m_currentPower << NRF24::RF_SETUP_RF_PWR_SHIFT) & NRF24::RF_SETUP_RF_PWR_MASK));
+  }
 
+  void NRF24Driver ::
+    setCE(bool state)
+  {
+    // Set CE pin state via GPIO port
+    this->cePin_out(0, state ? Fw::Logic::HIGH : Fw::Logic::LOW);
+    m_trace.level(NRF24TraceRecord::CE, state);
+    m_busOps++;
+  }
 
+  void NRF24Driver ::
+    setCSN(bool state)
+  {
+    // Set CSN pin state via GPIO port
+    this->csnPin_out(0, state ? Fw::Logic::HIGH : Fw::Logic::LOW);
+    m_trace.level(NRF24TraceRecord::CSN, state);
+    m_busOps++;
+  }
 
+  bool NRF24Driver ::
+    irqAsserted()
+  {
+    // A failed read counts as the line high
+    Fw::Logic level = Fw::Logic::HIGH;
+    const bool read = (this->irqRead_out(0, level) == Drv::GpioStatus::OP_OK);
+    const bool asserted = read && (level == Fw::Logic::LOW);
+    m_trace.level(NRF24TraceRecord::IRQ_LINE, !asserted);
+    return asserted;
+  }
 
+}
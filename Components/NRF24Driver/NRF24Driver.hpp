@@ -8,6 +8,11 @@
 #define Components_NRF24Driver_HPP
 
 #include "Components/NRF24Driver/NRF24DriverComponentAc.hpp"
+#include "Components/NRF24Driver/NRF24FrameRing.hpp"
+#include "Components/NRF24Driver/NRF24SpiBatch.hpp"
+#include "Components/NRF24Driver/NRF24TimeHistogram.hpp"
+#include "Components/NRF24Driver/NRF24Trace.hpp"
+#include <Os/RawTime.hpp>
 
 namespace Components {
 
@@ -35,8 +40,119 @@ namespace Components {
      //! Destroy NRF24Driver object
      ~NRF24Driver();
 
+     //! Configure how CSN is driven and the channel INIT tunes to
+     void configure(
+         const bool hardwareChipSelect, //!< CSN is the SPI controller's chip select, skip csnPin writes
+         const U8 channel = 0 //!< Channel until CONFIGURE or a tune moves it, one per radio when bonded
+     );
+
+     //! Exchange frames with RFCommManager through shared rings instead of bufferSendIn and dataOut
+     void attachRings(
+         NRF24FrameRing& txRing, //!< Frames to transmit, consumed here
+         NRF24FrameRing& rxRing //!< Received frames, produced here
+     );
+
+     //! Record every bus operation, input and frame into a trace file mapped into memory. Call it
+     //! after configure and before the component starts, a replay starts from the INIT it records.
+     //! \return 0, or the errno of what failed
+     I32 openTrace(
+         const char* path, //!< Trace file, created or overwritten
+         U32 records //!< Records the file holds before the oldest are overwritten, at least NRF24Trace::MIN_FILE_RECORDS
+     );
+
+     //! The trace, for a replay to hook its inputs
+     NRF24Trace& trace() {
+       return m_trace;
+     }
+
+     //! Error codes reported through the Error event
+     enum ErrorCode : I32 {
+       ERROR_BATCH_OVERFLOW = 1, //!< A command sequence did not fit in one NRF24SpiBatch
+       ERROR_INIT_VERIFY = 2,    //!< Register readback after INIT did not match what was written
+       ERROR_PAYLOAD_SIZE = 3,   //!< A buffer on bufferSendIn was empty or longer than one frame
+       ERROR_RX_WIDTH = 4,       //!< R_RX_PL_WID reported more than 32 bytes, the RX FIFO was flushed
+       ERROR_SURVEY_BUSY = 5,    //!< A survey on surveyIn was refused, the radio was transmitting or not initialized
+       ERROR_TUNE_CHANNEL = 6,   //!< tuneIn asked for a channel above NRF24::MAX_CHANNEL
+       ERROR_TUNE_POWER = 7,     //!< tuneIn asked for a power level above NRF24::MAX_POWER_LEVEL
+       ERROR_NODE_ADDRESS = 8,   //!< nodeAddressIn asked for a node at or above NRF24::MAX_NODES
+       ERROR_REGISTER_DRIFT = 0x100 //!< Scrub found a register differing from the shadow, OR'd with its address
+     };
+
+     //! Registers re-read per scrub tick
+     static const U32 SCRUB_REGISTERS_PER_CYCLE = 2;
+
+     //! Bytes ahead of the payload in a dataOut buffer: the U8 pipe number and the serialized Fw::Time
+     static const U32 RX_HEADER_SIZE = sizeof(U8) + Fw::Time::SERIALIZED_SIZE;
+
+     //! Most drain batches per interrupt, bounds the time spent when frames keep arriving
+     static const U32 MAX_DRAIN_PASSES = 4;
+
+     //! Buffers held while the TX FIFO is full
+     static const U32 TX_PENDING_DEPTH = 8;
+
    private:
 
+     // ----------------------------------------------------------------------
+     // Handler implementations for user-defined typed input ports
+     // ----------------------------------------------------------------------
+
+     //! Handler implementation for run
+     //!
+     //! Publish the telemetry gathered since the previous tick, then re-read the next registers
+     //! of the scrub list and compare them with the shadow
+     void run_handler(
+         FwIndexType portNum, //!< The port number
+         U32 context //!< The call order
+     ) override;
+
+     //! Handler implementation for irqIn
+     void irqIn_handler(
+         FwIndexType portNum, //!< The port number
+         Os::RawTime& cycleStart //!< Time of the IRQ edge
+     ) override;
+
+     //! Handler implementation for service
+     //!
+     //! Read the IRQ line and drain when it is asserted
+     void service_handler(
+         FwIndexType portNum, //!< The port number
+         U32 context //!< The call order
+     ) override;
+
+     //! Handler implementation for bufferSendIn
+     //!
+     //! Load the buffer into the TX FIFO with a single W_TX_PAYLOAD and return it through deallocate
+     void bufferSendIn_handler(
+         FwIndexType portNum, //!< The port number
+         Fw::Buffer& fwBuffer //!< The buffer
+     ) override;
+
+     //! Handler implementation for txRingDoorbell
+     void txRingDoorbell_handler(
+         FwIndexType portNum, //!< The port number
+         U32 context //!< Unused
+     ) override;
+
+     //! Handler implementation for surveyIn
+     void surveyIn_handler(
+         FwIndexType portNum, //!< The port number
+         U8 dwells //!< Passes over all channels
+     ) override;
+
+     //! Handler implementation for tuneIn
+     void tuneIn_handler(
+         FwIndexType portNum, //!< The port number
+         U8 channel, //!< Radio channel (0-125)
+         const NRF24DataRate& rate, //!< Air data rate
+         U8 power //!< TX power level (0-3)
+     ) override;
+
+     //! Handler implementation for nodeAddressIn
+     void nodeAddressIn_handler(
+         FwIndexType portNum, //!< The port number
+         U8 node //!< Node address
+     ) override;
+
      // ----------------------------------------------------------------------
      // Command handlers
      // ----------------------------------------------------------------------
@@ -46,12 +162,6 @@ namespace Components {
          const U32 cmdSeq
      ) override;
 
-     void SEND_PACKET_cmdHandler(
-         const FwOpcodeType opCode,
-         const U32 cmdSeq,
-         const Fw::CmdStringArg& data
-     ) override;
-
      void START_RECEIVE_cmdHandler(
          const FwOpcodeType opCode,
          const U32 cmdSeq
@@ -64,12 +174,112 @@ namespace Components {
          const U8 power
      ) override;
 
+     void SET_STREAMING_cmdHandler(
+         const FwOpcodeType opCode,
+         const U32 cmdSeq,
+         Fw::Enabled mode,
+         bool noAck
+     ) override;
+
+     void SURVEY_CHANNELS_cmdHandler(
+         const FwOpcodeType opCode,
+         const U32 cmdSeq,
+         U8 dwells
+     ) override;
+
+     void SET_DATA_RATE_cmdHandler(
+         const FwOpcodeType opCode,
+         const U32 cmdSeq,
+         NRF24DataRate rate
+     ) override;
+
      // ----------------------------------------------------------------------
      // Helper functions
      // ----------------------------------------------------------------------
 
-     bool writeRegister(U8 reg, U8 value);
-     bool readRegister(U8 reg, U8& value);
+     //! Drain every RX FIFO level in one batch per pass and acknowledge the interrupt flags
+     void drain(
+         Os::RawTime& cycleStart //!< Time of the IRQ edge
+     );
+
+     //! Read the IRQ line
+     //! \return true when it is held low
+     bool irqAsserted();
+
+     //! Queue a register write onto m_batch unless the shadow already holds the value
+     //! \return false if the batch is full
+     bool queueWrite(U8 reg, U8 value);
+
+     //! Queue a multi-byte register write onto m_batch unless the shadow already holds it
+     //! \return false if the batch is full
+     bool queueWrite(U8 reg, const U8* data, U8 length);
+
+     //! Forget the shadow, e.g. when the chip state is unknown before INIT
+     void invalidateShadow();
+
+     //! Switch to PRX and raise CE
+     void enterRx();
+
+     //! Write RF_CH and RF_SETUP from m_currentChannel, m_currentRate and m_currentPower, relocking a listening receiver
+     void retune();
+
+     //! Sweep every channel dwells times, reading RPD after each dwell, and publish the histogram
+     //! \return false if the radio is not in STANDBY or RECEIVE
+     bool survey(U8 dwells);
+
+     //! Load pending buffers into the free TX FIFO slots and start transmitting them
+     void serviceTx();
+
+     //! Pipe a pending payload is addressed to, counting the buffers from bufferSendIn first
+     U8 pendingPipe(
+         U32 index, //!< Position among the pending payloads
+         U32 buffered //!< Buffers from bufferSendIn ahead of the ring
+     ) const;
+
+     //! Node a pending payload is addressed to, counting the buffers from bufferSendIn first
+     U8 pendingNode(
+         U32 index, //!< Position among the pending payloads
+         U32 buffered //!< Buffers from bufferSendIn ahead of the ring
+     ) const;
+
+     //! Account for a TX_DS or MAX_RT and keep the FIFO moving
+     void txComplete(
+         bool failed, //!< MAX_RT was raised and the TX FIFO flushed
+         U8 fifoStatus //!< FIFO_STATUS read after the flags were cleared
+     );
+
+     //! End transmission, back to RECEIVE if enabled, otherwise STANDBY
+     void finishTx();
+
+     //! Read FIFO_STATUS and report whether the TX FIFO is empty
+     bool txFifoEmpty();
+
+     //! Return every pending buffer through deallocate without sending it, and drop the TX ring
+     void releasePending();
+
+     //! Free TX ring slots, telling the producer if it waits for them
+     void releaseRing(U32 frames);
+
+     void setState(NRF24RadioState state);
+
+     //! CE pulse for one PTX transmission, the GPIO write time covers the 10 us minimum
+     void pulseCE();
+
+     //! Copy one drained frame into the RX ring, or into a buffer from allocate sent out dataOut
+     void deliverFrame(U8 pipe, const Fw::Time& timestamp, const U8* data, U8 length);
+
+     //! Issue every segment of a batch through spiOut, framing each with CSN
+     void transact(NRF24SpiBatch& batch);
+
+     //! Send the transmit statistics gathered since the last report out linkStatsOut
+     void reportLinkStats();
+
+     //! Write the counters, rates and histograms kept up to date on the hot path
+     void publishTelemetry();
+
+     //! RF_SETUP value for the current data rate and power level
+     U8 rfSetupValue() const;
+
      void setCE(bool state);
      void setCSN(bool state);
 
@@ -77,9 +287,63 @@ namespace Components {
      // Member variables
      // ----------------------------------------------------------------------
 
+     NRF24SpiBatch m_batch;
      U8 m_currentChannel;
      U8 m_currentPower;
-     bool m_isInitialized;
+     NRF24DataRate m_currentRate;
+     NRF24RadioState m_state;
+     bool m_hardwareChipSelect;
+     U32 m_spiTransfers;
+     U32 m_busOps; //!< spiOut transfers plus CE/CSN GPIO writes
+
+     //! Last value written to each register, LSByte first, indexed by register address
+     U8 m_shadow[NRF24::REGISTER_COUNT][NRF24::MAX_ADDRESS_WIDTH];
+     bool m_shadowValid[NRF24::REGISTER_COUNT];
+     U32 m_scrubIndex; //!< Next entry of the scrub list
+     U32 m_writesSkipped;
+     U32 m_registerDrifts;
+     U32 m_packetsSent;
+     U32 m_packetsDropped;
+     U32 m_spiOpsPerPacket; //!< Bus operations per payload of the last load
+     bool m_rxEnabled; //!< START_RECEIVE was commanded, return to PRX after each transmission
+     bool m_streaming; //!< SET_STREAMING mode
+     bool m_noAck; //!< SET_STREAMING noAck
+     NRF24FrameRing* m_txRing; //!< Frames waiting behind m_txPending, nullptr without attachRings
+     NRF24FrameRing* m_rxRing;
+     Fw::Buffer m_txPending[TX_PENDING_DEPTH]; //!< Buffers waiting for a TX FIFO slot, oldest at m_txPendingHead
+     Os::RawTime m_txPendingAt[TX_PENDING_DEPTH]; //!< Arrival of each m_txPending buffer
+     U32 m_txPendingHead;
+     U32 m_txPendingCount;
+     U32 m_txFifoFree; //!< Upper bound on free TX FIFO slots, each load is confirmed by its STATUS byte
+     U8 m_node; //!< Node address the RX pipes listen on
+     U8 m_txPipe; //!< Pipe TX_ADDR points at
+     U8 m_txNode; //!< Node TX_ADDR points at
+     U32 m_txPipeSwitches;
+     U32 m_txUnderruns;
+     U32 m_txFailures;
+     U32 m_txRetransmits;
+     U32 m_ackedSent; //!< Payloads loaded with auto-acknowledge
+     U32 m_statsAckedSent; //!< Counters at the last reportLinkStats
+     U32 m_statsRetransmits;
+     U32 m_statsFailures;
+     Os::RawTime m_rateStart; //!< Start of the TxPacketsPerSecond window
+     U32 m_rateStartPackets;
+     U32 m_rateStartTxBytes;
+     U32 m_rateStartRxBytes;
+     bool m_rateStartValid;
+     U32 m_txBytes; //!< Payload bytes loaded into the TX FIFO
+     U32 m_rxBytes; //!< Payload bytes drained from the RX FIFO
+     U32 m_framesReceived;
+     U32 m_rxFifoOverflows;
+     U32 m_rxDropped;
+     U32 m_irqPolledDrains;
+     NRF24TimeHistogram m_spiBatchTime;
+     NRF24TimeHistogram m_txQueueLatency;
+     NRF24FifoHistogram m_txFifoFill;
+     NRF24FifoHistogram m_rxFifoFill;
+     NRF24ChannelOccupancy m_occupancy; //!< Last survey
+     NRF24Trace m_trace;
+     U32 m_traceRingSeen; //!< Frames at the TX ring head already traced
 
  };
 
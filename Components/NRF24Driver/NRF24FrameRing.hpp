@@ -0,0 +1,126 @@
+// ======================================================================
+// \title  NRF24FrameRing.hpp
+// \author mustafa
+// \brief  Single-producer/single-consumer ring of radio frames shared by
+//         NRF24Driver and RFCommManager
+//
+// Frames cross between the two components through preallocated slots
+// instead of Fw::Buffer port calls, so the F´ queues only carry control.
+// One ring per direction: RFCommManager produces into the TX ring and
+// NRF24Driver consumes it, the RX ring runs the other way.
+//
+// The producer rings the consumer's doorbell port only when the doorbell
+// flag was clear, and the consumer clears the flag before draining, so at
+// most one doorbell message is queued however many frames are pushed. A
+// producer that found the ring full sets the waiting flag and is told
+// through its space port once the consumer frees a slot.
+// ======================================================================
+
+#ifndef Components_NRF24FrameRing_HPP
+#define Components_NRF24FrameRing_HPP
+
+#include <FpConfig.hpp>
+#include <Fw/Time/Time.hpp>
+#include <Os/RawTime.hpp>
+
+#include <atomic>
+
+#include "Components/NRF24Driver/NRF24Registers.hpp"
+
+namespace Components {
+
+  class NRF24FrameRing {
+
+    public:
+
+      //! Slots in the ring, a power of two
+      static const U32 CAPACITY = 32;
+
+      //! One frame
+      struct Slot {
+        U8 pipe; //!< RX pipe, or the pipe address a TX frame goes to
+        U8 node; //!< Node a TX frame goes to, unused on RX
+        bool noAck; //!< TX with W_TX_PAYLOAD_NOACK, unused on RX
+        U8 length;
+        Fw::Time timestamp; //!< RX time, unused on TX
+        Os::RawTime queuedAt; //!< TX publish time, unused on RX
+        U8 data[NRF24::MAX_PAYLOAD_SIZE];
+      };
+
+      NRF24FrameRing() : m_head(0), m_tail(0), m_doorbell(false), m_waiting(false) {}
+
+      // ----------------------------------------------------------------------
+      // Producer side
+      // ----------------------------------------------------------------------
+
+      //! Free slots
+      U32 space() const {
+        return CAPACITY - (m_tail.load(std::memory_order_relaxed) - m_head.load());
+      }
+
+      //! Slot to fill next, nullptr when the ring is full. Nothing is visible to the consumer until publish.
+      Slot* claim() {
+        if (space() == 0) {
+          return nullptr;
+        }
+        return &m_slots[m_tail.load(std::memory_order_relaxed) % CAPACITY];
+      }
+
+      //! Hand the claimed slot to the consumer
+      //! \return true when the consumer's doorbell must be rung
+      bool publish() {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1);
+        return !m_doorbell.exchange(true);
+      }
+
+      //! Ask to be told when a slot frees up, after claim failed or the producer held back at a fill level
+      //! \return true when the ring went below the fill level meanwhile and the producer should retry now
+      bool waitForSpace(U32 fill = CAPACITY) {
+        m_waiting.store(true);
+        // The consumer may have released between the failed claim and the flag
+        return CAPACITY - space() < fill && m_waiting.exchange(false);
+      }
+
+      // ----------------------------------------------------------------------
+      // Consumer side
+      // ----------------------------------------------------------------------
+
+      //! Frames ready
+      U32 count() const {
+        return m_tail.load() - m_head.load(std::memory_order_relaxed);
+      }
+
+      //! Frame at position index from the head, index < count()
+      const Slot& peek(U32 index) const {
+        return m_slots[(m_head.load(std::memory_order_relaxed) + index) % CAPACITY];
+      }
+
+      //! Free the frames at the head
+      //! \return true when the producer is waiting for space and must be told
+      bool release(U32 frames) {
+        m_head.store(m_head.load(std::memory_order_relaxed) + frames);
+        return frames > 0 && m_waiting.exchange(false);
+      }
+
+      //! Take the doorbell before draining, a frame published after this rings it again
+      void answerDoorbell() {
+        m_doorbell.store(false);
+      }
+
+    private:
+
+      Slot m_slots[CAPACITY];
+
+      //! Counters run freely and wrap, CAPACITY divides 2^32. The flag handshakes are store-then-load
+      //! on both sides, so the shared accesses stay sequentially consistent; only each side's own
+      //! counter is read relaxed.
+      alignas(64) std::atomic<U32> m_head; //!< Written by the consumer
+      alignas(64) std::atomic<U32> m_tail; //!< Written by the producer
+      alignas(64) std::atomic<bool> m_doorbell;
+      std::atomic<bool> m_waiting;
+
+  };
+
+}
+
+#endif
@@ -0,0 +1,200 @@
+// ======================================================================
+// \title  NRF24Registers.hpp
+// \author mustafa
+// \brief  NRF24L01+ SPI command set, register map and bit definitions
+//
+// Values follow the NRF24L01+ Product Specification v1.0, sections 8.3
+// (SPI commands) and 9.1 (register map). Shared by the driver and the
+// simulated radio so both sides agree on the wire format.
+// ======================================================================
+
+#ifndef Components_NRF24Registers_HPP
+#define Components_NRF24Registers_HPP
+
+#include <FpConfig.hpp>
+
+namespace Components {
+
+namespace NRF24 {
+
+  // ----------------------------------------------------------------------
+  // SPI commands
+  // ----------------------------------------------------------------------
+
+  enum Command : U8 {
+    R_REGISTER = 0x00,          //!< Read register, OR with 5-bit register address
+    W_REGISTER = 0x20,          //!< Write register, OR with 5-bit register address
+    R_RX_PAYLOAD = 0x61,        //!< Read RX payload, pops the RX FIFO
+    W_TX_PAYLOAD = 0xA0,        //!< Write TX payload
+    FLUSH_TX = 0xE1,            //!< Flush TX FIFO
+    FLUSH_RX = 0xE2,            //!< Flush RX FIFO
+    REUSE_TX_PL = 0xE3,         //!< Reuse last transmitted payload
+    R_RX_PL_WID = 0x60,         //!< Read width of the RX FIFO head payload
+    W_ACK_PAYLOAD = 0xA8,       //!< Write ACK payload, OR with 3-bit pipe number
+    W_TX_PAYLOAD_NOACK = 0xB0,  //!< Write TX payload with auto-ack disabled
+    NOP = 0xFF                  //!< No operation, returns STATUS
+  };
+
+  //! Mask of the register address field in R_REGISTER/W_REGISTER
+  static const U8 REGISTER_MASK = 0x1F;
+
+  //! Mask of the pipe field in W_ACK_PAYLOAD
+  static const U8 PIPE_MASK = 0x07;
+
+  // ----------------------------------------------------------------------
+  // Register addresses
+  // ----------------------------------------------------------------------
+
+  enum Register : U8 {
+    CONFIG = 0x00,
+    EN_AA = 0x01,
+    EN_RXADDR = 0x02,
+    SETUP_AW = 0x03,
+    SETUP_RETR = 0x04,
+    RF_CH = 0x05,
+    RF_SETUP = 0x06,
+    STATUS = 0x07,
+    OBSERVE_TX = 0x08,
+    RPD = 0x09,
+    RX_ADDR_P0 = 0x0A,
+    RX_ADDR_P1 = 0x0B,
+    RX_ADDR_P2 = 0x0C,
+    RX_ADDR_P3 = 0x0D,
+    RX_ADDR_P4 = 0x0E,
+    RX_ADDR_P5 = 0x0F,
+    TX_ADDR = 0x10,
+    RX_PW_P0 = 0x11,
+    RX_PW_P1 = 0x12,
+    RX_PW_P2 = 0x13,
+    RX_PW_P3 = 0x14,
+    RX_PW_P4 = 0x15,
+    RX_PW_P5 = 0x16,
+    FIFO_STATUS = 0x17,
+    DYNPD = 0x1C,
+    FEATURE = 0x1D
+  };
+
+  //! Number of register addresses (0x00 - 0x1D)
+  static const U8 REGISTER_COUNT = 0x1E;
+
+  // ----------------------------------------------------------------------
+  // Register bits
+  // ----------------------------------------------------------------------
+
+  // CONFIG
+  static const U8 CONFIG_MASK_RX_DR = 0x40;
+  static const U8 CONFIG_MASK_TX_DS = 0x20;
+  static const U8 CONFIG_MASK_MAX_RT = 0x10;
+  static const U8 CONFIG_EN_CRC = 0x08;
+  static const U8 CONFIG_CRCO = 0x04;
+  static const U8 CONFIG_PWR_UP = 0x02;
+  static const U8 CONFIG_PRIM_RX = 0x01;
+
+  // SETUP_RETR
+  static const U8 SETUP_RETR_ARD_SHIFT = 4;
+  static const U8 SETUP_RETR_ARC_MASK = 0x0F;
+
+  // RF_SETUP
+  static const U8 RF_SETUP_CONT_WAVE = 0x80;
+  static const U8 RF_SETUP_RF_DR_LOW = 0x20;
+  static const U8 RF_SETUP_PLL_LOCK = 0x10;
+  static const U8 RF_SETUP_RF_DR_HIGH = 0x08;
+  static const U8 RF_SETUP_RF_PWR_SHIFT = 1;
+  static const U8 RF_SETUP_RF_PWR_MASK = 0x06;
+
+  // STATUS
+  static const U8 STATUS_RX_DR = 0x40;
+  static const U8 STATUS_TX_DS = 0x20;
+  static const U8 STATUS_MAX_RT = 0x10;
+  static const U8 STATUS_RX_P_NO_SHIFT = 1;
+  static const U8 STATUS_RX_P_NO_MASK = 0x0E;
+  static const U8 STATUS_TX_FULL = 0x01;
+  static const U8 STATUS_IRQ_MASK = STATUS_RX_DR | STATUS_TX_DS | STATUS_MAX_RT;
+
+  //! RX_P_NO value reported when the RX FIFO is empty
+  static const U8 RX_P_NO_EMPTY = 0x07;
+
+  // OBSERVE_TX
+  static const U8 OBSERVE_TX_PLOS_SHIFT = 4;
+  static const U8 OBSERVE_TX_ARC_CNT_MASK = 0x0F;
+
+  // RPD
+  static const U8 RPD_RPD = 0x01;
+
+  // FIFO_STATUS
+  static const U8 FIFO_STATUS_TX_REUSE = 0x40;
+  static const U8 FIFO_STATUS_TX_FULL = 0x20;
+  static const U8 FIFO_STATUS_TX_EMPTY = 0x10;
+  static const U8 FIFO_STATUS_RX_FULL = 0x02;
+  static const U8 FIFO_STATUS_RX_EMPTY = 0x01;
+
+  // FEATURE
+  static const U8 FEATURE_EN_DPL = 0x04;
+  static const U8 FEATURE_EN_ACK_PAY = 0x02;
+  static const U8 FEATURE_EN_DYN_ACK = 0x01;
+
+  // ----------------------------------------------------------------------
+  // Chip limits and timing
+  // ----------------------------------------------------------------------
+
+  //! Largest payload carried by a single frame
+  static const U8 MAX_PAYLOAD_SIZE = 32;
+
+  //! Widest on-air address (SETUP_AW = 0b11)
+  static const U8 MAX_ADDRESS_WIDTH = 5;
+
+  //! Number of RX data pipes
+  static const U8 PIPE_COUNT = 6;
+
+  //! Depth of the TX and RX FIFOs
+  static const U8 FIFO_DEPTH = 3;
+
+  //! Highest valid RF channel (2400 + 125 MHz)
+  static const U8 MAX_CHANNEL = 125;
+
+  //! Highest RF_PWR level (0 dBm)
+  static const U8 MAX_POWER_LEVEL = 3;
+
+  //! Standby to TX/RX settling time (Tstby2a) in microseconds
+  static const U32 SETTLE_TIME_US = 130;
+
+  //! Power down to standby time (Tpd2stby) in microseconds, external clock worst case
+  static const U32 POWER_UP_TIME_US = 1500;
+
+  //! Time in RX before RPD is valid, in microseconds
+  static const U32 RPD_SETTLE_TIME_US = 170;
+
+  //! Auto retransmit delay step in microseconds, ARD = (n + 1) * 250 us
+  static const U32 ARD_STEP_US = 250;
+
+  // ----------------------------------------------------------------------
+  // NRF24Driver port conventions
+  // ----------------------------------------------------------------------
+
+  //! Fw::Buffer context bit on NRF24Driver.bufferSendIn asking for W_TX_PAYLOAD_NOACK,
+  //! for frames whose delivery is tracked above the driver
+  static const U32 TX_CONTEXT_NO_ACK = 0x80000000U;
+
+  //! Fw::Buffer context bits on NRF24Driver.bufferSendIn selecting the pipe address the
+  //! payload goes to, pipe 0 when clear
+  static const U32 TX_CONTEXT_PIPE_SHIFT = 24;
+  static const U32 TX_CONTEXT_PIPE_MASK = 0x07U << TX_CONTEXT_PIPE_SHIFT;
+
+  //! Node addresses NRF24Driver puts on the air, the node goes into byte 1 of every pipe address
+  static const U8 MAX_NODES = 64;
+
+  //! Fw::Buffer context bits on NRF24Driver.bufferSendIn selecting the node the payload goes to,
+  //! node 0 when clear
+  static const U32 TX_CONTEXT_NODE_SHIFT = 16;
+  static const U32 TX_CONTEXT_NODE_MASK = 0x3FU << TX_CONTEXT_NODE_SHIFT;
+
+  //! Register width in bytes, addresses are multi-byte, everything else is one byte
+  inline U8 registerWidth(U8 reg) {
+    return (reg == RX_ADDR_P0 || reg == RX_ADDR_P1 || reg == TX_ADDR) ? MAX_ADDRESS_WIDTH : 1;
+  }
+
+}
+
+}
+
+#endif
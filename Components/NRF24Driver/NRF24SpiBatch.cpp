@@ -0,0 +1,126 @@
+// ======================================================================
+// \title  NRF24SpiBatch.cpp
+// \author mustafa
+// \brief  cpp file for the NRF24L01+ SPI transaction builder
+// ======================================================================
+
+#include "Components/NRF24Driver/NRF24SpiBatch.hpp"
+
+#include <Fw/Types/Assert.hpp>
+
+#include <cstring>
+
+namespace Components {
+
+  NRF24SpiBatch ::
+    NRF24SpiBatch() :
+      m_count(0)
+  {
+    std::memset(m_tx, 0, sizeof(m_tx));
+    std::memset(m_rx, 0, sizeof(m_rx));
+    std::memset(m_offsets, 0, sizeof(m_offsets));
+  }
+
+  void NRF24SpiBatch ::
+    clear()
+  {
+    m_count = 0;
+    m_offsets[0] = 0;
+  }
+
+  bool NRF24SpiBatch ::
+    writeRegister(U8 reg, U8 value)
+  {
+    return this->append(NRF24::W_REGISTER | (reg & NRF24::REGISTER_MASK), &value, 1, nullptr);
+  }
+
+  bool NRF24SpiBatch ::
+    writeRegister(U8 reg, const U8* data, U8 length)
+  {
+    return this->append(NRF24::W_REGISTER | (reg & NRF24::REGISTER_MASK), data, length, nullptr);
+  }
+
+  bool NRF24SpiBatch ::
+    readRegister(U8 reg, U8 length, U32& segment)
+  {
+    return this->read(NRF24::R_REGISTER | (reg & NRF24::REGISTER_MASK), length, segment);
+  }
+
+  bool NRF24SpiBatch ::
+    command(U8 command)
+  {
+    return this->append(command, nullptr, 0, nullptr);
+  }
+
+  bool NRF24SpiBatch ::
+    write(U8 command, const U8* data, U8 length)
+  {
+    FW_ASSERT(data != nullptr || length == 0);
+    return this->append(command, data, length, nullptr);
+  }
+
+  bool NRF24SpiBatch ::
+    read(U8 command, U8 length, U32& segment)
+  {
+    return this->append(command, nullptr, length, &segment);
+  }
+
+  U8* NRF24SpiBatch ::
+    txData(U32 segment)
+  {
+    FW_ASSERT(segment < m_count, segment, m_count);
+    return &m_tx[m_offsets[segment]];
+  }
+
+  U8* NRF24SpiBatch ::
+    rxData(U32 segment)
+  {
+    FW_ASSERT(segment < m_count, segment, m_count);
+    return &m_rx[m_offsets[segment]];
+  }
+
+  U32 NRF24SpiBatch ::
+    length(U32 segment) const
+  {
+    FW_ASSERT(segment < m_count, segment, m_count);
+    return static_cast<U32>(m_offsets[segment + 1] - m_offsets[segment]);
+  }
+
+  U8 NRF24SpiBatch ::
+    status(U32 segment) const
+  {
+    FW_ASSERT(segment < m_count, segment, m_count);
+    return m_rx[m_offsets[segment]];
+  }
+
+  const U8* NRF24SpiBatch ::
+    response(U32 segment) const
+  {
+    FW_ASSERT(segment < m_count, segment, m_count);
+    return &m_rx[m_offsets[segment] + 1];
+  }
+
+  bool NRF24SpiBatch ::
+    append(U8 command, const U8* data, U8 length, U32* segment)
+  {
+    const U32 offset = m_offsets[m_count];
+    if (m_count >= MAX_SEGMENTS || offset + 1U + length > MAX_BYTES) {
+      return false;
+    }
+
+    m_tx[offset] = command;
+    if (data != nullptr) {
+      std::memcpy(&m_tx[offset + 1], data, length);
+    } else {
+      // Read phases clock out NOP so nothing is written by accident
+      std::memset(&m_tx[offset + 1], NRF24::NOP, length);
+    }
+    if (segment != nullptr) {
+      *segment = m_count;
+    }
+    m_count++;
+    m_offsets[m_count] = static_cast<U16>(offset + 1U + length);
+    return true;
+  }
+
+}
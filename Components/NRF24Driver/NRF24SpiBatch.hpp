@@ -0,0 +1,101 @@
+// ======================================================================
+// \title  NRF24SpiBatch.hpp
+// \author mustafa
+// \brief  hpp file for the NRF24L01+ SPI transaction builder
+// ======================================================================
+
+#ifndef Components_NRF24SpiBatch_HPP
+#define Components_NRF24SpiBatch_HPP
+
+#include <FpConfig.hpp>
+
+#include "Components/NRF24Driver/NRF24Registers.hpp"
+
+namespace Components {
+
+  //! Builder that lays a sequence of NRF24L01+ commands out in one contiguous buffer
+  //!
+  //! Each queued command is a segment: one command byte followed by its data, the unit the
+  //! chip frames with CSN. Segments sit back to back in a single transmit/receive buffer
+  //! pair, so a whole configuration sequence is built without per-register copies and
+  //! issued by NRF24Driver::transact in one pass. Multi-byte registers (addresses) and
+  //! payloads go out as a single segment. The STATUS byte the chip clocks out on every
+  //! command byte is kept per segment, so no separate NOP is needed to read it.
+  class NRF24SpiBatch {
+
+    public:
+
+      //! Most commands in one batch
+      static const U32 MAX_SEGMENTS = 24;
+
+      //! Most bytes in one batch, enough for a full INIT sequence or three payloads
+      static const U32 MAX_BYTES = 256;
+
+      NRF24SpiBatch();
+
+      //! Drop all queued segments
+      void clear();
+
+      //! Queue a W_REGISTER of a single byte register
+      //! \return false if the batch is full
+      bool writeRegister(U8 reg, U8 value);
+
+      //! Queue a W_REGISTER of a multi-byte register, LSByte first
+      //! \return false if the batch is full
+      bool writeRegister(U8 reg, const U8* data, U8 length);
+
+      //! Queue an R_REGISTER, the value is available from response(segment) after transfer
+      //! \return false if the batch is full
+      bool readRegister(U8 reg, U8 length, U32& segment);
+
+      //! Queue a command without data (FLUSH_TX, FLUSH_RX, REUSE_TX_PL, NOP)
+      //! \return false if the batch is full
+      bool command(U8 command);
+
+      //! Queue a command with a data phase, e.g. W_TX_PAYLOAD or W_ACK_PAYLOAD
+      //! \return false if the batch is full
+      bool write(U8 command, const U8* data, U8 length);
+
+      //! Queue a command with a read phase, e.g. R_RX_PAYLOAD or R_RX_PL_WID
+      //! \return false if the batch is full
+      bool read(U8 command, U8 length, U32& segment);
+
+      //! Number of queued segments
+      U32 segmentCount() const {
+        return m_count;
+      }
+
+      //! Total bytes queued across all segments
+      U32 byteCount() const {
+        return m_offsets[m_count];
+      }
+
+      //! Transmit bytes of a segment, command byte first
+      U8* txData(U32 segment);
+
+      //! Receive bytes of a segment, STATUS first
+      U8* rxData(U32 segment);
+
+      //! Length of a segment including the command byte
+      U32 length(U32 segment) const;
+
+      //! STATUS clocked out while the segment's command byte was sent
+      U8 status(U32 segment) const;
+
+      //! Data clocked out after the command byte of a segment
+      const U8* response(U32 segment) const;
+
+    private:
+
+      bool append(U8 command, const U8* data, U8 length, U32* segment);
+
+      U8 m_tx[MAX_BYTES];
+      U8 m_rx[MAX_BYTES];
+      U16 m_offsets[MAX_SEGMENTS + 1];
+      U32 m_count;
+
+  };
+
+}
+
+#endif
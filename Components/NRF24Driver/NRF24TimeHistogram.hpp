@@ -0,0 +1,67 @@
+// ======================================================================
+// \title  NRF24TimeHistogram.hpp
+// \author mustafa
+// \brief  Fixed-bucket histogram of durations, filled on the hot path
+//         and published once per run tick
+//
+// Bucket edges double from the first one, so eight buckets cover two
+// decades without a table. Recording is a few compares and an increment
+// on the component thread, with no lock and no allocation; take() hands
+// the counts to a telemetry channel and starts the next period.
+// ======================================================================
+
+#ifndef Components_NRF24TimeHistogram_HPP
+#define Components_NRF24TimeHistogram_HPP
+
+#include <FpConfig.hpp>
+#include <Os/RawTime.hpp>
+
+#include "Components/NRF24Driver/NRF24LatencyHistogramArrayAc.hpp"
+
+namespace Components {
+
+  class NRF24TimeHistogram {
+
+    public:
+
+      static const U32 BUCKETS = NRF24LatencyHistogram::SIZE;
+
+      explicit NRF24TimeHistogram(
+          U32 firstEdgeUs //!< Upper edge of the first bucket
+      ) : m_firstEdgeUs(firstEdgeUs) {}
+
+      //! Count one duration
+      void record(U32 us) {
+        U32 bucket = 0;
+        for (U32 edge = m_firstEdgeUs; bucket < BUCKETS - 1 && us >= edge; edge <<= 1) {
+          bucket++;
+        }
+        m_counts[bucket]++;
+      }
+
+      //! Count the time elapsed since start, nothing when the clock cannot be read
+      void recordSince(const Os::RawTime& start) {
+        Os::RawTime now;
+        U32 us = 0;
+        if (now.now() == Os::RawTime::OP_OK && now.getDiffUsec(start, us) == Os::RawTime::OP_OK) {
+          record(us);
+        }
+      }
+
+      //! Counts since the previous take, and start over
+      NRF24LatencyHistogram take() {
+        const NRF24LatencyHistogram counts = m_counts;
+        m_counts = NRF24LatencyHistogram();
+        return counts;
+      }
+
+    private:
+
+      U32 m_firstEdgeUs;
+      NRF24LatencyHistogram m_counts;
+
+  };
+
+}
+
+#endif
@@ -0,0 +1,295 @@
+// ======================================================================
+// \title  NRF24Trace.cpp
+// \author mustafa
+// \brief  cpp file for the NRF24Driver trace recorder and trace file reader
+// ======================================================================
+
+#include "Components/NRF24Driver/NRF24Trace.hpp"
+
+#include <Fw/Types/Assert.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Components {
+
+  namespace {
+
+    static_assert(sizeof(NRF24TraceRecord) == 80, "Records are laid out without padding");
+    static_assert(sizeof(NRF24TraceHeader) <= NRF24Trace::RECORDS_OFFSET, "The header fits ahead of the records");
+    static_assert(NRF24Trace::RECORDS_OFFSET % alignof(NRF24TraceRecord) == 0, "Records in the mapping are aligned");
+
+    //! Age of the clock reference at which it moves on, well before the U32 difference runs out
+    const U32 CLOCK_REBASE_US = 1000000000U;
+
+  }
+
+  // ----------------------------------------------------------------------
+  // NRF24Trace
+  // ----------------------------------------------------------------------
+
+  NRF24Trace ::
+    NRF24Trace() :
+      m_count(0),
+      m_fd(-1),
+      m_map(nullptr),
+      m_mapSize(0),
+      m_header(nullptr),
+      m_records(nullptr),
+      m_capacity(0),
+      m_written(0),
+      m_clockUs(0),
+      m_clockValid(false),
+      m_inputHook(nullptr),
+      m_inputHookContext(nullptr)
+  {
+    std::memset(m_ring, 0, sizeof(m_ring));
+  }
+
+  NRF24Trace ::
+    ~NRF24Trace()
+  {
+    this->close();
+  }
+
+  I32 NRF24Trace ::
+    open(const char* path, U32 capacity, bool hardwareChipSelect, U8 channel)
+  {
+    FW_ASSERT(!this->isOpen());
+    FW_ASSERT(capacity >= MIN_FILE_RECORDS, capacity);
+    const FwSizeType size = RECORDS_OFFSET + static_cast<FwSizeType>(capacity) * sizeof(NRF24TraceRecord);
+
+    m_fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0) {
+      return errno;
+    }
+    // Every block is taken up front: a store into a mapped page the disk has no room for raises SIGBUS
+    I32 error = ::posix_fallocate(m_fd, 0, static_cast<off_t>(size));
+    if (error != 0) {
+      this->close();
+      return error;
+    }
+    void* const map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) {
+      error = errno;
+      this->close();
+      return error;
+    }
+    m_map = static_cast<U8*>(map);
+    m_mapSize = size;
+
+    std::memset(m_map, 0, RECORDS_OFFSET);
+    m_header = reinterpret_cast<NRF24TraceHeader*>(m_map);
+    m_header->magic = MAGIC;
+    m_header->version = VERSION;
+    m_header->recordSize = sizeof(NRF24TraceRecord);
+    m_header->capacity = capacity;
+    m_header->written = 0;
+    m_header->hardwareChipSelect = hardwareChipSelect ? 1 : 0;
+    m_header->channel = channel;
+    m_records = reinterpret_cast<NRF24TraceRecord*>(m_map + RECORDS_OFFSET);
+    m_capacity = capacity;
+    m_count = 0;
+    m_written = 0;
+    m_clockUs = 0;
+    m_clockValid = (m_clockAt.now() == Os::RawTime::OP_OK);
+    return 0;
+  }
+
+  void NRF24Trace ::
+    close()
+  {
+    this->flush();
+    // The kernel writes the shared pages back after the unmap as well
+    if (m_map != nullptr) {
+      (void)::munmap(m_map, m_mapSize);
+      m_map = nullptr;
+      m_header = nullptr;
+      m_records = nullptr;
+    }
+    if (m_fd >= 0) {
+      (void)::close(m_fd);
+      m_fd = -1;
+    }
+  }
+
+  void NRF24Trace ::
+    flush()
+  {
+    if (!this->isOpen() || m_count == 0) {
+      return;
+    }
+    // At most two copies, the second one after the file wrapped
+    U32 done = 0;
+    while (done < m_count) {
+      const U32 slot = static_cast<U32>(m_written % m_capacity);
+      const U32 run = FW_MIN(m_count - done, m_capacity - slot);
+      std::memcpy(&m_records[slot], &m_ring[done], run * sizeof(NRF24TraceRecord));
+      done += run;
+      m_written += run;
+    }
+    m_header->written = m_written;
+    m_count = 0;
+  }
+
+  NRF24TraceRecord& NRF24Trace ::
+    append(NRF24TraceRecord::Kind kind)
+  {
+    if (m_count == RING_RECORDS) {
+      this->flush();
+    }
+    NRF24TraceRecord& record = m_ring[m_count];
+    m_count++;
+
+    // Timed from one reference rather than from the record before, so no truncation adds up
+    Os::RawTime now;
+    U32 elapsedUs = 0;
+    if (m_clockValid && now.now() == Os::RawTime::OP_OK && now.getDiffUsec(m_clockAt, elapsedUs) == Os::RawTime::OP_OK) {
+      record.timeUs = m_clockUs + elapsedUs;
+      if (elapsedUs >= CLOCK_REBASE_US) {
+        m_clockAt = now;
+        m_clockUs += elapsedUs;
+      }
+    } else {
+      record.timeUs = m_clockUs;
+    }
+    record.kind = kind;
+    record.value = 0;
+    record.length = 0;
+    record.pipe = 0;
+    record.node = 0;
+    record.noAck = 0;
+    return record;
+  }
+
+  void NRF24Trace ::
+    recordSpi(const U8* out, const U8* in, U32 length)
+  {
+    FW_ASSERT(length <= NRF24TraceRecord::DATA_SIZE / 2, length);
+    NRF24TraceRecord& record = this->append(NRF24TraceRecord::SPI);
+    record.length = static_cast<U8>(length);
+    std::memcpy(record.data, out, length);
+    std::memcpy(record.data + length, in, length);
+  }
+
+  NRF24TraceRecord& NRF24Trace ::
+    recordInput(NRF24TraceRecord::Input input, const U8* args, U8 length)
+  {
+    FW_ASSERT(length <= NRF24TraceRecord::DATA_SIZE, length);
+    FW_ASSERT(args != nullptr || length == 0);
+    NRF24TraceRecord& record = this->append(NRF24TraceRecord::INPUT);
+    record.value = input;
+    record.length = length;
+    if (length > 0) {
+      std::memcpy(record.data, args, length);
+    }
+    return record;
+  }
+
+  void NRF24Trace ::
+    recordFrame(NRF24TraceRecord::Kind kind, U8 pipe, U8 node, bool noAck, const U8* data, U8 length)
+  {
+    FW_ASSERT(length <= NRF24::MAX_PAYLOAD_SIZE, length);
+    NRF24TraceRecord& record = this->append(kind);
+    record.pipe = pipe;
+    record.node = node;
+    record.noAck = noAck ? 1 : 0;
+    record.length = length;
+    std::memcpy(record.data, data, length);
+  }
+
+  // ----------------------------------------------------------------------
+  // NRF24TraceFile
+  // ----------------------------------------------------------------------
+
+  NRF24TraceFile ::
+    NRF24TraceFile() :
+      m_fd(-1),
+      m_map(nullptr),
+      m_mapSize(0),
+      m_header(nullptr),
+      m_records(nullptr),
+      m_count(0),
+      m_first(0)
+  {
+
+  }
+
+  NRF24TraceFile ::
+    ~NRF24TraceFile()
+  {
+    this->close();
+  }
+
+  I32 NRF24TraceFile ::
+    open(const char* path)
+  {
+    FW_ASSERT(m_fd < 0);
+    m_fd = ::open(path, O_RDONLY);
+    if (m_fd < 0) {
+      return errno;
+    }
+    struct stat status;
+    if (::fstat(m_fd, &status) != 0) {
+      const I32 error = errno;
+      this->close();
+      return error;
+    }
+    if (status.st_size < static_cast<off_t>(NRF24Trace::RECORDS_OFFSET)) {
+      this->close();
+      return EINVAL;
+    }
+    const FwSizeType size = static_cast<FwSizeType>(status.st_size);
+    void* const map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (map == MAP_FAILED) {
+      const I32 error = errno;
+      this->close();
+      return error;
+    }
+    m_map = static_cast<const U8*>(map);
+    m_mapSize = size;
+    (void)::madvise(map, size, MADV_SEQUENTIAL);
+
+    const NRF24TraceHeader* const header = reinterpret_cast<const NRF24TraceHeader*>(m_map);
+    if (header->magic != NRF24Trace::MAGIC || header->version != NRF24Trace::VERSION ||
+        header->recordSize != sizeof(NRF24TraceRecord) || header->capacity == 0 ||
+        size < NRF24Trace::RECORDS_OFFSET + static_cast<FwSizeType>(header->capacity) * sizeof(NRF24TraceRecord)) {
+      this->close();
+      return EINVAL;
+    }
+    m_header = header;
+    m_records = reinterpret_cast<const NRF24TraceRecord*>(m_map + NRF24Trace::RECORDS_OFFSET);
+    m_count = FW_MIN(header->written, static_cast<U64>(header->capacity));
+    m_first = (header->written > header->capacity) ? header->written % header->capacity : 0;
+    return 0;
+  }
+
+  void NRF24TraceFile ::
+    close()
+  {
+    if (m_map != nullptr) {
+      (void)::munmap(const_cast<U8*>(m_map), m_mapSize);
+      m_map = nullptr;
+      m_header = nullptr;
+      m_records = nullptr;
+    }
+    if (m_fd >= 0) {
+      (void)::close(m_fd);
+      m_fd = -1;
+    }
+    m_count = 0;
+    m_first = 0;
+  }
+
+  const NRF24TraceRecord& NRF24TraceFile ::
+    record(U64 index) const
+  {
+    FW_ASSERT(index < m_count);
+    return m_records[(m_first + index) % m_header->capacity];
+  }
+
+}
@@ -0,0 +1,257 @@
+// ======================================================================
+// \title  NRF24Trace.hpp
+// \author mustafa
+// \brief  Binary trace of what NRF24Driver exchanges with the chip and the
+//         components around it, for offline replay
+//
+// Every record is the same 80 bytes: the time since the trace was opened,
+// what happened and its bytes. Each spiOut transfer is one record holding
+// the bytes clocked out and the bytes clocked in, each CE and CSN write
+// and each read of the IRQ line that mattered another. The inputs that set
+// the driver going, port calls and commands, are recorded with their
+// arguments when the driver takes them up, and so are the frames it finds
+// in the TX ring and the frames it drains. That is all the driver sees of
+// the world: fed the inputs again and answered from the trace on its bus,
+// it goes through the same steps.
+//
+// Recording is a clock read and a copy into a preallocated ring on the
+// driver's thread, no lock and no system call. The ring goes to the file
+// when it is full and on every run tick, a memcpy into a shared mapping;
+// the kernel writes the pages back on its own, also after the process
+// died. The file is a ring of records too: once full the oldest ones are
+// overwritten, and its header counts the records ever written.
+//
+// Records are in host byte order. A file from a host of the other byte
+// order does not open, its magic does not match.
+// ======================================================================
+
+#ifndef Components_NRF24Trace_HPP
+#define Components_NRF24Trace_HPP
+
+#include <FpConfig.hpp>
+#include <Os/RawTime.hpp>
+
+#include "Components/NRF24Driver/NRF24Registers.hpp"
+
+namespace Components {
+
+  //! One traced event, as laid out in the ring and the file
+  struct NRF24TraceRecord {
+
+    //! What the record holds
+    enum Kind : U8 {
+      SPI = 1,      //!< One spiOut transfer: length bytes out, then the length bytes that came in
+      CE = 2,       //!< CE written, value is the level
+      CSN = 3,      //!< CSN written, value is the level
+      IRQ_LINE = 4, //!< IRQ line read, value is the level, 0 asserted
+      INPUT = 5,    //!< The driver took up an input, value is the Input and data its arguments
+      TX_FRAME = 6, //!< A frame first seen in the TX ring
+      RX_FRAME = 7  //!< A frame drained from the RX FIFO
+    };
+
+    //! Port or command behind an INPUT record
+    enum Input : U8 {
+      RUN = 0,
+      IRQ = 1,
+      SERVICE = 2,         //!< Only service ticks that found the IRQ line asserted, it is read ahead of the input
+      BUFFER_SEND = 3,     //!< The payload, pipe, node and noAck from the buffer context
+      TX_DOORBELL = 4,
+      SURVEY = 5,          //!< dwells
+      TUNE = 6,            //!< channel, rate, power
+      NODE_ADDRESS = 7,    //!< node
+      INIT = 8,
+      START_RECEIVE = 9,
+      CONFIGURE = 10,      //!< channel, power
+      SET_STREAMING = 11,  //!< mode, 1 enabled, and noAck
+      SURVEY_CHANNELS = 12, //!< dwells
+      SET_DATA_RATE = 13   //!< rate
+    };
+
+    //! Bytes a record carries, both directions of the longest SPI transfer
+    static const U32 DATA_SIZE = 2 * (1 + NRF24::MAX_PAYLOAD_SIZE);
+
+    U64 timeUs; //!< Since the trace was opened
+    U8 kind;
+    U8 value;   //!< Level of CE, CSN and IRQ_LINE; the Input of INPUT
+    U8 length;  //!< SPI: bytes each way; INPUT and frames: bytes of data
+    U8 pipe;    //!< Frames and BUFFER_SEND
+    U8 node;    //!< TX_FRAME and BUFFER_SEND
+    U8 noAck;   //!< TX_FRAME and BUFFER_SEND
+    U8 data[DATA_SIZE];
+  };
+
+  //! Start of a trace file, the records follow at RECORDS_OFFSET
+  struct NRF24TraceHeader {
+    U32 magic;
+    U32 version;
+    U32 recordSize;
+    U32 capacity;            //!< Records the file holds
+    U64 written;             //!< Records ever written, the newest at (written - 1) % capacity
+    U8 hardwareChipSelect;   //!< NRF24Driver::configure arguments of the traced driver
+    U8 channel;
+  };
+
+  //! Records of a driver, kept in a ring and flushed to a trace file
+  class NRF24Trace {
+
+    public:
+
+      //! Called on the driver's thread as it takes up an input, before it acts on it
+      typedef void (*InputHook)(void* context, NRF24TraceRecord::Input input);
+
+      static const U32 MAGIC = 0x5446524E; //!< "NRFT" in a little endian file
+      static const U32 VERSION = 1;
+
+      //! Bytes ahead of the first record in the file
+      static const U32 RECORDS_OFFSET = 64;
+
+      //! Records collected before they go to the file
+      static const U32 RING_RECORDS = 128;
+
+      //! Fewest records a file holds, a few ring flushes
+      static const U32 MIN_FILE_RECORDS = 4 * RING_RECORDS;
+
+      NRF24Trace();
+      ~NRF24Trace();
+
+      //! Create or overwrite the trace file and map it
+      //! \return 0, or the errno of what failed
+      I32 open(
+          const char* path, //!< Trace file
+          U32 capacity, //!< Records the file holds, at least MIN_FILE_RECORDS
+          bool hardwareChipSelect, //!< Recorded for the replay
+          U8 channel //!< Recorded for the replay
+      );
+
+      //! Flush and unmap
+      void close();
+
+      bool isOpen() const { return m_records != nullptr; }
+
+      //! Record one spiOut transfer
+      void spi(const U8* out, const U8* in, U32 length) {
+        if (this->isOpen()) {
+          this->recordSpi(out, in, length);
+        }
+      }
+
+      //! Record a CE or CSN write or an IRQ line read
+      void level(NRF24TraceRecord::Kind kind, bool high) {
+        if (this->isOpen()) {
+          NRF24TraceRecord& record = this->append(kind);
+          record.value = high ? 1 : 0;
+        }
+      }
+
+      //! Record an input as the driver takes it up
+      void input(NRF24TraceRecord::Input input, const U8* args = nullptr, U8 length = 0) {
+        if (m_inputHook != nullptr) {
+          m_inputHook(m_inputHookContext, input);
+        }
+        if (this->isOpen()) {
+          (void)this->recordInput(input, args, length);
+        }
+      }
+
+      //! Record a buffer from bufferSendIn as the driver takes it up
+      void bufferSend(U8 pipe, U8 node, bool noAck, const U8* data, U8 length) {
+        if (m_inputHook != nullptr) {
+          m_inputHook(m_inputHookContext, NRF24TraceRecord::BUFFER_SEND);
+        }
+        if (this->isOpen()) {
+          NRF24TraceRecord& record = this->recordInput(NRF24TraceRecord::BUFFER_SEND, data, length);
+          record.pipe = pipe;
+          record.node = node;
+          record.noAck = noAck ? 1 : 0;
+        }
+      }
+
+      //! Record a frame seen in the TX ring or drained from the RX FIFO
+      void frame(NRF24TraceRecord::Kind kind, U8 pipe, U8 node, bool noAck, const U8* data, U8 length) {
+        if (this->isOpen()) {
+          this->recordFrame(kind, pipe, node, noAck, data, length);
+        }
+      }
+
+      //! Copy the ring into the file
+      void flush();
+
+      //! Records that went to the file
+      U64 written() const { return m_written; }
+
+      //! Have a hook called on every input, open or not. A replay learns from it that the driver
+      //! finished the input before and can be given the next one. Set it before the driver starts.
+      void setInputHook(InputHook hook, void* context) {
+        m_inputHook = hook;
+        m_inputHookContext = context;
+      }
+
+    private:
+
+      //! Next record in the ring, stamped with kind and time. A full ring is flushed first.
+      NRF24TraceRecord& append(NRF24TraceRecord::Kind kind);
+
+      void recordSpi(const U8* out, const U8* in, U32 length);
+      NRF24TraceRecord& recordInput(NRF24TraceRecord::Input input, const U8* args, U8 length);
+      void recordFrame(NRF24TraceRecord::Kind kind, U8 pipe, U8 node, bool noAck, const U8* data, U8 length);
+
+      NRF24TraceRecord m_ring[RING_RECORDS];
+      U32 m_count;
+
+      I32 m_fd;
+      U8* m_map;
+      FwSizeType m_mapSize;
+      NRF24TraceHeader* m_header;
+      NRF24TraceRecord* m_records; //!< In the mapping, nullptr while closed
+      U32 m_capacity;
+      U64 m_written;
+
+      Os::RawTime m_clockAt; //!< Last clock read, m_clockUs is the time at it
+      U64 m_clockUs;
+      bool m_clockValid;
+
+      InputHook m_inputHook;
+      void* m_inputHookContext;
+
+  };
+
+  //! A trace file mapped for reading, records oldest first
+  class NRF24TraceFile {
+
+    public:
+
+      NRF24TraceFile();
+      ~NRF24TraceFile();
+
+      //! Map a trace file
+      //! \return 0, or the errno of what failed; EINVAL for a file that is no trace
+      I32 open(const char* path);
+
+      void close();
+
+      //! Records the file still holds
+      U64 count() const { return m_count; }
+
+      //! Record by age, 0 the oldest the file holds
+      const NRF24TraceRecord& record(U64 index) const;
+
+      //! Whether records were overwritten, the trace no longer starts where it was opened
+      bool wrapped() const { return m_header != nullptr && m_header->written > m_header->capacity; }
+
+      const NRF24TraceHeader& header() const { return *m_header; }
+
+    private:
+
+      I32 m_fd;
+      const U8* m_map;
+      FwSizeType m_mapSize;
+      const NRF24TraceHeader* m_header;
+      const NRF24TraceRecord* m_records;
+      U64 m_count;
+      U64 m_first; //!< Slot of the oldest record
+
+  };
+
+}
+
+#endif
@@ -0,0 +1,67 @@
+// ======================================================================
+// \title  NRF24Ether.cpp
+// \author mustafa
+// \brief  cpp file for the virtual RF channel shared by NRF24Sim radios
+// ======================================================================
+
+#include "Components/NRF24Sim/NRF24Ether.hpp"
+#include "Components/NRF24Sim/NRF24Sim.hpp"
+
+namespace Components {
+
+  NRF24Ether ::
+    NRF24Ether() :
+      m_radios(),
+      m_radioCount(0)
+  {
+
+  }
+
+  bool NRF24Ether ::
+    attach(NRF24Sim& radio)
+  {
+    Os::ScopeLock lock(m_lock);
+    if (m_radioCount >= MAX_RADIOS) {
+      return false;
+    }
+    m_radios[m_radioCount++] = &radio;
+    return true;
+  }
+
+  bool NRF24Ether ::
+    transmit(const NRF24Sim& sender, const NRF24AirFrame& frame, NRF24AirFrame& ack)
+  {
+    // Receivers take their own lock inside receiveAir and never call back into the
+    // ether while holding it, so holding the ether lock across delivery cannot deadlock
+    // against a concurrent transmitter.
+    Os::ScopeLock lock(m_lock);
+    bool acked = false;
+    for (U32 i = 0; i < m_radioCount; i++) {
+      if (m_radios[i] == &sender) {
+        continue;
+      }
+      NRF24AirFrame candidate;
+      if (m_radios[i]->receiveAir(frame, candidate) && !acked) {
+        ack = candidate;
+        acked = true;
+      }
+    }
+    return acked;
+  }
+
+  U32 NRF24Ether ::
+    frameTimeUs(const NRF24AirFrame& frame, U8 crcBytes)
+  {
+    // Preamble + address + 9 bit packet control field + payload + CRC
+    const U32 bits = 8U * (1U + frame.addressWidth + frame.length + crcBytes) + 9U;
+    switch (frame.rate) {
+      case AIR_RATE_250KBPS:
+        return bits * 4U;
+      case AIR_RATE_1MBPS:
+        return bits;
+      default:
+        return (bits + 1U) / 2U;
+    }
+  }
+
+}
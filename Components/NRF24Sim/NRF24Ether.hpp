@@ -0,0 +1,80 @@
+// ======================================================================
+// \title  NRF24Ether.hpp
+// \author mustafa
+// \brief  hpp file for the virtual RF channel shared by NRF24Sim radios
+// ======================================================================
+
+#ifndef Components_NRF24Ether_HPP
+#define Components_NRF24Ether_HPP
+
+#include <FpConfig.hpp>
+#include <Os/Mutex.hpp>
+
+#include "Components/NRF24Driver/NRF24Registers.hpp"
+
+namespace Components {
+
+  class NRF24Sim;
+
+  //! Air data rates, in the order of increasing RF_SETUP speed
+  enum NRF24AirRate : U8 {
+    AIR_RATE_250KBPS = 0,
+    AIR_RATE_1MBPS = 1,
+    AIR_RATE_2MBPS = 2
+  };
+
+  //! One Enhanced ShockBurst packet as it appears on the air
+  struct NRF24AirFrame {
+    U8 channel;                                   //!< RF channel the packet was sent on
+    U8 rate;                                      //!< NRF24AirRate of the sender
+    U8 addressWidth;                              //!< Address width in bytes (3-5)
+    U8 address[NRF24::MAX_ADDRESS_WIDTH];         //!< Destination address, LSByte first
+    U8 length;                                    //!< Payload length in bytes
+    U8 payload[NRF24::MAX_PAYLOAD_SIZE];          //!< Payload bytes
+    U8 pid;                                       //!< 2-bit packet identity
+    bool noAck;                                   //!< NO_ACK flag of the packet control field
+  };
+
+  //! Virtual RF channel linking any number of simulated radios
+  //!
+  //! Every frame transmitted by one radio is offered to all other attached radios; each
+  //! decides on its own whether channel, data rate and address match, exactly as the air
+  //! interface does. The first receiver to acknowledge supplies the ACK packet.
+  class NRF24Ether {
+
+    public:
+
+      //! Most radios that can share one channel
+      static const U32 MAX_RADIOS = 64;
+
+      NRF24Ether();
+
+      //! Attach a radio, called by NRF24Sim::attach
+      //! \return false when the ether is full
+      bool attach(NRF24Sim& radio);
+
+      //! Put a frame on the air
+      //! \return true when a receiver acknowledged it, ack then holds the ACK packet
+      bool transmit(
+          const NRF24Sim& sender, //!< Transmitting radio, never receives its own frame
+          const NRF24AirFrame& frame, //!< Frame to deliver
+          NRF24AirFrame& ack //!< ACK packet returned by the receiver
+      );
+
+      //! On-air duration of a frame in microseconds, preamble through CRC
+      static U32 frameTimeUs(
+          const NRF24AirFrame& frame,
+          U8 crcBytes
+      );
+
+    private:
+
+      Os::Mutex m_lock;
+      NRF24Sim* m_radios[MAX_RADIOS];
+      U32 m_radioCount;
+
+  };
+
+}
+
+#endif
@@ -0,0 +1,752 @@
+// ======================================================================
+// \title  NRF24Sim.cpp
+// \author mustafa
+// \brief  cpp file for NRF24Sim component implementation class
+// ======================================================================
+
+#include "Components/NRF24Sim/NRF24Sim.hpp"
+
+#include <Fw/Types/Assert.hpp>
+#include <Os/RawTime.hpp>
+
+#include <cstring>
+
+namespace Components {
+
+  // ----------------------------------------------------------------------
+  // Component construction and destruction
+  // ----------------------------------------------------------------------
+
+  NRF24Sim ::
+    NRF24Sim(const char* const compName) :
+      NRF24SimComponentBase(compName),
+      m_ether(nullptr),
+      m_ceHigh(false),
+      m_csnLow(false),
+      m_csnDriven(false),
+      m_txActive(false),
+      m_reuseTx(false),
+      m_irqAsserted(false),
+      m_inTransaction(false),
+      m_command(NRF24::NOP),
+      m_byteIndex(0),
+      m_scratchLength(0),
+      m_txPid(0),
+      m_lossPercent(0),
+      m_rngState(0x9E3779B9),
+      m_airTimeUs(0),
+      m_framesSent(0),
+      m_framesReceived(0),
+      m_framesDropped(0),
+      m_retransmits(0)
+  {
+    this->resetRegisters();
+  }
+
+  NRF24Sim ::
+    ~NRF24Sim()
+  {
+
+  }
+
+  void NRF24Sim ::
+    attach(NRF24Ether& ether)
+  {
+    const bool attached = ether.attach(*this);
+    FW_ASSERT(attached);
+    m_ether = &ether;
+  }
+
+  bool NRF24Sim ::
+    receiveAir(const NRF24AirFrame& frame, NRF24AirFrame& ack)
+  {
+    bool acked = false;
+
+    m_lock.lock();
+    if (this->rxListening() &&
+        frame.channel == m_regs[NRF24::RF_CH] &&
+        frame.rate == this->airRate()) {
+      // Anything on our channel is above the -64 dBm detector threshold
+      m_regs[NRF24::RPD] = 0x01;
+
+      const U8 pipe = (frame.addressWidth == this->addressWidth()) ? this->matchPipe(frame) : NRF24::PIPE_COUNT;
+      const bool dynamic = (m_regs[NRF24::FEATURE] & NRF24::FEATURE_EN_DPL) &&
+                           (m_regs[NRF24::DYNPD] & (1U << pipe));
+      if (pipe >= NRF24::PIPE_COUNT) {
+        // Not for us
+      } else if (this->lossRoll()) {
+        m_framesDropped++;
+      } else if (!dynamic && m_regs[NRF24::RX_PW_P0 + pipe] != frame.length) {
+        // Static width mismatch fails the CRC check on the real chip
+        m_framesDropped++;
+      } else {
+        bool autoAck = (m_regs[NRF24::EN_AA] & (1U << pipe)) && !frame.noAck;
+        const bool duplicate = m_lastRxValid[pipe] &&
+                               m_lastRxPid[pipe] == frame.pid &&
+                               m_lastRx[pipe].length == frame.length &&
+                               std::memcmp(m_lastRx[pipe].data, frame.payload, frame.length) == 0;
+        if (!duplicate) {
+          FifoEntry entry;
+          std::memcpy(entry.data, frame.payload, frame.length);
+          entry.length = frame.length;
+          entry.pipe = pipe;
+          entry.noAck = frame.noAck;
+          entry.ackPayload = false;
+          if (fifoPush(m_rxFifo, entry)) {
+            m_regs[NRF24::STATUS] |= NRF24::STATUS_RX_DR;
+            m_lastRx[pipe] = entry;
+            m_lastRxPid[pipe] = frame.pid;
+            m_lastRxValid[pipe] = true;
+            m_framesReceived++;
+          } else {
+            // A full RX FIFO discards the packet and withholds the ACK
+            m_framesDropped++;
+            autoAck = false;
+          }
+        }
+
+        if (autoAck) {
+          acked = true;
+          ack.channel = frame.channel;
+          ack.rate = frame.rate;
+          ack.addressWidth = frame.addressWidth;
+          std::memcpy(ack.address, frame.address, sizeof(ack.address));
+          ack.pid = frame.pid;
+          ack.noAck = true;
+          ack.length = 0;
+          // ACK payloads share the TX FIFO, pick the oldest one queued for this pipe
+          if (m_txFifo.count > 0) {
+            FifoEntry& head = fifoHead(m_txFifo);
+            if (head.ackPayload && head.pipe == pipe) {
+              std::memcpy(ack.payload, head.data, head.length);
+              ack.length = head.length;
+              fifoPop(m_txFifo);
+              m_regs[NRF24::STATUS] |= NRF24::STATUS_TX_DS;
+            }
+          }
+        }
+      }
+    }
+    const bool edge = this->updateIrq();
+    m_lock.unLock();
+
+    if (edge) {
+      this->raiseIrq();
+    }
+    return acked;
+  }
+
+  // ----------------------------------------------------------------------
+  // Handler implementations for user-defined typed input ports
+  // ----------------------------------------------------------------------
+
+  void NRF24Sim ::
+    spiIn_handler(
+        FwIndexType portNum,
+        Fw::Buffer& writeBuffer,
+        Fw::Buffer& readBuffer
+    )
+  {
+    FW_ASSERT(readBuffer.getSize() >= writeBuffer.getSize());
+    const U8* const mosi = writeBuffer.getData();
+    U8* const miso = readBuffer.getData();
+    const FwSizeType size = writeBuffer.getSize();
+
+    m_lock.lock();
+    // Until csnIn is first driven, CSN is assumed to be the SPI controller's hardware
+    // chip select, which frames every transfer as one transaction.
+    const bool hardwareChipSelect = !m_csnDriven;
+    if (hardwareChipSelect) {
+      this->beginTransaction();
+    }
+    for (FwSizeType i = 0; i < size; i++) {
+      // MISO is tri-stated, and pulled up, while CSN is high
+      miso[i] = m_inTransaction ? this->clockByte(mosi[i]) : 0xFF;
+    }
+    if (hardwareChipSelect) {
+      this->endTransaction();
+    }
+    const bool transmit = this->txReady();
+    const bool edge = this->updateIrq();
+    m_lock.unLock();
+
+    if (edge) {
+      this->raiseIrq();
+    }
+    if (transmit) {
+      this->serviceTx();
+    }
+  }
+
+  Drv::GpioStatus NRF24Sim ::
+    ceIn_handler(
+        FwIndexType portNum,
+        const Fw::Logic& state
+    )
+  {
+    m_lock.lock();
+    const bool high = (state == Fw::Logic::HIGH);
+    const bool rising = high && !m_ceHigh;
+    m_ceHigh = high;
+    if (!high) {
+      // Back to standby-I, the next transmission pays the PLL settle again. RPD stays
+      // latched from the receive period that just ended.
+      m_txActive = false;
+    } else if (rising) {
+      m_regs[NRF24::RPD] = 0;
+    }
+    m_lock.unLock();
+
+    if (rising) {
+      this->serviceTx();
+    }
+    return Drv::GpioStatus::OP_OK;
+  }
+
+  Drv::GpioStatus NRF24Sim ::
+    csnIn_handler(
+        FwIndexType portNum,
+        const Fw::Logic& state
+    )
+  {
+    m_lock.lock();
+    const bool low = (state == Fw::Logic::LOW);
+    if (low && !m_csnLow) {
+      this->beginTransaction();
+    } else if (!low && m_csnLow) {
+      this->endTransaction();
+    }
+    m_csnLow = low;
+    m_csnDriven = true;
+    const bool transmit = this->txReady();
+    const bool edge = this->updateIrq();
+    m_lock.unLock();
+
+    if (edge) {
+      this->raiseIrq();
+    }
+    if (transmit) {
+      this->serviceTx();
+    }
+    return Drv::GpioStatus::OP_OK;
+  }
+
+  Drv::GpioStatus NRF24Sim ::
+    irqRead_handler(
+        FwIndexType portNum,
+        Fw::Logic& state
+    )
+  {
+    m_lock.lock();
+    state = m_irqAsserted ? Fw::Logic::LOW : Fw::Logic::HIGH;
+    m_lock.unLock();
+    return Drv::GpioStatus::OP_OK;
+  }
+
+  void NRF24Sim ::
+    run_handler(
+        FwIndexType portNum,
+        U32 context
+    )
+  {
+    m_lock.lock();
+    const U64 airTimeUs = m_airTimeUs;
+    const U32 framesSent = m_framesSent;
+    const U32 framesReceived = m_framesReceived;
+    const U32 framesDropped = m_framesDropped;
+    const U32 retransmits = m_retransmits;
+    m_lock.unLock();
+
+    this->tlmWrite_AirTimeUs(airTimeUs);
+    this->tlmWrite_FramesSent(framesSent);
+    this->tlmWrite_FramesReceived(framesReceived);
+    this->tlmWrite_FramesDropped(framesDropped);
+    this->tlmWrite_Retransmits(retransmits);
+  }
+
+  // ----------------------------------------------------------------------
+  // Command handler implementations
+  // ----------------------------------------------------------------------
+
+  void NRF24Sim ::
+    SET_RX_LOSS_cmdHandler(
+        const FwOpcodeType opCode,
+        const U32 cmdSeq,
+        const U8 percent
+    )
+  {
+    if (percent > 100) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+
+    m_lock.lock();
+    m_lossPercent = percent;
+    m_lock.unLock();
+
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  // ----------------------------------------------------------------------
+  // Radio model
+  // ----------------------------------------------------------------------
+
+  void NRF24Sim ::
+    resetRegisters()
+  {
+    std::memset(m_regs, 0, sizeof(m_regs));
+    m_regs[NRF24::CONFIG] = NRF24::CONFIG_EN_CRC;
+    m_regs[NRF24::EN_AA] = 0x3F;
+    m_regs[NRF24::EN_RXADDR] = 0x03;
+    m_regs[NRF24::SETUP_AW] = 0x03;
+    m_regs[NRF24::SETUP_RETR] = 0x03;
+    m_regs[NRF24::RF_CH] = 0x02;
+    m_regs[NRF24::RF_SETUP] = 0x0E;
+    m_regs[NRF24::RX_ADDR_P2] = 0xC3;
+    m_regs[NRF24::RX_ADDR_P3] = 0xC4;
+    m_regs[NRF24::RX_ADDR_P4] = 0xC5;
+    m_regs[NRF24::RX_ADDR_P5] = 0xC6;
+    std::memset(m_rxAddrP0, 0xE7, sizeof(m_rxAddrP0));
+    std::memset(m_rxAddrP1, 0xC2, sizeof(m_rxAddrP1));
+    std::memset(m_txAddr, 0xE7, sizeof(m_txAddr));
+    std::memset(&m_txFifo, 0, sizeof(m_txFifo));
+    std::memset(&m_rxFifo, 0, sizeof(m_rxFifo));
+    std::memset(m_lastRx, 0, sizeof(m_lastRx));
+    std::memset(m_lastRxPid, 0, sizeof(m_lastRxPid));
+    std::memset(m_lastRxValid, 0, sizeof(m_lastRxValid));
+    std::memset(m_scratch, 0, sizeof(m_scratch));
+  }
+
+  void NRF24Sim ::
+    beginTransaction()
+  {
+    m_inTransaction = true;
+    m_command = NRF24::NOP;
+    m_byteIndex = 0;
+    m_scratchLength = 0;
+  }
+
+  U8 NRF24Sim ::
+    clockByte(U8 mosi)
+  {
+    // The first byte of every transaction is the command, clocked against STATUS
+    if (m_byteIndex++ == 0) {
+      m_command = mosi;
+      return this->status();
+    }
+
+    const U32 index = m_byteIndex - 2;
+    const U8 command = m_command;
+    if ((command & ~NRF24::REGISTER_MASK) == NRF24::R_REGISTER) {
+      return this->readRegister(command & NRF24::REGISTER_MASK, static_cast<U8>(FW_MIN(index, 0xFFU)));
+    }
+    if (command == NRF24::R_RX_PAYLOAD) {
+      if (m_rxFifo.count > 0 && index < fifoHead(m_rxFifo).length) {
+        return fifoHead(m_rxFifo).data[index];
+      }
+      return 0x00;
+    }
+    if (command == NRF24::R_RX_PL_WID) {
+      return (m_rxFifo.count > 0) ? fifoHead(m_rxFifo).length : 0x00;
+    }
+    // Everything else is a write, buffer it until CSN rises
+    if (m_scratchLength < sizeof(m_scratch)) {
+      m_scratch[m_scratchLength++] = mosi;
+    }
+    return 0x00;
+  }
+
+  void NRF24Sim ::
+    endTransaction()
+  {
+    if (!m_inTransaction) {
+      return;
+    }
+    m_inTransaction = false;
+    if (m_byteIndex == 0) {
+      return;
+    }
+
+    const U8 command = m_command;
+    if ((command & ~NRF24::REGISTER_MASK) == NRF24::W_REGISTER) {
+      if (m_scratchLength > 0) {
+        this->writeRegister(command & NRF24::REGISTER_MASK, m_scratch, m_scratchLength);
+      }
+    } else if (command == NRF24::R_RX_PAYLOAD) {
+      if (m_byteIndex > 1 && m_rxFifo.count > 0) {
+        fifoPop(m_rxFifo);
+      }
+    } else if (command == NRF24::W_TX_PAYLOAD || command == NRF24::W_TX_PAYLOAD_NOACK) {
+      if (m_scratchLength > 0) {
+        FifoEntry entry;
+        std::memcpy(entry.data, m_scratch, m_scratchLength);
+        entry.length = m_scratchLength;
+        entry.pipe = 0;
+        entry.noAck = (command == NRF24::W_TX_PAYLOAD_NOACK) &&
+                      (m_regs[NRF24::FEATURE] & NRF24::FEATURE_EN_DYN_ACK);
+        entry.ackPayload = false;
+        // Writes to a full FIFO are discarded by the chip
+        (void) fifoPush(m_txFifo, entry);
+        m_reuseTx = false;
+      }
+    } else if ((command & ~NRF24::PIPE_MASK) == NRF24::W_ACK_PAYLOAD) {
+      if (m_scratchLength > 0 && (m_regs[NRF24::FEATURE] & NRF24::FEATURE_EN_ACK_PAY)) {
+        FifoEntry entry;
+        std::memcpy(entry.data, m_scratch, m_scratchLength);
+        entry.length = m_scratchLength;
+        entry.pipe = command & NRF24::PIPE_MASK;
+        entry.noAck = false;
+        entry.ackPayload = true;
+        (void) fifoPush(m_txFifo, entry);
+      }
+    } else if (command == NRF24::FLUSH_TX) {
+      m_txFifo.head = 0;
+      m_txFifo.count = 0;
+      m_reuseTx = false;
+    } else if (command == NRF24::FLUSH_RX) {
+      m_rxFifo.head = 0;
+      m_rxFifo.count = 0;
+    } else if (command == NRF24::REUSE_TX_PL) {
+      m_reuseTx = true;
+    }
+  }
+
+  void NRF24Sim ::
+    writeRegister(U8 reg, const U8* data, U8 length)
+  {
+    switch (reg) {
+      case NRF24::STATUS:
+        // Interrupt flags are cleared by writing 1
+        m_regs[NRF24::STATUS] &= static_cast<U8>(~(data[0] & NRF24::STATUS_IRQ_MASK));
+        break;
+      case NRF24::RX_ADDR_P0:
+        std::memcpy(m_rxAddrP0, data, FW_MIN(length, NRF24::MAX_ADDRESS_WIDTH));
+        break;
+      case NRF24::RX_ADDR_P1:
+        std::memcpy(m_rxAddrP1, data, FW_MIN(length, NRF24::MAX_ADDRESS_WIDTH));
+        break;
+      case NRF24::TX_ADDR:
+        std::memcpy(m_txAddr, data, FW_MIN(length, NRF24::MAX_ADDRESS_WIDTH));
+        break;
+      case NRF24::OBSERVE_TX:
+      case NRF24::RPD:
+      case NRF24::FIFO_STATUS:
+        // Read only
+        break;
+      case NRF24::RF_CH:
+        // Writing RF_CH resets the lost packet counter
+        m_regs[NRF24::RF_CH] = data[0] & 0x7F;
+        m_regs[NRF24::OBSERVE_TX] &= NRF24::OBSERVE_TX_ARC_CNT_MASK;
+        break;
+      case NRF24::CONFIG:
+        m_regs[NRF24::CONFIG] = data[0] & 0x7F;
+        if (!(m_regs[NRF24::CONFIG] & NRF24::CONFIG_PWR_UP)) {
+          m_txActive = false;
+        }
+        break;
+      default:
+        // 0x18 - 0x1B are reserved and ignore writes
+        if (reg < NRF24::REGISTER_COUNT && (reg < 0x18 || reg > 0x1B)) {
+          m_regs[reg] = data[0];
+        }
+        break;
+    }
+  }
+
+  U8 NRF24Sim ::
+    readRegister(U8 reg, U8 index) const
+  {
+    switch (reg) {
+      case NRF24::RX_ADDR_P0:
+        return (index < NRF24::MAX_ADDRESS_WIDTH) ? m_rxAddrP0[index] : 0x00;
+      case NRF24::RX_ADDR_P1:
+        return (index < NRF24::MAX_ADDRESS_WIDTH) ? m_rxAddrP1[index] : 0x00;
+      case NRF24::TX_ADDR:
+        return (index < NRF24::MAX_ADDRESS_WIDTH) ? m_txAddr[index] : 0x00;
+      case NRF24::STATUS:
+        return this->status();
+      case NRF24::FIFO_STATUS:
+        return this->fifoStatus();
+      default:
+        return (reg < NRF24::REGISTER_COUNT) ? m_regs[reg] : 0x00;
+    }
+  }
+
+  U8 NRF24Sim ::
+    status() const
+  {
+    const U8 pipe = (m_rxFifo.count > 0) ? m_rxFifo.entries[m_rxFifo.head].pipe : NRF24::RX_P_NO_EMPTY;
+    U8 value = m_regs[NRF24::STATUS] & NRF24::STATUS_IRQ_MASK;
+    value |= static_cast<U8>(pipe << NRF24::STATUS_RX_P_NO_SHIFT);
+    if (m_txFifo.count >= NRF24::FIFO_DEPTH) {
+      value |= NRF24::STATUS_TX_FULL;
+    }
+    return value;
+  }
+
+  U8 NRF24Sim ::
+    fifoStatus() const
+  {
+    U8 value = 0;
+    if (m_reuseTx) {
+      value |= NRF24::FIFO_STATUS_TX_REUSE;
+    }
+    if (m_txFifo.count >= NRF24::FIFO_DEPTH) {
+      value |= NRF24::FIFO_STATUS_TX_FULL;
+    }
+    if (m_txFifo.count == 0) {
+      value |= NRF24::FIFO_STATUS_TX_EMPTY;
+    }
+    if (m_rxFifo.count >= NRF24::FIFO_DEPTH) {
+      value |= NRF24::FIFO_STATUS_RX_FULL;
+    }
+    if (m_rxFifo.count == 0) {
+      value |= NRF24::FIFO_STATUS_RX_EMPTY;
+    }
+    return value;
+  }
+
+  U8 NRF24Sim ::
+    addressWidth() const
+  {
+    // SETUP_AW 0b01 = 3 bytes ... 0b11 = 5 bytes, 0b00 is illegal and treated as 3
+    const U8 aw = m_regs[NRF24::SETUP_AW] & 0x03;
+    return (aw == 0) ? 3 : static_cast<U8>(aw + 2);
+  }
+
+  U8 NRF24Sim ::
+    airRate() const
+  {
+    const U8 setup = m_regs[NRF24::RF_SETUP];
+    if (setup & NRF24::RF_SETUP_RF_DR_LOW) {
+      return AIR_RATE_250KBPS;
+    }
+    return (setup & NRF24::RF_SETUP_RF_DR_HIGH) ? AIR_RATE_2MBPS : AIR_RATE_1MBPS;
+  }
+
+  U8 NRF24Sim ::
+    crcBytes() const
+  {
+    const U8 config = m_regs[NRF24::CONFIG];
+    if (!(config & NRF24::CONFIG_EN_CRC)) {
+      return 0;
+    }
+    return (config & NRF24::CONFIG_CRCO) ? 2 : 1;
+  }
+
+  U8 NRF24Sim ::
+    matchPipe(const NRF24AirFrame& frame) const
+  {
+    const U8 width = frame.addressWidth;
+    const U8 enabled = m_regs[NRF24::EN_RXADDR];
+    if ((enabled & 0x01) && std::memcmp(frame.address, m_rxAddrP0, width) == 0) {
+      return 0;
+    }
+    // Pipes 2-5 share the upper address bytes with pipe 1 and differ in the LSByte
+    if (std::memcmp(&frame.address[1], &m_rxAddrP1[1], width - 1U) != 0) {
+      return NRF24::PIPE_COUNT;
+    }
+    if ((enabled & 0x02) && frame.address[0] == m_rxAddrP1[0]) {
+      return 1;
+    }
+    for (U8 pipe = 2; pipe < NRF24::PIPE_COUNT; pipe++) {
+      if ((enabled & (1U << pipe)) && frame.address[0] == m_regs[NRF24::RX_ADDR_P2 + pipe - 2]) {
+        return pipe;
+      }
+    }
+    return NRF24::PIPE_COUNT;
+  }
+
+  bool NRF24Sim ::
+    txReady() const
+  {
+    const U8 config = m_regs[NRF24::CONFIG];
+    return m_ceHigh &&
+           (config & NRF24::CONFIG_PWR_UP) &&
+           !(config & NRF24::CONFIG_PRIM_RX) &&
+           !(m_regs[NRF24::STATUS] & NRF24::STATUS_MAX_RT) &&
+           m_txFifo.count > 0 &&
+           !m_txFifo.entries[m_txFifo.head].ackPayload;
+  }
+
+  bool NRF24Sim ::
+    rxListening() const
+  {
+    const U8 config = m_regs[NRF24::CONFIG];
+    return m_ceHigh && (config & NRF24::CONFIG_PWR_UP) && (config & NRF24::CONFIG_PRIM_RX);
+  }
+
+  bool NRF24Sim ::
+    lossRoll()
+  {
+    if (m_lossPercent == 0) {
+      return false;
+    }
+    // xorshift32, deterministic so CI runs are reproducible
+    m_rngState ^= m_rngState << 13;
+    m_rngState ^= m_rngState >> 17;
+    m_rngState ^= m_rngState << 5;
+    return (m_rngState % 100U) < m_lossPercent;
+  }
+
+  bool NRF24Sim ::
+    updateIrq()
+  {
+    // CONFIG mask bits line up with the STATUS flags they mask
+    const bool asserted = (m_regs[NRF24::STATUS] & NRF24::STATUS_IRQ_MASK & ~m_regs[NRF24::CONFIG]) != 0;
+    const bool edge = asserted && !m_irqAsserted;
+    m_irqAsserted = asserted;
+    return edge;
+  }
+
+  void NRF24Sim ::
+    serviceTx()
+  {
+    // CE pulse width is not modelled: while CE is high the radio empties the TX FIFO,
+    // which is what a host slower than the air interface observes.
+    while (true) {
+      NRF24AirFrame frame;
+      U64 airTimeUs = 0;
+
+      m_lock.lock();
+      if (!this->txReady()) {
+        m_lock.unLock();
+        return;
+      }
+      const FifoEntry& entry = fifoHead(m_txFifo);
+      frame.channel = m_regs[NRF24::RF_CH];
+      frame.rate = this->airRate();
+      frame.addressWidth = this->addressWidth();
+      std::memcpy(frame.address, m_txAddr, sizeof(frame.address));
+      std::memcpy(frame.payload, entry.data, entry.length);
+      frame.length = entry.length;
+      frame.noAck = entry.noAck;
+      if (!m_reuseTx) {
+        m_txPid = (m_txPid + 1) & 0x03;
+      }
+      frame.pid = m_txPid;
+      const bool expectAck = (m_regs[NRF24::EN_AA] & 0x01) && !entry.noAck;
+      // The ACK comes back on pipe 0, so RX_ADDR_P0 must equal TX_ADDR to see it
+      const bool ackVisible = std::memcmp(m_rxAddrP0, m_txAddr, frame.addressWidth) == 0;
+      const U8 retryLimit = m_regs[NRF24::SETUP_RETR] & NRF24::SETUP_RETR_ARC_MASK;
+      const U32 retryDelayUs = ((m_regs[NRF24::SETUP_RETR] >> NRF24::SETUP_RETR_ARD_SHIFT) + 1U) * NRF24::ARD_STEP_US;
+      const U8 crc = this->crcBytes();
+      const bool reuse = m_reuseTx;
+      if (!m_txActive) {
+        airTimeUs += NRF24::SETTLE_TIME_US;
+        m_txActive = true;
+      }
+      m_lock.unLock();
+
+      NRF24AirFrame ack;
+      bool acked = false;
+      U32 sent = 0;
+      U32 retransmits = 0;
+      while (true) {
+        airTimeUs += NRF24Ether::frameTimeUs(frame, crc);
+        sent++;
+        const bool delivered = (m_ether != nullptr) && m_ether->transmit(*this, frame, ack);
+        if (!expectAck) {
+          break;
+        }
+        // Turn around to RX and wait for the ACK
+        airTimeUs += NRF24::SETTLE_TIME_US;
+        if (delivered && ackVisible) {
+          m_lock.lock();
+          const bool lost = this->lossRoll();
+          m_lock.unLock();
+          if (!lost) {
+            airTimeUs += NRF24Ether::frameTimeUs(ack, crc);
+            acked = true;
+            break;
+          }
+        }
+        if (retransmits >= retryLimit) {
+          break;
+        }
+        retransmits++;
+        airTimeUs += retryDelayUs;
+      }
+
+      m_lock.lock();
+      m_airTimeUs += airTimeUs;
+      m_framesSent += sent;
+      m_retransmits += retransmits;
+      U8 lost = m_regs[NRF24::OBSERVE_TX] >> NRF24::OBSERVE_TX_PLOS_SHIFT;
+      if (!expectAck || acked) {
+        if (!reuse && m_txFifo.count > 0) {
+          fifoPop(m_txFifo);
+        }
+        m_regs[NRF24::STATUS] |= NRF24::STATUS_TX_DS;
+        if (acked && ack.length > 0) {
+          FifoEntry entry;
+          std::memcpy(entry.data, ack.payload, ack.length);
+          entry.length = ack.length;
+          entry.pipe = 0;
+          entry.noAck = true;
+          entry.ackPayload = false;
+          if (fifoPush(m_rxFifo, entry)) {
+            m_regs[NRF24::STATUS] |= NRF24::STATUS_RX_DR;
+          }
+        }
+      } else {
+        // Payload stays in the FIFO, TX halts until MAX_RT is cleared
+        m_regs[NRF24::STATUS] |= NRF24::STATUS_MAX_RT;
+        lost = static_cast<U8>(FW_MIN(lost + 1U, 0x0FU));
+      }
+      m_regs[NRF24::OBSERVE_TX] = static_cast<U8>((lost << NRF24::OBSERVE_TX_PLOS_SHIFT) |
+                                                  (retransmits & NRF24::OBSERVE_TX_ARC_CNT_MASK));
+      if (m_txFifo.count == 0) {
+        // Standby-II, a new payload pays the PLL settle again
+        m_txActive = false;
+      }
+      const bool edge = this->updateIrq();
+      m_lock.unLock();
+
+      if (edge) {
+        this->raiseIrq();
+      }
+      if (reuse) {
+        // A reused payload is resent for as long as CE stays high, send it once per call
+        return;
+      }
+    }
+  }
+
+  void NRF24Sim ::
+    raiseIrq()
+  {
+    if (this->isConnected_irqOut_OutputPort(0)) {
+      Os::RawTime now;
+      (void) now.now();
+      this->irqOut_out(0, now);
+    }
+  }
+
+  bool NRF24Sim ::
+    fifoPush(Fifo& fifo, const FifoEntry& entry)
+  {
+    if (fifo.count >= NRF24::FIFO_DEPTH) {
+      return false;
+    }
+    fifo.entries[(fifo.head + fifo.count) % NRF24::FIFO_DEPTH] = entry;
+    fifo.count++;
+    return true;
+  }
+
+  NRF24Sim::FifoEntry& NRF24Sim ::
+    fifoHead(Fifo& fifo)
+  {
+    FW_ASSERT(fifo.count > 0);
+    return fifo.entries[fifo.head];
+  }
+
+  void NRF24Sim ::
+    fifoPop(Fifo& fifo)
+  {
+    FW_ASSERT(fifo.count > 0);
+    fifo.head = (fifo.head + 1) % NRF24::FIFO_DEPTH;
+    fifo.count--;
+  }
+
+}
@@ -0,0 +1,190 @@
+// ======================================================================
+// \title  NRF24Sim.hpp
+// \author mustafa
+// \brief  hpp file for NRF24Sim component implementation class
+// ======================================================================
+
+#ifndef Components_NRF24Sim_HPP
+#define Components_NRF24Sim_HPP
+
+#include "Components/NRF24Sim/NRF24SimComponentAc.hpp"
+#include "Components/NRF24Sim/NRF24Ether.hpp"
+#include "Components/NRF24Driver/NRF24Registers.hpp"
+
+#include <Os/Mutex.hpp>
+
+namespace Components {
+
+ class NRF24Sim :
+   public NRF24SimComponentBase
+ {
+
+   public:
+
+     // ----------------------------------------------------------------------
+     // Component construction and destruction
+     // ----------------------------------------------------------------------
+
+     //! Construct NRF24Sim object
+     NRF24Sim(
+         const char* const compName //!< The component name
+     );
+
+     //! Destroy NRF24Sim object
+     ~NRF24Sim();
+
+     //! Attach this radio to a virtual RF channel
+     void attach(
+         NRF24Ether& ether //!< Channel shared with the peer radios
+     );
+
+     //! Deliver a frame from the air, called by NRF24Ether
+     //! \return true when the frame is acknowledged, ack then holds the ACK packet
+     bool receiveAir(
+         const NRF24AirFrame& frame,
+         NRF24AirFrame& ack
+     );
+
+   private:
+
+     // ----------------------------------------------------------------------
+     // Handler implementations for user-defined typed input ports
+     // ----------------------------------------------------------------------
+
+     void spiIn_handler(
+         FwIndexType portNum,
+         Fw::Buffer& writeBuffer,
+         Fw::Buffer& readBuffer
+     ) override;
+
+     Drv::GpioStatus ceIn_handler(
+         FwIndexType portNum,
+         const Fw::Logic& state
+     ) override;
+
+     Drv::GpioStatus csnIn_handler(
+         FwIndexType portNum,
+         const Fw::Logic& state
+     ) override;
+
+     Drv::GpioStatus irqRead_handler(
+         FwIndexType portNum,
+         Fw::Logic& state
+     ) override;
+
+     void run_handler(
+         FwIndexType portNum,
+         U32 context
+     ) override;
+
+     // ----------------------------------------------------------------------
+     // Command handlers
+     // ----------------------------------------------------------------------
+
+     void SET_RX_LOSS_cmdHandler(
+         const FwOpcodeType opCode,
+         const U32 cmdSeq,
+         const U8 percent
+     ) override;
+
+     // ----------------------------------------------------------------------
+     // Radio model, called with m_lock held
+     // ----------------------------------------------------------------------
+
+     //! One payload slot of the TX or RX FIFO
+     struct FifoEntry {
+       U8 data[NRF24::MAX_PAYLOAD_SIZE];
+       U8 length;
+       U8 pipe;        //!< RX pipe, or ACK payload pipe for TX entries
+       bool noAck;     //!< Written with W_TX_PAYLOAD_NOACK
+       bool ackPayload; //!< Written with W_ACK_PAYLOAD
+     };
+
+     //! Fixed three-level FIFO
+     struct Fifo {
+       FifoEntry entries[NRF24::FIFO_DEPTH];
+       U8 head;
+       U8 count;
+     };
+
+     void resetRegisters();
+     void beginTransaction();
+     U8 clockByte(U8 mosi);
+     void endTransaction();
+     void writeRegister(U8 reg, const U8* data, U8 length);
+     U8 readRegister(U8 reg, U8 index) const;
+     U8 status() const;
+     U8 fifoStatus() const;
+     U8 addressWidth() const;
+     U8 airRate() const;
+     U8 crcBytes() const;
+     U8 matchPipe(const NRF24AirFrame& frame) const;
+     bool txReady() const;
+     bool rxListening() const;
+     bool lossRoll();
+
+     //! Recompute the IRQ line
+     //! \return true on a falling edge, the caller raises irqOut after unlocking
+     bool updateIrq();
+
+     //! Transmit TX FIFO payloads while the chip is in TX mode, takes m_lock itself
+     void serviceTx();
+
+     //! Raise irqOut, called without m_lock held
+     void raiseIrq();
+
+     static bool fifoPush(Fifo& fifo, const FifoEntry& entry);
+     static FifoEntry& fifoHead(Fifo& fifo);
+     static void fifoPop(Fifo& fifo);
+
+     // ----------------------------------------------------------------------
+     // Member variables
+     // ----------------------------------------------------------------------
+
+     Os::Mutex m_lock;
+     NRF24Ether* m_ether;
+
+     U8 m_regs[NRF24::REGISTER_COUNT];
+     U8 m_rxAddrP0[NRF24::MAX_ADDRESS_WIDTH];
+     U8 m_rxAddrP1[NRF24::MAX_ADDRESS_WIDTH];
+     U8 m_txAddr[NRF24::MAX_ADDRESS_WIDTH];
+
+     Fifo m_txFifo;
+     Fifo m_rxFifo;
+
+     bool m_ceHigh;
+     bool m_csnLow;
+     bool m_csnDriven;   //!< csnIn has been written, otherwise CSN is the SPI hardware chip select
+     bool m_txActive;    //!< PLL settled in TX mode, next packet goes out back to back
+     bool m_reuseTx;
+     bool m_irqAsserted;
+
+     // SPI transaction in progress
+     bool m_inTransaction;
+     U8 m_command;
+     U32 m_byteIndex;
+     U8 m_scratch[NRF24::MAX_PAYLOAD_SIZE];
+     U8 m_scratchLength;
+
+     // Packet identity and duplicate detection
+     U8 m_txPid;
+     FifoEntry m_lastRx[NRF24::PIPE_COUNT];
+     U8 m_lastRxPid[NRF24::PIPE_COUNT];
+     bool m_lastRxValid[NRF24::PIPE_COUNT];
+
+     // Loss model
+     U8 m_lossPercent;
+     U32 m_rngState;
+
+     // Statistics
+     U64 m_airTimeUs;
+     U32 m_framesSent;
+     U32 m_framesReceived;
+     U32 m_framesDropped;
+     U32 m_retransmits;
+
+ };
+
+}
+
+#endif
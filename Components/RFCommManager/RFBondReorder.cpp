@@ -0,0 +1,293 @@
+// ======================================================================
+// \title  RFBondReorder.cpp
+// \author mustafa
+// \brief  cpp file for the receive order of frames bonded over several
+//         radios
+// ======================================================================
+
+#include "Components/RFCommManager/RFBondReorder.hpp"
+
+#include <Fw/Types/Assert.hpp>
+
+#include <cstring>
+
+namespace Components {
+
+  namespace {
+
+    // A frame that left the TX ring waits in the radio's FIFO, the ring's oldest one went at most
+    // SKEW_FRAMES after it
+    static_assert(2 * RFBond::SKEW_FRAMES + RFBond::MAX_RADIOS * NRF24::FIFO_DEPTH < 128,
+                  "Frames in flight stay within half the sequence space");
+    static_assert((RFBond::RADIO_DEPTH & (RFBond::RADIO_DEPTH - 1)) == 0, "Free running counters index the history");
+    static_assert(RFBond::ACTIVE_FRAMES < 128, "A recent sequence number compares with the expected one");
+
+    //! Whether a sequence number is at or after another one
+    bool atOrAfter(U8 seq, U8 reference) {
+      return static_cast<U8>(seq - reference) < 128;
+    }
+
+  }
+
+  RFBondReorder ::
+    RFBondReorder() :
+      m_radios(0),
+      m_kept(0),
+      m_longestHoldUs(0),
+      m_gaps(0)
+  {
+    std::memset(m_sources, 0, sizeof(m_sources));
+    for (U32 i = 0; i < RFBond::REORDER_SLOTS; i++) {
+      m_used[i] = false;
+    }
+  }
+
+  void RFBondReorder ::
+    addRadio()
+  {
+    FW_ASSERT(m_radios < RFBond::MAX_RADIOS, m_radios);
+    m_radios++;
+  }
+
+  bool RFBondReorder ::
+    admit(U8 radio, U8 pipe, const RFFragment::Header& header, const U8* frame, U8 length)
+  {
+    FW_ASSERT(radio < m_radios && header.source < NRF24::MAX_NODES, radio, header.source);
+    Source& state = m_sources[header.source];
+    state.dataSeq[radio] = header.seq;
+    state.dataMsgId[radio] = header.msgId;
+    state.dataIndex[radio] = header.index;
+    return this->place(radio, pipe, header.source, header.seq, frame, length);
+  }
+
+  bool RFBondReorder ::
+    admitFollowing(U8 radio, U8 pipe, const RFFragment::Header& header, U8 index, U8 offset, const U8* frame,
+                   U8 length)
+  {
+    FW_ASSERT(radio < m_radios && header.source < NRF24::MAX_NODES, radio, header.source);
+    FW_ASSERT(length <= NRF24::MAX_PAYLOAD_SIZE, length);
+    Source& state = m_sources[header.source];
+    if (!state.synced || state.lastArrival[radio] == 0) {
+      return true;
+    }
+    state.following = (offset + 1U > state.following) ? static_cast<U8>(offset + 1) : state.following;
+    if (state.dataMsgId[radio] == header.msgId && state.dataIndex[radio] == index) {
+      return this->place(radio, pipe, header.source, static_cast<U8>(state.dataSeq[radio] + 1 + offset), frame,
+                         length);
+    }
+    // The fragment it follows did not come. Its number lies before the next one its radio brings,
+    // until then it waits. Without room it goes on now.
+    if (!this->keep(radio, pipe, header.source, offset, Frame::UNPLACED, frame, length)) {
+      return true;
+    }
+    state.unplaced = static_cast<U8>(state.unplaced | (1U << radio));
+    return false;
+  }
+
+  bool RFBondReorder ::
+    place(U8 radio, U8 pipe, U8 source, U8 seq, const U8* frame, U8 length)
+  {
+    FW_ASSERT(length <= NRF24::MAX_PAYLOAD_SIZE, length);
+    Source& state = m_sources[source];
+    state.arrivals++;
+    state.last[radio] = seq;
+    state.lastArrival[radio] = state.arrivals;
+
+    if (!state.synced) {
+      state.synced = true;
+      state.expected = static_cast<U8>(seq + 1);
+      return true;
+    }
+    if ((state.unplaced & (1U << radio)) != 0) {
+      this->settle(radio, source, seq);
+    }
+    if (seq == state.expected) {
+      state.expected++;
+      return true;
+    }
+    // Behind: given up on and come after all, or a duplicate. It goes on as it is, reassembly
+    // drops what it already has.
+    if (!atOrAfter(seq, state.expected)) {
+      return true;
+    }
+
+    if (!this->keep(radio, pipe, source, seq, Frame::NUMBERED, frame, length)) {
+      m_gaps++;
+      return true;
+    }
+    return false;
+  }
+
+  void RFBondReorder ::
+    settle(U8 radio, U8 source, U8 seq)
+  {
+    Source& state = m_sources[source];
+    state.unplaced = static_cast<U8>(state.unplaced & ~(1U << radio));
+
+    // The unplaced frames came between the radio's last frame and this one, right after the
+    // fragment they follow and numbered on from it, as many as follow every such fragment. That
+    // fragment and they are missing, the first run of missing numbers as long is theirs.
+    U32 present[256 / 32];
+    std::memset(present, 0, sizeof(present));
+    for (U32 i = 0; i < RFBond::REORDER_SLOTS; i++) {
+      const Frame& kept = m_frames[i];
+      if (m_used[i] && kept.source == source && kept.kind == Frame::NUMBERED) {
+        present[kept.seq / 32U] |= 1U << (kept.seq % 32U);
+      }
+    }
+    bool found = false;
+    U8 first = state.expected;
+    U32 missing = 0;
+    if (atOrAfter(seq, state.expected)) {
+      for (U8 number = state.expected; number != seq && !found; number++) {
+        if ((present[number / 32U] & (1U << (number % 32U))) != 0) {
+          missing = 0;
+          continue;
+        }
+        first = (missing == 0) ? number : first;
+        missing++;
+        found = (missing > state.following);
+      }
+    }
+
+    // Without such a run they go on now, the frames they follow came or were given up on
+    for (U32 i = 0; i < RFBond::REORDER_SLOTS; i++) {
+      Frame& kept = m_frames[i];
+      if (m_used[i] && kept.source == source && kept.radio == radio && kept.kind == Frame::UNPLACED) {
+        kept.kind = found ? Frame::NUMBERED : Frame::FOLLOWING;
+        kept.seq = found ? static_cast<U8>(first + 1 + kept.seq) : static_cast<U8>(state.expected - 1);
+      }
+    }
+  }
+
+  const RFBondReorder::Frame* RFBondReorder ::
+    next()
+  {
+    Os::RawTime now;
+    const bool timed = (now.now() == Os::RawTime::OP_OK);
+
+    while (m_kept > 0) {
+      // A kept frame that fell behind, parity whose frames went on or a duplicate of one passed on,
+      // goes ahead of the one whose turn came
+      U32 due = RFBond::REORDER_SLOTS;
+      for (U32 i = 0; i < RFBond::REORDER_SLOTS; i++) {
+        const Frame& kept = m_frames[i];
+        if (!m_used[i] || kept.kind == Frame::UNPLACED) {
+          continue;
+        }
+        const U8 expected = m_sources[kept.source].expected;
+        if (kept.kind == Frame::NUMBERED && kept.seq == expected) {
+          due = i;
+        } else if (!atOrAfter(kept.seq, expected)) {
+          due = i;
+          break;
+        }
+      }
+      if (due < RFBond::REORDER_SLOTS) {
+        Frame& kept = m_frames[due];
+        Source& state = m_sources[kept.source];
+        if (kept.kind == Frame::NUMBERED && kept.seq == state.expected) {
+          state.expected++;
+        }
+        U32 heldUs = 0;
+        if (timed && now.getDiffUsec(kept.keptAt, heldUs) == Os::RawTime::OP_OK && heldUs > m_longestHoldUs) {
+          m_longestHoldUs = heldUs;
+        }
+        m_used[due] = false;
+        m_kept--;
+        return &kept;
+      }
+
+      // Otherwise give up the frame one neighbor waits for, or place frames whose radio went quiet,
+      // and look again
+      bool gaveUp = false;
+      for (U32 i = 0; i < RFBond::REORDER_SLOTS && !gaveUp; i++) {
+        if (!m_used[i]) {
+          continue;
+        }
+        Frame& kept = m_frames[i];
+        Source& state = m_sources[kept.source];
+        U32 heldUs = 0;
+        const bool expired = timed && now.getDiffUsec(kept.keptAt, heldUs) == Os::RawTime::OP_OK &&
+                             heldUs >= RFBond::REORDER_HOLD_US;
+        if (kept.kind == Frame::UNPLACED) {
+          if (expired) {
+            this->settle(kept.radio, kept.source, state.expected);
+            gaveUp = true;
+          }
+        } else if (expired || this->lost(state)) {
+          state.expected++;
+          m_gaps++;
+          gaveUp = true;
+        }
+      }
+      if (!gaveUp) {
+        return nullptr;
+      }
+    }
+    return nullptr;
+  }
+
+  bool RFBondReorder ::
+    keep(U8 radio, U8 pipe, U8 source, U8 seq, Frame::Kind kind, const U8* frame, U8 length)
+  {
+    U32 slot = 0;
+    while (slot < RFBond::REORDER_SLOTS && m_used[slot]) {
+      slot++;
+    }
+    if (slot == RFBond::REORDER_SLOTS) {
+      return false;
+    }
+    Frame& kept = m_frames[slot];
+    kept.radio = radio;
+    kept.pipe = pipe;
+    kept.source = source;
+    kept.seq = seq;
+    kept.kind = kind;
+    kept.length = length;
+    (void)kept.keptAt.now();
+    std::memcpy(kept.data, frame, length);
+    m_used[slot] = true;
+    m_kept++;
+    return true;
+  }
+
+  U32 RFBondReorder ::
+    takeLongestHold()
+  {
+    const U32 longest = m_longestHoldUs;
+    m_longestHoldUs = 0;
+    return longest;
+  }
+
+  U32 RFBondReorder ::
+    takeGaps()
+  {
+    const U32 gaps = m_gaps;
+    m_gaps = 0;
+    return gaps;
+  }
+
+  bool RFBondReorder ::
+    lost(const Source& source) const
+  {
+    // Each radio delivers in the order it was handed frames, one that went past the missing
+    // frame will not bring it any more. Radios that stopped carrying the neighbor's frames are
+    // left out, their last numbers are too old to compare; one that brought none yet may still
+    // be on its first while the neighbor is new.
+    for (U32 radio = 0; radio < m_radios; radio++) {
+      if (source.lastArrival[radio] == 0) {
+        if (source.arrivals <= RFBond::ACTIVE_FRAMES) {
+          return false;
+        }
+        continue;
+      }
+      const bool active = source.arrivals - source.lastArrival[radio] <= RFBond::ACTIVE_FRAMES;
+      if (active && !atOrAfter(source.last[radio], source.expected)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+}
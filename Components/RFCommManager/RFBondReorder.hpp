@@ -0,0 +1,185 @@
+// ======================================================================
+// \title  RFBondReorder.hpp
+// \author mustafa
+// \brief  hpp file for the receive order of frames bonded over several
+//         radios
+//
+// RFCommManager drives up to MAX_RADIOS NRF24Driver instances, each on
+// its own chip select and channel, and hands every frame to the radio
+// with the most room left in its TX ring, so each radio carries a share
+// of the frames as large as it can take. The peer listens with as many
+// radios on the same channels. Every radio keeps its own frames in
+// order, but one may run ahead of another.
+//
+// DATA frames carry a sequence number in their seq byte, counted per
+// neighbor they go to. FEC parity frames take numbers too but have no
+// room for them: they go on the radio of the fragment they follow and
+// the receiver counts on from it, or, with that fragment lost, finds
+// them a run of missing numbers before the radio's next frame. The
+// receiver passes the frames on in that order and keeps the ones that
+// came early. The frame it waits for is given up once every radio that
+// carried frames of the neighbor lately delivered a later one, since
+// none of them can still bring it, or once a frame after it was kept
+// REORDER_HOLD_US. Until ACTIVE_FRAMES came from the neighbor, a radio
+// that brought none of them yet counts as carrying them: a slow radio's
+// first frame lands well after the fast one's.
+//
+// Each radio's TX ring holds frames in proportion to the frames it took
+// the run period before, so a slow radio has little room and takes few.
+// The sequence number is a byte, so the sender keeps the radios within
+// half the sequence space of each other: a frame is only handed over
+// while it is less than SKEW_FRAMES after the oldest one still queued on
+// any radio. A slow radio then holds fewer frames, not fewer than it can
+// send, and the receiver keeps at most twice SKEW_FRAMES.
+// ======================================================================
+
+#ifndef Components_RFBondReorder_HPP
+#define Components_RFBondReorder_HPP
+
+#include <FpConfig.hpp>
+#include <Os/RawTime.hpp>
+
+#include "Components/NRF24Driver/NRF24Registers.hpp"
+#include "Components/RFCommManager/RFFragment.hpp"
+
+namespace Components {
+
+namespace RFBond {
+
+  //! Radios one RFCommManager bonds
+  static const U32 MAX_RADIOS = 4;
+
+  //! Radio hops, surveys and link adaptation go to, the first one attached
+  static const U32 PRIMARY_RADIO = 0;
+
+  //! No radio in particular, the one with the most room takes the frame
+  static const U32 ANY_RADIO = MAX_RADIOS;
+
+  //! Frames the TX ring of the radio that took the most frames last run period holds while bonded,
+  //! the others hold their share of it
+  static const U32 RADIO_DEPTH = 16;
+
+  //! Frames a bonded TX ring holds at the least, so a radio that took none lately gets tried again
+  static const U32 MIN_RADIO_DEPTH = 2;
+
+  //! Frames a bonded frame may be handed over after the oldest one still queued
+  static const U32 SKEW_FRAMES = 48;
+
+  //! Frames kept ahead of a missing one, over all neighbors
+  static const U32 REORDER_SLOTS = 2 * SKEW_FRAMES;
+
+  //! Longest a frame is kept waiting for the ones ahead of it
+  static const U32 REORDER_HOLD_US = 50000;
+
+  //! Frames of a neighbor a radio may go without delivering one and still count as carrying them
+  static const U32 ACTIVE_FRAMES = 64;
+
+}
+
+  class RFBondReorder {
+
+    public:
+
+      //! A frame kept until the frames sent before it came or were given up on
+      struct Frame {
+        //! How it is put in line
+        enum Kind : U8 {
+          NUMBERED,  //!< seq is its sequence number
+          FOLLOWING, //!< Goes on once seq went on
+          UNPLACED   //!< seq is the offset it was sent at, its radio's next frame tells where it goes
+        };
+        U8 radio;
+        U8 pipe;
+        U8 source;
+        U8 seq;
+        Kind kind;
+        U8 length;
+        Os::RawTime keptAt;
+        U8 data[NRF24::MAX_PAYLOAD_SIZE];
+      };
+
+      RFBondReorder();
+
+      //! Count one more radio in, the radios of a neighbor that has not sent ACTIVE_FRAMES yet are
+      //! taken to carry its frames before they delivered one
+      void addRadio();
+
+      //! Take a DATA frame a radio received from a neighbor
+      //! \return true if it goes on now, in order or too late to wait for; false if it was kept
+      bool admit(
+          U8 radio, //!< Radio it came in on
+          U8 pipe,
+          const RFFragment::Header& header, //!< Its header, seq is its sequence number
+          const U8* frame, //!< The whole frame, header included
+          U8 length
+      );
+
+      //! Take a frame that has no room for its sequence number, e.g. FEC parity. The sender gave it
+      //! the number offset + 1 after a DATA fragment of the same message and put it on that
+      //! fragment's radio right after it. Without the fragment the number is not known, the frame
+      //! waits for the radio's next one and takes its number from the missing ones before that.
+      //! \return true if it goes on now; false if it was kept
+      bool admitFollowing(
+          U8 radio, //!< Radio it came in on
+          U8 pipe,
+          const RFFragment::Header& header, //!< Its header
+          U8 index, //!< Index of the fragment it follows
+          U8 offset, //!< Frames between that fragment and it
+          const U8* frame, //!< The whole frame, header included
+          U8 length
+      );
+
+      //! Next kept frame that may go on, its turn came or the frames ahead of it were given up on
+      //! \return nullptr if none may go yet. The frame stays valid until the next call to admit,
+      //! admitFollowing or next.
+      const Frame* next();
+
+      //! Whether frames are kept, next has to be called again as time goes by
+      bool holding() const { return m_kept > 0; }
+
+      //! Longest a frame was kept since the last call, in microseconds
+      U32 takeLongestHold();
+
+      //! Frames given up on, or passed on out of order for want of room, since the last call
+      U32 takeGaps();
+
+    private:
+
+      struct Source {
+        bool synced; //!< A frame came from the neighbor, expected is set
+        U8 expected; //!< Sequence number to go on next
+        U32 arrivals; //!< Frames taken from the neighbor
+        U8 last[RFBond::MAX_RADIOS]; //!< Sequence number each radio delivered last
+        U32 lastArrival[RFBond::MAX_RADIOS]; //!< arrivals when it did, 0 never
+        U8 dataSeq[RFBond::MAX_RADIOS]; //!< Sequence number of the last DATA fragment each radio delivered
+        U8 dataMsgId[RFBond::MAX_RADIOS]; //!< Its message
+        U8 dataIndex[RFBond::MAX_RADIOS]; //!< Its index in the message
+        U8 following; //!< Frames seen to follow a fragment, the highest offset plus one
+        U8 unplaced; //!< Bit i set while radio i has UNPLACED frames kept
+      };
+
+      //! Put a frame with a known sequence number in line
+      bool place(U8 radio, U8 pipe, U8 source, U8 seq, const U8* frame, U8 length);
+
+      //! Place the UNPLACED frames a radio brought before the frame numbered seq
+      void settle(U8 radio, U8 source, U8 seq);
+
+      //! Keep a frame, false without room
+      bool keep(U8 radio, U8 pipe, U8 source, U8 seq, Frame::Kind kind, const U8* frame, U8 length);
+
+      //! Whether no radio carrying a neighbor's frames can still bring the one it waits for
+      bool lost(const Source& source) const;
+
+      Source m_sources[NRF24::MAX_NODES];
+      Frame m_frames[RFBond::REORDER_SLOTS];
+      bool m_used[RFBond::REORDER_SLOTS];
+      U32 m_radios;
+      U32 m_kept;
+      U32 m_longestHoldUs;
+      U32 m_gaps;
+
+  };
+
+}
+
+#endif
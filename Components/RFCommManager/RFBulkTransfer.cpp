@@ -0,0 +1,471 @@
+// ======================================================================
+// \title  RFBulkTransfer.cpp
+// \author mustafa
+// \brief  cpp file for the bulk file transfer source, sink and chunk map
+// ======================================================================
+
+#include "Components/RFCommManager/RFBulkTransfer.hpp"
+
+#include <Fw/Types/Assert.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Components {
+
+  namespace {
+
+    static_assert(RFBulk::MAX_CHUNKS % 32 == 0, "The bitmap is whole words");
+    static_assert(RFBulk::CHUNK_SIZE + RFBulk::DATA_HEADER_SIZE <= RFFragment::MAX_MESSAGE_SIZE, "A chunk is one message");
+    // fillBulk builds offers and chunks in the storage of a queued RFSession::TxMessage
+    static_assert(RFBulk::CHUNK_SIZE + RFBulk::DATA_HEADER_SIZE <= FW_COM_BUFFER_MAX_SIZE, "A chunk fits a TX message");
+    static_assert(RFBulk::OFFER_HEADER_SIZE + RFBulk::MAX_PATH_SIZE <= FW_COM_BUFFER_MAX_SIZE, "An offer fits a TX message");
+
+    //! FNV-1a over a byte range, continuing from hash
+    U32 fnv1a(U32 hash, const void* data, FwSizeType size) {
+      const U8* bytes = static_cast<const U8*>(data);
+      for (FwSizeType i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619U;
+      }
+      return hash;
+    }
+
+    const U32 FNV_OFFSET_BASIS = 2166136261U;
+
+    //! Count the set bits of a word
+    U32 popCount(U32 word) {
+      U32 count = 0;
+      while (word != 0) {
+        word &= word - 1;
+        count++;
+      }
+      return count;
+    }
+
+    //! pwrite the whole range, retrying short writes
+    I32 writeAll(I32 fd, const U8* data, U32 length, off_t offset) {
+      while (length > 0) {
+        const ssize_t written = ::pwrite(fd, data, length, offset);
+        if (written < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return errno;
+        }
+        data += written;
+        length -= static_cast<U32>(written);
+        offset += written;
+      }
+      return 0;
+    }
+
+  }
+
+  // ----------------------------------------------------------------------
+  // RFBulk
+  // ----------------------------------------------------------------------
+
+  bool RFBulk ::
+    confinedPath(const U8* path, U32 length)
+  {
+    if (length == 0 || path[0] == '/') {
+      return false;
+    }
+    U32 start = 0;
+    for (U32 i = 0; i <= length; i++) {
+      if (i < length && path[i] == '\0') {
+        return false;
+      }
+      if (i == length || path[i] == '/') {
+        if (i - start == 2 && path[start] == '.' && path[start + 1] == '.') {
+          return false;
+        }
+        start = i + 1;
+      }
+    }
+    return true;
+  }
+
+  // ----------------------------------------------------------------------
+  // RFBulkChunkMap
+  // ----------------------------------------------------------------------
+
+  RFBulkChunkMap ::
+    RFBulkChunkMap() :
+      m_chunks(0),
+      m_held(0)
+  {
+
+  }
+
+  void RFBulkChunkMap ::
+    reset(U32 chunks)
+  {
+    FW_ASSERT(chunks <= RFBulk::MAX_CHUNKS, chunks);
+    std::memset(m_words, 0, this->rawSize());
+    m_chunks = chunks;
+    m_held = 0;
+  }
+
+  bool RFBulkChunkMap ::
+    set(U32 chunk)
+  {
+    FW_ASSERT(chunk < m_chunks, chunk, m_chunks);
+    const U32 bit = 1U << (chunk % 32);
+    if ((m_words[chunk / 32] & bit) != 0) {
+      return false;
+    }
+    m_words[chunk / 32] |= bit;
+    m_held++;
+    return true;
+  }
+
+  bool RFBulkChunkMap ::
+    test(U32 chunk) const
+  {
+    return chunk < m_chunks && (m_words[chunk / 32] & (1U << (chunk % 32))) != 0;
+  }
+
+  U32 RFBulkChunkMap ::
+    firstMissing(U32 from) const
+  {
+    // Whole words at a time, a file mostly arrives in runs
+    U32 chunk = from;
+    while (chunk < m_chunks) {
+      const U32 word = m_words[chunk / 32] | ((1U << (chunk % 32)) - 1);
+      if (word != 0xFFFFFFFF) {
+        U32 bit = chunk % 32;
+        while ((word & (1U << bit)) != 0) {
+          bit++;
+        }
+        chunk = chunk / 32 * 32 + bit;
+        return (chunk < m_chunks) ? chunk : m_chunks;
+      }
+      chunk = (chunk / 32 + 1) * 32;
+    }
+    return m_chunks;
+  }
+
+  U32 RFBulkChunkMap ::
+    firstHeld(U32 from) const
+  {
+    U32 chunk = from;
+    while (chunk < m_chunks) {
+      const U32 word = m_words[chunk / 32] & ~((1U << (chunk % 32)) - 1);
+      if (word != 0) {
+        U32 bit = chunk % 32;
+        while ((word & (1U << bit)) == 0) {
+          bit++;
+        }
+        chunk = chunk / 32 * 32 + bit;
+        return (chunk < m_chunks) ? chunk : m_chunks;
+      }
+      chunk = (chunk / 32 + 1) * 32;
+    }
+    return m_chunks;
+  }
+
+  void RFBulkChunkMap ::
+    copyOut(U32 from, U8* bitmap, U32 bytes) const
+  {
+    std::memset(bitmap, 0, bytes);
+    for (U32 i = 0; i < bytes * 8; i++) {
+      if (this->test(from + i)) {
+        bitmap[i / 8] = static_cast<U8>(bitmap[i / 8] | (1U << (i % 8)));
+      }
+    }
+  }
+
+  void RFBulkChunkMap ::
+    copyIn(U32 from, const U8* bitmap, U32 bytes)
+  {
+    // from comes off the air, past the end it names nothing
+    const U32 count = (from >= m_chunks) ? 0 : (m_chunks - from < bytes * 8) ? m_chunks - from : bytes * 8;
+    for (U32 i = 0; i < count; i++) {
+      if ((bitmap[i / 8] & (1U << (i % 8))) != 0) {
+        (void)this->set(from + i);
+      }
+    }
+  }
+
+  U32 RFBulkChunkMap ::
+    bytesHeld(U32 size) const
+  {
+    if (m_held == 0) {
+      return 0;
+    }
+    // Every chunk is full but the last one
+    const U32 last = m_chunks - 1;
+    const U32 full = this->test(last) ? m_held - 1 : m_held;
+    const U32 tail = this->test(last) ? RFBulk::chunkLength(size, last) : 0;
+    return full * RFBulk::CHUNK_SIZE + tail;
+  }
+
+  void RFBulkChunkMap ::
+    recount()
+  {
+    // Bits past the last chunk would count as chunks held
+    const U32 words = (m_chunks + 31) / 32;
+    if (m_chunks % 32 != 0) {
+      m_words[words - 1] &= (1U << (m_chunks % 32)) - 1;
+    }
+    m_held = 0;
+    for (U32 i = 0; i < words; i++) {
+      m_held += popCount(m_words[i]);
+    }
+  }
+
+  // ----------------------------------------------------------------------
+  // RFBulkSource
+  // ----------------------------------------------------------------------
+
+  RFBulkSource ::
+    RFBulkSource() :
+      m_fd(-1),
+      m_map(nullptr),
+      m_size(0),
+      m_fileId(0),
+      m_windowOffset(0),
+      m_windowLength(0)
+  {
+
+  }
+
+  RFBulkSource ::
+    ~RFBulkSource()
+  {
+    this->close();
+  }
+
+  I32 RFBulkSource ::
+    open(const char* path)
+  {
+    FW_ASSERT(m_fd < 0);
+    const I32 fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+      return errno;
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+      const I32 error = errno;
+      (void)::close(fd);
+      return error;
+    }
+    if (!S_ISREG(status.st_mode) || static_cast<U64>(status.st_size) > RFBulk::MAX_FILE_SIZE) {
+      (void)::close(fd);
+      return EFBIG;
+    }
+
+    m_fd = fd;
+    m_size = static_cast<U32>(status.st_size);
+    m_fileId = fnv1a(FNV_OFFSET_BASIS, path, std::strlen(path));
+    m_fileId = fnv1a(m_fileId, &status.st_size, sizeof(status.st_size));
+    m_fileId = fnv1a(m_fileId, &status.st_mtime, sizeof(status.st_mtime));
+    m_windowOffset = 0;
+    m_windowLength = 0;
+
+    // Chunks are copied straight out of the page cache. Where the file cannot be mapped,
+    // reads of a whole window keep the syscalls down to one per READ_WINDOW bytes.
+    if (m_size > 0) {
+      void* const map = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED) {
+        (void)::madvise(map, m_size, MADV_SEQUENTIAL);
+        m_map = static_cast<const U8*>(map);
+      } else {
+        (void)::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+      }
+    }
+    return 0;
+  }
+
+  void RFBulkSource ::
+    close()
+  {
+    if (m_map != nullptr) {
+      (void)::munmap(const_cast<U8*>(m_map), m_size);
+      m_map = nullptr;
+    }
+    if (m_fd >= 0) {
+      (void)::close(m_fd);
+      m_fd = -1;
+    }
+  }
+
+  bool RFBulkSource ::
+    read(U32 offset, U8* data, U32 length)
+  {
+    FW_ASSERT(m_fd >= 0);
+    FW_ASSERT(length <= m_size && offset <= m_size - length, offset, length, m_size);
+    if (m_map != nullptr) {
+      std::memcpy(data, m_map + offset, length);
+      return true;
+    }
+
+    if (offset < m_windowOffset || offset + length > m_windowOffset + m_windowLength) {
+      m_windowOffset = offset;
+      m_windowLength = 0;
+      const U32 wanted = (m_size - offset < RFBulk::READ_WINDOW) ? m_size - offset : RFBulk::READ_WINDOW;
+      while (m_windowLength < wanted) {
+        const ssize_t got = ::pread(m_fd, m_window + m_windowLength, wanted - m_windowLength,
+                                    static_cast<off_t>(offset + m_windowLength));
+        if (got < 0 && errno == EINTR) {
+          continue;
+        }
+        if (got <= 0) {
+          // Shortened under us, or an I/O error
+          m_windowLength = 0;
+          return false;
+        }
+        m_windowLength += static_cast<U32>(got);
+      }
+    }
+    std::memcpy(data, m_window + (offset - m_windowOffset), length);
+    return true;
+  }
+
+  // ----------------------------------------------------------------------
+  // RFBulkSink
+  // ----------------------------------------------------------------------
+
+  RFBulkSink ::
+    RFBulkSink() :
+      m_fd(-1),
+      m_recordFd(-1),
+      m_fileId(0),
+      m_size(0),
+      m_dirty(false)
+  {
+    m_directory[0] = '\0';
+    m_recordPath[0] = '\0';
+  }
+
+  RFBulkSink ::
+    ~RFBulkSink()
+  {
+    this->close();
+  }
+
+  void RFBulkSink ::
+    setDirectory(const char* directory)
+  {
+    FW_ASSERT(m_fd < 0);
+    const int written = std::snprintf(m_directory, sizeof(m_directory), "%s", directory);
+    FW_ASSERT(written > 0 && static_cast<U32>(written) < sizeof(m_directory), written);
+  }
+
+  I32 RFBulkSink ::
+    open(const char* path, U32 fileId, U32 size)
+  {
+    FW_ASSERT(m_fd < 0);
+    FW_ASSERT(RFBulk::confinedPath(reinterpret_cast<const U8*>(path), static_cast<U32>(std::strlen(path))));
+    if (m_directory[0] == '\0') {
+      return EACCES;
+    }
+    if (size > RFBulk::MAX_FILE_SIZE) {
+      return EFBIG;
+    }
+    // The destination is the record's path without its suffix
+    const int written = std::snprintf(m_recordPath, sizeof(m_recordPath), "%s/%s.bulk", m_directory, path);
+    FW_ASSERT(written > 5 && static_cast<U32>(written) < sizeof(m_recordPath), written);
+    const U32 destinationLength = static_cast<U32>(written) - 5;
+    char destination[sizeof(m_recordPath)];
+    std::memcpy(destination, m_recordPath, destinationLength);
+    destination[destinationLength] = '\0';
+
+    m_recordFd = ::open(m_recordPath, O_RDWR | O_CREAT, 0644);
+    if (m_recordFd < 0) {
+      return errno;
+    }
+    m_fileId = fileId;
+    m_size = size;
+    m_map.reset(RFBulk::chunkCount(size));
+
+    // Only a record of this very file says which chunks the destination already holds
+    U32 header[RFBulk::RECORD_HEADER_SIZE / 4];
+    const ssize_t got = ::pread(m_recordFd, header, sizeof(header), 0);
+    const bool resume = (got == static_cast<ssize_t>(sizeof(header)) && header[0] == RFBulk::RECORD_MAGIC &&
+                         header[1] == fileId && header[2] == size && header[3] == RFBulk::CHUNK_SIZE &&
+                         ::pread(m_recordFd, m_map.raw(), m_map.rawSize(), sizeof(header)) ==
+                             static_cast<ssize_t>(m_map.rawSize()));
+    if (resume) {
+      m_map.recount();
+    } else {
+      m_map.reset(m_map.chunks());
+    }
+
+    m_fd = ::open(destination, resume ? (O_WRONLY | O_CREAT) : (O_WRONLY | O_CREAT | O_TRUNC), 0644);
+    if (m_fd < 0) {
+      const I32 error = errno;
+      this->close();
+      return error;
+    }
+    if (!resume) {
+      header[0] = RFBulk::RECORD_MAGIC;
+      header[1] = fileId;
+      header[2] = size;
+      header[3] = RFBulk::CHUNK_SIZE;
+      const I32 error = writeAll(m_recordFd, reinterpret_cast<const U8*>(header), sizeof(header), 0);
+      if (error != 0) {
+        this->close();
+        return error;
+      }
+      m_dirty = true;
+      this->save();
+    }
+    return 0;
+  }
+
+  I32 RFBulkSink ::
+    write(U32 chunk, const U8* data, U32 length)
+  {
+    FW_ASSERT(m_fd >= 0);
+    FW_ASSERT(length == RFBulk::chunkLength(m_size, chunk), chunk, length);
+    const I32 error = writeAll(m_fd, data, length, static_cast<off_t>(static_cast<U64>(chunk) * RFBulk::CHUNK_SIZE));
+    if (error == 0 && m_map.set(chunk)) {
+      m_dirty = true;
+    }
+    return error;
+  }
+
+  void RFBulkSink ::
+    save()
+  {
+    // The chunks reach the disk ahead of the bitmap, so a record never claims one the file lost.
+    // A lost record write only costs chunks sent again.
+    if (m_dirty && m_recordFd >= 0) {
+      if (m_fd >= 0) {
+        (void)::fdatasync(m_fd);
+      }
+      (void)writeAll(m_recordFd, m_map.raw(), m_map.rawSize(), RFBulk::RECORD_HEADER_SIZE);
+      m_dirty = false;
+    }
+  }
+
+  void RFBulkSink ::
+    finish()
+  {
+    this->close();
+    (void)::unlink(m_recordPath);
+  }
+
+  void RFBulkSink ::
+    close()
+  {
+    // Saved while the destination is still open, its chunks are synced ahead of the bitmap
+    this->save();
+    if (m_fd >= 0) {
+      (void)::close(m_fd);
+      m_fd = -1;
+    }
+    if (m_recordFd >= 0) {
+      (void)::close(m_recordFd);
+      m_recordFd = -1;
+    }
+  }
+
+}
@@ -0,0 +1,253 @@
+// ======================================================================
+// \title  RFBulkTransfer.hpp
+// \author mustafa
+// \brief  hpp file for the bulk file transfer source, sink and chunk map
+//
+// RFCommManager streams a file to the peer's manager as chunks on the FILE
+// stream, each one a message of CHUNK_FRAGMENTS full fragments. The sender
+// first offers the transfer:
+//
+//   | OFFER_MAGIC (U8) | transfer (U8) | fileId (U32) | size (U32) | length (U8) | destination ... |
+//
+// then sends the chunks the receiver does not hold, in order:
+//
+//   | DATA_MAGIC (U8) | transfer (U8) | chunk (U32) | data ... |
+//
+// Both share the FILE pipe with F' frames (0xDE...). fileId is taken from
+// the source path, size and modification time. The receiver writes each
+// chunk at its offset and keeps a bitmap of the chunks it holds next to
+// the destination, in a resume record:
+//
+//   | RECORD_MAGIC (U32) | fileId (U32) | size (U32) | chunk size (U32) | bitmap ... |
+//
+// A later offer of the same file to the same destination takes the record
+// up, so an interrupted transfer resumes where it stopped. The receiver
+// reports the chunks it holds with BULK_ACK frames (see RFFragment.hpp),
+// sweeping its whole bitmap after each offer. Integers are big-endian on
+// the air and in native order in the record, which never leaves the host.
+// ======================================================================
+
+#ifndef Components_RFBulkTransfer_HPP
+#define Components_RFBulkTransfer_HPP
+
+#include <FpConfig.hpp>
+
+#include "Components/RFCommManager/RFFragment.hpp"
+
+namespace Components {
+
+namespace RFBulk {
+
+  //! First byte of offers
+  static const U8 OFFER_MAGIC = 0xB1;
+
+  //! First byte of chunks
+  static const U8 DATA_MAGIC = 0xB2;
+
+  //! First word of resume records
+  static const U32 RECORD_MAGIC = 0x5246424B;
+
+  //! Bytes of offer ahead of the destination
+  static const U32 OFFER_HEADER_SIZE = 11;
+
+  //! Bytes of chunk header ahead of the data
+  static const U32 DATA_HEADER_SIZE = 6;
+
+  //! Bytes of resume record ahead of the bitmap
+  static const U32 RECORD_HEADER_SIZE = 16;
+
+  //! Fragments of a full chunk, header included
+  static const U32 CHUNK_FRAGMENTS = 16;
+
+  //! File bytes a chunk carries, the last one of a file possibly fewer
+  static const U32 CHUNK_SIZE = CHUNK_FRAGMENTS * RFFragment::FRAGMENT_DATA_SIZE - DATA_HEADER_SIZE;
+
+  //! Most chunks of a transfer
+  static const U32 MAX_CHUNKS = 131072;
+
+  //! Largest file a transfer takes
+  static const U32 MAX_FILE_SIZE = MAX_CHUNKS * CHUNK_SIZE;
+
+  //! Longest destination path
+  static const U32 MAX_PATH_SIZE = 100;
+
+  //! Longest receive directory
+  static const U32 MAX_DIRECTORY_SIZE = 100;
+
+  //! Bytes a source not mapped into memory reads at once
+  static const U32 READ_WINDOW = 32768;
+
+  //! BULK_ACK base telling the sender the destination could not be opened
+  static const U32 REFUSED = 0xFFFFFFFF;
+
+  //! Chunks of a file of the given size
+  inline U32 chunkCount(U32 size) {
+    return static_cast<U32>((static_cast<U64>(size) + CHUNK_SIZE - 1) / CHUNK_SIZE);
+  }
+
+  //! File bytes of a chunk
+  inline U32 chunkLength(U32 size, U32 chunk) {
+    const U64 offset = static_cast<U64>(chunk) * CHUNK_SIZE;
+    return (size - offset < CHUNK_SIZE) ? static_cast<U32>(size - offset) : CHUNK_SIZE;
+  }
+
+  inline void put32(U8* out, U32 value) {
+    out[0] = static_cast<U8>(value >> 24);
+    out[1] = static_cast<U8>(value >> 16);
+    out[2] = static_cast<U8>(value >> 8);
+    out[3] = static_cast<U8>(value);
+  }
+
+  inline U32 get32(const U8* data) {
+    return (static_cast<U32>(data[0]) << 24) | (static_cast<U32>(data[1]) << 16) |
+           (static_cast<U32>(data[2]) << 8) | static_cast<U32>(data[3]);
+  }
+
+  //! Whether an offered destination stays inside the receive directory: relative, without a ..
+  //! component and without NUL bytes
+  bool confinedPath(const U8* path, U32 length);
+
+}
+
+  //! One bit per chunk of a transfer, set once the receiver holds the chunk
+  class RFBulkChunkMap {
+
+    public:
+
+      RFBulkChunkMap();
+
+      //! Clear every chunk
+      void reset(U32 chunks);
+
+      //! Set a chunk
+      //! \return false if it was already set
+      bool set(U32 chunk);
+
+      bool test(U32 chunk) const;
+
+      //! First chunk at or after from that is not set, chunks() if none
+      U32 firstMissing(U32 from) const;
+
+      //! First chunk at or after from that is set, chunks() if none
+      U32 firstHeld(U32 from) const;
+
+      //! Write the bits of the chunks from from on, LSB of byte 0 first, past the end as 0
+      void copyOut(U32 from, U8* bitmap, U32 bytes) const;
+
+      //! Set the chunks whose bits are set, as copyOut wrote them
+      void copyIn(U32 from, const U8* bitmap, U32 bytes);
+
+      //! File bytes the chunks set hold, of a file of the given size
+      U32 bytesHeld(U32 size) const;
+
+      U32 chunks() const { return m_chunks; }
+      U32 held() const { return m_held; }
+      bool complete() const { return m_held == m_chunks; }
+
+      //! The bitmap as stored in a resume record
+      U8* raw() { return reinterpret_cast<U8*>(m_words); }
+      const U8* raw() const { return reinterpret_cast<const U8*>(m_words); }
+      U32 rawSize() const { return (m_chunks + 31) / 32 * 4; }
+
+      //! Count the chunks set after raw() was written to
+      void recount();
+
+    private:
+
+      U32 m_words[RFBulk::MAX_CHUNKS / 32];
+      U32 m_chunks;
+      U32 m_held;
+
+  };
+
+  //! File a transfer sends, mapped into memory or else read a window at a time
+  class RFBulkSource {
+
+    public:
+
+      RFBulkSource();
+      ~RFBulkSource();
+
+      //! Open a file and map it
+      //! \return 0, or the errno of what failed
+      I32 open(const char* path);
+
+      void close();
+
+      //! Copy file bytes out
+      //! \return false if they could not be read
+      bool read(U32 offset, U8* data, U32 length);
+
+      bool isOpen() const { return m_fd >= 0; }
+      bool mapped() const { return m_map != nullptr; }
+      U32 size() const { return m_size; }
+
+      //! Identity of the file's contents, from its path, size and modification time
+      U32 fileId() const { return m_fileId; }
+
+    private:
+
+      I32 m_fd;
+      const U8* m_map;
+      U32 m_size;
+      U32 m_fileId;
+      U8 m_window[RFBulk::READ_WINDOW]; //!< Read ahead when the file could not be mapped
+      U32 m_windowOffset;
+      U32 m_windowLength;
+
+  };
+
+  //! File a transfer lands in, and its resume record
+  class RFBulkSink {
+
+    public:
+
+      RFBulkSink();
+      ~RFBulkSink();
+
+      //! Set the directory destinations land in, before the first open
+      void setDirectory(const char* directory);
+
+      //! Open the destination and its record in the receive directory. A record of the same file
+      //! is taken up, anything else starts the destination over.
+      //! \return 0, or the errno of what failed; EACCES without a receive directory
+      I32 open(
+          const char* path, //!< Destination relative to the receive directory, see RFBulk::confinedPath
+          U32 fileId,
+          U32 size
+      );
+
+      //! Write a chunk at its offset
+      //! \return 0, or the errno of what failed
+      I32 write(U32 chunk, const U8* data, U32 length);
+
+      //! Write the bitmap to the record if chunks came in since it was last written
+      void save();
+
+      //! Close the destination and remove the record, every chunk is in
+      void finish();
+
+      //! Close the destination and keep the record for a later offer
+      void close();
+
+      bool isOpen() const { return m_fd >= 0; }
+      U32 fileId() const { return m_fileId; }
+      U32 size() const { return m_size; }
+      const RFBulkChunkMap& map() const { return m_map; }
+
+    private:
+
+      I32 m_fd;
+      I32 m_recordFd;
+      char m_directory[RFBulk::MAX_DIRECTORY_SIZE + 1]; //!< Empty until setDirectory
+      char m_recordPath[RFBulk::MAX_DIRECTORY_SIZE + 1 + RFBulk::MAX_PATH_SIZE + 6];
+      U32 m_fileId;
+      U32 m_size;
+      bool m_dirty;
+      RFBulkChunkMap m_map;
+
+  };
+
+}
+
+#endif
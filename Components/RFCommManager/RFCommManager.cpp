@@ -6,17 +6,234 @@
 
 #include "Components/RFCommManager/RFCommManager.hpp"
 
+#include <Fw/Com/ComPacket.hpp>
+#include <Fw/Types/Assert.hpp>
+#include <Fw/Types/Serializable.hpp>
+#include <Utils/Hash/Hash.hpp>
+
+#include <cstdio>
+#include <cstring>
+
 namespace Components {
 
+  namespace {
+
+    //! Fragments per turn of each RFStream until SET_STREAM_WEIGHT changes them. Commands and
+    //! their responses cut in front of bulk file data.
+    const U8 DEFAULT_STREAM_WEIGHTS[RFStream::NUM_CONSTANTS] = {
+      8, // COMMAND
+      4, // EVENT
+      4, // TELEMETRY
+      1, // FILE
+      2  // OTHER
+    };
+
+    //! Token bucket share of the link capacity of each RFStream until SET_STREAM_SHAPING changes
+    //! it, 0 unshaped. Telemetry left alone would take most of a slow link from file downlink.
+    const U8 DEFAULT_STREAM_SHARES[RFStream::NUM_CONSTANTS] = {
+      0,  // COMMAND
+      0,  // EVENT
+      50, // TELEMETRY
+      0,  // FILE
+      0   // OTHER
+    };
+
+    //! Fragments each token bucket holds until SET_STREAM_SHAPING changes it
+    const U8 DEFAULT_STREAM_BURST = 8;
+
+    //! Deadline of each RFStream until SET_STREAM_DEADLINE changes it, 0 never. Telemetry goes out
+    //! again every run tick, a value two ticks old is only in the way of the current one.
+    const U32 DEFAULT_STREAM_DEADLINES_MS[RFStream::NUM_CONSTANTS] = {
+      0,    // COMMAND
+      0,    // EVENT
+      2000, // TELEMETRY
+      0,    // FILE
+      0     // OTHER
+    };
+
+    //! Tokens a fragment costs, buckets count in millionths of a fragment so a fill over
+    //! microseconds is exact
+    const U64 FRAGMENT_TOKENS = 1000000;
+
+    //! Pipe a stream goes out on
+    U8 streamPipe(U32 stream) {
+      return static_cast<U8>(RFCommManager::CONTROL_PIPE + 1 + stream);
+    }
+
+    //! Fragments of the block of a message starting at first
+    U32 blockFragments(U32 count, U32 first) {
+      return (count - first < RFFec::BLOCK_FRAGMENTS) ? (count - first) : RFFec::BLOCK_FRAGMENTS;
+    }
+
+    //! Bit i set when fragment first + i is not in a seen bitmap
+    U32 lostFragments(const U32* seen, U32 first, U32 fragments) {
+      U32 lost = 0;
+      for (U32 i = 0; i < fragments; i++) {
+        const U32 index = first + i;
+        if ((seen[index / 32U] & (1U << (index % 32U))) == 0) {
+          lost |= 1U << i;
+        }
+      }
+      return lost;
+    }
+
+  }
+
   // ----------------------------------------------------------------------
   // Component construction and destruction
   // ----------------------------------------------------------------------
 
   RFCommManager ::
     RFCommManager(const char* const compName) :
-      RFCommManagerComponentBase(compName)
+      RFCommManagerComponentBase(compName),
+      m_framesFree(FRAME_POOL_SIZE),
+      m_radioCount(0),
+      m_claimRadio(0),
+      m_nextRadio(0),
+      m_framesHanded(0),
+      m_bondFull(false),
+      m_reorderWait(false),
+      m_txCount(0),
+      m_tokensAtValid(false),
+      m_tokenWait(false),
+      m_linkCapacity(0),
+      m_linkPeak(0),
+      m_linkTaken(0),
+      m_linkStartValid(false),
+      m_linkIdle(false),
+      m_linkThrottled(false),
+      m_heldStream(RFStream::OTHER),
+      m_comStarted(false),
+      m_reassemblyTimeout(DEFAULT_REASSEMBLY_TIMEOUT),
+      m_fecRows(0),
+      m_fecPending(0),
+      m_fecNext(0),
+      m_fecPipe(CONTROL_PIPE),
+      m_fecNode(0),
+      m_fecRadio(0),
+      m_fecRecovered(0),
+      m_fecUnrecoverable(0),
+      m_arqEnabled(false),
+      m_arqWindow(DEFAULT_ARQ_WINDOW),
+      m_acksPending(0),
+      m_arqWait(false),
+      m_arqWaitUs(0),
+      m_rttHistogram(ARQ_RTT_FIRST_EDGE_US),
+      m_arqBytesAcked(0),
+      m_arqTransmissions(0),
+      m_arqRetransmissions(0),
+      m_reportStartValid(false),
+      m_surveyPending(false),
+      m_surveyAge(0),
+      m_hopActive(false),
+      m_hopLeader(false),
+      m_hopAcked(false),
+      m_hopId(0),
+      m_peerHopId(0),
+      m_peerHopIdValid(false),
+      m_hopChannel(0),
+      m_hopCountdown(0),
+      m_channel(0),
+      m_hops(0),
+      m_autoHopPercent(0),
+      m_hopHoldoff(0),
+      m_hopRate(NRF24DataRate::RATE_1MBPS),
+      m_hopPower(0),
+      m_rate(NRF24DataRate::RATE_1MBPS),
+      m_power(0),
+      m_settingsPending(false),
+      m_adaptEnabled(false),
+      m_adaptSent(0),
+      m_adaptRetries(0),
+      m_adaptFailures(0),
+      m_adaptArqTransmissions(0),
+      m_adaptArqRetransmissions(0),
+      m_cleanPeriods(0),
+      m_stepUpPeriods(ADAPT_STEP_UP_PERIODS),
+      m_probedUp(false),
+      m_probation(0),
+      m_fallbackChannel(0),
+      m_fallbackRate(NRF24DataRate::RATE_1MBPS),
+      m_fallbackPower(0),
+      m_heard(false),
+      m_confirmed(false),
+      m_tlmRejected(0),
+      m_tlmKeyframeInterval(DEFAULT_TLM_KEYFRAME_INTERVAL),
+      m_tlmSinceKeyframe(0),
+      m_tlmAckWait(0),
+      m_tlmChannelsSent(0),
+      m_tlmMode(RFTelemetryMode::DELTA),
+      m_tlmFramesSent(0),
+      m_tlmUpdatesDropped(0),
+      m_bulkSending(false),
+      m_bulkTransfer(0),
+      m_bulkOfferDue(false),
+      m_bulkOffered(false),
+      m_bulkCursor(0),
+      m_bulkRewind(0),
+      m_bulkAckAge(0),
+      m_bulkRxState(BULK_IDLE),
+      m_bulkRxTransfer(0),
+      m_bulkLastChunk(0),
+      m_bulkSweep(0),
+      m_bulkSinceAck(0),
+      m_bulkIdle(0),
+      m_bulkBytes(0),
+      m_bulkRate(0.0f),
+      m_bulkProgress(0),
+      m_bulkReportAtValid(false),
+      m_node(0),
+      m_destination(0),
+      m_hopLimit(RFRoute::DEFAULT_HOP_LIMIT),
+      m_peersUp(0),
+      m_messagesForwarded(0),
+      m_forwardDrops(0),
+      m_bondGaps(0),
+      m_messagesSent(0),
+      m_fragmentsSent(0),
+      m_txDropped(0),
+      m_messagesReceived(0),
+      m_reassemblyTimeouts(0),
+      m_rxDropped(0)
   {
-
+    for (U32 i = 0; i < FRAME_POOL_SIZE; i++) {
+      m_frameBusy[i] = false;
+    }
+    for (U32 i = 0; i < RFBond::MAX_RADIOS; i++) {
+      m_radios[i].txRing = nullptr;
+      m_radios[i].rxRing = nullptr;
+      m_radios[i].handed = 0;
+      m_radios[i].frames = 0;
+      m_radios[i].depth = RFBond::RADIO_DEPTH;
+      for (U32 j = 0; j < RFBond::RADIO_DEPTH; j++) {
+        m_radios[i].sent[j] = 0;
+      }
+    }
+    for (U32 i = 0; i < RFStream::NUM_CONSTANTS; i++) {
+      m_txStreams[i].count = 0;
+      m_txStreams[i].weight = DEFAULT_STREAM_WEIGHTS[i];
+      m_txStreams[i].latencyUs = 0;
+      m_txStreams[i].share = DEFAULT_STREAM_SHARES[i];
+      m_txStreams[i].burst = DEFAULT_STREAM_BURST;
+      m_txStreams[i].tokens = DEFAULT_STREAM_BURST * FRAGMENT_TOKENS;
+      m_txStreams[i].deadlineMs = DEFAULT_STREAM_DEADLINES_MS[i];
+      m_txStreams[i].queueDelayUs = 0;
+      m_txStreams[i].expired = 0;
+    }
+    for (U32 i = 0; i < REASSEMBLY_SLOTS; i++) {
+      m_slots[i].active = false;
+    }
+    for (U32 i = 0; i < FEC_PARITY_SLOTS; i++) {
+      m_fecParity[i].active = false;
+    }
+    for (U32 node = 0; node < RFRoute::MAX_NODES; node++) {
+      m_peers.session(static_cast<U8>(node)).rtoUs = ARQ_INITIAL_RTO_US;
+    }
+    m_bulkSourcePath[0] = '\0';
+    m_bulkDestination[0] = '\0';
+    m_bulkRxPath[0] = '\0';
+    m_framing.setup(*this);
+    m_tlmPacket.resetPktSer();
   }
 
   RFCommManager ::
@@ -25,18 +242,3237 @@ namespace Components {
 
   }
 
+  void RFCommManager ::
+    attachRings(NRF24FrameRing& txRing, NRF24FrameRing& rxRing)
+  {
+    static_assert(RFBond::MAX_RADIOS == NUM_TXRINGDOORBELL_OUTPUT_PORTS, "One ring port per bonded radio");
+    FW_ASSERT(m_radioCount < RFBond::MAX_RADIOS, m_radioCount);
+    m_radios[m_radioCount].txRing = &txRing;
+    m_radios[m_radioCount].rxRing = &rxRing;
+    m_radioCount++;
+    m_reorder.addRadio();
+  }
+
+  void RFCommManager ::
+    configureBulkReceive(const char* directory)
+  {
+    m_bulkSink.setDirectory(directory);
+  }
+
+
+  // ----------------------------------------------------------------------
+  // Handler implementations for user-defined typed input ports
+  // ----------------------------------------------------------------------
+
+  void RFCommManager ::
+    comIn_handler(
+        FwIndexType portNum,
+        Fw::ComBuffer& data,
+        U32 context
+    )
+  {
+    const RFStream stream = classify(data.getBuffAddr(), data.getBuffLength());
+    RFSession::TxMessage* message = this->pushTx(stream, data.getBuffLength());
+    if (message == nullptr) {
+      return;
+    }
+    // The queued copy of the com buffer only lives for this call, keep the bytes
+    std::memcpy(message->storage, data.getBuffAddr(), data.getBuffLength());
+    message->data = message->storage;
+    this->pumpTx();
+  }
+
+  Drv::SendStatus RFCommManager ::
+    comDataIn_handler(
+        FwIndexType portNum,
+        Fw::Buffer& sendBuffer
+    )
+  {
+    // Svc.ComQueue sends nothing more until comStatus answers, so this never piles up
+    this->comDataQueued_internalInterfaceInvoke(sendBuffer);
+    return Drv::SendStatus::SEND_OK;
+  }
+
+  void RFCommManager ::
+    bridgeIn_handler(
+        FwIndexType portNum,
+        Fw::Buffer& recvBuffer,
+        const Drv::RecvStatus& recvStatus
+    )
+  {
+    if (recvStatus != Drv::RecvStatus::RECV_OK) {
+      this->deallocate_out(0, recvBuffer);
+      return;
+    }
+    this->queueBuffer(recvBuffer, RFStream::OTHER, false);
+  }
+
+  void RFCommManager ::
+    bridgeIn_overflowHook(
+        FwIndexType portNum,
+        Fw::Buffer& recvBuffer,
+        const Drv::RecvStatus& recvStatus
+    )
+  {
+    // Runs on the driver's thread, only the buffer is touched
+    this->deallocate_out(0, recvBuffer);
+  }
+
+  void RFCommManager ::
+    frameReturn_handler(
+        FwIndexType portNum,
+        Fw::Buffer& fwBuffer
+    )
+  {
+    const U8* const pool = &m_frameStorage[0][0];
+    const U8* const data = fwBuffer.getData();
+    if (data < pool || data >= pool + sizeof(m_frameStorage)) {
+      // Not one of ours, e.g. an RX buffer the driver could not use
+      this->deallocate_out(0, fwBuffer);
+      return;
+    }
+
+    const U32 index = static_cast<U32>(data - pool) / NRF24::MAX_PAYLOAD_SIZE;
+    FW_ASSERT(m_frameBusy[index], index);
+    m_frameBusy[index] = false;
+    m_framesFree++;
+    this->pumpTx();
+  }
+
+  void RFCommManager ::
+    frameIn_handler(
+        FwIndexType portNum,
+        Fw::Buffer& fwBuffer
+    )
+  {
+    // NRF24Driver prefixes each frame with the pipe number and its receive time
+    Fw::ExternalSerializeBuffer deserializer(fwBuffer.getData(), fwBuffer.getSize());
+    Fw::SerializeStatus status = deserializer.setBuffLen(fwBuffer.getSize());
+    U8 pipe = 0;
+    Fw::Time timestamp;
+    if (status == Fw::FW_SERIALIZE_OK) {
+      status = deserializer.deserialize(pipe);
+    }
+    if (status == Fw::FW_SERIALIZE_OK) {
+      status = deserializer.deserialize(timestamp);
+    }
+
+    if (status != Fw::FW_SERIALIZE_OK) {
+      this->countRxDrop();
+    } else {
+      const FwSizeType offset = fwBuffer.getSize() - deserializer.getBuffLeft();
+      this->processFrame(0, pipe, fwBuffer.getData() + offset, deserializer.getBuffLeft());
+    }
+
+    this->deallocate_out(0, fwBuffer);
+  }
+
+  void RFCommManager ::
+    txRingSpace_handler(
+        FwIndexType portNum,
+        U32 context
+    )
+  {
+    this->pumpTx();
+  }
+
+  void RFCommManager ::
+    rxRingDoorbell_handler(
+        FwIndexType portNum,
+        U32 context
+    )
+  {
+    FW_ASSERT(portNum >= 0 && static_cast<U32>(portNum) < m_radioCount, portNum);
+    NRF24FrameRing* const rxRing = m_radios[portNum].rxRing;
+    rxRing->answerDoorbell();
+
+    // Frames are processed in place and their slots freed a batch at a time
+    U32 frames = rxRing->count();
+    while (frames > 0) {
+      for (U32 i = 0; i < frames; i++) {
+        const NRF24FrameRing::Slot& slot = rxRing->peek(i);
+        this->processFrame(static_cast<U8>(portNum), slot.pipe, slot.data, slot.length);
+      }
+      (void)rxRing->release(frames);
+      frames = rxRing->count();
+    }
+  }
+
+  void RFCommManager ::
+    surveyIn_handler(
+        FwIndexType portNum,
+        const NRF24ChannelOccupancy& occupancy,
+        U8 dwells,
+        U8 channel
+    )
+  {
+    m_channel = channel;
+    this->tlmWrite_Channel(m_channel);
+    if (!m_surveyPending) {
+      // Commanded on the driver, not ours to act on
+      return;
+    }
+    m_surveyPending = false;
+
+    U8 least = occupancy[0];
+    for (U32 i = 1; i < NRF24ChannelOccupancy::SIZE; i++) {
+      least = (occupancy[i] < least) ? occupancy[i] : least;
+    }
+    if (occupancy[channel] == least) {
+      // Already on one of the cleanest channels
+      return;
+    }
+
+    // Interference such as a Wi-Fi channel spans many radio channels, so of the cleanest
+    // channels the one farthest from the busy one is taken
+    U32 best = channel;
+    U32 bestDistance = 0;
+    for (U32 i = 0; i < NRF24ChannelOccupancy::SIZE; i++) {
+      const U32 distance = (i > channel) ? (i - channel) : (channel - i);
+      if (occupancy[i] == least && distance > bestDistance) {
+        best = i;
+        bestDistance = distance;
+      }
+    }
+
+    this->startHop(static_cast<U8>(best), m_rate, m_power);
+  }
+
+  void RFCommManager ::
+    linkStatsIn_handler(
+        FwIndexType portNum,
+        U32 sent,
+        U32 retransmits,
+        U32 failures,
+        U8 channel,
+        const NRF24DataRate& rate,
+        U8 power
+    )
+  {
+    if (m_settingsPending) {
+      // The report may have been sent before the driver took the settings
+      m_settingsPending = false;
+    } else if (!m_hopActive) {
+      // Commands to the driver itself change the settings too
+      m_channel = channel;
+      m_rate = rate;
+      m_power = power;
+    }
+    this->tlmWrite_Channel(m_channel);
+    this->tlmWrite_DataRate(m_rate);
+    this->tlmWrite_PowerLevel(m_power);
+
+    if (!m_adaptEnabled) {
+      return;
+    }
+    m_adaptSent += sent;
+    m_adaptRetries += retransmits;
+    m_adaptFailures += failures;
+    // No-ack frames outside the ARQ are lost without a trace, an end sending only those never
+    // gathers a period and leaves the decisions to its peer
+    const U32 transmissions = m_adaptSent + m_adaptRetries + m_adaptArqTransmissions;
+    if (transmissions < ADAPT_MIN_TRANSMISSIONS) {
+      return;
+    }
+
+    // Radio retries and ARQ retransmissions are both frames lost on the air, in either direction
+    // since a lost acknowledgment costs the same. A failed payload is lost on top of its retries.
+    const U32 lost = m_adaptRetries + m_adaptFailures + m_adaptArqRetransmissions;
+    const U32 lossPercent = (lost >= transmissions) ? 100U : (lost * 100U) / transmissions;
+    this->tlmWrite_LinkLoss(static_cast<F32>(lossPercent) / 100.0f);
+    this->resetAdaptation();
+
+    if (!m_hopActive && !m_surveyPending && m_probation == 0) {
+      this->adaptLink(lossPercent);
+    }
+  }
+
+  void RFCommManager ::
+    tlmIn_handler(
+        FwIndexType portNum,
+        FwChanIdType id,
+        Fw::Time& timeTag,
+        Fw::TlmBuffer& val
+    )
+  {
+    // The manager's own channels come in here too, from its thread, while no snapshot is being taken
+    m_tlmLock.lock();
+    if (!m_tlmEncoder.update(id, timeTag, val.getBuffAddr(), static_cast<U32>(val.getBuffLength()))) {
+      m_tlmRejected++;
+    }
+    m_tlmLock.unLock();
+  }
+
+  void RFCommManager ::
+    run_handler(
+        FwIndexType portNum,
+        U32 context
+    )
+  {
+    // Svc.ComStub opens the downlink when its driver connects, the radio needs no connection
+    if (!m_comStarted) {
+      m_comStarted = true;
+      this->comReady();
+    }
+
+    for (U32 i = 0; i < REASSEMBLY_SLOTS; i++) {
+      ReassemblySlot& slot = m_slots[i];
+      if (!slot.active) {
+        continue;
+      }
+      slot.age++;
+      if (slot.age > m_reassemblyTimeout) {
+        this->releaseSlot(slot);
+        m_reassemblyTimeouts++;
+      }
+    }
+
+    this->agePeers();
+    this->runHop();
+    this->runProbation();
+    this->runBulk();
+
+    // Acknowledge a trickle that never reached ARQ_ACK_EVERY, and run the retransmit timers
+    for (U32 node = 0; node < RFRoute::MAX_NODES; node++) {
+      if (m_peers.session(static_cast<U8>(node)).framesSinceAck > 0) {
+        this->requestAck(static_cast<U8>(node));
+      }
+    }
+    this->pumpTx();
+    this->reportArq();
+    this->reportStreams();
+    this->reportTraffic();
+    this->reportBulk();
+    // After the reports, so the update carries this run period's channels
+    this->sendTelemetry();
+  }
+
+  void RFCommManager ::
+    service_handler(
+        FwIndexType portNum,
+        U32 context
+    )
+  {
+    // One wake-up at a time, pumpTx arms the flag again if the bucket is still short
+    if (m_tokenWait.exchange(false)) {
+      this->tokensDue_internalInterfaceInvoke();
+    }
+    if (m_reorderWait.exchange(false)) {
+      this->reorderDue_internalInterfaceInvoke();
+    }
+    // Retransmit timers are only woken for once the earliest of them runs out
+    if (m_arqWait) {
+      Os::RawTime armedAt;
+      m_arqTimerLock.lock();
+      armedAt = m_arqArmedAt;
+      const U32 waitUs = m_arqWaitUs;
+      m_arqTimerLock.unLock();
+      Os::RawTime now;
+      U32 elapsedUs = 0;
+      if (now.now() == Os::RawTime::OP_OK && now.getDiffUsec(armedAt, elapsedUs) == Os::RawTime::OP_OK &&
+          elapsedUs >= waitUs && m_arqWait.exchange(false)) {
+        this->arqDue_internalInterfaceInvoke();
+      }
+    }
+  }
+
+  // ----------------------------------------------------------------------
+  // Handler implementations for internal interfaces
+  // ----------------------------------------------------------------------
+
+  void RFCommManager ::
+    comDataQueued_internalInterfaceHandler(const Fw::Buffer& fwBuffer)
+  {
+    Fw::Buffer buffer = fwBuffer;
+    this->queueBuffer(buffer, classifyFramed(buffer), true);
+  }
+
+  void RFCommManager ::
+    tokensDue_internalInterfaceHandler()
+  {
+    this->pumpTx();
+  }
+
+  void RFCommManager ::
+    reorderDue_internalInterfaceHandler()
+  {
+    this->releaseFrames();
+  }
+
+  void RFCommManager ::
+    arqDue_internalInterfaceHandler()
+  {
+    // pumpTx runs the timers before it refills and sends the window
+    this->pumpTx();
+  }
+
   // ----------------------------------------------------------------------
   // Handler implementations for commands
   // ----------------------------------------------------------------------
 
   void RFCommManager ::
-    TODO_cmdHandler(
+    SET_REASSEMBLY_TIMEOUT_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        U32 ticks
+    )
+  {
+    if (ticks == 0) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    m_reassemblyTimeout = ticks;
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void RFCommManager ::
+    SET_ARQ_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        Fw::Enabled mode,
+        U8 window
+    )
+  {
+    if (window == 0 || window > RFFragment::ARQ_MAX_WINDOW) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+
+    const bool enable = (mode == Fw::Enabled::ENABLED);
+    if (enable && !m_arqEnabled) {
+      for (U32 node = 0; node < RFRoute::MAX_NODES; node++) {
+        // Half the sequence space away from the last session, so the neighbor takes the SYNC
+        // frames as a new session rather than as old duplicates
+        RFSession::Session& session = m_peers.session(static_cast<U8>(node));
+        session.sendNext = static_cast<U8>(session.sendNext + 128);
+        session.sendBase = session.sendNext;
+        session.arqSynced = false;
+      }
+      // Parity of a DATA block still going out would wait for the end of the session
+      m_fecPending = 0;
+      m_fecNext = 0;
+    } else if (!enable && m_arqEnabled) {
+      // Unacknowledged frames are abandoned
+      for (U32 node = 0; node < RFRoute::MAX_NODES; node++) {
+        RFSession::Session& session = m_peers.session(static_cast<U8>(node));
+        for (U32 i = 0; i < RFFragment::ARQ_MAX_WINDOW; i++) {
+          session.arqTx[i].used = false;
+        }
+        session.sendBase = session.sendNext;
+      }
+    }
+    m_arqEnabled = enable;
+    m_arqWindow = window;
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+    this->pumpTx();
+  }
+
+  void RFCommManager ::
+    SURVEY_AND_HOP_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        U8 dwells
+    )
+  {
+    if (dwells == 0) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    // The hop itself is reported by the ChannelHop and ChannelHopAborted events
+    const bool requested = this->requestSurvey(dwells);
+    this->cmdResponse_out(opCode, cmdSeq, requested ? Fw::CmdResponse::OK : Fw::CmdResponse::EXECUTION_ERROR);
+  }
+
+  void RFCommManager ::
+    SET_AUTO_HOP_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        U8 retransmitPercent
+    )
+  {
+    if (retransmitPercent > 100) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    m_autoHopPercent = retransmitPercent;
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void RFCommManager ::
+    SET_LINK_ADAPTATION_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        Fw::Enabled mode
+    )
+  {
+    m_adaptEnabled = (mode == Fw::Enabled::ENABLED);
+    this->resetAdaptation();
+    m_cleanPeriods = 0;
+    m_stepUpPeriods = ADAPT_STEP_UP_PERIODS;
+    m_probedUp = false;
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void RFCommManager ::
+    SET_STREAM_WEIGHT_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        RFStream stream,
+        U8 weight
+    )
+  {
+    if (!stream.isValid() || weight == 0) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    // Takes effect from the stream's next turn
+    m_txStreams[stream.e].weight = weight;
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void RFCommManager ::
+    SET_TLM_KEYFRAME_INTERVAL_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        U32 updates
+    )
+  {
+    if (updates == 0) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    m_tlmKeyframeInterval = updates;
+    m_tlmSinceKeyframe = 0;
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void RFCommManager ::
+    SET_TLM_MODE_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        RFTelemetryMode mode
+    )
+  {
+    if (!mode.isValid()) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    // Back in DELTA mode the first update is a keyframe, the peer's base may be long gone
+    m_tlmMode = mode;
+    m_tlmSinceKeyframe = 0;
+    m_tlmAckWait = 0;
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void RFCommManager ::
+    SET_TLM_PRIORITY_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        U32 channel,
+        U8 priority
+    )
+  {
+    m_tlmLock.lock();
+    const bool kept = m_tlmEncoder.setPriority(static_cast<FwChanIdType>(channel), priority);
+    m_tlmLock.unLock();
+    this->cmdResponse_out(opCode, cmdSeq, kept ? Fw::CmdResponse::OK : Fw::CmdResponse::EXECUTION_ERROR);
+  }
+
+  void RFCommManager ::
+    SET_STREAM_SHAPING_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        RFStream stream,
+        U8 share,
+        U8 burst
+    )
+  {
+    if (!stream.isValid() || share > 100 || burst == 0) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    // The bucket starts over full
+    TxStream& queue = m_txStreams[stream.e];
+    queue.share = share;
+    queue.burst = burst;
+    queue.tokens = burst * FRAGMENT_TOKENS;
+    this->pumpTx();
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void RFCommManager ::
+    SET_STREAM_DEADLINE_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        RFStream stream,
+        U32 deadline
+    )
+  {
+    if (!stream.isValid() || deadline > MAX_STREAM_DEADLINE_MS) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    m_txStreams[stream.e].deadlineMs = deadline;
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void RFCommManager ::
+    BULK_DOWNLINK_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        const Fw::CmdStringArg& source,
+        const Fw::CmdStringArg& destination
+    )
+  {
+    if (destination.length() == 0 || destination.length() > RFBulk::MAX_PATH_SIZE ||
+        source.length() > RFBulk::MAX_PATH_SIZE) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    if (m_bulkSending) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::BUSY);
+      return;
+    }
+    const I32 error = m_bulkSource.open(source.toChar());
+    if (error != 0) {
+      this->log_WARNING_HI_BulkOpenFailed(source, error);
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::EXECUTION_ERROR);
+      return;
+    }
+
+    // Nothing goes out but the offer until the peer said what it already holds
+    (void)std::snprintf(m_bulkSourcePath, sizeof(m_bulkSourcePath), "%s", source.toChar());
+    (void)std::snprintf(m_bulkDestination, sizeof(m_bulkDestination), "%s", destination.toChar());
+    m_bulkHeld.reset(RFBulk::chunkCount(m_bulkSource.size()));
+    m_bulkSending = true;
+    m_bulkTransfer++;
+    m_bulkOfferDue = true;
+    m_bulkOffered = false;
+    m_bulkCursor = 0;
+    m_bulkRewind = 0;
+    m_bulkAckAge = 0;
+    m_bulkRate = 0.0f;
+    m_bulkProgress = 0;
+    (void)m_bulkStartedAt.now();
+    this->log_ACTIVITY_HI_BulkDownlinkStarted(source, destination, m_bulkSource.size());
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+    this->pumpTx();
+  }
+
+  void RFCommManager ::
+    BULK_CANCEL_cmdHandler(
         FwOpcodeType opCode,
         U32 cmdSeq
     )
   {
-    // TODO
+    if (!m_bulkSending) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::EXECUTION_ERROR);
+      return;
+    }
+    // Chunks already queued still go out, the peer takes them like any other
+    this->stopBulk();
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void RFCommManager ::
+    SET_FEC_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        U8 parity
+    )
+  {
+    if (parity > RFFec::MAX_PARITY) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    // Blocks already started keep the rows they started with
+    m_fecRows = parity;
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void RFCommManager ::
+    SET_NODE_ADDRESS_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        U8 address
+    )
+  {
+    if (address >= RFRoute::MAX_NODES) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    // Frames already handed over go out with the old source
+    m_node = address;
+    for (FwIndexType port = 0; port < this->getNum_nodeAddress_OutputPorts(); port++) {
+      if (this->isConnected_nodeAddress_OutputPort(port)) {
+        this->nodeAddress_out(port, m_node);
+      }
+    }
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void RFCommManager ::
+    SET_ROUTE_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        U8 destination,
+        U8 nextHop
+    )
+  {
+    if (destination >= RFRoute::MAX_NODES || nextHop >= RFRoute::MAX_NODES) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    // A bulk transfer runs with one neighbor from start to end
+    if (destination == m_destination && nextHop != this->linkPeer() && m_bulkSending) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::BUSY);
+      return;
+    }
+    // Messages already queued keep the neighbor they were queued for, and its session finishes them
+    const U8 linkPeer = this->linkPeer();
+    m_peers.setRoute(destination, nextHop);
+    if (this->linkPeer() != linkPeer && m_heldBuffer.getData() != nullptr) {
+      this->admitHeld();
+      this->pumpTx();
+    }
+    this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
+  }
+
+  void RFCommManager ::
+    SET_DESTINATION_cmdHandler(
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        U8 destination,
+        U8 hopLimit
+    )
+  {
+    if (destination >= RFRoute::MAX_NODES || hopLimit == 0) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::VALIDATION_ERROR);
+      return;
+    }
+    if (m_peers.nextHop(destination) != this->linkPeer() && m_bulkSending) {
+      this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::BUSY);
+      return;
+    }
+    // The session with the old neighbor sends what was queued for it, a buffer held for its
+    // queue waits on the new one's
+    const U8 linkPeer = this->linkPeer();
+    m_destination = destination;
+    m_hopLimit = hopLimit;
+    if (this->linkPeer() != linkPeer && m_heldBuffer.getData() != nullptr) {
+      this->admitHeld();
+      this->pumpTx();
+    }
     this->cmdResponse_out(opCode, cmdSeq, Fw::CmdResponse::OK);
   }
 
+  // ----------------------------------------------------------------------
+  // Framing protocol interface
+  // ----------------------------------------------------------------------
+
+  Fw::Buffer RFCommManager ::
+    allocate(const U32 size)
+  {
+    FW_ASSERT(m_tlmFrame.getSize() >= size, static_cast<FwAssertArgType>(m_tlmFrame.getSize()), size);
+    return m_tlmFrame;
+  }
+
+  void RFCommManager ::
+    send(Fw::Buffer& outgoing)
+  {
+    m_tlmFrame = Fw::Buffer();
+    this->deliver(outgoing);
+  }
+
+  // ----------------------------------------------------------------------
+  // Helper functions
+  // ----------------------------------------------------------------------
+
+  RFSession::TxMessage* RFCommManager ::
+    pushTx(const RFStream& stream, FwSizeType size)
+  {
+    // A message for a node that is not a neighbor gets the route header ahead of its bytes, cut
+    // into the first fragment like the rest
+    const U8 node = this->linkPeer();
+    const bool routed = (node != m_destination);
+    const U8 routeSize = routed ? static_cast<U8>(RFRoute::HEADER_SIZE) : 0;
+    RFSession::TxMessage* const message = this->queueTx(stream.e, size + routeSize, node);
+    if (message != nullptr && routed) {
+      message->route[0] = m_destination;
+      message->route[1] = m_node;
+      message->route[2] = m_hopLimit;
+      message->routeSize = routeSize;
+      message->routed = true;
+    }
+    return message;
+  }
+
+  RFSession::TxMessage* RFCommManager ::
+    queueTx(U32 stream, FwSizeType size, U8 node)
+  {
+    RFSession::Session& session = m_peers.session(node);
+    RFSession::TxQueue& queue = session.queues[stream];
+    if (queue.count == TX_QUEUE_DEPTH || size > RFFragment::MAX_MESSAGE_SIZE) {
+      m_txDropped++;
+      return nullptr;
+    }
+
+    RFSession::TxMessage& message = queue.messages[(queue.head + queue.count) % TX_QUEUE_DEPTH];
+    message.buffer = Fw::Buffer();
+    message.data = nullptr;
+    message.size = size;
+    message.routeSize = 0;
+    message.routed = false;
+    message.msgId = m_peers.takeMsgId(node);
+    message.next = 0;
+    message.count = static_cast<U8>(RFFragment::fragmentCount(size));
+    (void)message.queuedAt.now();
+    queue.count++;
+    session.count++;
+    m_txStreams[stream].count++;
+    m_txCount++;
+    m_peers.wakeSession(node);
+    return &message;
+  }
+
+  U8 RFCommManager ::
+    linkPeer() const
+  {
+    return m_peers.nextHop(m_destination);
+  }
+
+  void RFCommManager ::
+    queueBuffer(Fw::Buffer& fwBuffer, const RFStream& stream, bool flowControlled)
+  {
+    this->admitBuffer(fwBuffer, stream, flowControlled);
+    this->pumpTx();
+  }
+
+  void RFCommManager ::
+    admitBuffer(Fw::Buffer& fwBuffer, const RFStream& stream, bool flowControlled)
+  {
+    // Svc.ComQueue sends one buffer per comStatus, so at most one is ever held
+    const RFSession::TxQueue& queue = m_peers.session(this->linkPeer()).queues[stream.e];
+    if (flowControlled && queue.count == TX_QUEUE_DEPTH && m_heldBuffer.getData() == nullptr) {
+      m_heldBuffer = fwBuffer;
+      m_heldStream = stream;
+      return;
+    }
+
+    RFSession::TxMessage* message = this->pushTx(stream, fwBuffer.getSize());
+    if (message == nullptr) {
+      this->deallocate_out(0, fwBuffer);
+    } else {
+      // Fragments are cut straight from the caller's buffer, it is returned after the last one
+      message->buffer = fwBuffer;
+      message->data = fwBuffer.getData();
+    }
+    // Queued or dropped, the downlink moves on to its next buffer, which may be for another stream
+    if (flowControlled) {
+      this->comReady();
+    }
+  }
+
+  void RFCommManager ::
+    admitHeld()
+  {
+    Fw::Buffer buffer = m_heldBuffer;
+    m_heldBuffer = Fw::Buffer();
+    this->admitBuffer(buffer, m_heldStream, true);
+  }
+
+  RFStream RFCommManager ::
+    classify(U8* packet, FwSizeType size)
+  {
+    Fw::ExternalSerializeBuffer deserializer(packet, size);
+    FwPacketDescriptorType descriptor = 0;
+    if (deserializer.setBuffLen(size) != Fw::FW_SERIALIZE_OK ||
+        deserializer.deserialize(descriptor) != Fw::FW_SERIALIZE_OK) {
+      return RFStream::OTHER;
+    }
+    switch (descriptor) {
+      case Fw::ComPacket::FW_PACKET_COMMAND:
+        return RFStream::COMMAND;
+      case Fw::ComPacket::FW_PACKET_LOG:
+        return RFStream::EVENT;
+      case Fw::ComPacket::FW_PACKET_TELEM:
+      case Fw::ComPacket::FW_PACKET_PACKETIZED_TLM:
+        return RFStream::TELEMETRY;
+      case Fw::ComPacket::FW_PACKET_FILE:
+        return RFStream::FILE;
+      default:
+        return RFStream::OTHER;
+    }
+  }
+
+  RFStream RFCommManager ::
+    classifyFramed(Fw::Buffer& fwBuffer)
+  {
+    // The packet descriptor follows the start word and the size
+    Fw::ExternalSerializeBuffer deserializer(fwBuffer.getData(), fwBuffer.getSize());
+    Svc::FpFrameHeader::TokenType startWord = 0;
+    if (fwBuffer.getSize() < Svc::FpFrameHeader::SIZE ||
+        deserializer.setBuffLen(fwBuffer.getSize()) != Fw::FW_SERIALIZE_OK ||
+        deserializer.deserialize(startWord) != Fw::FW_SERIALIZE_OK ||
+        startWord != Svc::FpFrameHeader::START_WORD) {
+      return RFStream::OTHER;
+    }
+    return classify(fwBuffer.getData() + Svc::FpFrameHeader::SIZE, fwBuffer.getSize() - Svc::FpFrameHeader::SIZE);
+  }
+
+  void RFCommManager ::
+    popTx(U8 node, U32 stream)
+  {
+    RFSession::Session& session = m_peers.session(node);
+    RFSession::TxQueue& queue = session.queues[stream];
+    FW_ASSERT(queue.count > 0, stream);
+    RFSession::TxMessage& message = queue.messages[queue.head];
+    if (message.buffer.getData() != nullptr) {
+      this->deallocate_out(0, message.buffer);
+    }
+    queue.head = (queue.head + 1) % TX_QUEUE_DEPTH;
+    queue.count--;
+    session.count--;
+    m_txStreams[stream].count--;
+    m_txCount--;
+    // Credits (or ARQ window room) only come back as the radio takes frames, so a held buffer is paced
+    // by the air. Messages other nodes sent through here take turns with it, neither starves the other.
+    const bool held = (m_heldBuffer.getData() != nullptr && static_cast<U32>(m_heldStream.e) == stream &&
+                       node == this->linkPeer());
+    if ((queue.forwardTurn || !held) && this->forwardOne(stream)) {
+      queue.forwardTurn = false;
+    } else if (held) {
+      this->admitHeld();
+      queue.forwardTurn = true;
+    }
+  }
+
+  U32 RFCommManager ::
+    scheduleStream(RFSession::Session& session)
+  {
+    FW_ASSERT(this->sessionReady(session));
+    // Each stream with messages queued sends up to its weight in fragments before the next one's
+    // turn; fragments are all full but the last of each message, so fragments weigh as bytes.
+    // A stream its bucket holds back loses the rest of its turn.
+    RFSession::TxQueue* queue = &session.queues[session.stream];
+    while (queue->count == 0 || queue->deficit == 0 || !this->streamEligible(m_txStreams[session.stream])) {
+      // An idle stream banks nothing for later
+      queue->deficit = 0;
+      session.stream = (session.stream + 1) % RFStream::NUM_CONSTANTS;
+      queue = &session.queues[session.stream];
+      queue->deficit = m_txStreams[session.stream].weight;
+    }
+    return session.stream;
+  }
+
+  bool RFCommManager ::
+    streamEligible(const TxStream& queue) const
+  {
+    // Buckets fill at a share of the capacity, without a measurement they do not hold anything back
+    return queue.share == 0 || m_linkCapacity == 0 || queue.tokens >= FRAGMENT_TOKENS;
+  }
+
+  bool RFCommManager ::
+    txReady() const
+  {
+    for (U32 i = 0; i < RFStream::NUM_CONSTANTS; i++) {
+      if (m_txStreams[i].count > 0 && this->streamEligible(m_txStreams[i])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool RFCommManager ::
+    sessionReady(const RFSession::Session& session) const
+  {
+    for (U32 i = 0; i < RFStream::NUM_CONSTANTS; i++) {
+      if (session.queues[i].count > 0 && this->streamEligible(m_txStreams[i])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool RFCommManager ::
+    nextSession(U32& position)
+  {
+    for (U32 k = 0; k < m_peers.sessionCount(); k++) {
+      if (this->sessionReady(m_peers.session(m_peers.sessionAt(k)))) {
+        position = k;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void RFCommManager ::
+    shapeStreams()
+  {
+    Os::RawTime now;
+    if (now.now() != Os::RawTime::OP_OK) {
+      return;
+    }
+
+    U32 elapsedUs = 0;
+    if (m_tokensAtValid && now.getDiffUsec(m_tokensAt, elapsedUs) == Os::RawTime::OP_OK) {
+      for (U32 i = 0; i < RFStream::NUM_CONSTANTS; i++) {
+        TxStream& queue = m_txStreams[i];
+        if (queue.share == 0) {
+          continue;
+        }
+        // Fragments per second times microseconds is millionths of a fragment
+        const U64 rate = static_cast<U64>(m_linkCapacity) * queue.share / 100;
+        const U64 full = queue.burst * FRAGMENT_TOKENS;
+        queue.tokens += rate * elapsedUs;
+        queue.tokens = (queue.tokens > full) ? full : queue.tokens;
+      }
+    }
+    m_tokensAt = now;
+    m_tokensAtValid = true;
+
+    // Messages go in order, so only the head can be past the deadline while the ones behind it are not. A
+    // message with fragments out is finished, dropping it would waste them.
+    for (U32 k = 0; k < m_peers.sessionCount(); k++) {
+      const U8 node = m_peers.sessionAt(k);
+      RFSession::Session& session = m_peers.session(node);
+      for (U32 i = 0; i < RFStream::NUM_CONSTANTS; i++) {
+        TxStream& stream = m_txStreams[i];
+        RFSession::TxQueue& queue = session.queues[i];
+        if (stream.deadlineMs == 0) {
+          continue;
+        }
+        while (queue.count > 0) {
+          const RFSession::TxMessage& message = queue.messages[queue.head];
+          U32 waitUs = 0;
+          if (message.next > 0 || now.getDiffUsec(message.queuedAt, waitUs) != Os::RawTime::OP_OK ||
+              waitUs < stream.deadlineMs * 1000) {
+            break;
+          }
+          stream.expired++;
+          this->popTx(node, i);
+        }
+      }
+    }
+  }
+
+  void RFCommManager ::
+    comReady()
+  {
+    if (this->isConnected_comStatus_OutputPort(0)) {
+      Fw::Success condition = Fw::Success::SUCCESS;
+      this->comStatus_out(0, condition);
+    }
+  }
+
+  void RFCommManager ::
+    pumpTx()
+  {
+    m_peers.dropIdleSessions();
+    this->shapeStreams();
+    this->fillBulk();
+    this->fillForward();
+    this->sendAcks();
+
+    if (m_arqEnabled) {
+      for (U32 k = 0; k < m_peers.sessionCount(); k++) {
+        const U8 node = m_peers.sessionAt(k);
+        this->checkArqTimers(node);
+        this->fillWindow(node);
+      }
+      this->sendWindows();
+      this->armArqTimer();
+    } else {
+      // Parity frames go right after their block on the radio its last fragment took, a bonded
+      // receiver knows then which frames came before them
+      U32 position = 0;
+      while ((m_fecNext < m_fecPending) ? this->hasCredit(m_fecRadio)
+                                        : (this->hasCredit() && this->nextSession(position))) {
+        // The only copy on the way out: message bytes into the frame the driver loads
+        U8* const frame = this->claimFrame((m_fecNext < m_fecPending) ? m_fecRadio : RFBond::ANY_RADIO);
+        if (m_fecNext < m_fecPending) {
+          // Before any other fragment is cut
+          std::memcpy(frame, m_fecFrames[m_fecNext], RFFec::PARITY_FRAME_SIZE);
+          m_fecNext++;
+          // Counted with the fragments, a bonded receiver waits for it in their order
+          (void)m_peers.takeBondSeq(m_fecNode);
+          this->sendFrame(frame, RFFec::PARITY_FRAME_SIZE, false, m_fecPipe, m_fecNode);
+          continue;
+        }
+        // Neighbors take a fragment each in turn
+        const U8 node = m_peers.sessionAt(position);
+        U8 pipe = CONTROL_PIPE;
+        const U8 length = this->nextFragment(node, RFFragment::DATA, 0, frame, pipe);
+        // Numbered per neighbor so a bonded receiver puts the radios back in order
+        frame[1] = m_peers.takeBondSeq(node);
+        this->sendFrame(frame, length, false, pipe, node);
+        m_fragmentsSent++;
+        m_peers.passTurn(position);
+      }
+    }
+
+    // A credit left over means the radio has nothing more from us right now. Held back by a
+    // bucket, the streams need a wake-up once tokens came in, frame returns may never come.
+    bool creditFree = (m_radioCount == 0) && (m_framesFree > 0);
+    for (U32 radio = 0; radio < m_radioCount; radio++) {
+      creditFree = creditFree || (this->framesInRadio(radio) < this->radioDepth(radio));
+    }
+    if (creditFree && !this->txReady()) {
+      m_linkIdle = true;
+      if (m_txCount > 0) {
+        m_linkThrottled = true;
+        m_tokenWait = true;
+      }
+    }
+  }
+
+  U8 RFCommManager ::
+    nextFragment(U8 node, RFFragment::FrameType type, U8 seq, U8* frame, U8& pipe)
+  {
+    RFSession::Session& session = m_peers.session(node);
+    const U32 stream = this->scheduleStream(session);
+    TxStream& link = m_txStreams[stream];
+    RFSession::TxQueue& queue = session.queues[stream];
+    RFSession::TxMessage& message = queue.messages[queue.head];
+    pipe = streamPipe(stream);
+    const FwSizeType offset = static_cast<FwSizeType>(message.next) * RFFragment::FRAGMENT_DATA_SIZE;
+    const FwSizeType remaining = message.size - offset;
+    const FwSizeType chunk = (remaining < RFFragment::FRAGMENT_DATA_SIZE) ? remaining : RFFragment::FRAGMENT_DATA_SIZE;
+
+    RFFragment::Header header;
+    header.type = static_cast<U8>(type | (message.routed ? RFFragment::FLAG_ROUTED : 0));
+    header.seq = seq;
+    header.msgId = message.msgId;
+    header.index = message.next;
+    header.count = message.count;
+    header.source = m_node;
+    RFFragment::encode(header, frame);
+    U8* const data = &frame[RFFragment::HEADER_SIZE];
+    FwSizeType copied = 0;
+    if (offset < message.routeSize) {
+      copied = (message.routeSize - offset < chunk) ? (message.routeSize - offset) : chunk;
+      std::memcpy(data, &message.route[offset], copied);
+    }
+    std::memcpy(data + copied, message.data + (offset + copied - message.routeSize), chunk - copied);
+    if (type == RFFragment::DATA) {
+      this->protectFragment(queue, message, &frame[RFFragment::HEADER_SIZE], chunk, pipe, node);
+    } else {
+      queue.parityRows = 0;
+    }
+
+    if (message.next == 0) {
+      Os::RawTime now;
+      U32 waitUs = 0;
+      if (now.now() == Os::RawTime::OP_OK && now.getDiffUsec(message.queuedAt, waitUs) == Os::RawTime::OP_OK) {
+        link.queueDelayUs = (waitUs > link.queueDelayUs) ? waitUs : link.queueDelayUs;
+      }
+    }
+    message.next++;
+    queue.deficit--;
+    if (link.share > 0 && m_linkCapacity > 0) {
+      link.tokens -= FRAGMENT_TOKENS;
+    }
+    if (message.next == message.count) {
+      Os::RawTime now;
+      U32 latencyUs = 0;
+      if (now.now() == Os::RawTime::OP_OK && now.getDiffUsec(message.queuedAt, latencyUs) == Os::RawTime::OP_OK) {
+        link.latencyUs = (link.latencyUs == 0) ? latencyUs : (7 * (link.latencyUs / 8) + latencyUs / 8);
+      }
+      m_messagesSent++;
+      this->popTx(node, stream);
+    }
+    return static_cast<U8>(RFFragment::HEADER_SIZE + chunk);
+  }
+
+  void RFCommManager ::
+    protectFragment(RFSession::TxQueue& queue, const RFSession::TxMessage& message, const U8* data,
+                    FwSizeType length, U8 pipe, U8 node)
+  {
+    const U32 position = message.next % RFFec::BLOCK_FRAGMENTS;
+    if (position == 0) {
+      queue.parityRows = m_fecRows;
+      for (U32 r = 0; r < queue.parityRows; r++) {
+        std::memset(queue.parity[r], 0, RFFec::SYMBOL_SIZE);
+      }
+    }
+    // A block started before FEC was turned on goes without
+    if (queue.parityRows == 0) {
+      return;
+    }
+    for (U32 r = 0; r < queue.parityRows; r++) {
+      RFFec::accumulate(queue.parity[r], data, static_cast<U32>(length), RFFec::coefficient(r, position));
+    }
+
+    const bool last = (message.next + 1U == message.count);
+    if (!last && position + 1 < RFFec::BLOCK_FRAGMENTS) {
+      return;
+    }
+    // pumpTx sends the parity of a block before cutting the next fragment
+    FW_ASSERT(m_fecNext == m_fecPending, m_fecNext, m_fecPending);
+    RFFragment::Header header;
+    header.type = static_cast<U8>(RFFragment::FEC_PARITY | (message.routed ? RFFragment::FLAG_ROUTED : 0));
+    header.msgId = message.msgId;
+    header.index = static_cast<U8>(message.next - position);
+    header.count = message.count;
+    header.source = m_node;
+    for (U32 r = 0; r < queue.parityRows; r++) {
+      header.seq = static_cast<U8>((r << RFFec::ROW_SHIFT) | (last ? length : 0));
+      RFFragment::encode(header, m_fecFrames[r]);
+      std::memcpy(&m_fecFrames[r][RFFragment::HEADER_SIZE], queue.parity[r], RFFec::SYMBOL_SIZE);
+    }
+    m_fecPending = queue.parityRows;
+    m_fecNext = 0;
+    m_fecPipe = pipe;
+    m_fecNode = node;
+    m_fecRadio = m_claimRadio;
+    queue.parityRows = 0;
+  }
+
+  bool RFCommManager ::
+    hasCredit(U32 radio)
+  {
+    if (m_radioCount == 0) {
+      m_claimRadio = 0;
+      return m_framesFree > 0;
+    }
+    const bool any = (radio == RFBond::ANY_RADIO);
+    FW_ASSERT(any || radio < m_radioCount, radio, m_radioCount);
+
+    // Only the lagging radio sending its oldest frame lets the others go on
+    U32 lagging = 0;
+    if (this->bondSkewed(lagging)) {
+      m_bondFull = m_bondFull || any;
+      return m_radios[lagging].txRing->waitForSpace(this->framesInRadio(lagging)) && this->hasCredit(radio);
+    }
+
+    // The radio with the most room takes the frame, so each carries what its link takes. Ties go
+    // round, or the first radio would take every frame while the link is light.
+    const U32 first = any ? m_nextRadio : radio;
+    const U32 radios = any ? m_radioCount : 1;
+    U32 bestRoom = 0;
+    for (U32 k = 0; k < radios; k++) {
+      const U32 candidate = (first + k) % m_radioCount;
+      const U32 depth = this->radioDepth(candidate);
+      const U32 fill = this->framesInRadio(candidate);
+      const U32 room = (fill < depth) ? depth - fill : 0;
+      if (room > bestRoom && m_radios[candidate].txRing->claim() != nullptr) {
+        bestRoom = room;
+        m_claimRadio = candidate;
+      }
+    }
+    if (bestRoom > 0) {
+      return true;
+    }
+
+    // Full rings tell us through txRingSpace once their drivers have loaded a frame
+    m_bondFull = m_bondFull || any;
+    bool retry = false;
+    for (U32 k = 0; k < radios; k++) {
+      const U32 candidate = (first + k) % m_radioCount;
+      retry = m_radios[candidate].txRing->waitForSpace(this->radioDepth(candidate)) || retry;
+    }
+    return retry && this->hasCredit(radio);
+  }
+
+  U8* RFCommManager ::
+    claimFrame(U32 radio)
+  {
+    if (m_radioCount > 0) {
+      FW_ASSERT(radio == RFBond::ANY_RADIO || m_claimRadio == radio, m_claimRadio, radio);
+      NRF24FrameRing::Slot* const slot = m_radios[m_claimRadio].txRing->claim();
+      FW_ASSERT(slot != nullptr);
+      return slot->data;
+    }
+
+    FW_ASSERT(m_framesFree > 0);
+    U32 frame = 0;
+    while (frame < FRAME_POOL_SIZE && m_frameBusy[frame]) {
+      frame++;
+    }
+    FW_ASSERT(frame < FRAME_POOL_SIZE, frame);
+    m_frameBusy[frame] = true;
+    m_framesFree--;
+    return m_frameStorage[frame];
+  }
+
+  void RFCommManager ::
+    sendFrame(U8* frame, U8 length, bool noAck, U8 pipe, U8 node)
+  {
+    Radio& radio = m_radios[m_claimRadio];
+    m_framesHanded++;
+    radio.handed++;
+    radio.frames++;
+    radio.sent[radio.handed % RFBond::RADIO_DEPTH] = m_framesHanded;
+    if (radio.txRing != nullptr) {
+      // claim hands out the same slot until it is published
+      NRF24FrameRing::Slot* const slot = radio.txRing->claim();
+      FW_ASSERT(slot != nullptr && slot->data == frame);
+      slot->pipe = pipe;
+      slot->node = node;
+      slot->length = length;
+      slot->noAck = noAck;
+      (void)slot->queuedAt.now();
+      if (radio.txRing->publish()) {
+        this->txRingDoorbell_out(static_cast<FwIndexType>(m_claimRadio), 0);
+      }
+      m_nextRadio = (m_claimRadio + 1) % m_radioCount;
+      return;
+    }
+
+    const U32 index = static_cast<U32>(frame - &m_frameStorage[0][0]) / NRF24::MAX_PAYLOAD_SIZE;
+    U32 context = index | (static_cast<U32>(pipe) << NRF24::TX_CONTEXT_PIPE_SHIFT);
+    context |= static_cast<U32>(node) << NRF24::TX_CONTEXT_NODE_SHIFT;
+    context |= noAck ? NRF24::TX_CONTEXT_NO_ACK : 0;
+    Fw::Buffer frameBuffer(frame, length, context);
+    this->frameOut_out(0, frameBuffer);
+  }
+
+  U32 RFCommManager ::
+    radioDepth(U32 radio) const
+  {
+    return (m_radioCount > 1) ? m_radios[radio].depth : NRF24FrameRing::CAPACITY;
+  }
+
+  bool RFCommManager ::
+    bondSkewed(U32& lagging) const
+  {
+    if (m_radioCount < 2) {
+      return false;
+    }
+    for (U32 radio = 0; radio < m_radioCount; radio++) {
+      // Frames already in the radio's FIFO are not seen, one that is idle holds the others back no more
+      const U32 fill = this->framesInRadio(radio);
+      const Radio& state = m_radios[radio];
+      if (fill > 0 && m_framesHanded + 1 - state.sent[(state.handed - fill + 1) % RFBond::RADIO_DEPTH] >= RFBond::SKEW_FRAMES) {
+        lagging = radio;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  U32 RFCommManager ::
+    framesInRadio(U32 radio) const
+  {
+    if (m_radioCount == 0) {
+      return FRAME_POOL_SIZE - m_framesFree;
+    }
+    return NRF24FrameRing::CAPACITY - m_radios[radio].txRing->space();
+  }
+
+  U32 RFCommManager ::
+    framesInDriver() const
+  {
+    U32 frames = (m_radioCount == 0) ? this->framesInRadio(0) : 0;
+    for (U32 radio = 0; radio < m_radioCount; radio++) {
+      frames += this->framesInRadio(radio);
+    }
+    return frames;
+  }
+
+  bool RFCommManager ::
+    inDriver(const RFSession::ArqTxSlot& slot) const
+  {
+    // Counting from the newest frame handed to its radio, the last framesInRadio ones are still queued
+    return m_radios[slot.radio].handed - slot.handoff < this->framesInRadio(slot.radio);
+  }
+
+  void RFCommManager ::
+    requestAck(U8 node)
+  {
+    RFSession::Session& session = m_peers.session(node);
+    if (!session.ackPending) {
+      session.ackPending = true;
+      m_acksPending++;
+    }
+  }
+
+  void RFCommManager ::
+    sendAcks()
+  {
+    for (U32 node = 0; node < RFRoute::MAX_NODES && m_acksPending > 0; node++) {
+      if (!m_peers.session(static_cast<U8>(node)).ackPending) {
+        continue;
+      }
+      if (!this->hasCredit()) {
+        return;
+      }
+      this->sendAck(static_cast<U8>(node));
+    }
+  }
+
+  void RFCommManager ::
+    sendAck(U8 node)
+  {
+    RFSession::Session& session = m_peers.session(node);
+    U8* const data = this->claimFrame();
+    data[0] = RFFragment::ARQ_ACK;
+    data[1] = session.receiveBase;
+    data[2] = m_node;
+    U8* const bitmap = &data[3];
+    std::memset(bitmap, 0, RFFragment::ACK_BITMAP_SIZE);
+    for (U32 i = 0; i + 1 < RFFragment::ARQ_MAX_WINDOW; i++) {
+      const U8 seq = static_cast<U8>(session.receiveBase + 1 + i);
+      if (session.arqRx[seq % RFFragment::ARQ_MAX_WINDOW].seen) {
+        bitmap[i / 8] = static_cast<U8>(bitmap[i / 8] | (1U << (i % 8)));
+      }
+    }
+    if (session.ackPending) {
+      session.ackPending = false;
+      m_acksPending--;
+    }
+    session.framesSinceAck = 0;
+
+    this->sendFrame(data, RFFragment::ACK_FRAME_SIZE, true, CONTROL_PIPE, node);
+  }
+
+  void RFCommManager ::
+    fillWindow(U8 node)
+  {
+    // Fragments move into the window without waiting for credits, the window is the limit
+    RFSession::Session& session = m_peers.session(node);
+    while (this->sessionReady(session) && this->windowOccupancy(session) < this->sendWindowSize(session)) {
+      const U8 seq = session.sendNext;
+      const U32 index = seq % RFFragment::ARQ_MAX_WINDOW;
+      RFSession::ArqTxSlot& slot = session.arqTx[index];
+      slot.length = this->nextFragment(node, RFFragment::ARQ_DATA, seq, session.arqTxFrames[index], slot.pipe);
+      slot.used = true;
+      slot.queued = true;
+      slot.tries = 0;
+      session.sendNext++;
+    }
+  }
+
+  bool RFCommManager ::
+    sendWindow(U8 node)
+  {
+    RFSession::Session& session = m_peers.session(node);
+    const U32 occupancy = this->windowOccupancy(session);
+    U32 k = 0;
+    while (k < occupancy && !session.arqTx[static_cast<U8>(session.sendBase + k) % RFFragment::ARQ_MAX_WINDOW].queued) {
+      k++;
+    }
+    if (k == occupancy) {
+      return false;
+    }
+    const U32 index = static_cast<U8>(session.sendBase + k) % RFFragment::ARQ_MAX_WINDOW;
+    RFSession::ArqTxSlot& slot = session.arqTx[index];
+    U8* const window = session.arqTxFrames[index];
+
+    // Without the neighbor's first ACK it cannot be known whether its receiver follows this session.
+    // The neighbor's ACK timing does not know our window, so the frames we would otherwise wait on poll.
+    const bool newest = (k + 1 == occupancy);
+    const bool stalled = newest && (occupancy >= this->sendWindowSize(session) || !this->sessionReady(session));
+    U8 type = static_cast<U8>(RFFragment::ARQ_DATA | (window[0] & RFFragment::FLAG_ROUTED));
+    type = static_cast<U8>(type | (session.arqSynced ? 0 : RFFragment::FLAG_SYNC));
+    type = static_cast<U8>(type | ((stalled || slot.tries > 0) ? RFFragment::FLAG_POLL : 0));
+    window[0] = type;
+    slot.queued = false;
+    slot.tries++;
+    (void)slot.sentAt.now();
+    m_arqTransmissions++;
+    m_adaptArqTransmissions++;
+    if (slot.tries > 1) {
+      m_arqRetransmissions++;
+      m_adaptArqRetransmissions++;
+    } else {
+      m_fragmentsSent++;
+    }
+
+    // The window keeps its copy for retransmission
+    U8* const frame = this->claimFrame();
+    std::memcpy(frame, window, slot.length);
+    slot.radio = static_cast<U8>(m_claimRadio);
+    this->sendFrame(frame, slot.length, true, slot.pipe, node);
+    slot.handoff = m_radios[slot.radio].handed;
+    return true;
+  }
+
+  void RFCommManager ::
+    sendWindows()
+  {
+    // Neighbors take a frame each in turn, oldest first within a window; one with none waiting passes
+    U32 position = 0;
+    while (position < m_peers.sessionCount() && this->hasCredit()) {
+      if (this->sendWindow(m_peers.sessionAt(position))) {
+        m_peers.passTurn(position);
+        position = 0;
+      } else {
+        position++;
+      }
+    }
+  }
+
+  void RFCommManager ::
+    checkArqTimers(U8 node)
+  {
+    Os::RawTime now;
+    if (now.now() != Os::RawTime::OP_OK) {
+      return;
+    }
+
+    RFSession::Session& session = m_peers.session(node);
+    bool expired = false;
+    const U32 occupancy = this->windowOccupancy(session);
+    for (U32 k = 0; k < occupancy; k++) {
+      RFSession::ArqTxSlot& slot = session.arqTx[static_cast<U8>(session.sendBase + k) % RFFragment::ARQ_MAX_WINDOW];
+      if (!slot.used || slot.queued || slot.tries == 0 || this->inDriver(slot)) {
+        continue;
+      }
+      U32 elapsedUs = 0;
+      if (now.getDiffUsec(slot.sentAt, elapsedUs) == Os::RawTime::OP_OK && elapsedUs >= session.rtoUs) {
+        slot.queued = true;
+        expired = true;
+      }
+    }
+
+    // Back off once per expiry round, the next progress brings it back down. The backoff is
+    // bounded so a burst of losses does not stall the window past the reassembly timeout.
+    if (expired) {
+      const U32 ceiling = this->estimatedRto(session) * ARQ_MAX_BACKOFF;
+      const U32 limit = (ceiling < ARQ_MAX_RTO_US) ? ceiling : ARQ_MAX_RTO_US;
+      session.rtoUs = (session.rtoUs > limit / 2) ? limit : session.rtoUs * 2;
+    }
+  }
+
+  void RFCommManager ::
+    armArqTimer()
+  {
+    Os::RawTime now;
+    if (now.now() != Os::RawTime::OP_OK) {
+      return;
+    }
+
+    // Frames still queued in a driver have no timer running, the ring's space doorbell comes first.
+    // Sessions with frames unacknowledged stay in the turns.
+    bool running = false;
+    U32 waitUs = 0;
+    for (U32 position = 0; position < m_peers.sessionCount(); position++) {
+      const RFSession::Session& session = m_peers.session(m_peers.sessionAt(position));
+      const U32 occupancy = this->windowOccupancy(session);
+      for (U32 k = 0; k < occupancy; k++) {
+        const RFSession::ArqTxSlot& slot =
+            session.arqTx[static_cast<U8>(session.sendBase + k) % RFFragment::ARQ_MAX_WINDOW];
+        if (!slot.used || slot.queued || slot.tries == 0 || this->inDriver(slot)) {
+          continue;
+        }
+        U32 elapsedUs = 0;
+        if (now.getDiffUsec(slot.sentAt, elapsedUs) != Os::RawTime::OP_OK) {
+          continue;
+        }
+        const U32 remainingUs = (elapsedUs < session.rtoUs) ? (session.rtoUs - elapsedUs) : 0;
+        if (!running || remainingUs < waitUs) {
+          waitUs = remainingUs;
+        }
+        running = true;
+      }
+    }
+
+    if (!running) {
+      m_arqWait = false;
+      return;
+    }
+    m_arqTimerLock.lock();
+    m_arqArmedAt = now;
+    m_arqWaitUs = waitUs;
+    m_arqTimerLock.unLock();
+    m_arqWait = true;
+  }
+
+  void RFCommManager ::
+    receiveAck(const U8* frame, FwSizeType length)
+  {
+    if (length < RFFragment::ACK_FRAME_SIZE || frame[2] >= RFRoute::MAX_NODES) {
+      this->countRxDrop();
+      return;
+    }
+    if (!m_arqEnabled) {
+      return;
+    }
+
+    RFSession::Session& session = m_peers.session(frame[2]);
+    const U8 base = frame[1];
+    const U8* const bitmap = &frame[3];
+    const U32 occupancy = this->windowOccupancy(session);
+    const U32 cumulative = static_cast<U8>(base - session.sendBase);
+    if (cumulative > occupancy) {
+      // Older than the window, or from before this session
+      return;
+    }
+    session.arqSynced = true;
+    if (cumulative > 0 && session.rttValid) {
+      // The link is moving again, drop any timer backoff
+      session.rtoUs = this->estimatedRto(session);
+    }
+
+    for (U32 k = 0; k < cumulative; k++) {
+      this->ackFrame(session, static_cast<U8>(session.sendBase + k));
+    }
+    U32 highest = cumulative;
+    U32 highestOn[RFBond::MAX_RADIOS] = {};
+    for (U32 i = 0; i + 1 < RFFragment::ARQ_MAX_WINDOW; i++) {
+      const U32 offset = cumulative + 1 + i;
+      if (offset >= occupancy) {
+        break;
+      }
+      if ((bitmap[i / 8] & (1U << (i % 8))) != 0) {
+        const RFSession::ArqTxSlot& acked = session.arqTx[static_cast<U8>(base + 1 + i) % RFFragment::ARQ_MAX_WINDOW];
+        if (acked.used) {
+          highestOn[acked.radio] = offset + 1;
+        }
+        this->ackFrame(session, static_cast<U8>(base + 1 + i));
+        highest = offset + 1;
+      }
+    }
+
+    // Frames missing below one that arrived on the same radio were lost, a radio does not
+    // reorder; bonded radios may. They go again without waiting for the timer, once; later
+    // losses are left to the timer.
+    for (U32 offset = cumulative; offset < highest; offset++) {
+      RFSession::ArqTxSlot& slot =
+          session.arqTx[static_cast<U8>(session.sendBase + offset) % RFFragment::ARQ_MAX_WINDOW];
+      if (slot.used && !slot.queued && slot.tries == 1 && offset < highestOn[slot.radio] && !this->inDriver(slot)) {
+        slot.queued = true;
+      }
+    }
+
+    this->advanceWindow(session);
+    this->pumpTx();
+  }
+
+  void RFCommManager ::
+    ackFrame(RFSession::Session& session, U8 seq)
+  {
+    RFSession::ArqTxSlot& slot = session.arqTx[seq % RFFragment::ARQ_MAX_WINDOW];
+    if (!slot.used) {
+      return;
+    }
+    slot.used = false;
+    slot.queued = false;
+    m_arqBytesAcked += slot.length - RFFragment::HEADER_SIZE;
+
+    // Karn: only frames sent once give an unambiguous sample
+    if (slot.tries == 1) {
+      Os::RawTime now;
+      U32 rttUs = 0;
+      if (now.now() == Os::RawTime::OP_OK && now.getDiffUsec(slot.sentAt, rttUs) == Os::RawTime::OP_OK) {
+        this->updateRto(session, rttUs);
+        m_rttHistogram.record(rttUs);
+      }
+    }
+  }
+
+  void RFCommManager ::
+    advanceWindow(RFSession::Session& session)
+  {
+    while (session.sendBase != session.sendNext && !session.arqTx[session.sendBase % RFFragment::ARQ_MAX_WINDOW].used) {
+      session.sendBase++;
+    }
+  }
+
+  void RFCommManager ::
+    updateRto(RFSession::Session& session, U32 rttUs)
+  {
+    // RFC 6298 estimator, with the sample bounded so a stale timestamp cannot overflow it
+    const U32 sample = (rttUs < ARQ_MAX_RTO_US) ? rttUs : ARQ_MAX_RTO_US;
+    if (!session.rttValid) {
+      session.srttUs = sample;
+      session.rttVarUs = sample / 2;
+      session.rttValid = true;
+    } else {
+      const U32 delta = (session.srttUs > sample) ? (session.srttUs - sample) : (sample - session.srttUs);
+      session.rttVarUs = (3 * session.rttVarUs + delta) / 4;
+      session.srttUs = (7 * session.srttUs + sample) / 8;
+    }
+    session.rtoUs = this->estimatedRto(session);
+  }
+
+  U32 RFCommManager ::
+    estimatedRto(const RFSession::Session& session) const
+  {
+    const U32 rto = session.srttUs + 4 * session.rttVarUs;
+    return (rto < ARQ_MIN_RTO_US) ? ARQ_MIN_RTO_US : ((rto > ARQ_MAX_RTO_US) ? ARQ_MAX_RTO_US : rto);
+  }
+
+  void RFCommManager ::
+    receiveArqFrame(U8 pipe, const RFFragment::Header& header, const U8* frame, FwSizeType length)
+  {
+    // Each neighbor numbers the frames it sends us on its own
+    RFSession::Session& session = m_peers.session(header.source);
+    U32 offset = static_cast<U8>(header.seq - session.receiveBase);
+    const bool sync = (header.type & RFFragment::FLAG_SYNC) != 0;
+    const bool outside = (offset >= RFFragment::ARQ_MAX_WINDOW && offset < 256 - RFFragment::ARQ_MAX_WINDOW);
+    if (sync && (!session.receiveSynced || outside)) {
+      // A new session on the sender, the window restarts at this frame
+      for (U32 i = 0; i < RFFragment::ARQ_MAX_WINDOW; i++) {
+        session.arqRx[i].seen = false;
+      }
+      session.receiveBase = header.seq;
+      session.receiveSynced = true;
+      offset = 0;
+    }
+    if (!session.receiveSynced) {
+      this->countRxDrop();
+      return;
+    }
+
+    if (offset >= RFFragment::ARQ_MAX_WINDOW) {
+      // Delivered already and our ACK was lost, or not of this session; the ACK tells the sender where we are
+      this->requestAck(header.source);
+      this->pumpTx();
+      return;
+    }
+
+    if (offset == 0) {
+      this->receiveFragment(pipe, header, frame + RFFragment::HEADER_SIZE, length - RFFragment::HEADER_SIZE);
+      session.receiveBase++;
+      session.framesSinceAck++;
+
+      // Frames held behind this one follow in order
+      while (session.arqRx[session.receiveBase % RFFragment::ARQ_MAX_WINDOW].seen) {
+        const U32 index = session.receiveBase % RFFragment::ARQ_MAX_WINDOW;
+        RFSession::ArqRxSlot& slot = session.arqRx[index];
+        RFFragment::Header held;
+        const bool valid = RFFragment::decode(session.arqRxFrames[index], slot.length, held);
+        FW_ASSERT(valid);
+        this->receiveFragment(slot.pipe, held, session.arqRxFrames[index] + RFFragment::HEADER_SIZE,
+                              slot.length - RFFragment::HEADER_SIZE);
+        slot.seen = false;
+        session.receiveBase++;
+        session.framesSinceAck++;
+      }
+    } else {
+      const U32 index = header.seq % RFFragment::ARQ_MAX_WINDOW;
+      RFSession::ArqRxSlot& slot = session.arqRx[index];
+      if (!slot.seen) {
+        // The first frame past a gap is acknowledged at once so the sender repeats the missing one early
+        bool holding = false;
+        for (U32 i = 0; i < RFFragment::ARQ_MAX_WINDOW && !holding; i++) {
+          holding = session.arqRx[i].seen;
+        }
+        if (!holding) {
+          this->requestAck(header.source);
+        }
+        std::memcpy(session.arqRxFrames[index], frame, length);
+        slot.seen = true;
+        slot.pipe = pipe;
+        slot.length = static_cast<U8>(length);
+        session.framesSinceAck++;
+      }
+    }
+
+    const bool poll = (header.type & RFFragment::FLAG_POLL) != 0;
+    const bool last = (header.index + 1U == header.count);
+    if (poll || last || session.framesSinceAck >= ARQ_ACK_EVERY) {
+      this->requestAck(header.source);
+    }
+    if (session.ackPending) {
+      this->pumpTx();
+    }
+  }
+
+  U32 RFCommManager ::
+    windowOccupancy(const RFSession::Session& session) const
+  {
+    return static_cast<U8>(session.sendNext - session.sendBase);
+  }
+
+  U32 RFCommManager ::
+    sendWindowSize(const RFSession::Session& session) const
+  {
+    // The neighbor starts its receive window at the first SYNC frame it hears. With more in flight
+    // it could miss the first one and take it for an old duplicate once repeated.
+    return session.arqSynced ? m_arqWindow : 1;
+  }
+
+  void RFCommManager ::
+    processFrame(U8 radio, U8 pipe, const U8* frame, FwSizeType length)
+  {
+    RFFragment::Header header;
+    const U8 type = (length > 0) ? (frame[0] & RFFragment::TYPE_MASK) : 0;
+    if (type == RFFragment::ARQ_ACK) {
+      this->receiveAck(frame, length);
+    } else if (type == RFFragment::HOP) {
+      this->receiveHop(frame, length);
+    } else if (type == RFFragment::HOP_ACK) {
+      this->receiveHopAck(frame, length);
+    } else if (type == RFFragment::TLM_ACK) {
+      this->receiveTlmAck(frame, length);
+    } else if (type == RFFragment::BULK_ACK) {
+      this->receiveBulkAck(frame, length);
+    } else if (!RFFragment::decode(frame, length, header)) {
+      this->countRxDrop();
+    } else {
+      // Control frames other than ACKs carry no source, the fragments tell which neighbors are about
+      this->heardFrom(header.source);
+      if (type == RFFragment::ARQ_DATA) {
+        this->receiveArqFrame(pipe, header, frame, length);
+      } else if (type == RFFragment::DATA && m_radioCount > 1) {
+        // Bonded radios each keep their frames in order, but not with each other
+        if (m_reorder.admit(radio, pipe, header, frame, static_cast<U8>(length))) {
+          this->receiveFragment(pipe, header, frame + RFFragment::HEADER_SIZE, length - RFFragment::HEADER_SIZE);
+        }
+        this->releaseFrames();
+      } else if (type == RFFragment::DATA) {
+        this->receiveFragment(pipe, header, frame + RFFragment::HEADER_SIZE, length - RFFragment::HEADER_SIZE);
+      } else if (type == RFFragment::FEC_PARITY && m_radioCount > 1) {
+        // Rows follow the block's last fragment on its radio, so parity rebuilds no fragment that is
+        // only held up on another radio, and no later message goes on before it
+        const U8 last = static_cast<U8>(header.index + blockFragments(header.count, header.index) - 1);
+        const U8 row = static_cast<U8>(header.seq >> RFFec::ROW_SHIFT);
+        if (m_reorder.admitFollowing(radio, pipe, header, last, row, frame, static_cast<U8>(length))) {
+          this->receiveParity(pipe, header, frame + RFFragment::HEADER_SIZE, length - RFFragment::HEADER_SIZE);
+        }
+        this->releaseFrames();
+      } else if (type == RFFragment::FEC_PARITY) {
+        this->receiveParity(pipe, header, frame + RFFragment::HEADER_SIZE, length - RFFragment::HEADER_SIZE);
+      } else {
+        this->countRxDrop();
+      }
+    }
+  }
+
+  void RFCommManager ::
+    releaseFrames()
+  {
+    const RFBondReorder::Frame* kept = m_reorder.next();
+    while (kept != nullptr) {
+      RFFragment::Header header;
+      (void)RFFragment::decode(kept->data, kept->length, header);
+      if ((header.type & RFFragment::TYPE_MASK) == RFFragment::FEC_PARITY) {
+        this->receiveParity(kept->pipe, header, kept->data + RFFragment::HEADER_SIZE,
+                            kept->length - RFFragment::HEADER_SIZE);
+      } else {
+        this->receiveFragment(kept->pipe, header, kept->data + RFFragment::HEADER_SIZE,
+                              kept->length - RFFragment::HEADER_SIZE);
+      }
+      kept = m_reorder.next();
+    }
+    // Frames still kept wait on the ones ahead or on their hold running out
+    if (m_reorder.holding()) {
+      m_reorderWait = true;
+    }
+  }
+
+  void RFCommManager ::
+    receiveFragment(U8 pipe, const RFFragment::Header& header, const U8* data, FwSizeType length)
+  {
+    // Every fragment but the last is full, the last one carries the remainder
+    const bool last = (header.index + 1U == header.count);
+    if (length > RFFragment::FRAGMENT_DATA_SIZE || (!last && length != RFFragment::FRAGMENT_DATA_SIZE)) {
+      this->countRxDrop();
+      return;
+    }
+
+    if (!this->canReceive(header)) {
+      this->countRxDrop();
+      return;
+    }
+    // A frame given up on and come after all, parity may have rebuilt its message meanwhile
+    if (m_radioCount > 1 && m_peers.delivered(header.source, header.msgId)) {
+      return;
+    }
+
+    // Single frame messages skip the slot pool
+    if (header.count == 1) {
+      Fw::Buffer buffer = this->allocate_out(0, static_cast<U32>(length));
+      if (buffer.getData() == nullptr || buffer.getSize() < length) {
+        if (buffer.getData() != nullptr) {
+          this->deallocate_out(0, buffer);
+        }
+        this->countRxDrop();
+        return;
+      }
+      std::memcpy(buffer.getData(), data, length);
+      buffer.setSize(length);
+      m_peers.markDelivered(header.source, header.msgId);
+      this->receiveMessage(header.source, pipe, (header.type & RFFragment::FLAG_ROUTED) != 0, buffer);
+      return;
+    }
+
+    ReassemblySlot* slot = this->findSlot(pipe, header);
+    if (slot == nullptr) {
+      this->countRxDrop();
+      return;
+    }
+
+    const U32 word = header.index / 32U;
+    const U32 bit = 1U << (header.index % 32U);
+    if ((slot->seen[word] & bit) != 0) {
+      // Duplicate, e.g. an ACK lost and the frame retransmitted
+      return;
+    }
+
+    // Fragments land at their final offset, no staging copy
+    const FwSizeType offset = static_cast<FwSizeType>(header.index) * RFFragment::FRAGMENT_DATA_SIZE;
+    std::memcpy(slot->buffer.getData() + offset, data, length);
+    slot->seen[word] |= bit;
+    slot->received++;
+    // The timeout runs from the last fragment, a message still making progress is kept
+    slot->age = 0;
+    if (last) {
+      slot->size = offset + length;
+      // Parity is taken over the last fragment zero padded
+      std::memset(slot->buffer.getData() + offset + length, 0, RFFragment::FRAGMENT_DATA_SIZE - length);
+    }
+
+    if (slot->parity) {
+      this->recoverBlock(*slot, header.index - header.index % RFFec::BLOCK_FRAGMENTS);
+    }
+    if (slot->received == slot->count) {
+      this->completeSlot(*slot);
+    }
+  }
+
+  RFCommManager::ReassemblySlot* RFCommManager ::
+    findSlot(U8 pipe, const RFFragment::Header& header)
+  {
+    ReassemblySlot* oldest = nullptr;
+    ReassemblySlot* freeSlot = nullptr;
+    for (U32 i = 0; i < REASSEMBLY_SLOTS; i++) {
+      ReassemblySlot& slot = m_slots[i];
+      if (!slot.active) {
+        freeSlot = (freeSlot == nullptr) ? &slot : freeSlot;
+        continue;
+      }
+      if (slot.source == header.source && slot.pipe == pipe && slot.msgId == header.msgId) {
+        if (slot.count == header.count) {
+          return &slot;
+        }
+        // Same id with a different shape, the old message was abandoned by the sender
+        this->releaseSlot(slot);
+        this->countRxDrop();
+        freeSlot = &slot;
+        break;
+      }
+      if (oldest == nullptr || slot.age > oldest->age) {
+        oldest = &slot;
+      }
+    }
+
+    if (freeSlot == nullptr) {
+      // All slots busy, the oldest message is the least likely to complete
+      FW_ASSERT(oldest != nullptr);
+      this->releaseSlot(*oldest);
+      this->countRxDrop();
+      freeSlot = oldest;
+    }
+
+    // Sized for the worst case, the real size is known when the last fragment arrives
+    const U32 capacity = static_cast<U32>(header.count) * RFFragment::FRAGMENT_DATA_SIZE;
+    Fw::Buffer buffer = this->allocate_out(0, capacity);
+    if (buffer.getData() == nullptr || buffer.getSize() < capacity) {
+      if (buffer.getData() != nullptr) {
+        this->deallocate_out(0, buffer);
+      }
+      return nullptr;
+    }
+
+    freeSlot->active = true;
+    freeSlot->source = header.source;
+    freeSlot->pipe = pipe;
+    freeSlot->msgId = header.msgId;
+    freeSlot->count = header.count;
+    freeSlot->received = 0;
+    freeSlot->size = 0;
+    freeSlot->age = 0;
+    std::memset(freeSlot->seen, 0, sizeof(freeSlot->seen));
+    freeSlot->parity = false;
+    freeSlot->tail = 0;
+    freeSlot->routed = (header.type & RFFragment::FLAG_ROUTED) != 0;
+    freeSlot->buffer = buffer;
+    // A new message with the id, the one delivered under it is long gone
+    m_peers.clearDelivered(header.source, header.msgId);
+    return freeSlot;
+  }
+
+  void RFCommManager ::
+    releaseSlot(ReassemblySlot& slot)
+  {
+    FW_ASSERT(slot.active);
+    this->dropParity(slot);
+    slot.active = false;
+    this->deallocate_out(0, slot.buffer);
+  }
+
+  void RFCommManager ::
+    completeSlot(ReassemblySlot& slot)
+  {
+    FW_ASSERT(slot.active && slot.received == slot.count, slot.received, slot.count);
+    this->dropParity(slot);
+    Fw::Buffer buffer = slot.buffer;
+    buffer.setSize(slot.size);
+    slot.active = false;
+    m_peers.markDelivered(slot.source, slot.msgId);
+    this->receiveMessage(slot.source, slot.pipe, slot.routed, buffer);
+  }
+
+  void RFCommManager ::
+    receiveParity(U8 pipe, const RFFragment::Header& header, const U8* data, FwSizeType length)
+  {
+    const U8 row = static_cast<U8>(header.seq >> RFFec::ROW_SHIFT);
+    const U32 tail = header.seq & RFFec::TAIL_MASK;
+    if (length != RFFec::SYMBOL_SIZE || row >= RFFec::MAX_PARITY || tail > RFFec::SYMBOL_SIZE ||
+        header.index % RFFec::BLOCK_FRAGMENTS != 0 || !this->canReceive(header)) {
+      this->countRxDrop();
+      return;
+    }
+    // Every fragment arrived, or an earlier row rebuilt the message
+    if (m_peers.delivered(header.source, header.msgId)) {
+      return;
+    }
+
+    // A single fragment message is its own block, any row rebuilds it
+    if (header.count == 1) {
+      Fw::Buffer buffer = this->allocate_out(0, tail);
+      if (buffer.getData() == nullptr || buffer.getSize() < tail) {
+        if (buffer.getData() != nullptr) {
+          this->deallocate_out(0, buffer);
+        }
+        this->countRxDrop();
+        return;
+      }
+      U8 fragment[RFFec::SYMBOL_SIZE];
+      const bool recovered = RFFec::recover(fragment, 1, 1, &data, &row, 1);
+      FW_ASSERT(recovered);
+      std::memcpy(buffer.getData(), fragment, tail);
+      buffer.setSize(tail);
+      m_fecRecovered++;
+      m_peers.markDelivered(header.source, header.msgId);
+      this->receiveMessage(header.source, pipe, (header.type & RFFragment::FLAG_ROUTED) != 0, buffer);
+      return;
+    }
+
+    const U32 first = header.index;
+    const bool lastBlock = (first + blockFragments(header.count, first) == header.count);
+    if (lastBlock && tail == 0) {
+      this->countRxDrop();
+      return;
+    }
+    ReassemblySlot* slot = this->findSlot(pipe, header);
+    if (slot == nullptr) {
+      this->countRxDrop();
+      return;
+    }
+    slot->parity = true;
+    slot->age = 0;
+    if (lastBlock) {
+      slot->tail = static_cast<U8>(tail);
+    }
+
+    const U8 index = static_cast<U8>(slot - m_slots);
+    FecParitySlot* freeParity = nullptr;
+    for (U32 i = 0; i < FEC_PARITY_SLOTS; i++) {
+      FecParitySlot& parity = m_fecParity[i];
+      if (!parity.active) {
+        freeParity = (freeParity == nullptr) ? &parity : freeParity;
+      } else if (parity.slot == index && parity.first == first && parity.row == row) {
+        return;
+      }
+    }
+    if (freeParity == nullptr) {
+      this->countRxDrop();
+      return;
+    }
+    freeParity->active = true;
+    freeParity->slot = index;
+    freeParity->first = static_cast<U8>(first);
+    freeParity->row = row;
+    std::memcpy(freeParity->data, data, RFFec::SYMBOL_SIZE);
+
+    this->recoverBlock(*slot, first);
+    if (slot->received == slot->count) {
+      this->completeSlot(*slot);
+    }
+  }
+
+  void RFCommManager ::
+    recoverBlock(ReassemblySlot& slot, U32 first)
+  {
+    const U8 index = static_cast<U8>(&slot - m_slots);
+    const U32 fragments = blockFragments(slot.count, first);
+    const U32 lost = lostFragments(slot.seen, first, fragments);
+
+    const U8* parity[RFFec::MAX_PARITY];
+    U8 rows[RFFec::MAX_PARITY];
+    U32 parityCount = 0;
+    U32 missing = 0;
+    for (U32 i = 0; i < fragments; i++) {
+      missing += (lost >> i) & 1U;
+    }
+    for (U32 i = 0; i < FEC_PARITY_SLOTS && parityCount < RFFec::MAX_PARITY; i++) {
+      const FecParitySlot& entry = m_fecParity[i];
+      if (entry.active && entry.slot == index && entry.first == first) {
+        parity[parityCount] = entry.data;
+        rows[parityCount] = entry.row;
+        parityCount++;
+      }
+    }
+    if (missing > parityCount) {
+      return;
+    }
+
+    if (missing > 0) {
+      const bool tailLost = (first + fragments == slot.count) && ((lost >> (fragments - 1)) & 1U) != 0;
+      if (tailLost && slot.tail == 0) {
+        return;
+      }
+      U8* const block = slot.buffer.getData() + first * RFFec::SYMBOL_SIZE;
+      if (!RFFec::recover(block, fragments, lost, parity, rows, parityCount)) {
+        return;
+      }
+      for (U32 i = 0; i < fragments; i++) {
+        if ((lost & (1U << i)) != 0) {
+          const U32 fragment = first + i;
+          slot.seen[fragment / 32U] |= 1U << (fragment % 32U);
+        }
+      }
+      slot.received += missing;
+      if (tailLost) {
+        slot.size = static_cast<FwSizeType>(slot.count - 1) * RFFragment::FRAGMENT_DATA_SIZE + slot.tail;
+      }
+      m_fecRecovered++;
+    }
+
+    // The block is whole, its parity is of no more use
+    for (U32 i = 0; i < FEC_PARITY_SLOTS; i++) {
+      FecParitySlot& entry = m_fecParity[i];
+      if (entry.active && entry.slot == index && entry.first == first) {
+        entry.active = false;
+      }
+    }
+  }
+
+  void RFCommManager ::
+    dropParity(const ReassemblySlot& slot)
+  {
+    if (!slot.parity) {
+      return;
+    }
+    for (U32 first = 0; first < slot.count; first += RFFec::BLOCK_FRAGMENTS) {
+      if (lostFragments(slot.seen, first, blockFragments(slot.count, first)) != 0) {
+        m_fecUnrecoverable++;
+      }
+    }
+    const U8 index = static_cast<U8>(&slot - m_slots);
+    for (U32 i = 0; i < FEC_PARITY_SLOTS; i++) {
+      if (m_fecParity[i].slot == index) {
+        m_fecParity[i].active = false;
+      }
+    }
+  }
+
+  bool RFCommManager ::
+    hasSink()
+  {
+    return this->isConnected_comDataOut_OutputPort(0) || this->isConnected_bridgeOut_OutputPort(0);
+  }
+
+  bool RFCommManager ::
+    canReceive(const RFFragment::Header& header)
+  {
+    // A relay takes routed messages without a sink of its own, most of them are for other nodes
+    return (header.type & RFFragment::FLAG_ROUTED) != 0 || this->hasSink();
+  }
+
+  void RFCommManager ::
+    deliver(Fw::Buffer& buffer)
+  {
+    m_messagesReceived++;
+    if (this->isConnected_comDataOut_OutputPort(0)) {
+      this->comDataOut_out(0, buffer, Drv::RecvStatus::RECV_OK);
+      return;
+    }
+    // The driver keeps the buffer unless it asks for a retry, the ground link is best effort
+    if (this->bridgeOut_out(0, buffer) == Drv::SendStatus::SEND_RETRY) {
+      this->deallocate_out(0, buffer);
+    }
+  }
+
+  void RFCommManager ::
+    receiveMessage(U8 source, U8 pipe, bool routed, Fw::Buffer& buffer)
+  {
+    if (!routed) {
+      this->dispatchMessage(source, pipe, false, buffer);
+      return;
+    }
+
+    U8* const data = buffer.getData();
+    const FwSizeType size = buffer.getSize();
+    if (size < RFRoute::HEADER_SIZE || data[0] >= RFRoute::MAX_NODES || data[1] >= RFRoute::MAX_NODES) {
+      this->countRxDrop();
+      this->deallocate_out(0, buffer);
+      return;
+    }
+    if (data[0] != m_node) {
+      this->forwardMessage(pipe, buffer);
+      return;
+    }
+    if (!this->hasSink()) {
+      this->countRxDrop();
+      this->deallocate_out(0, buffer);
+      return;
+    }
+    // The buffer goes on as the message alone, to whoever frees it
+    const U8 origin = data[1];
+    std::memmove(data, data + RFRoute::HEADER_SIZE, size - RFRoute::HEADER_SIZE);
+    buffer.setSize(size - RFRoute::HEADER_SIZE);
+    this->dispatchMessage(origin, pipe, true, buffer);
+  }
+
+  void RFCommManager ::
+    dispatchMessage(U8 source, U8 pipe, bool routed, Fw::Buffer& buffer)
+  {
+    // Telemetry updates and bulk transfers are acknowledged with control frames, which only go to
+    // the link peer; anything else is taken from any node
+    const bool linked = !routed && source == this->linkPeer();
+    const U8 first = (buffer.getSize() > 0) ? buffer.getData()[0] : 0;
+
+    // F' frames start with their start word, never with any of the magics
+    if (pipe == streamPipe(RFStream::TELEMETRY) && buffer.getSize() > 0 &&
+        (first == RFTelemetry::MAGIC || first == RFTelemetry::FRAME_MAGIC)) {
+      if (first == RFTelemetry::MAGIC && !linked) {
+        m_tlmUpdatesDropped++;
+        this->deallocate_out(0, buffer);
+        return;
+      }
+      this->receiveTelemetry(buffer);
+    } else if (pipe == streamPipe(RFStream::FILE) && buffer.getSize() > 0 &&
+               (first == RFBulk::OFFER_MAGIC || first == RFBulk::DATA_MAGIC)) {
+      if (!linked) {
+        this->countRxDrop();
+        this->deallocate_out(0, buffer);
+        return;
+      }
+      this->receiveBulk(buffer);
+    } else {
+      this->deliver(buffer);
+    }
+  }
+
+  void RFCommManager ::
+    forwardMessage(U8 pipe, Fw::Buffer& buffer)
+  {
+    U8* const route = buffer.getData();
+    const bool valid = (pipe > CONTROL_PIPE && pipe <= streamPipe(RFStream::NUM_CONSTANTS - 1));
+    // The message was sent through here, taking one of its hops; the last one goes no further
+    if (!valid || route[2] <= 1) {
+      m_forwardDrops++;
+      this->deallocate_out(0, buffer);
+      return;
+    }
+    route[2]--;
+    if (!m_peers.queueForward(route[1], buffer, static_cast<U8>(pipe - streamPipe(0)))) {
+      m_forwardDrops++;
+      this->deallocate_out(0, buffer);
+      return;
+    }
+    this->pumpTx();
+  }
+
+  void RFCommManager ::
+    fillForward()
+  {
+    if (m_peers.forwardCount() == 0) {
+      return;
+    }
+    // Each next hop has queues of its own, an origin waits only on the one its message goes to
+    Fw::Buffer buffer;
+    U8 stream = 0;
+    U8 node = 0;
+    while (m_peers.takeForward((1U << RFStream::NUM_CONSTANTS) - 1, buffer, stream, node)) {
+      this->pushForward(stream, node, buffer);
+    }
+  }
+
+  bool RFCommManager ::
+    forwardOne(U32 stream)
+  {
+    Fw::Buffer buffer;
+    U8 taken = 0;
+    U8 node = 0;
+    if (!m_peers.takeForward(1U << stream, buffer, taken, node)) {
+      return false;
+    }
+    this->pushForward(stream, node, buffer);
+    return true;
+  }
+
+  void RFCommManager ::
+    pushForward(U32 stream, U8 node, Fw::Buffer& buffer)
+  {
+    RFSession::TxMessage* const message = this->queueTx(stream, buffer.getSize(), node);
+    FW_ASSERT(message != nullptr, stream);
+    // Route header and all, straight out of the reassembly buffer
+    message->buffer = buffer;
+    message->data = buffer.getData();
+    message->routed = true;
+    m_messagesForwarded++;
+  }
+
+  void RFCommManager ::
+    heardFrom(U8 node)
+  {
+    if (m_peers.heard(node)) {
+      m_peersUp++;
+      this->log_ACTIVITY_LO_PeerUp(node);
+    }
+  }
+
+  void RFCommManager ::
+    agePeers()
+  {
+    for (U32 node = 0; node < RFRoute::MAX_NODES; node++) {
+      if (m_peers.age(static_cast<U8>(node))) {
+        FW_ASSERT(m_peersUp > 0);
+        m_peersUp--;
+        this->log_WARNING_LO_PeerDown(static_cast<U8>(node));
+      }
+    }
+  }
+
+  void RFCommManager ::
+    sendTelemetry()
+  {
+    if (m_tlmMode == RFTelemetryMode::FRAMES) {
+      this->sendTelemetryFrames();
+      return;
+    }
+
+    // One update in flight: the peer only keeps the last one it applied, an acknowledgment of an
+    // update since superseded would be of no use
+    if (m_tlmEncoder.awaitingAck() && m_tlmAckWait < TLM_ACK_TIMEOUT_TICKS) {
+      m_tlmAckWait++;
+      return;
+    }
+    m_tlmAckWait = 0;
+
+    // A full queue means the link is behind, the next run period's update covers this one's channels
+    RFSession::TxQueue& queue = m_peers.session(this->linkPeer()).queues[RFStream::TELEMETRY];
+    if (queue.count == TX_QUEUE_DEPTH) {
+      return;
+    }
+
+    const bool keyframe = (m_tlmSinceKeyframe == 0);
+    m_tlmLock.lock();
+    const U32 channels = m_tlmEncoder.channels();
+    const U32 plainBytes = (channels > 0) ? m_tlmEncoder.snapshot(keyframe, this->getTime()) : 0;
+    m_tlmLock.unLock();
+    if (channels == 0) {
+      return;
+    }
+    m_tlmSinceKeyframe = (m_tlmSinceKeyframe + 1) % m_tlmKeyframeInterval;
+
+    // Parts are encoded straight into the storage of the slot queueTx hands out next. Whatever does
+    // not fit the queue is dropped with the update, the next one is taken against the same base.
+    U32 encodedBytes = 0;
+    while (queue.count < TX_QUEUE_DEPTH) {
+      RFSession::TxMessage& next = queue.messages[(queue.head + queue.count) % TX_QUEUE_DEPTH];
+      U32 partChannels = 0;
+      const U32 size = m_tlmEncoder.encodePart(next.storage, TLM_PART_SIZE, partChannels);
+      if (size == 0) {
+        break;
+      }
+      RFSession::TxMessage* const message = this->queueTx(RFStream::TELEMETRY, size, this->linkPeer());
+      FW_ASSERT(message == &next);
+      message->data = message->storage;
+      encodedBytes += size;
+      m_tlmChannelsSent += partChannels;
+    }
+
+    if (encodedBytes > 0) {
+      this->tlmWrite_TlmCompression(static_cast<F32>(plainBytes) / static_cast<F32>(encodedBytes));
+      this->pumpTx();
+    }
+  }
+
+  void RFCommManager ::
+    sendTelemetryFrames()
+  {
+    // One fragment per frame, so each message goes out whole or not at all and skips reassembly.
+    // A routed message carries the route header in its fragment too. The queue's free slots are
+    // this run tick's budget.
+    static_assert(TX_QUEUE_DEPTH <= RFTelemetry::MAX_FRAMES, "A packing fills at most MAX_FRAMES");
+    static_assert(RFFragment::FRAGMENT_DATA_SIZE <= RFTelemetry::MAX_FRAME_SIZE, "Frames fit a fragment");
+    const U32 frameSize = (this->linkPeer() != m_destination) ? RFFragment::FRAGMENT_DATA_SIZE - RFRoute::HEADER_SIZE
+                                                                : RFFragment::FRAGMENT_DATA_SIZE;
+    const RFSession::TxQueue& queue = m_peers.session(this->linkPeer()).queues[RFStream::TELEMETRY];
+    const U32 budget = TX_QUEUE_DEPTH - queue.count;
+    if (budget == 0) {
+      return;
+    }
+
+    U32 sizes[TX_QUEUE_DEPTH];
+    U32 channels = 0;
+    U32 plainBytes = 0;
+    m_tlmLock.lock();
+    const U32 frames = m_tlmEncoder.packFrames(this->getTime(), &m_tlmFrames[0][0], frameSize, budget,
+                                               sizes, channels, plainBytes);
+    m_tlmLock.unLock();
+    if (frames == 0) {
+      return;
+    }
+
+    U32 encodedBytes = 0;
+    for (U32 i = 0; i < frames; i++) {
+      RFSession::TxMessage* const message = this->pushTx(RFStream::TELEMETRY, sizes[i]);
+      FW_ASSERT(message != nullptr);
+      FW_ASSERT(message->count == 1, message->count);
+      std::memcpy(message->storage, &m_tlmFrames[0][0] + i * frameSize, sizes[i]);
+      message->data = message->storage;
+      encodedBytes += sizes[i];
+    }
+    m_tlmFramesSent += frames;
+    m_tlmChannelsSent += channels;
+    this->tlmWrite_TlmCompression(static_cast<F32>(plainBytes) / static_cast<F32>(encodedBytes));
+    this->pumpTx();
+  }
+
+  void RFCommManager ::
+    receiveTelemetry(Fw::Buffer& buffer)
+  {
+    m_messagesReceived++;
+    RFTelemetryDecoder::Status status = m_tlmDecoder.start(buffer.getData(), buffer.getSize());
+    if (status == RFTelemetryDecoder::PART_OK) {
+      FwChanIdType id = 0;
+      Fw::Time time;
+      const U8* value = nullptr;
+      U32 size = 0;
+      while (m_tlmDecoder.next(id, time, value, size)) {
+        // Values are at most RFTelemetry::MAX_VALUE_SIZE, they fit a telemetry buffer and an empty packet
+        Fw::TlmBuffer tlmBuffer;
+        Fw::SerializeStatus serStatus = tlmBuffer.setBuff(value, size);
+        FW_ASSERT(serStatus == Fw::FW_SERIALIZE_OK, serStatus);
+        if (m_tlmPacket.addValue(id, time, tlmBuffer) != Fw::FW_SERIALIZE_OK) {
+          this->flushTlmPacket();
+          serStatus = m_tlmPacket.addValue(id, time, tlmBuffer);
+          FW_ASSERT(serStatus == Fw::FW_SERIALIZE_OK, serStatus);
+        }
+      }
+      status = m_tlmDecoder.finish();
+    }
+    this->deallocate_out(0, buffer);
+
+    // Channels applied before an error are still good, they are sent either way
+    this->flushTlmPacket();
+    if (status == RFTelemetryDecoder::UPDATE_DONE) {
+      this->sendTlmAck(m_tlmDecoder.ackSeq());
+    } else if (status != RFTelemetryDecoder::PART_OK) {
+      m_tlmUpdatesDropped++;
+    }
+  }
+
+  void RFCommManager ::
+    flushTlmPacket()
+  {
+    if (m_tlmPacket.getNumEntries() == 0) {
+      return;
+    }
+    Fw::ComBuffer& packet = m_tlmPacket.getBuffer();
+    const U32 frameSize = static_cast<U32>(Svc::FpFrameHeader::SIZE + packet.getBuffLength() + HASH_DIGEST_LENGTH);
+    m_tlmFrame = this->allocate_out(0, frameSize);
+    if (m_tlmFrame.getData() == nullptr || m_tlmFrame.getSize() < frameSize) {
+      if (m_tlmFrame.getData() != nullptr) {
+        this->deallocate_out(0, m_tlmFrame);
+      }
+      m_tlmFrame = Fw::Buffer();
+      this->countRxDrop();
+    } else {
+      // The packet carries its own descriptor
+      m_framing.frame(packet.getBuffAddr(), static_cast<U32>(packet.getBuffLength()), Fw::ComPacket::FW_PACKET_UNKNOWN);
+    }
+    m_tlmPacket.resetPktSer();
+  }
+
+  void RFCommManager ::
+    sendTlmAck(U8 seq)
+  {
+    // A lost acknowledgment only costs the sender deltas against an older base
+    if (!this->hasCredit()) {
+      return;
+    }
+    U8* const ack = this->claimFrame();
+    ack[0] = RFFragment::TLM_ACK;
+    ack[1] = seq;
+    this->sendFrame(ack, RFFragment::TLM_ACK_FRAME_SIZE, true, CONTROL_PIPE, this->linkPeer());
+  }
+
+  void RFCommManager ::
+    receiveTlmAck(const U8* frame, FwSizeType length)
+  {
+    if (length < RFFragment::TLM_ACK_FRAME_SIZE) {
+      this->countRxDrop();
+      return;
+    }
+    m_tlmEncoder.acknowledge(frame[1]);
+  }
+
+  void RFCommManager ::
+    fillBulk()
+  {
+    if (!m_bulkSending) {
+      return;
+    }
+
+    // The FILE stream is kept full, so the chunks go out back to back at whatever its turns and
+    // the link give it. Chunks are read straight into the slot queueTx hands out next.
+    RFSession::TxQueue& queue = m_peers.session(this->linkPeer()).queues[RFStream::FILE];
+    while (queue.count < TX_QUEUE_DEPTH) {
+      RFSession::TxMessage& next = queue.messages[(queue.head + queue.count) % TX_QUEUE_DEPTH];
+      U32 size = 0;
+      if (m_bulkOfferDue) {
+        const U32 length = static_cast<U32>(std::strlen(m_bulkDestination));
+        next.storage[0] = RFBulk::OFFER_MAGIC;
+        next.storage[1] = m_bulkTransfer;
+        RFBulk::put32(&next.storage[2], m_bulkSource.fileId());
+        RFBulk::put32(&next.storage[6], m_bulkSource.size());
+        next.storage[10] = static_cast<U8>(length);
+        std::memcpy(&next.storage[RFBulk::OFFER_HEADER_SIZE], m_bulkDestination, length);
+        size = RFBulk::OFFER_HEADER_SIZE + length;
+        m_bulkOfferDue = false;
+      } else {
+        if (!m_bulkOffered) {
+          break;
+        }
+        m_bulkCursor = m_bulkHeld.firstMissing(m_bulkCursor);
+        if (m_bulkCursor == m_bulkHeld.chunks()) {
+          m_bulkRewind = (m_bulkRewind == 0) ? BULK_REWIND_TICKS : m_bulkRewind;
+          break;
+        }
+        const U32 offset = m_bulkCursor * RFBulk::CHUNK_SIZE;
+        const U32 length = RFBulk::chunkLength(m_bulkSource.size(), m_bulkCursor);
+        if (!m_bulkSource.read(offset, &next.storage[RFBulk::DATA_HEADER_SIZE], length)) {
+          this->log_WARNING_HI_BulkReadFailed(Fw::LogStringArg(m_bulkSourcePath), offset);
+          this->stopBulk();
+          break;
+        }
+        next.storage[0] = RFBulk::DATA_MAGIC;
+        next.storage[1] = m_bulkTransfer;
+        RFBulk::put32(&next.storage[2], m_bulkCursor);
+        size = RFBulk::DATA_HEADER_SIZE + length;
+        m_bulkCursor++;
+        m_bulkBytes += length;
+      }
+      RFSession::TxMessage* const message = this->queueTx(RFStream::FILE, size, this->linkPeer());
+      FW_ASSERT(message == &next);
+      message->data = message->storage;
+    }
+  }
+
+  void RFCommManager ::
+    stopBulk()
+  {
+    m_bulkSource.close();
+    m_bulkSending = false;
+    m_bulkOfferDue = false;
+  }
+
+  void RFCommManager ::
+    receiveBulkAck(const U8* frame, FwSizeType length)
+  {
+    if (length < RFFragment::BULK_ACK_FRAME_SIZE) {
+      this->countRxDrop();
+      return;
+    }
+    // Acknowledgments of an earlier transfer may still be on their way
+    if (!m_bulkSending || frame[1] != m_bulkTransfer) {
+      return;
+    }
+    const U32 base = RFBulk::get32(&frame[2]);
+    if (base == RFBulk::REFUSED) {
+      this->log_WARNING_HI_BulkRefused(Fw::LogStringArg(m_bulkDestination));
+      this->stopBulk();
+      return;
+    }
+
+    m_bulkAckAge = 0;
+    U32 chunk = m_bulkHeld.firstMissing(0);
+    while (chunk < base && chunk < m_bulkHeld.chunks()) {
+      (void)m_bulkHeld.set(chunk);
+      chunk = m_bulkHeld.firstMissing(chunk + 1);
+    }
+    m_bulkHeld.copyIn(RFBulk::get32(&frame[6]), &frame[10], RFFragment::BULK_BITMAP_SIZE);
+
+    if (m_bulkHeld.complete()) {
+      Os::RawTime now;
+      U32 elapsedUs = 0;
+      if (now.now() != Os::RawTime::OP_OK || now.getDiffUsec(m_bulkStartedAt, elapsedUs) != Os::RawTime::OP_OK) {
+        elapsedUs = 0;
+      }
+      m_bulkProgress = m_bulkSource.size();
+      this->log_ACTIVITY_HI_BulkDownlinkDone(Fw::LogStringArg(m_bulkDestination), m_bulkSource.size(),
+                                             elapsedUs / 1000000);
+      this->stopBulk();
+      return;
+    }
+
+    // The first answer to an offer lets the chunks go, from the first one the peer lacks
+    if (!m_bulkOffered) {
+      m_bulkOffered = true;
+      m_bulkCursor = 0;
+      m_bulkRewind = 0;
+      this->pumpTx();
+    }
+  }
+
+  void RFCommManager ::
+    receiveBulk(Fw::Buffer& buffer)
+  {
+    m_messagesReceived++;
+    if (buffer.getData()[0] == RFBulk::OFFER_MAGIC) {
+      this->receiveBulkOffer(buffer.getData(), buffer.getSize());
+    } else {
+      this->receiveBulkChunk(buffer.getData(), buffer.getSize());
+    }
+    this->deallocate_out(0, buffer);
+  }
+
+  void RFCommManager ::
+    receiveBulkOffer(const U8* data, FwSizeType size)
+  {
+    if (size < RFBulk::OFFER_HEADER_SIZE) {
+      this->countRxDrop();
+      return;
+    }
+    const U8 transfer = data[1];
+    const U32 fileId = RFBulk::get32(&data[2]);
+    const U32 fileSize = RFBulk::get32(&data[6]);
+    const U32 length = data[10];
+    if (length == 0 || length > RFBulk::MAX_PATH_SIZE || size < RFBulk::OFFER_HEADER_SIZE + length) {
+      this->countRxDrop();
+      return;
+    }
+    // Any node on the channel can offer, it only gets to write below the receive directory
+    if (!RFBulk::confinedPath(&data[RFBulk::OFFER_HEADER_SIZE], length)) {
+      char rejected[RFBulk::MAX_PATH_SIZE + 1];
+      std::memcpy(rejected, &data[RFBulk::OFFER_HEADER_SIZE], length);
+      rejected[length] = '\0';
+      this->log_WARNING_HI_BulkOfferRejected(Fw::LogStringArg(rejected));
+      this->sendBulkRefusal(transfer);
+      return;
+    }
+
+    // Offered again, the sender lost track of what this end holds
+    if (m_bulkRxState != BULK_IDLE && transfer == m_bulkRxTransfer && fileId == m_bulkSink.fileId()) {
+      m_bulkSweep = 0;
+      m_bulkIdle = 0;
+      this->sendBulkAcks();
+      return;
+    }
+
+    if (m_bulkRxState == BULK_RECEIVING) {
+      m_bulkSink.close();
+    }
+    m_bulkRxState = BULK_IDLE;
+    m_bulkRxTransfer = transfer;
+    std::memcpy(m_bulkRxPath, &data[RFBulk::OFFER_HEADER_SIZE], length);
+    m_bulkRxPath[length] = '\0';
+    const I32 error = m_bulkSink.open(m_bulkRxPath, fileId, fileSize);
+    if (error != 0) {
+      this->log_WARNING_HI_BulkWriteFailed(Fw::LogStringArg(m_bulkRxPath), error);
+      this->sendBulkRefusal(transfer);
+      return;
+    }
+
+    m_bulkRxState = BULK_RECEIVING;
+    m_bulkLastChunk = 0;
+    m_bulkSweep = 0;
+    m_bulkSinceAck = 0;
+    m_bulkIdle = 0;
+    m_bulkRate = 0.0f;
+    m_bulkProgress = m_bulkSink.map().bytesHeld(fileSize);
+    this->log_ACTIVITY_HI_BulkReceiveStarted(Fw::LogStringArg(m_bulkRxPath), fileSize, m_bulkProgress);
+    if (m_bulkSink.map().complete()) {
+      this->finishBulkReceive();
+    }
+    this->sendBulkAcks();
+  }
+
+  void RFCommManager ::
+    receiveBulkChunk(const U8* data, FwSizeType size)
+  {
+    if (size < RFBulk::DATA_HEADER_SIZE) {
+      this->countRxDrop();
+      return;
+    }
+    // Chunks of a transfer never offered here, or of one given up
+    if (m_bulkRxState == BULK_IDLE || data[1] != m_bulkRxTransfer) {
+      this->countRxDrop();
+      return;
+    }
+    const RFBulkChunkMap& map = m_bulkSink.map();
+    const U32 chunk = RFBulk::get32(&data[2]);
+    const FwSizeType length = size - RFBulk::DATA_HEADER_SIZE;
+    if (chunk >= map.chunks() || length != RFBulk::chunkLength(m_bulkSink.size(), chunk)) {
+      this->countRxDrop();
+      return;
+    }
+
+    m_bulkIdle = 0;
+    if (m_bulkRxState == BULK_RECEIVING && !map.test(chunk)) {
+      const I32 error = m_bulkSink.write(chunk, &data[RFBulk::DATA_HEADER_SIZE], static_cast<U32>(length));
+      if (error != 0) {
+        this->log_WARNING_HI_BulkWriteFailed(Fw::LogStringArg(m_bulkRxPath), error);
+        m_bulkSink.close();
+        m_bulkRxState = BULK_IDLE;
+        this->sendBulkRefusal(m_bulkRxTransfer);
+        return;
+      }
+      m_bulkLastChunk = chunk;
+      m_bulkBytes += static_cast<U32>(length);
+      if (map.complete()) {
+        this->finishBulkReceive();
+        this->sendBulkAcks();
+        return;
+      }
+    }
+    // Duplicates count too, they mean the sender has not heard what this end holds
+    m_bulkSinceAck++;
+    if (m_bulkSinceAck >= BULK_ACK_EVERY) {
+      this->sendBulkAcks();
+    }
+  }
+
+  void RFCommManager ::
+    finishBulkReceive()
+  {
+    m_bulkSink.finish();
+    m_bulkRxState = BULK_RECEIVED;
+    m_bulkProgress = m_bulkSink.size();
+    this->log_ACTIVITY_HI_BulkReceived(Fw::LogStringArg(m_bulkRxPath), m_bulkSink.size());
+  }
+
+  void RFCommManager ::
+    sendBulkAcks()
+  {
+    // A lost acknowledgment is made up by the next one, the bitmap is the whole state
+    if (!this->hasCredit()) {
+      return;
+    }
+    m_bulkSinceAck = 0;
+    const RFBulkChunkMap& map = m_bulkSink.map();
+    const U32 window = RFFragment::BULK_BITMAP_SIZE * 8;
+    this->sendBulkAck((m_bulkLastChunk + 1 > window) ? m_bulkLastChunk + 1 - window : 0);
+
+    // After an offer the sender only knows what the last chunks told it. The sweep walks the runs of
+    // chunks held past the first missing one, so a resumed transfer skips what landed before.
+    const U32 base = map.firstMissing(0);
+    for (U32 i = 0; i < BULK_SWEEP_ACKS && m_bulkSweep < map.chunks() && this->hasCredit(); i++) {
+      m_bulkSweep = map.firstHeld((m_bulkSweep > base) ? m_bulkSweep : base);
+      if (m_bulkSweep == map.chunks()) {
+        break;
+      }
+      this->sendBulkAck(m_bulkSweep);
+      m_bulkSweep = (map.chunks() - m_bulkSweep > window) ? m_bulkSweep + window : map.chunks();
+    }
+  }
+
+  void RFCommManager ::
+    sendBulkAck(U32 from)
+  {
+    const RFBulkChunkMap& map = m_bulkSink.map();
+    U8* const ack = this->claimFrame();
+    ack[0] = RFFragment::BULK_ACK;
+    ack[1] = m_bulkRxTransfer;
+    RFBulk::put32(&ack[2], map.firstMissing(0));
+    RFBulk::put32(&ack[6], from);
+    map.copyOut(from, &ack[10], RFFragment::BULK_BITMAP_SIZE);
+    this->sendFrame(ack, RFFragment::BULK_ACK_FRAME_SIZE, true, CONTROL_PIPE, this->linkPeer());
+  }
+
+  void RFCommManager ::
+    sendBulkRefusal(U8 transfer)
+  {
+    // The sender offers again after BULK_STALL_TICKS if this one is lost
+    if (!this->hasCredit()) {
+      return;
+    }
+    U8* const ack = this->claimFrame();
+    std::memset(ack, 0, RFFragment::BULK_ACK_FRAME_SIZE);
+    ack[0] = RFFragment::BULK_ACK;
+    ack[1] = transfer;
+    RFBulk::put32(&ack[2], RFBulk::REFUSED);
+    this->sendFrame(ack, RFFragment::BULK_ACK_FRAME_SIZE, true, CONTROL_PIPE, this->linkPeer());
+  }
+
+  void RFCommManager ::
+    runBulk()
+  {
+    if (m_bulkSending) {
+      // A peer silent for a while may have lost the transfer, or restarted. It answers the offer
+      // from its resume record.
+      m_bulkAckAge++;
+      if (m_bulkAckAge >= BULK_STALL_TICKS) {
+        m_bulkAckAge = 0;
+        m_bulkOffered = false;
+        m_bulkOfferDue = true;
+      } else if (m_bulkRewind > 0) {
+        m_bulkRewind--;
+        m_bulkCursor = (m_bulkRewind == 0) ? 0 : m_bulkCursor;
+      }
+    }
+
+    if (m_bulkRxState == BULK_RECEIVING) {
+      m_bulkIdle++;
+      if (m_bulkIdle >= BULK_IDLE_TICKS) {
+        // The record stays for a later offer of the same file
+        m_bulkSink.close();
+        m_bulkRxState = BULK_IDLE;
+      } else {
+        m_bulkSink.save();
+        this->sendBulkAcks();
+      }
+    }
+  }
+
+  void RFCommManager ::
+    reportBulk()
+  {
+    Os::RawTime now;
+    if (now.now() != Os::RawTime::OP_OK) {
+      return;
+    }
+    U32 elapsedUs = 0;
+    const bool elapsed = m_bulkReportAtValid && now.getDiffUsec(m_bulkReportAt, elapsedUs) == Os::RawTime::OP_OK &&
+                         elapsedUs > 0;
+    m_bulkReportAt = now;
+    m_bulkReportAtValid = true;
+    const U32 bytes = m_bulkBytes;
+    m_bulkBytes = 0;
+
+    U32 size = 0;
+    if (m_bulkSending) {
+      size = m_bulkSource.size();
+      m_bulkProgress = m_bulkHeld.bytesHeld(size);
+    } else if (m_bulkRxState == BULK_RECEIVING) {
+      size = m_bulkSink.size();
+      m_bulkProgress = m_bulkSink.map().bytesHeld(size);
+    } else {
+      m_bulkRate = 0.0f;
+    }
+
+    U32 eta = 0;
+    if (size > 0 && elapsed) {
+      const F32 rate = static_cast<F32>(bytes) * 1000000.0f / static_cast<F32>(elapsedUs);
+      m_bulkRate = (m_bulkRate == 0.0f) ? rate : (0.75f * m_bulkRate + 0.25f * rate);
+      if (m_bulkRate > 0.0f) {
+        eta = static_cast<U32>(static_cast<F32>(size - m_bulkProgress) / m_bulkRate + 0.5f);
+      }
+    }
+    this->tlmWrite_BulkProgress(m_bulkProgress);
+    this->tlmWrite_BulkRate(m_bulkRate);
+    this->tlmWrite_BulkEta(eta);
+  }
+
+  void RFCommManager ::
+    countRxDrop()
+  {
+    m_rxDropped++;
+  }
+
+  void RFCommManager ::
+    reportArq()
+  {
+    Os::RawTime now;
+    if (now.now() != Os::RawTime::OP_OK) {
+      return;
+    }
+    U32 elapsedUs = 0;
+    if (m_reportStartValid && now.getDiffUsec(m_reportStart, elapsedUs) == Os::RawTime::OP_OK && elapsedUs > 0) {
+      this->tlmWrite_ArqGoodput(static_cast<F32>(m_arqBytesAcked) * 1000000.0f / static_cast<F32>(elapsedUs));
+      const F32 ratio = (m_arqTransmissions == 0) ? 0.0f :
+          static_cast<F32>(m_arqRetransmissions) / static_cast<F32>(m_arqTransmissions);
+      this->tlmWrite_ArqRetransmitRatio(ratio);
+
+      if (m_autoHopPercent > 0 && m_arqEnabled && m_hopHoldoff == 0 &&
+          m_arqTransmissions >= AUTO_HOP_MIN_TRANSMISSIONS &&
+          ratio * 100.0f >= static_cast<F32>(m_autoHopPercent)) {
+        (void)this->requestSurvey(AUTO_HOP_DWELLS);
+      }
+    }
+    m_reportStart = now;
+    m_reportStartValid = true;
+    m_arqBytesAcked = 0;
+    m_arqTransmissions = 0;
+    m_arqRetransmissions = 0;
+
+    U32 occupancy = 0;
+    for (U32 k = 0; k < m_peers.sessionCount(); k++) {
+      occupancy += this->windowOccupancy(m_peers.session(m_peers.sessionAt(k)));
+    }
+    const RFSession::Session& session = m_peers.session(this->linkPeer());
+    this->tlmWrite_ArqWindowOccupancy(occupancy);
+    this->tlmWrite_ArqRtt(session.srttUs);
+    this->tlmWrite_ArqRto(session.rtoUs);
+    this->tlmWrite_ArqRttHistogram(m_rttHistogram.take());
+  }
+
+  void RFCommManager ::
+    reportStreams()
+  {
+    RFStreamValues depth;
+    RFStreamValues latency;
+    RFStreamValues queueDelay;
+    RFStreamValues expired;
+    for (U32 i = 0; i < RFStream::NUM_CONSTANTS; i++) {
+      depth[i] = m_txStreams[i].count;
+      latency[i] = m_txStreams[i].latencyUs;
+      queueDelay[i] = m_txStreams[i].queueDelayUs;
+      expired[i] = m_txStreams[i].expired;
+      m_txStreams[i].queueDelayUs = 0;
+    }
+    this->tlmWrite_StreamDepth(depth);
+    this->tlmWrite_StreamLatency(latency);
+    this->tlmWrite_StreamQueueDelay(queueDelay);
+    this->tlmWrite_StreamExpired(expired);
+
+    // The frames the driver took over a run period it was never left waiting for one are what the link
+    // carries. A period with credits left over only bounds it from below, and when a bucket was what
+    // left them over the estimate probes higher, or shares of a low one would keep it low. Probes stop
+    // at twice the best period seen, a saturated period then brings an overshoot back in a few steps.
+    Os::RawTime now;
+    if (now.now() != Os::RawTime::OP_OK) {
+      return;
+    }
+    const U32 taken = m_framesHanded - this->framesInDriver();
+    U32 elapsedUs = 0;
+    if (m_linkStartValid && now.getDiffUsec(m_linkStart, elapsedUs) == Os::RawTime::OP_OK && elapsedUs > 0) {
+      const U32 rate = static_cast<U32>(static_cast<U64>(taken - m_linkTaken) * 1000000 / elapsedUs);
+      m_linkPeak = (rate > m_linkPeak) ? rate : m_linkPeak;
+      if (!m_linkIdle) {
+        m_linkCapacity = (m_linkCapacity == 0) ? rate : (3 * (m_linkCapacity / 4) + rate / 4);
+      } else if (m_linkThrottled) {
+        const U32 probe = m_linkCapacity + m_linkCapacity / 8 + 1;
+        const U32 ceiling = 2 * m_linkPeak;
+        m_linkCapacity = (probe < ceiling) ? probe : ceiling;
+        m_linkCapacity = (rate > m_linkCapacity) ? rate : m_linkCapacity;
+      } else {
+        m_linkCapacity = (rate > m_linkCapacity) ? rate : m_linkCapacity;
+      }
+    }
+    m_linkStart = now;
+    m_linkStartValid = true;
+    m_linkTaken = taken;
+    m_linkIdle = false;
+    m_linkThrottled = false;
+    this->tlmWrite_LinkCapacity(m_linkCapacity);
+  }
+
+  void RFCommManager ::
+    reportTraffic()
+  {
+    this->tlmWrite_MessagesSent(m_messagesSent);
+    this->tlmWrite_FragmentsSent(m_fragmentsSent);
+    this->tlmWrite_TxDropped(m_txDropped);
+    this->tlmWrite_MessagesReceived(m_messagesReceived);
+    this->tlmWrite_ReassemblyTimeouts(m_reassemblyTimeouts);
+    this->tlmWrite_RxDropped(m_rxDropped);
+    this->tlmWrite_FecRecovered(m_fecRecovered);
+    this->tlmWrite_FecUnrecoverable(m_fecUnrecoverable);
+    this->tlmWrite_PeersUp(m_peersUp);
+    this->tlmWrite_MessagesForwarded(m_messagesForwarded);
+    this->tlmWrite_ForwardDrops(m_forwardDrops);
+
+    U32 frames = 0;
+    U32 most = 0;
+    for (U32 radio = 0; radio < RFBond::MAX_RADIOS; radio++) {
+      frames += m_radios[radio].frames;
+      most = (m_radios[radio].frames > most) ? m_radios[radio].frames : most;
+    }
+    // Bonded rings hold frames in proportion to what their radios took while all of them ran full,
+    // so a frame waits about as long on a slow radio as on a fast one, and a slow radio holds the
+    // others back less. A light load tells nothing of what a radio takes, the rings go back to
+    // the full depth and take turns.
+    RFRadioValues share;
+    for (U32 radio = 0; radio < RFBond::MAX_RADIOS; radio++) {
+      Radio& state = m_radios[radio];
+      share[radio] = (frames > 0) ? static_cast<U32>(static_cast<U64>(state.frames) * 100 / frames) : 0;
+      if (!m_bondFull) {
+        state.depth = RFBond::RADIO_DEPTH;
+      } else if (most > 0) {
+        const U32 depth = static_cast<U32>(static_cast<U64>(state.frames) * RFBond::RADIO_DEPTH / most);
+        state.depth = (depth > RFBond::MIN_RADIO_DEPTH) ? depth : RFBond::MIN_RADIO_DEPTH;
+      }
+      state.frames = 0;
+    }
+    m_bondFull = false;
+    m_bondGaps += m_reorder.takeGaps();
+    this->tlmWrite_RadioShare(share);
+    this->tlmWrite_RadioSkew(m_reorder.takeLongestHold());
+    this->tlmWrite_BondGaps(m_bondGaps);
+
+    m_tlmLock.lock();
+    const U32 rejected = m_tlmRejected;
+    m_tlmLock.unLock();
+    this->tlmWrite_TlmChannelsSent(m_tlmChannelsSent);
+    this->tlmWrite_TlmFramesSent(m_tlmFramesSent);
+    this->tlmWrite_TlmChannelsRejected(rejected);
+    this->tlmWrite_TlmUpdatesDropped(m_tlmUpdatesDropped);
+  }
+
+  bool RFCommManager ::
+    requestSurvey(U8 dwells)
+  {
+    if (m_surveyPending || m_hopActive || !this->isConnected_surveyRequest_OutputPort(0)) {
+      return false;
+    }
+    m_surveyPending = true;
+    m_surveyAge = 0;
+    // The radio is deaf while it sweeps, so a link that stays bad is not surveyed every run period
+    m_hopHoldoff = AUTO_HOP_HOLDOFF_TICKS;
+    this->surveyRequest_out(0, dwells);
+    return true;
+  }
+
+  void RFCommManager ::
+    startHop(U8 channel, const NRF24DataRate& rate, U8 power)
+  {
+    m_hopActive = true;
+    m_hopLeader = true;
+    m_hopAcked = false;
+    m_hopId++;
+    m_hopChannel = channel;
+    m_hopRate = rate;
+    m_hopPower = power;
+    m_hopCountdown = HOP_COUNTDOWN_TICKS;
+  }
+
+  void RFCommManager ::
+    runHop()
+  {
+    if (m_hopHoldoff > 0) {
+      m_hopHoldoff--;
+    }
+    if (m_surveyPending) {
+      m_surveyAge++;
+      m_surveyPending = (m_surveyAge <= SURVEY_TIMEOUT_TICKS);
+    }
+    if (!m_hopActive) {
+      return;
+    }
+
+    if (m_hopCountdown > 0) {
+      // Without a credit this tick's announcement is skipped, the next one carries the countdown
+      if (m_hopLeader && this->hasCredit(RFBond::PRIMARY_RADIO)) {
+        U8* const frame = this->claimFrame(RFBond::PRIMARY_RADIO);
+        frame[0] = RFFragment::HOP;
+        frame[1] = m_hopId;
+        frame[2] = m_hopChannel;
+        frame[3] = static_cast<U8>(m_hopCountdown);
+        frame[4] = static_cast<U8>(m_hopRate.e);
+        frame[5] = m_hopPower;
+        this->sendFrame(frame, RFFragment::HOP_FRAME_SIZE, true, CONTROL_PIPE, this->linkPeer());
+      }
+      m_hopCountdown--;
+      return;
+    }
+
+    m_hopActive = false;
+    if (m_hopLeader && !m_hopAcked) {
+      this->log_WARNING_LO_ChannelHopAborted(m_hopChannel);
+      return;
+    }
+    const U8 previousChannel = m_channel;
+    const NRF24DataRate previousRate = m_rate;
+    const U8 previousPower = m_power;
+    this->retune(m_hopChannel, m_hopRate, m_hopPower);
+
+    // The leader heard the peer through its acknowledgment, the peer has heard nothing since
+    // announcing a countdown and may be the only one to have moved
+    m_probation = HOP_CONFIRM_TICKS;
+    m_fallbackChannel = previousChannel;
+    m_fallbackRate = previousRate;
+    m_fallbackPower = previousPower;
+    m_heard = false;
+    m_confirmed = false;
+    this->sendHopAck(m_hopLeader ? m_hopId : m_peerHopId, m_channel, m_rate, m_power, true);
+  }
+
+  void RFCommManager ::
+    retune(U8 channel, const NRF24DataRate& rate, U8 power)
+  {
+    const U8 previousChannel = m_channel;
+    const NRF24DataRate previousRate = m_rate;
+    const U8 previousPower = m_power;
+    if (this->isConnected_tune_OutputPort(0)) {
+      this->tune_out(0, channel, rate, power);
+    }
+    m_settingsPending = true;
+    m_channel = channel;
+    m_rate = rate;
+    m_power = power;
+    if (m_channel != previousChannel) {
+      m_hops++;
+      this->tlmWrite_Channel(m_channel);
+      this->tlmWrite_Hops(m_hops);
+      this->log_ACTIVITY_HI_ChannelHop(previousChannel, m_channel);
+    }
+    if (m_rate != previousRate) {
+      this->tlmWrite_DataRate(m_rate);
+      this->log_ACTIVITY_HI_DataRateChange(previousRate, m_rate);
+      // Measured at the old rate, the streams go unshaped until the next run period measures it again
+      m_linkCapacity = 0;
+      m_linkPeak = 0;
+    }
+    if (m_power != previousPower) {
+      this->tlmWrite_PowerLevel(m_power);
+      this->log_ACTIVITY_HI_PowerLevelChange(previousPower, m_power);
+    }
+    m_probedUp = (m_rate.e > previousRate.e);
+    // Frames still in flight were lost to the old settings
+    this->resetAdaptation();
+  }
+
+  void RFCommManager ::
+    resetAdaptation()
+  {
+    m_adaptSent = 0;
+    m_adaptRetries = 0;
+    m_adaptFailures = 0;
+    m_adaptArqTransmissions = 0;
+    m_adaptArqRetransmissions = 0;
+  }
+
+  void RFCommManager ::
+    runProbation()
+  {
+    if (m_probation == 0) {
+      return;
+    }
+    if (m_confirmed) {
+      m_probation = 0;
+      return;
+    }
+    m_probation--;
+    if (m_probation > 0) {
+      this->sendHopAck(m_hopLeader ? m_hopId : m_peerHopId, m_channel, m_rate, m_power, true);
+      return;
+    }
+    // A peer that polled is on the new settings even if none of its answers got through
+    if (m_heard) {
+      return;
+    }
+
+    if (m_probedUp) {
+      this->backOffStepUp();
+    }
+    this->retune(m_fallbackChannel, m_fallbackRate, m_fallbackPower);
+    m_probedUp = false;
+    this->log_WARNING_LO_HopReverted(m_channel, m_rate, m_power);
+  }
+
+  void RFCommManager ::
+    adaptLink(U32 lossPercent)
+  {
+    const bool probedUp = m_probedUp;
+    m_probedUp = false;
+
+    if (lossPercent >= ADAPT_LOSS_HIGH_PERCENT) {
+      m_cleanPeriods = 0;
+      if (probedUp) {
+        this->backOffStepUp();
+      }
+      if (m_power < NRF24::MAX_POWER_LEVEL) {
+        this->startHop(m_channel, m_rate, static_cast<U8>(m_power + 1));
+      } else if (m_rate != NRF24DataRate::RATE_250KBPS) {
+        this->startHop(m_channel, static_cast<NRF24DataRate::T>(m_rate.e - 1), m_power);
+      }
+      return;
+    }
+    if (probedUp) {
+      m_stepUpPeriods = ADAPT_STEP_UP_PERIODS;
+    }
+    if (lossPercent > ADAPT_LOSS_LOW_PERCENT) {
+      m_cleanPeriods = 0;
+      return;
+    }
+
+    // Throughput first: the rate goes up at full power, the power only comes down at the top rate
+    m_cleanPeriods++;
+    if (m_cleanPeriods < m_stepUpPeriods) {
+      return;
+    }
+    m_cleanPeriods = 0;
+    if (m_rate != NRF24DataRate::RATE_2MBPS) {
+      this->startHop(m_channel, static_cast<NRF24DataRate::T>(m_rate.e + 1), m_power);
+    } else if (m_power > 0) {
+      this->startHop(m_channel, m_rate, static_cast<U8>(m_power - 1));
+    }
+  }
+
+  void RFCommManager ::
+    backOffStepUp()
+  {
+    // The faster rate did not hold, it is tried again after longer
+    m_stepUpPeriods = (2 * m_stepUpPeriods < ADAPT_MAX_STEP_UP_PERIODS) ? 2 * m_stepUpPeriods : ADAPT_MAX_STEP_UP_PERIODS;
+  }
+
+  void RFCommManager ::
+    sendHopAck(U8 id, U8 channel, const NRF24DataRate& rate, U8 power, bool poll)
+  {
+    if (!this->hasCredit(RFBond::PRIMARY_RADIO)) {
+      return;
+    }
+    U8* const ack = this->claimFrame(RFBond::PRIMARY_RADIO);
+    ack[0] = static_cast<U8>(RFFragment::HOP_ACK | (poll ? RFFragment::FLAG_POLL : 0));
+    ack[1] = id;
+    ack[2] = channel;
+    ack[3] = static_cast<U8>(rate.e);
+    ack[4] = power;
+    this->sendFrame(ack, RFFragment::HOP_ACK_FRAME_SIZE, true, CONTROL_PIPE, this->linkPeer());
+  }
+
+  void RFCommManager ::
+    receiveHop(const U8* frame, FwSizeType length)
+  {
+    if (length < RFFragment::HOP_FRAME_SIZE || frame[2] > NRF24::MAX_CHANNEL || frame[3] == 0 ||
+        frame[4] > NRF24DataRate::RATE_2MBPS || frame[5] > NRF24::MAX_POWER_LEVEL) {
+      this->countRxDrop();
+      return;
+    }
+    if (m_hopActive && m_hopLeader) {
+      // Both ends started a hop at once. Neither follows the other, so neither is acknowledged
+      // and both stay.
+      return;
+    }
+
+    const U8 id = frame[1];
+    const bool repeat = m_peerHopIdValid && id == m_peerHopId;
+    if (!repeat || m_hopActive) {
+      // The peer takes one off its countdown right after announcing it
+      m_hopActive = true;
+      m_hopLeader = false;
+      m_hopChannel = frame[2];
+      m_hopCountdown = frame[3] - 1U;
+      m_hopRate = static_cast<NRF24DataRate::T>(frame[4]);
+      m_hopPower = frame[5];
+      m_peerHopId = id;
+      m_peerHopIdValid = true;
+    }
+
+    // Every announcement is answered, repeats of a finished hop included
+    this->sendHopAck(id, frame[2], static_cast<NRF24DataRate::T>(frame[4]), frame[5], false);
+  }
+
+  void RFCommManager ::
+    receiveHopAck(const U8* frame, FwSizeType length)
+  {
+    if (length < RFFragment::HOP_ACK_FRAME_SIZE || frame[3] > NRF24DataRate::RATE_2MBPS ||
+        frame[4] > NRF24::MAX_POWER_LEVEL) {
+      this->countRxDrop();
+      return;
+    }
+    if ((frame[0] & RFFragment::FLAG_POLL) != 0) {
+      // The peer retuned and asks whether it is heard. Frames it sent before retuning can still
+      // come in after ours, only a poll on our settings shows it followed.
+      m_heard = m_heard || (m_probation > 0 && frame[2] == m_channel && frame[3] == m_rate.e && frame[4] == m_power);
+      this->sendHopAck(frame[1], frame[2], static_cast<NRF24DataRate::T>(frame[3]), frame[4], false);
+    } else if (m_hopActive && m_hopLeader && frame[1] == m_hopId && frame[2] == m_hopChannel &&
+               frame[3] == m_hopRate.e && frame[4] == m_hopPower) {
+      m_hopAcked = true;
+    } else if (m_probation > 0) {
+      m_confirmed = true;
+    }
+  }
+
 }
@@ -8,15 +8,128 @@
 #define Components_RFCommManager_HPP
 
 #include "Components/RFCommManager/RFCommManagerComponentAc.hpp"
+#include "Components/RFCommManager/RFBondReorder.hpp"
+#include "Components/RFCommManager/RFBulkTransfer.hpp"
+#include "Components/RFCommManager/RFFecCodec.hpp"
+#include "Components/RFCommManager/RFFragment.hpp"
+#include "Components/RFCommManager/RFPeerTable.hpp"
+#include "Components/RFCommManager/RFTelemetryCodec.hpp"
+#include "Components/NRF24Driver/NRF24FrameRing.hpp"
+#include "Components/NRF24Driver/NRF24TimeHistogram.hpp"
+
+#include <Fw/Tlm/TlmPacket.hpp>
+#include <Os/Mutex.hpp>
+#include <Os/RawTime.hpp>
+#include <Svc/FramingProtocol/FprimeProtocol.hpp>
+
+#include <atomic>
 
 namespace Components {
 
   class RFCommManager :
-    public RFCommManagerComponentBase
+    public RFCommManagerComponentBase,
+    public Svc::FramingProtocolInterface
   {
 
     public:
 
+      //! Frame buffers owned by the manager. Each one is a transmit credit: a fragment
+      //! only goes to the driver when a frame buffer is free, so the driver's pending
+      //! queue (NRF24Driver::TX_PENDING_DEPTH) never overflows.
+      static const U32 FRAME_POOL_SIZE = 8;
+
+      //! Messages each stream holds per neighbor waiting to be fragmented
+      static const U32 TX_QUEUE_DEPTH = RFSession::TX_QUEUE_DEPTH;
+
+      //! Messages reassembled concurrently, the peers' streams interleave theirs
+      static const U32 REASSEMBLY_SLOTS = 8;
+
+      //! Pipe of the ARQ acknowledgments and hop control, RFStream n goes out on pipe n + 1
+      static const U8 CONTROL_PIPE = 0;
+
+      //! Default reassembly timeout in run ticks
+      static const U32 DEFAULT_REASSEMBLY_TIMEOUT = 2;
+
+      //! ARQ window until SET_ARQ changes it
+      static const U32 DEFAULT_ARQ_WINDOW = 16;
+
+      //! In-order ARQ frames received before an ACK goes back; gaps, polls and message ends are acknowledged at once
+      static const U32 ARQ_ACK_EVERY = 4;
+
+      //! Retransmit timeout before the first RTT sample, and its bounds
+      static const U32 ARQ_INITIAL_RTO_US = 20000;
+      static const U32 ARQ_MIN_RTO_US = 2000;
+      static const U32 ARQ_MAX_RTO_US = 1000000;
+
+      //! Upper edge of the first ArqRttHistogram bucket
+      static const U32 ARQ_RTT_FIRST_EDGE_US = 250;
+
+      //! Largest multiple of the estimated timeout the backoff reaches
+      static const U32 ARQ_MAX_BACKOFF = 8;
+
+      //! Survey passes for an automatic hop; each pass dwells about 200 us on each of the 126 channels
+      static const U8 AUTO_HOP_DWELLS = 8;
+
+      //! Run ticks a hop is announced before both ends retune
+      static const U32 HOP_COUNTDOWN_TICKS = 3;
+
+      //! Run ticks a requested survey may take before it is given up, the driver refuses while transmitting
+      static const U32 SURVEY_TIMEOUT_TICKS = 2;
+
+      //! ARQ transmissions in a run period below which the retransmit ratio does not trigger a hop
+      static const U32 AUTO_HOP_MIN_TRANSMISSIONS = 16;
+
+      //! Run ticks after a survey request before the retransmit ratio may trigger another one
+      static const U32 AUTO_HOP_HOLDOFF_TICKS = 30;
+
+      //! Transmissions a link adaptation period gathers before its loss is judged
+      static const U32 ADAPT_MIN_TRANSMISSIONS = 32;
+
+      //! Loss in percent at or above which power goes up, then the rate down
+      static const U32 ADAPT_LOSS_HIGH_PERCENT = 20;
+
+      //! Loss in percent at or below which a period counts as clean
+      static const U32 ADAPT_LOSS_LOW_PERCENT = 5;
+
+      //! Clean periods in a row before the rate goes up, then the power down. Doubled after each
+      //! step up in rate that had to be taken back, up to the maximum.
+      static const U32 ADAPT_STEP_UP_PERIODS = 3;
+      static const U32 ADAPT_MAX_STEP_UP_PERIODS = 48;
+
+      //! Run ticks both ends wait to hear each other after a hop before going back
+      static const U32 HOP_CONFIRM_TICKS = 10;
+
+      //! Telemetry updates from one keyframe to the next until SET_TLM_KEYFRAME_INTERVAL changes it
+      static const U32 DEFAULT_TLM_KEYFRAME_INTERVAL = 10;
+
+      //! Run ticks an update waits for its TLM_ACK before the next one is taken against the same base
+      static const U32 TLM_ACK_TIMEOUT_TICKS = 2;
+
+      //! Largest part of a telemetry update, one TX queue message
+      static const U32 TLM_PART_SIZE = FW_COM_BUFFER_MAX_SIZE;
+
+      //! Longest stream deadline SET_STREAM_DEADLINE takes
+      static const U32 MAX_STREAM_DEADLINE_MS = 60000;
+
+      //! New chunks a bulk receiver takes before a BULK_ACK goes back, besides one per run tick
+      static const U32 BULK_ACK_EVERY = 4;
+
+      //! BULK_ACK frames a bulk receiver adds to each one to sweep its bitmap after an offer
+      static const U32 BULK_SWEEP_ACKS = 4;
+
+      //! Run ticks a bulk sender goes without a BULK_ACK before it stops and offers again
+      static const U32 BULK_STALL_TICKS = 3;
+
+      //! Run ticks a bulk sender waits after a pass over the file before sending the chunks still
+      //! missing, so the ones in flight are acknowledged first
+      static const U32 BULK_REWIND_TICKS = 2;
+
+      //! Run ticks a bulk receiver waits for an offer or a chunk before it closes the destination
+      static const U32 BULK_IDLE_TICKS = 30;
+
+      //! Parity frames held for blocks still short of fragments, over all reassembly slots
+      static const U32 FEC_PARITY_SLOTS = 32;
+
       // ----------------------------------------------------------------------
       // Component construction and destruction
       // ----------------------------------------------------------------------
@@ -29,20 +142,815 @@ namespace Components {
       //! Destroy RFCommManager object
       ~RFCommManager();
 
+      //! Exchange frames with an NRF24Driver through shared rings instead of frameOut and frameIn. Each
+      //! call adds a radio, bonded with the ones before it; its ring ports are the ones at the radio's
+      //! index, and the first one is the radio hops, surveys and link adaptation go to.
+      void attachRings(
+          NRF24FrameRing& txRing, //!< Frames to transmit, produced here
+          NRF24FrameRing& rxRing //!< Received frames, consumed here
+      );
+
+      //! Let bulk transfers from the peer land in a directory, before the component starts. Offers
+      //! are refused without one, and offered paths are taken relative to it.
+      void configureBulkReceive(
+          const char* directory //!< Existing directory, at most RFBulk::MAX_DIRECTORY_SIZE characters
+      );
+
     PRIVATE:
 
+      //! How one RFStream shares the link, its messages are queued per neighbor (see RFPeerTable)
+      struct TxStream {
+        U32 count; //!< Messages queued over all neighbors
+        U32 weight; //!< Fragments per turn
+        U32 latencyUs; //!< Smoothed time from queueing to the last fragment
+        U32 share; //!< Percent of the link capacity the token bucket fills at, 0 unshaped
+        U32 burst; //!< Fragments the bucket holds
+        U64 tokens; //!< Fragments the stream may send now, in millionths
+        U32 deadlineMs; //!< Wait after which a message not started yet is dropped, 0 never
+        U32 queueDelayUs; //!< Longest wait for a first fragment this run period
+        U32 expired; //!< Messages dropped past the deadline
+      };
+
+      //! Where the receiving end of a bulk transfer stands
+      enum BulkReceiveState {
+        BULK_IDLE, //!< No transfer, chunks are dropped
+        BULK_RECEIVING, //!< The destination is open
+        BULK_RECEIVED //!< Every chunk landed, offers and chunks of the transfer are only acknowledged
+      };
+
+      //! A message being reassembled straight into its output buffer
+      struct ReassemblySlot {
+        bool active;
+        U8 source; //!< Neighbor the fragments come from
+        U8 pipe;
+        U8 msgId;
+        U8 count;
+        U32 received; //!< Fragments stored so far
+        FwSizeType size; //!< Message size, known once the last fragment arrived
+        U32 age; //!< Run ticks since the slot was opened
+        U32 seen[(RFFragment::MAX_FRAGMENTS + 31) / 32]; //!< Bitmap of stored fragment indices
+        bool parity; //!< Parity frames came for the message
+        U8 tail; //!< Size of the last fragment, as the parity frames of its block tell
+        bool routed; //!< The message starts with a route header
+        Fw::Buffer buffer;
+      };
+
+      //! A parity frame kept until its block is complete
+      struct FecParitySlot {
+        bool active;
+        U8 slot; //!< Reassembly slot of the message
+        U8 first; //!< First fragment of the block
+        U8 row;
+        U8 data[RFFec::SYMBOL_SIZE];
+      };
+
       // ----------------------------------------------------------------------
-      // Handler implementations for commands
+      // Handler implementations for user-defined typed input ports
       // ----------------------------------------------------------------------
 
-      //! Handler implementation for command TODO
+      //! Handler implementation for comIn
+      void comIn_handler(
+          FwIndexType portNum, //!< The port number
+          Fw::ComBuffer& data, //!< Buffer containing packet data
+          U32 context //!< Call context value; meaning chosen by user
+      ) override;
+
+      //! Handler implementation for comDataIn
+      //!
+      //! Runs on the framer's thread, so the buffer is only handed over to the component thread
+      Drv::SendStatus comDataIn_handler(
+          FwIndexType portNum, //!< The port number
+          Fw::Buffer& sendBuffer //!< Data to send
+      ) override;
+
+      //! Handler implementation for bridgeIn
+      void bridgeIn_handler(
+          FwIndexType portNum, //!< The port number
+          Fw::Buffer& recvBuffer, //!< Data received by the ground link driver
+          const Drv::RecvStatus& recvStatus //!< Receive status
+      ) override;
+
+      //! Overflow hook for bridgeIn, the ground link has no flow control so the buffer is dropped
+      void bridgeIn_overflowHook(
+          FwIndexType portNum, //!< The port number
+          Fw::Buffer& recvBuffer, //!< Data received by the ground link driver
+          const Drv::RecvStatus& recvStatus //!< Receive status
+      ) override;
+
+      //! Handler implementation for frameReturn
+      //!
+      //! Frames from the pool free a credit, anything else goes back to the buffer manager
+      void frameReturn_handler(
+          FwIndexType portNum, //!< The port number
+          Fw::Buffer& fwBuffer //!< The buffer
+      ) override;
+
+      //! Handler implementation for frameIn
+      void frameIn_handler(
+          FwIndexType portNum, //!< The port number
+          Fw::Buffer& fwBuffer //!< The buffer
+      ) override;
+
+      //! Handler implementation for txRingSpace
+      void txRingSpace_handler(
+          FwIndexType portNum, //!< The port number
+          U32 context //!< Unused
+      ) override;
+
+      //! Handler implementation for rxRingDoorbell
+      void rxRingDoorbell_handler(
+          FwIndexType portNum, //!< The port number
+          U32 context //!< Unused
+      ) override;
+
+      //! Handler implementation for surveyIn
+      void surveyIn_handler(
+          FwIndexType portNum, //!< The port number
+          const NRF24ChannelOccupancy& occupancy, //!< Passes each channel was found busy
+          U8 dwells, //!< Passes over all channels
+          U8 channel //!< Channel the radio is tuned to
+      ) override;
+
+      //! Handler implementation for linkStatsIn
+      void linkStatsIn_handler(
+          FwIndexType portNum, //!< The port number
+          U32 sent, //!< Auto-acknowledged payloads loaded since the last report
+          U32 retransmits, //!< Automatic retransmissions since the last report
+          U32 failures, //!< Payloads dropped after the last retransmission
+          U8 channel, //!< Channel the radio is tuned to
+          const NRF24DataRate& rate, //!< Air data rate
+          U8 power //!< TX power level
+      ) override;
+
+      //! Handler implementation for tlmIn
       //!
-      //! TODO
-      void TODO_cmdHandler(
+      //! Runs on the caller's thread, only the latest values are touched
+      void tlmIn_handler(
+          FwIndexType portNum, //!< The port number
+          FwChanIdType id, //!< Telemetry Channel ID
+          Fw::Time& timeTag, //!< Time Tag
+          Fw::TlmBuffer& val //!< Buffer containing serialized telemetry value
+      ) override;
+
+      //! Handler implementation for run
+      void run_handler(
+          FwIndexType portNum, //!< The port number
+          U32 context //!< The call order
+      ) override;
+
+      //! Handler implementation for service
+      //!
+      //! Runs on the fast rate group's thread, only the token wait flag is touched
+      void service_handler(
+          FwIndexType portNum, //!< The port number
+          U32 context //!< The call order
+      ) override;
+
+      // ----------------------------------------------------------------------
+      // Handler implementations for internal interfaces
+      // ----------------------------------------------------------------------
+
+      //! Internal interface handler for comDataQueued
+      void comDataQueued_internalInterfaceHandler(
+          const Fw::Buffer& fwBuffer //!< Framed data from comDataIn
+      ) override;
+
+      //! Internal interface handler for tokensDue
+      void tokensDue_internalInterfaceHandler() override;
+
+      //! Internal interface handler for reorderDue
+      void reorderDue_internalInterfaceHandler() override;
+
+      //! Internal interface handler for arqDue
+      void arqDue_internalInterfaceHandler() override;
+
+      // ----------------------------------------------------------------------
+      // Handler implementations for commands
+      // ----------------------------------------------------------------------
+
+      //! Handler implementation for command SET_REASSEMBLY_TIMEOUT
+      void SET_REASSEMBLY_TIMEOUT_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          U32 ticks //!< Timeout in run ticks
+      ) override;
+
+      //! Handler implementation for command SET_ARQ
+      void SET_ARQ_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          Fw::Enabled mode, //!< Sequence and acknowledge outgoing fragments
+          U8 window //!< Frames in flight
+      ) override;
+
+      //! Handler implementation for command SURVEY_AND_HOP
+      void SURVEY_AND_HOP_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          U8 dwells //!< Survey passes over all channels
+      ) override;
+
+      //! Handler implementation for command SET_AUTO_HOP
+      void SET_AUTO_HOP_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          U8 retransmitPercent //!< Threshold in percent, 0 disables
+      ) override;
+
+      //! Handler implementation for command SET_LINK_ADAPTATION
+      void SET_LINK_ADAPTATION_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          Fw::Enabled mode //!< Adapt power and data rate
+      ) override;
+
+      //! Handler implementation for command SET_STREAM_WEIGHT
+      void SET_STREAM_WEIGHT_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          RFStream stream, //!< Stream to weigh
+          U8 weight //!< Fragments per turn
+      ) override;
+
+      //! Handler implementation for command SET_TLM_KEYFRAME_INTERVAL
+      void SET_TLM_KEYFRAME_INTERVAL_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          U32 updates //!< Updates from one keyframe to the next
+      ) override;
+
+      //! Handler implementation for command SET_TLM_MODE
+      void SET_TLM_MODE_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          RFTelemetryMode mode //!< Telemetry mode
+      ) override;
+
+      //! Handler implementation for command SET_TLM_PRIORITY
+      void SET_TLM_PRIORITY_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          U32 channel, //!< Channel id
+          U8 priority //!< Priority
+      ) override;
+
+      //! Handler implementation for command SET_STREAM_SHAPING
+      void SET_STREAM_SHAPING_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          RFStream stream, //!< Stream to shape
+          U8 share, //!< Percent of the link capacity
+          U8 burst //!< Fragments the bucket holds
+      ) override;
+
+      //! Handler implementation for command SET_STREAM_DEADLINE
+      void SET_STREAM_DEADLINE_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          RFStream stream, //!< Stream
+          U32 deadline //!< Deadline in milliseconds
+      ) override;
+
+      //! Handler implementation for command BULK_DOWNLINK
+      void BULK_DOWNLINK_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          const Fw::CmdStringArg& source, //!< File to send
+          const Fw::CmdStringArg& destination //!< Path on the peer's host
+      ) override;
+
+      //! Handler implementation for command BULK_CANCEL
+      void BULK_CANCEL_cmdHandler(
           FwOpcodeType opCode, //!< The opcode
           U32 cmdSeq //!< The command sequence number
       ) override;
 
+      //! Handler implementation for command SET_FEC
+      void SET_FEC_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          U8 parity //!< Parity frames per block
+      ) override;
+
+      //! Handler implementation for command SET_NODE_ADDRESS
+      void SET_NODE_ADDRESS_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          U8 address //!< Node address
+      ) override;
+
+      //! Handler implementation for command SET_ROUTE
+      void SET_ROUTE_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          U8 destination, //!< Node to reach
+          U8 nextHop //!< Neighbor messages for it go through
+      ) override;
+
+      //! Handler implementation for command SET_DESTINATION
+      void SET_DESTINATION_cmdHandler(
+          FwOpcodeType opCode, //!< The opcode
+          U32 cmdSeq, //!< The command sequence number
+          U8 destination, //!< Node messages go to
+          U8 hopLimit //!< Nodes a message may go through
+      ) override;
+
+      // ----------------------------------------------------------------------
+      // Framing protocol interface, for telemetry packets rebuilt from updates
+      // ----------------------------------------------------------------------
+
+      //! The frame flushTlmPacket took from the buffer manager
+      Fw::Buffer allocate(const U32 size) override;
+
+      //! Hand a framed telemetry packet on like any received message
+      void send(Fw::Buffer& outgoing) override;
+
+      // ----------------------------------------------------------------------
+      // Helper functions
+      // ----------------------------------------------------------------------
+
+      //! Claim the next slot in the TX queue of a stream for a message to the destination, nullptr if the
+      //! queue is full or the message too large
+      RFSession::TxMessage* pushTx(const RFStream& stream, FwSizeType size);
+
+      //! Claim the next slot in a neighbor's TX queue of a stream, nullptr if the queue is full or the
+      //! message too large
+      RFSession::TxMessage* queueTx(U32 stream, FwSizeType size, U8 node);
+
+      //! Neighbor messages to the destination go to, the one hops, telemetry updates and bulk
+      //! transfers run with
+      U8 linkPeer() const;
+
+      //! Queue a buffer to be fragmented straight out of its memory, and send what can go
+      void queueBuffer(Fw::Buffer& fwBuffer, const RFStream& stream, bool flowControlled);
+
+      //! Queue a buffer, or hold a flow controlled one back while its stream is full
+      void admitBuffer(Fw::Buffer& fwBuffer, const RFStream& stream, bool flowControlled);
+
+      //! Queue the held buffer, or hold it again
+      void admitHeld();
+
+      //! Stream of a com packet, from its packet descriptor
+      static RFStream classify(U8* packet, FwSizeType size);
+
+      //! Stream of a buffer framed by Svc.FprimeFraming
+      static RFStream classifyFramed(Fw::Buffer& fwBuffer);
+
+      //! Retire the head message of a neighbor's stream, letting a held buffer or a message to forward in
+      void popTx(U8 node, U32 stream);
+
+      //! Stream a session's next fragment comes from, deficit round robin over the weights of the
+      //! streams their token buckets let send; sessionReady must be true
+      U32 scheduleStream(RFSession::Session& session);
+
+      //! Whether a stream's token bucket lets it send a fragment
+      bool streamEligible(const TxStream& queue) const;
+
+      //! Whether any stream has a message queued and may send it
+      bool txReady() const;
+
+      //! Whether a session has a message queued its stream may send
+      bool sessionReady(const RFSession::Session& session) const;
+
+      //! Position in the turns of the first session that may send a fragment
+      //! \return false if none may
+      bool nextSession(U32& position);
+
+      //! Fill the token buckets for the time since the last call and drop the messages past their deadline
+      void shapeStreams();
+
+      //! Tell Svc.ComQueue (through the framer) that the next buffer can come
+      void comReady();
+
+      //! Whether reassembled messages have somewhere to go
+      bool hasSink();
+
+      //! Hand a reassembled message to the deframer, or to the ground link driver
+      void deliver(Fw::Buffer& buffer);
+
+      //! Forward a routed message not for this node, strip the route header of one that is, and dispatch it
+      void receiveMessage(U8 source, U8 pipe, bool routed, Fw::Buffer& buffer);
+
+      //! Decode a telemetry update part, take a bulk transfer message, deliver anything else
+      void dispatchMessage(U8 source, U8 pipe, bool routed, Fw::Buffer& buffer);
+
+      //! Hold a message for another node until its stream has room, or drop it
+      void forwardMessage(U8 pipe, Fw::Buffer& buffer);
+
+      //! Queue the messages to forward, origins in turn, while their streams have room
+      void fillForward();
+
+      //! Queue one message to forward on a stream
+      //! \return false if none waits for it with room towards its next hop
+      bool forwardOne(U32 stream);
+
+      //! Queue a message to forward on the next hop's stream, which must have room
+      void pushForward(U32 stream, U8 node, Fw::Buffer& buffer);
+
+      //! A fragment came from a neighbor, it is up
+      void heardFrom(U8 node);
+
+      //! Take the neighbors silent for too long as down
+      void agePeers();
+
+      //! Take a snapshot of the latest telemetry values and queue its parts on the TELEMETRY stream
+      void sendTelemetry();
+
+      //! Pack the latest telemetry values into single fragment messages on the TELEMETRY stream
+      void sendTelemetryFrames();
+
+      //! Turn a telemetry update part into F' telemetry packets, returning its buffer
+      void receiveTelemetry(Fw::Buffer& buffer);
+
+      //! Frame and deliver the telemetry packet being filled, if it holds any channel
+      void flushTlmPacket();
+
+      //! Send a TLM_ACK if a frame credit is free
+      void sendTlmAck(U8 seq);
+
+      //! Process a TLM_ACK from the peer
+      void receiveTlmAck(const U8* frame, FwSizeType length);
+
+      //! Queue the bulk transfer's offer and the chunks the peer still lacks while the FILE stream has room
+      void fillBulk();
+
+      //! Close the source of the bulk transfer in progress
+      void stopBulk();
+
+      //! Process a BULK_ACK from the peer
+      void receiveBulkAck(const U8* frame, FwSizeType length);
+
+      //! Process a bulk transfer offer or chunk, returning its buffer
+      void receiveBulk(Fw::Buffer& buffer);
+
+      //! Open the destination of an offered transfer, or answer a repeated offer
+      void receiveBulkOffer(const U8* data, FwSizeType size);
+
+      //! Write a chunk of the transfer being received
+      void receiveBulkChunk(const U8* data, FwSizeType size);
+
+      //! Close the destination of a transfer every chunk of which landed
+      void finishBulkReceive();
+
+      //! Send the BULK_ACK covering the last chunk received, then the next ones of the sweep, as far as credits go
+      void sendBulkAcks();
+
+      //! Send one BULK_ACK with its bitmap from a chunk, the credit must be free
+      void sendBulkAck(U32 from);
+
+      //! Tell the peer its offer could not be taken, if a frame credit is free
+      void sendBulkRefusal(U8 transfer);
+
+      //! Offer again after a stall, start the next pass, and acknowledge or close the transfer being received
+      void runBulk();
+
+      //! Report the progress, rate and time left of the bulk transfer in progress
+      void reportBulk();
+
+      //! Send pending ACKs and fragment queued messages into free frame credits
+      void pumpTx();
+
+      //! Write the next fragment of the head message of a session's scheduled stream after a header,
+      //! retiring the message after its last one
+      //! \return frame length
+      U8 nextFragment(
+          U8 node, //!< Neighbor of the session, sessionReady must be true
+          RFFragment::FrameType type, //!< Frame type
+          U8 seq, //!< ARQ sequence number
+          U8* frame, //!< Frame to fill
+          U8& pipe //!< Pipe of the fragment's stream
+      );
+
+      //! Add a DATA fragment to the parity of its block, queueing the parity frames after the block's
+      //! last fragment
+      void protectFragment(RFSession::TxQueue& queue, const RFSession::TxMessage& message, const U8* data,
+                           FwSizeType length, U8 pipe, U8 node);
+
+      //! Whether a frame can go to a driver now, a TX ring slot or a pool credit. Picks the radio with
+      //! the most room for claimFrame.
+      bool hasCredit(
+          U32 radio = RFBond::ANY_RADIO //!< Only this radio, e.g. the primary one for frames about its channel
+      );
+
+      //! Frame to fill for the driver, hasCredit must be true
+      U8* claimFrame(
+          U32 radio = RFBond::ANY_RADIO //!< As given to hasCredit
+      );
+
+      //! Hand a claimed frame to the driver
+      void sendFrame(U8* frame, U8 length, bool noAck, U8 pipe, U8 node);
+
+      //! Frames a radio's TX ring takes, less while bonded
+      U32 radioDepth(U32 radio) const;
+
+      //! Whether the next frame would go SKEW_FRAMES or more after the oldest one a bonded radio still queues
+      bool bondSkewed(
+          U32& lagging //!< Radio queueing it
+      ) const;
+
+      //! Frames handed to a radio's driver and not loaded into the radio yet
+      U32 framesInRadio(U32 radio) const;
+
+      //! Frames handed to the drivers and not loaded into the radios yet
+      U32 framesInDriver() const;
+
+      //! Whether a window frame's last transmission still waits in the driver, its timer has not started
+      bool inDriver(const RFSession::ArqTxSlot& slot) const;
+
+      //! Have the ACK for a neighbor's receive window sent with the next credit
+      void requestAck(U8 node);
+
+      //! Send the ACKs requested, as far as credits go
+      void sendAcks();
+
+      //! Send the ACK for a neighbor's receive window, the credit must be free
+      void sendAck(U8 node);
+
+      //! Move a session's queued fragments into its ARQ window while it has room
+      void fillWindow(U8 node);
+
+      //! Transmit a session's window frames waiting for a credit, oldest first
+      //! \return true if any went
+      bool sendWindow(U8 node);
+
+      //! Transmit the window frames of the sessions in turn
+      void sendWindows();
+
+      //! Queue a session's frames whose retransmit timer ran out
+      void checkArqTimers(U8 node);
+
+      //! Arm service for the earliest retransmit timer still running, or disarm it
+      void armArqTimer();
+
+      //! Process an ACK from a neighbor
+      void receiveAck(const U8* frame, FwSizeType length);
+
+      //! Mark one sequence number acknowledged
+      void ackFrame(RFSession::Session& session, U8 seq);
+
+      //! Slide the send window over acknowledged frames
+      void advanceWindow(RFSession::Session& session);
+
+      //! Feed an RTT sample into the retransmit timeout
+      void updateRto(RFSession::Session& session, U32 rttUs);
+
+      //! Retransmit timeout from the RTT estimate, without backoff
+      U32 estimatedRto(const RFSession::Session& session) const;
+
+      //! Process a sequenced fragment, delivering it and anything it unblocks in order
+      void receiveArqFrame(U8 pipe, const RFFragment::Header& header, const U8* frame, FwSizeType length);
+
+      //! Frames sent and not yet acknowledged
+      U32 windowOccupancy(const RFSession::Session& session) const;
+
+      //! Frames allowed in flight, a single one until the neighbor's first ACK
+      U32 sendWindowSize(const RFSession::Session& session) const;
+
+      //! Dispatch one received frame by type
+      void processFrame(U8 radio, U8 pipe, const U8* frame, FwSizeType length);
+
+      //! Pass on the DATA frames kept for order that may go now
+      void releaseFrames();
+
+      //! Store one received fragment, completing its message if it was the last one
+      void receiveFragment(U8 pipe, const RFFragment::Header& header, const U8* data, FwSizeType length);
+
+      //! Find the slot of a message in progress, or open one
+      ReassemblySlot* findSlot(U8 pipe, const RFFragment::Header& header);
+
+      //! Whether a received message has somewhere to go, another node for a routed one
+      bool canReceive(const RFFragment::Header& header);
+
+      //! Give up a slot, returning its buffer
+      void releaseSlot(ReassemblySlot& slot);
+
+      //! Deliver the message of a slot holding every fragment
+      void completeSlot(ReassemblySlot& slot);
+
+      //! Keep a parity frame for its block, or rebuild a single fragment message from it
+      void receiveParity(U8 pipe, const RFFragment::Header& header, const U8* data, FwSizeType length);
+
+      //! Rebuild the lost fragments of a block once it has as many parity frames
+      void recoverBlock(ReassemblySlot& slot, U32 first);
+
+      //! Drop the parity frames kept for a slot, counting the blocks they could not rebuild
+      void dropParity(const ReassemblySlot& slot);
+
+      void countRxDrop();
+
+      //! Report goodput, retransmit ratio and window state for the last run period
+      void reportArq();
+
+      //! Report the depth, latency and queueing delay of each stream, and measure the link capacity
+      void reportStreams();
+
+      //! Report the message and fragment counters, kept off the hot path until the run tick
+      void reportTraffic();
+
+      //! Ask the driver for a survey that ends in a hop
+      //! \return false if a survey or hop is already under way or no driver is connected
+      bool requestSurvey(U8 dwells);
+
+      //! Start announcing a hop to the peer
+      void startHop(U8 channel, const NRF24DataRate& rate, U8 power);
+
+      //! Announce the hop in progress, or retune once its countdown ran out
+      void runHop();
+
+      //! Retune the driver and report what changed
+      void retune(U8 channel, const NRF24DataRate& rate, U8 power);
+
+      //! Start over the loss measurement of the current link adaptation period
+      void resetAdaptation();
+
+      //! Confirm a hop with the peer, or go back once HOP_CONFIRM_TICKS ran out
+      void runProbation();
+
+      //! Step power or rate for the loss over the last link adaptation period
+      void adaptLink(U32 lossPercent);
+
+      //! Wait twice as many clean periods before the next step up in rate
+      void backOffStepUp();
+
+      //! Send a HOP_ACK if a frame credit is free
+      void sendHopAck(U8 id, U8 channel, const NRF24DataRate& rate, U8 power, bool poll);
+
+      //! Process a HOP announcement from the peer
+      void receiveHop(const U8* frame, FwSizeType length);
+
+      //! Process a HOP_ACK from the peer
+      void receiveHopAck(const U8* frame, FwSizeType length);
+
+      // ----------------------------------------------------------------------
+      // Member variables
+      // ----------------------------------------------------------------------
+
+      U8 m_frameStorage[FRAME_POOL_SIZE][NRF24::MAX_PAYLOAD_SIZE];
+      bool m_frameBusy[FRAME_POOL_SIZE];
+      U32 m_framesFree;
+
+      //! A driver exchanging frames through rings
+      struct Radio {
+        NRF24FrameRing* txRing;
+        NRF24FrameRing* rxRing;
+        U32 handed; //!< Frames sent to the driver; it takes them in order
+        U32 frames; //!< Frames sent this run period
+        U32 depth; //!< Frames its TX ring holds while bonded
+        U32 sent[RFBond::RADIO_DEPTH]; //!< m_framesHanded after each of its last frames, while bonded
+      };
+
+      Radio m_radios[RFBond::MAX_RADIOS]; //!< Replace the pool and frameOut when attached
+      U32 m_radioCount;
+      U32 m_claimRadio; //!< Radio hasCredit picked
+      U32 m_nextRadio; //!< Radio ties go to next
+      U32 m_framesHanded; //!< Frames sent to the drivers, over all radios
+      bool m_bondFull; //!< Every bonded TX ring ran full this run period
+      RFBondReorder m_reorder;
+      std::atomic<bool> m_reorderWait; //!< DATA frames are kept for order, service wakes releaseFrames
+
+      TxStream m_txStreams[RFStream::NUM_CONSTANTS];
+      U32 m_txCount; //!< Messages queued over all streams and neighbors
+      Os::RawTime m_tokensAt; //!< Last token bucket fill
+      bool m_tokensAtValid;
+      std::atomic<bool> m_tokenWait; //!< A stream waits on its bucket with a credit free, service wakes pumpTx
+      U32 m_linkCapacity; //!< Frames per second the driver takes when kept busy, 0 unknown
+      U32 m_linkPeak; //!< Most frames per second any run period saw since the data rate last changed
+      U32 m_linkTaken; //!< Frames the driver had taken at the last run tick
+      Os::RawTime m_linkStart;
+      bool m_linkStartValid;
+      bool m_linkIdle; //!< A credit went unused this run period
+      bool m_linkThrottled; //!< ... while a token bucket held a stream back
+      Fw::Buffer m_heldBuffer; //!< comDataIn buffer waiting for room in its stream, comStatus is not answered meanwhile
+      RFStream m_heldStream;
+
+      bool m_comStarted; //!< comStatus opened on the first run tick
+
+      ReassemblySlot m_slots[REASSEMBLY_SLOTS];
+      U32 m_reassemblyTimeout;
+
+      U32 m_fecRows; //!< Parity frames per block, 0 without FEC
+      U8 m_fecFrames[RFFec::MAX_PARITY][NRF24::MAX_PAYLOAD_SIZE]; //!< Parity frames of the last block
+      U32 m_fecPending; //!< Frames of it
+      U32 m_fecNext; //!< Next one to send
+      U8 m_fecPipe;
+      U8 m_fecNode;
+      U32 m_fecRadio; //!< Radio the block's last fragment went on
+      FecParitySlot m_fecParity[FEC_PARITY_SLOTS];
+      U32 m_fecRecovered;
+      U32 m_fecUnrecoverable;
+
+      bool m_arqEnabled;
+      U32 m_arqWindow;
+      U32 m_acksPending; //!< Sessions whose ACK waits for a credit
+      std::atomic<bool> m_arqWait; //!< A retransmit timer runs, service wakes pumpTx once it is due
+      Os::Mutex m_arqTimerLock; //!< Guards the armed deadline between pumpTx and service
+      Os::RawTime m_arqArmedAt;
+      U32 m_arqWaitUs; //!< How long after m_arqArmedAt the earliest timer runs out
+      NRF24TimeHistogram m_rttHistogram; //!< Karn samples of the current run period
+
+      U32 m_arqBytesAcked;
+      U32 m_arqTransmissions;
+      U32 m_arqRetransmissions;
+      Os::RawTime m_reportStart;
+      bool m_reportStartValid;
+
+      bool m_surveyPending; //!< A survey from requestSurvey has not come back
+      U32 m_surveyAge; //!< Run ticks since requestSurvey
+      bool m_hopActive; //!< A hop countdown is running
+      bool m_hopLeader; //!< The hop was started here and is announced to the peer
+      bool m_hopAcked; //!< The peer answered the announcement
+      U8 m_hopId; //!< Last hop led from here
+      U8 m_peerHopId; //!< Last hop announced by the peer, repeats of it are only acknowledged
+      bool m_peerHopIdValid;
+      U8 m_hopChannel;
+      U32 m_hopCountdown; //!< Run ticks left before retuning
+      U8 m_channel;
+      U32 m_hops;
+      U8 m_autoHopPercent; //!< 0 when automatic hops are off
+      U32 m_hopHoldoff; //!< Run ticks left before the next automatic survey
+      NRF24DataRate m_hopRate;
+      U8 m_hopPower;
+      NRF24DataRate m_rate;
+      U8 m_power;
+      bool m_settingsPending; //!< Settings went to the driver since its last report, which may predate them
+
+      bool m_adaptEnabled;
+      U32 m_adaptSent; //!< Auto-acknowledged payloads the driver loaded this period
+      U32 m_adaptRetries; //!< Radio retransmissions this period
+      U32 m_adaptFailures; //!< Payloads the radio gave up on this period
+      U32 m_adaptArqTransmissions; //!< ARQ transmissions this period
+      U32 m_adaptArqRetransmissions;
+      U32 m_cleanPeriods; //!< Clean periods in a row
+      U32 m_stepUpPeriods; //!< Clean periods needed to step up
+      bool m_probedUp; //!< The rate went up since the last judged period
+      U32 m_probation; //!< Run ticks left to hear the peer after a hop
+      U8 m_fallbackChannel; //!< Settings before the hop
+      NRF24DataRate m_fallbackRate;
+      U8 m_fallbackPower;
+      bool m_heard; //!< The peer polled on the new settings since the probation started
+      bool m_confirmed; //!< The peer answered a poll since the probation started
+
+      Os::Mutex m_tlmLock; //!< Guards the latest values between tlmIn and snapshots
+      RFTelemetryEncoder m_tlmEncoder;
+      U32 m_tlmRejected;
+      U32 m_tlmKeyframeInterval;
+      U32 m_tlmSinceKeyframe; //!< Updates since the last keyframe
+      U32 m_tlmAckWait; //!< Run ticks the last update has waited for its TLM_ACK
+      U32 m_tlmChannelsSent;
+      RFTelemetryMode m_tlmMode;
+      U8 m_tlmFrames[TX_QUEUE_DEPTH][RFFragment::FRAGMENT_DATA_SIZE]; //!< Frames packed in FRAMES mode, back to back at the frame size
+      U32 m_tlmFramesSent;
+
+      RFTelemetryDecoder m_tlmDecoder;
+      Svc::FprimeFraming m_framing;
+      Fw::TlmPacket m_tlmPacket; //!< Channels of received updates, as the packet to frame next
+      Fw::Buffer m_tlmFrame; //!< Frame for the packet, taken ahead so a pool miss drops it instead of asserting
+      U32 m_tlmUpdatesDropped;
+
+      RFBulkSource m_bulkSource;
+      RFBulkChunkMap m_bulkHeld; //!< Chunks the peer reported holding
+      bool m_bulkSending;
+      U8 m_bulkTransfer; //!< Last transfer started here
+      bool m_bulkOfferDue; //!< The offer goes out with the next chunks
+      bool m_bulkOffered; //!< The peer answered the offer, chunks may go
+      U32 m_bulkCursor; //!< Next chunk of the current pass
+      U32 m_bulkRewind; //!< Run ticks left before the next pass, 0 while a pass is going
+      U32 m_bulkAckAge; //!< Run ticks since the last BULK_ACK
+      Os::RawTime m_bulkStartedAt;
+      char m_bulkSourcePath[RFBulk::MAX_PATH_SIZE + 1];
+      char m_bulkDestination[RFBulk::MAX_PATH_SIZE + 1];
+
+      RFBulkSink m_bulkSink;
+      BulkReceiveState m_bulkRxState;
+      U8 m_bulkRxTransfer;
+      char m_bulkRxPath[RFBulk::MAX_PATH_SIZE + 1];
+      U32 m_bulkLastChunk; //!< Last chunk landed, the regular BULK_ACK covers the chunks up to it
+      U32 m_bulkSweep; //!< Next chunk the sweep reports, chunks() once it is through
+      U32 m_bulkSinceAck; //!< Chunks since the last BULK_ACK
+      U32 m_bulkIdle; //!< Run ticks since the last offer or chunk
+
+      U32 m_bulkBytes; //!< File bytes sent or landed this run period
+      F32 m_bulkRate;
+      U32 m_bulkProgress;
+      Os::RawTime m_bulkReportAt;
+      bool m_bulkReportAtValid;
+
+      U8 m_node; //!< Node address of the radio
+      U8 m_destination; //!< Node messages go to
+      U8 m_hopLimit; //!< Nodes a message to the destination may go through
+      RFPeerTable m_peers; //!< Sessions with the neighbors included
+      U32 m_peersUp;
+      U32 m_messagesForwarded;
+      U32 m_forwardDrops;
+      U32 m_bondGaps; //!< DATA frames given up on waiting for order
+
+      U32 m_messagesSent;
+      U32 m_fragmentsSent;
+      U32 m_txDropped;
+      U32 m_messagesReceived;
+      U32 m_reassemblyTimeouts;
+      U32 m_rxDropped;
+
   };
 
 }
@@ -0,0 +1,146 @@
+// ======================================================================
+// \title  RFFecCodec.cpp
+// \author mustafa
+// \brief  cpp file for the erasure code over the fragments of a message
+// ======================================================================
+
+#include "Components/RFCommManager/RFFecCodec.hpp"
+
+#include <Fw/Types/Assert.hpp>
+
+#include <cstring>
+
+namespace Components {
+
+  namespace {
+
+    static_assert(RFFec::BLOCK_FRAGMENTS + RFFec::MAX_PARITY <= 256, "Cauchy points are field elements");
+    static_assert(RFFec::BLOCK_FRAGMENTS <= 32, "Lost fragments are a U32 mask");
+    static_assert(RFFec::SYMBOL_SIZE <= RFFec::TAIL_MASK, "The tail fits below the row");
+    static_assert((RFFec::MAX_PARITY - 1) << RFFec::ROW_SHIFT <= 0xFF, "The row fits the seq byte");
+
+    //! x^8 + x^4 + x^3 + x^2 + 1, 2 generates its multiplicative group
+    const U32 FIELD_POLYNOMIAL = 0x11D;
+
+    //! Products and inverses of GF(2^8), built before main
+    struct FieldTables {
+      U8 product[256][256];
+      U8 inverse[256];
+
+      FieldTables() {
+        U8 exp[255];
+        U8 log[256];
+        U32 x = 1;
+        for (U32 i = 0; i < 255; i++) {
+          exp[i] = static_cast<U8>(x);
+          log[x] = static_cast<U8>(i);
+          x <<= 1;
+          if (x & 0x100) {
+            x ^= FIELD_POLYNOMIAL;
+          }
+        }
+        for (U32 a = 0; a < 256; a++) {
+          for (U32 b = 0; b < 256; b++) {
+            product[a][b] = (a == 0 || b == 0) ? 0 : exp[(log[a] + log[b]) % 255];
+          }
+          inverse[a] = (a == 0) ? 0 : exp[(255 - log[a]) % 255];
+        }
+      }
+    };
+
+    const FieldTables FIELD;
+
+    //! Multiply data by a coefficient in place
+    void scale(U8* data, U32 length, U8 coefficient) {
+      const U8* const row = FIELD.product[coefficient];
+      for (U32 i = 0; i < length; i++) {
+        data[i] = row[data[i]];
+      }
+    }
+
+  }
+
+  U8 RFFec::coefficient(U32 row, U32 position) {
+    FW_ASSERT(row < MAX_PARITY && position < BLOCK_FRAGMENTS, row, position);
+    // Rows and positions are distinct points, so every square submatrix is invertible
+    return FIELD.inverse[(BLOCK_FRAGMENTS + row) ^ position];
+  }
+
+  void RFFec::accumulate(U8* parity, const U8* data, U32 length, U8 coefficient) {
+    FW_ASSERT(length <= SYMBOL_SIZE, length);
+    const U8* const row = FIELD.product[coefficient];
+    for (U32 i = 0; i < length; i++) {
+      parity[i] ^= row[data[i]];
+    }
+  }
+
+  bool RFFec::recover(U8* block, U32 fragments, U32 lost, const U8* const* parity, const U8* rows, U32 parityCount) {
+    FW_ASSERT(fragments <= BLOCK_FRAGMENTS, fragments);
+
+    U32 positions[MAX_PARITY];
+    U32 missing = 0;
+    for (U32 i = 0; i < fragments; i++) {
+      if ((lost & (1U << i)) != 0) {
+        if (missing == MAX_PARITY || missing == parityCount) {
+          return false;
+        }
+        positions[missing++] = i;
+      }
+    }
+
+    // Take the fragments held out of the first rows, what is left is the lost ones times a
+    // square Cauchy matrix
+    U8 matrix[MAX_PARITY][MAX_PARITY];
+    U8 syndromes[MAX_PARITY][SYMBOL_SIZE];
+    for (U32 r = 0; r < missing; r++) {
+      std::memcpy(syndromes[r], parity[r], SYMBOL_SIZE);
+      U32 next = 0;
+      for (U32 i = 0; i < fragments; i++) {
+        if (next < missing && positions[next] == i) {
+          matrix[r][next++] = coefficient(rows[r], i);
+        } else {
+          accumulate(syndromes[r], block + i * SYMBOL_SIZE, SYMBOL_SIZE, coefficient(rows[r], i));
+        }
+      }
+    }
+
+    // Gauss-Jordan; rows given twice are the only way to a singular matrix
+    for (U32 c = 0; c < missing; c++) {
+      U32 pivot = c;
+      while (pivot < missing && matrix[pivot][c] == 0) {
+        pivot++;
+      }
+      if (pivot == missing) {
+        return false;
+      }
+      if (pivot != c) {
+        U8 swap[SYMBOL_SIZE];
+        for (U32 k = 0; k < missing; k++) {
+          const U8 m = matrix[c][k];
+          matrix[c][k] = matrix[pivot][k];
+          matrix[pivot][k] = m;
+        }
+        std::memcpy(swap, syndromes[c], SYMBOL_SIZE);
+        std::memcpy(syndromes[c], syndromes[pivot], SYMBOL_SIZE);
+        std::memcpy(syndromes[pivot], swap, SYMBOL_SIZE);
+      }
+      const U8 inverse = FIELD.inverse[matrix[c][c]];
+      scale(matrix[c], missing, inverse);
+      scale(syndromes[c], SYMBOL_SIZE, inverse);
+      for (U32 r = 0; r < missing; r++) {
+        const U8 factor = matrix[r][c];
+        if (r == c || factor == 0) {
+          continue;
+        }
+        accumulate(matrix[r], matrix[c], missing, factor);
+        accumulate(syndromes[r], syndromes[c], SYMBOL_SIZE, factor);
+      }
+    }
+
+    for (U32 r = 0; r < missing; r++) {
+      std::memcpy(block + positions[r] * SYMBOL_SIZE, syndromes[r], SYMBOL_SIZE);
+    }
+    return true;
+  }
+
+}
@@ -0,0 +1,71 @@
+// ======================================================================
+// \title  RFFecCodec.hpp
+// \author mustafa
+// \brief  hpp file for the erasure code over the fragments of a message
+//
+// With forward error correction on, RFCommManager cuts the DATA fragments
+// of each message into blocks of BLOCK_FRAGMENTS fragments, the last block
+// possibly shorter, and sends parity frames after each block:
+//
+//   | FEC_PARITY (U8) | row (3 bits) tail (5 bits) | msgId (U8) | first (U8) | count (U8) | source (U8) | parity ... |
+//
+// first is the index of the block's first fragment, count the message's
+// fragment count, source the sender as in the fragments. tail is the data size of the message's last fragment
+// when the block holds it, so the receiver can rebuild it at its size.
+//
+// The code is a systematic Reed-Solomon code over GF(2^8): parity row r is
+// the sum over the block's fragments i of coefficient(r, i) times the
+// fragment data, zero padded to SYMBOL_SIZE. The coefficients form a
+// Cauchy matrix, so any rows of a block rebuild as many lost fragments.
+// Products come from a full multiplication table, one lookup per byte.
+// ======================================================================
+
+#ifndef Components_RFFecCodec_HPP
+#define Components_RFFecCodec_HPP
+
+#include <FpConfig.hpp>
+
+#include "Components/RFCommManager/RFFragment.hpp"
+
+namespace Components {
+
+namespace RFFec {
+
+  //! Fragments of a full block, a bulk chunk is one
+  static const U32 BLOCK_FRAGMENTS = 16;
+
+  //! Most parity rows per block, the row takes 3 bits
+  static const U32 MAX_PARITY = 8;
+
+  //! Bytes of a fragment's data and of a row of parity
+  static const U32 SYMBOL_SIZE = RFFragment::FRAGMENT_DATA_SIZE;
+
+  //! Size of a FEC_PARITY frame
+  static const U32 PARITY_FRAME_SIZE = RFFragment::HEADER_SIZE + SYMBOL_SIZE;
+
+  //! Position of the row in the seq byte of parity frames, the tail is below it
+  static const U32 ROW_SHIFT = 5;
+  static const U8 TAIL_MASK = 0x1F;
+
+  //! Coefficient row r gives fragment position i of a block
+  U8 coefficient(U32 row, U32 position);
+
+  //! Add coefficient times data into parity, data shorter than SYMBOL_SIZE as if zero padded
+  void accumulate(U8* parity, const U8* data, U32 length, U8 coefficient);
+
+  //! Rebuild the lost fragments of a block in place
+  //! \return false if fewer parity rows than lost fragments were given
+  bool recover(
+      U8* block, //!< The block's fragments, SYMBOL_SIZE apart, the lost ones overwritten
+      U32 fragments, //!< Fragments of the block
+      U32 lost, //!< Bit i set when fragment i is lost
+      const U8* const* parity, //!< Parity rows received
+      const U8* rows, //!< Row of each of them
+      U32 parityCount
+  );
+
+}
+
+}
+
+#endif
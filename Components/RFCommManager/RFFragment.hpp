@@ -0,0 +1,178 @@
+// ======================================================================
+// \title  RFFragment.hpp
+// \author mustafa
+// \brief  Header carried by every RF frame RFCommManager puts on the air
+//
+// A message larger than one NRF24L01+ payload is split into fragments
+// of up to FRAGMENT_DATA_SIZE bytes, each preceded by a 6 byte header:
+//
+//   | type (U8) | seq (U8) | msgId (U8) | index (U8) | count (U8) | source (U8) | data ... |
+//
+// msgId rolls over per message and per neighbor it goes to, index counts
+// from 0 to count - 1. The last fragment carries the remainder, so its
+// payload is shorter. source is the node address of the sender, the
+// neighbor the frame came from, not the node the message started at.
+//
+// Messages for a node that is not a neighbor start with a route header
+// (see RFPeerTable.hpp) and their frames are flagged FLAG_ROUTED; every
+// node on the way reassembles them and sends them on to the next hop.
+//
+// In DATA frames seq counts the frames sent to the neighbor, so a
+// receiver bonding several radios puts them back in order (see
+// RFBondReorder.hpp). In ARQ_DATA frames it is the selective repeat
+// ARQ's sequence number, counted per neighbor. The receiver answers
+// those with ARQ_ACK frames:
+//
+//   | ARQ_ACK (U8) | base (U8) | source (U8) | bitmap (ACK_BITMAP_SIZE bytes) |
+//
+// base is the next sequence number expected in order, everything
+// before it arrived. source is the node address of the receiver, the
+// sender's window with it is the one acknowledged. Bit i of the bitmap
+// (LSB of byte 0 first) is set when base + 1 + i arrived out of order.
+//
+// A hop to another channel, data rate or TX power level is announced once
+// per run tick with HOP frames and answered with HOP_ACK frames:
+//
+//   | HOP (U8) | hopId (U8) | channel (U8) | countdown (U8) | rate (U8) | power (U8) |
+//   | HOP_ACK (U8) | hopId (U8) | channel (U8) | rate (U8) | power (U8) |
+//
+// countdown is the number of run ticks left before both ends retune, rate
+// is an NRF24DataRate. After retuning both ends poll with HOP_ACK frames
+// flagged FLAG_POLL until one comes back unflagged, and go back if they
+// never hear the other side.
+//
+// A telemetry update (see RFTelemetryCodec.hpp) the receiver applied in
+// full is acknowledged so the sender can take it as its next base:
+//
+//   | TLM_ACK (U8) | seq (U8) |
+//
+// The receiver of a bulk file transfer (see RFBulkTransfer.hpp) reports
+// the chunks it holds:
+//
+//   | BULK_ACK (U8) | transfer (U8) | base (U32) | from (U32) | bitmap (BULK_BITMAP_SIZE bytes) |
+//
+// base is the first chunk it does not hold, bit i of the bitmap (LSB of
+// byte 0 first) is set when chunk from + i is held.
+//
+// With forward error correction on, FEC_PARITY frames follow each block
+// of DATA fragments of a message, see RFFecCodec.hpp.
+// ======================================================================
+
+#ifndef Components_RFFragment_HPP
+#define Components_RFFragment_HPP
+
+#include <FpConfig.hpp>
+
+#include "Components/NRF24Driver/NRF24Registers.hpp"
+
+namespace Components {
+
+namespace RFFragment {
+
+  //! Frame types, the first byte of every frame
+  enum FrameType : U8 {
+    DATA = 0x01,     //!< Fragment of a message, unsequenced
+    ARQ_DATA = 0x02, //!< Fragment of a message, sequenced and acknowledged
+    ARQ_ACK = 0x03,  //!< Acknowledgment bitmap
+    HOP = 0x04,      //!< Radio settings hop announcement
+    HOP_ACK = 0x05,  //!< Hop acknowledgment
+    TLM_ACK = 0x06,  //!< Telemetry update acknowledgment
+    BULK_ACK = 0x07, //!< Bulk transfer chunks held by the receiver
+    FEC_PARITY = 0x08 //!< Parity over a block of DATA fragments
+  };
+
+  //! Set on ARQ_DATA frames until the sender saw its first ACK, the receiver
+  //! then takes the sequence number as its new window base
+  static const U8 FLAG_SYNC = 0x80;
+
+  //! Set on ARQ_DATA frames the sender wants acknowledged at once: retransmissions and
+  //! the frame that filled the window or emptied the queue. Set on HOP_ACK frames polling
+  //! the peer after a hop, it echoes them without the flag.
+  static const U8 FLAG_POLL = 0x40;
+
+  //! Set on DATA, ARQ_DATA and FEC_PARITY frames of a message that starts with a route header
+  static const U8 FLAG_ROUTED = 0x20;
+
+  //! Frame type without its flags
+  static const U8 TYPE_MASK = 0x1F;
+
+  //! Bytes of header ahead of the fragment data
+  static const U32 HEADER_SIZE = 6;
+
+  //! Largest fragment data in one frame
+  static const U32 FRAGMENT_DATA_SIZE = NRF24::MAX_PAYLOAD_SIZE - HEADER_SIZE;
+
+  //! Most fragments per message, count is a U8
+  static const U32 MAX_FRAGMENTS = 255;
+
+  //! Largest message that can be fragmented
+  static const U32 MAX_MESSAGE_SIZE = MAX_FRAGMENTS * FRAGMENT_DATA_SIZE;
+
+  //! Largest ARQ window; sequence numbers are a U8, so selective repeat needs it at most half of 256
+  static const U32 ARQ_MAX_WINDOW = 64;
+
+  //! Bytes of ACK bitmap, one bit per sequence number after the base
+  static const U32 ACK_BITMAP_SIZE = ARQ_MAX_WINDOW / 8;
+
+  //! Size of an ARQ_ACK frame
+  static const U32 ACK_FRAME_SIZE = 3 + ACK_BITMAP_SIZE;
+
+  //! Size of a HOP frame
+  static const U32 HOP_FRAME_SIZE = 6;
+
+  //! Size of a HOP_ACK frame
+  static const U32 HOP_ACK_FRAME_SIZE = 5;
+
+  //! Size of a TLM_ACK frame
+  static const U32 TLM_ACK_FRAME_SIZE = 2;
+
+  //! Bytes of BULK_ACK bitmap, the rest of the payload
+  static const U32 BULK_BITMAP_SIZE = NRF24::MAX_PAYLOAD_SIZE - 10;
+
+  //! Size of a BULK_ACK frame
+  static const U32 BULK_ACK_FRAME_SIZE = 10 + BULK_BITMAP_SIZE;
+
+  struct Header {
+    U8 type;
+    U8 seq;
+    U8 msgId;
+    U8 index;
+    U8 count;
+    U8 source;
+  };
+
+  //! Fragments needed for a message of the given size, at least one
+  inline U32 fragmentCount(FwSizeType size) {
+    return (size == 0) ? 1 : static_cast<U32>((size + FRAGMENT_DATA_SIZE - 1) / FRAGMENT_DATA_SIZE);
+  }
+
+  inline void encode(const Header& header, U8* frame) {
+    frame[0] = header.type;
+    frame[1] = header.seq;
+    frame[2] = header.msgId;
+    frame[3] = header.index;
+    frame[4] = header.count;
+    frame[5] = header.source;
+  }
+
+  //! Decode and sanity check a header
+  //! \return false if the frame is too short, the index/count pair is impossible or the source is
+  //! not a node address
+  inline bool decode(const U8* frame, FwSizeType length, Header& header) {
+    if (length < HEADER_SIZE) {
+      return false;
+    }
+    header.type = frame[0];
+    header.seq = frame[1];
+    header.msgId = frame[2];
+    header.index = frame[3];
+    header.count = frame[4];
+    header.source = frame[5];
+    return header.count != 0 && header.index < header.count && header.source < NRF24::MAX_NODES;
+  }
+
+}
+
+}
+
+#endif
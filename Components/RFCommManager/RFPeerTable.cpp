@@ -0,0 +1,294 @@
+// ======================================================================
+// \title  RFPeerTable.cpp
+// \author mustafa
+// \brief  cpp file for the table of the nodes RFCommManager talks to
+// ======================================================================
+
+#include "Components/RFCommManager/RFPeerTable.hpp"
+
+#include <Fw/Types/Assert.hpp>
+
+#include <cstring>
+
+namespace Components {
+
+  RFPeerTable ::
+    RFPeerTable() :
+      m_turnHead(0),
+      m_turnCount(0),
+      m_forwardCount(0),
+      m_sessionHead(0),
+      m_sessionCount(0)
+  {
+    for (U32 node = 0; node < RFRoute::MAX_NODES; node++) {
+      Peer& peer = m_peers[node];
+      peer.nextHop = static_cast<U8>(node);
+      peer.nextMsgId = 0;
+      peer.nextBondSeq = 0;
+      std::memset(peer.delivered, 0, sizeof(peer.delivered));
+      peer.newestDelivered = 0;
+      peer.anyDelivered = false;
+      peer.up = false;
+      peer.silence = 0;
+      peer.forwardHead = 0;
+      peer.forwardQueued = 0;
+      peer.sending = false;
+      m_turns[node] = 0;
+      m_sessions[node] = 0;
+
+      // The owner sets the retransmit timeout it starts with
+      RFSession::Session& session = peer.session;
+      for (U32 i = 0; i < RFStream::NUM_CONSTANTS; i++) {
+        session.queues[i].head = 0;
+        session.queues[i].count = 0;
+        session.queues[i].deficit = 0;
+        session.queues[i].parityRows = 0;
+        session.queues[i].forwardTurn = false;
+      }
+      session.stream = 0;
+      session.count = 0;
+      session.arqSynced = false;
+      session.sendBase = 0;
+      session.sendNext = 0;
+      session.rttValid = false;
+      session.srttUs = 0;
+      session.rttVarUs = 0;
+      session.rtoUs = 0;
+      session.receiveSynced = false;
+      session.receiveBase = 0;
+      session.ackPending = false;
+      session.framesSinceAck = 0;
+      for (U32 i = 0; i < RFFragment::ARQ_MAX_WINDOW; i++) {
+        session.arqTx[i].used = false;
+        session.arqTx[i].radio = 0;
+        session.arqRx[i].seen = false;
+      }
+    }
+  }
+
+  U8 RFPeerTable ::
+    nextHop(U8 node) const
+  {
+    FW_ASSERT(node < RFRoute::MAX_NODES, node);
+    return m_peers[node].nextHop;
+  }
+
+  void RFPeerTable ::
+    setRoute(U8 node, U8 nextHop)
+  {
+    FW_ASSERT(node < RFRoute::MAX_NODES && nextHop < RFRoute::MAX_NODES, node, nextHop);
+    m_peers[node].nextHop = nextHop;
+  }
+
+  U8 RFPeerTable ::
+    takeMsgId(U8 neighbor)
+  {
+    FW_ASSERT(neighbor < RFRoute::MAX_NODES, neighbor);
+    return m_peers[neighbor].nextMsgId++;
+  }
+
+  U8 RFPeerTable ::
+    takeBondSeq(U8 neighbor)
+  {
+    FW_ASSERT(neighbor < RFRoute::MAX_NODES, neighbor);
+    return m_peers[neighbor].nextBondSeq++;
+  }
+
+  void RFPeerTable ::
+    markDelivered(U8 neighbor, U8 msgId)
+  {
+    FW_ASSERT(neighbor < RFRoute::MAX_NODES, neighbor);
+    Peer& peer = m_peers[neighbor];
+    // Ids half the space behind the newest delivered are taken as free for new messages. The
+    // window moves over every id on the way, those of messages lost outright included.
+    U32 ahead = 1;
+    if (peer.anyDelivered) {
+      ahead = static_cast<U8>(msgId - peer.newestDelivered);
+      ahead = (ahead < 128) ? ahead : 0;
+    }
+    for (U32 step = 0; step < ahead; step++) {
+      const U8 stale = static_cast<U8>(msgId + 128 - step);
+      peer.delivered[stale / 32U] &= ~(1U << (stale % 32U));
+    }
+    if (ahead > 0) {
+      peer.newestDelivered = msgId;
+      peer.anyDelivered = true;
+    }
+    peer.delivered[msgId / 32U] |= 1U << (msgId % 32U);
+  }
+
+  void RFPeerTable ::
+    clearDelivered(U8 neighbor, U8 msgId)
+  {
+    FW_ASSERT(neighbor < RFRoute::MAX_NODES, neighbor);
+    m_peers[neighbor].delivered[msgId / 32U] &= ~(1U << (msgId % 32U));
+  }
+
+  bool RFPeerTable ::
+    delivered(U8 neighbor, U8 msgId) const
+  {
+    FW_ASSERT(neighbor < RFRoute::MAX_NODES, neighbor);
+    return (m_peers[neighbor].delivered[msgId / 32U] & (1U << (msgId % 32U))) != 0;
+  }
+
+  bool RFPeerTable ::
+    heard(U8 neighbor)
+  {
+    FW_ASSERT(neighbor < RFRoute::MAX_NODES, neighbor);
+    Peer& peer = m_peers[neighbor];
+    const bool wasDown = !peer.up;
+    peer.up = true;
+    peer.silence = 0;
+    return wasDown;
+  }
+
+  bool RFPeerTable ::
+    age(U8 neighbor)
+  {
+    FW_ASSERT(neighbor < RFRoute::MAX_NODES, neighbor);
+    Peer& peer = m_peers[neighbor];
+    if (!peer.up) {
+      return false;
+    }
+    peer.silence++;
+    peer.up = (peer.silence <= RFRoute::SILENT_TICKS);
+    return !peer.up;
+  }
+
+  bool RFPeerTable ::
+    up(U8 neighbor) const
+  {
+    FW_ASSERT(neighbor < RFRoute::MAX_NODES, neighbor);
+    return m_peers[neighbor].up;
+  }
+
+  bool RFPeerTable ::
+    queueForward(U8 origin, const Fw::Buffer& buffer, U8 stream)
+  {
+    FW_ASSERT(origin < RFRoute::MAX_NODES, origin);
+    Peer& peer = m_peers[origin];
+    if (peer.forwardQueued == RFRoute::FORWARD_DEPTH) {
+      return false;
+    }
+    // An origin joins the back of the turns with its first message
+    if (peer.forwardQueued == 0) {
+      FW_ASSERT(m_turnCount < RFRoute::MAX_NODES, m_turnCount);
+      m_turns[(m_turnHead + m_turnCount) % RFRoute::MAX_NODES] = origin;
+      m_turnCount++;
+    }
+    ForwardEntry& entry = peer.forward[(peer.forwardHead + peer.forwardQueued) % RFRoute::FORWARD_DEPTH];
+    entry.buffer = buffer;
+    entry.stream = stream;
+    peer.forwardQueued++;
+    m_forwardCount++;
+    return true;
+  }
+
+  bool RFPeerTable ::
+    takeForward(U32 streamMask, Fw::Buffer& buffer, U8& stream, U8& neighbor)
+  {
+    for (U32 k = 0; k < m_turnCount; k++) {
+      const U32 position = (m_turnHead + k) % RFRoute::MAX_NODES;
+      Peer& peer = m_peers[m_turns[position]];
+      const ForwardEntry& entry = peer.forward[peer.forwardHead];
+      // The route is looked up as the message leaves, after any SET_ROUTE since it came in
+      const U8 nextHop = this->nextHop(entry.buffer.getData()[0]);
+      if ((streamMask & (1U << entry.stream)) == 0 ||
+          m_peers[nextHop].session.queues[entry.stream].count == RFSession::TX_QUEUE_DEPTH) {
+        continue;
+      }
+      buffer = entry.buffer;
+      stream = entry.stream;
+      neighbor = nextHop;
+      peer.forwardHead = (peer.forwardHead + 1) % RFRoute::FORWARD_DEPTH;
+      peer.forwardQueued--;
+      m_forwardCount--;
+
+      // The origin leaves its place; the ones it passed keep theirs ahead of it, and it goes to
+      // the back if it has more waiting
+      const U8 origin = m_turns[position];
+      for (U32 j = k; j > 0; j--) {
+        m_turns[(m_turnHead + j) % RFRoute::MAX_NODES] = m_turns[(m_turnHead + j - 1) % RFRoute::MAX_NODES];
+      }
+      m_turnHead = (m_turnHead + 1) % RFRoute::MAX_NODES;
+      m_turnCount--;
+      if (peer.forwardQueued > 0) {
+        m_turns[(m_turnHead + m_turnCount) % RFRoute::MAX_NODES] = origin;
+        m_turnCount++;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  RFSession::Session& RFPeerTable ::
+    session(U8 neighbor)
+  {
+    FW_ASSERT(neighbor < RFRoute::MAX_NODES, neighbor);
+    return m_peers[neighbor].session;
+  }
+
+  void RFPeerTable ::
+    wakeSession(U8 neighbor)
+  {
+    FW_ASSERT(neighbor < RFRoute::MAX_NODES, neighbor);
+    Peer& peer = m_peers[neighbor];
+    if (peer.sending) {
+      return;
+    }
+    FW_ASSERT(m_sessionCount < RFRoute::MAX_NODES, m_sessionCount);
+    m_sessions[(m_sessionHead + m_sessionCount) % RFRoute::MAX_NODES] = neighbor;
+    m_sessionCount++;
+    peer.sending = true;
+  }
+
+  void RFPeerTable ::
+    dropIdleSessions()
+  {
+    U32 kept = 0;
+    for (U32 k = 0; k < m_sessionCount; k++) {
+      const U8 neighbor = m_sessions[(m_sessionHead + k) % RFRoute::MAX_NODES];
+      Peer& peer = m_peers[neighbor];
+      if (idle(peer.session)) {
+        peer.sending = false;
+        continue;
+      }
+      m_sessions[(m_sessionHead + kept) % RFRoute::MAX_NODES] = neighbor;
+      kept++;
+    }
+    m_sessionCount = kept;
+  }
+
+  U8 RFPeerTable ::
+    sessionAt(U32 position) const
+  {
+    FW_ASSERT(position < m_sessionCount, position, m_sessionCount);
+    return m_sessions[(m_sessionHead + position) % RFRoute::MAX_NODES];
+  }
+
+  void RFPeerTable ::
+    passTurn(U32 position)
+  {
+    FW_ASSERT(position < m_sessionCount, position, m_sessionCount);
+    const U8 neighbor = m_sessions[(m_sessionHead + position) % RFRoute::MAX_NODES];
+    for (U32 j = position; j > 0; j--) {
+      m_sessions[(m_sessionHead + j) % RFRoute::MAX_NODES] = m_sessions[(m_sessionHead + j - 1) % RFRoute::MAX_NODES];
+    }
+    m_sessionHead = (m_sessionHead + 1) % RFRoute::MAX_NODES;
+    m_sessionCount--;
+    Peer& peer = m_peers[neighbor];
+    if (idle(peer.session)) {
+      peer.sending = false;
+    } else {
+      m_sessions[(m_sessionHead + m_sessionCount) % RFRoute::MAX_NODES] = neighbor;
+      m_sessionCount++;
+    }
+  }
+
+  bool RFPeerTable ::
+    idle(const RFSession::Session& session)
+  {
+    return session.count == 0 && session.sendBase == session.sendNext;
+  }
+
+}
@@ -0,0 +1,256 @@
+// ======================================================================
+// \title  RFPeerTable.hpp
+// \author mustafa
+// \brief  hpp file for the table of the nodes RFCommManager talks to
+//
+// Every radio has a node address (see NRF24Driver), a gateway and its
+// field nodes share the channel and tell each other apart by it. The
+// table holds one entry per node, indexed by the address: the neighbor
+// messages for it go through, the message ids towards it and heard from
+// it, whether it was heard lately, the messages of it that wait to be
+// forwarded, and the session with it as a neighbor: the messages queued
+// for it and the ARQ windows both ways. It is sized for every address up
+// front, nothing is allocated as peers come and go.
+//
+// Neighbors whose sessions have messages queued or ARQ frames not yet
+// acknowledged take turns sending, so one node with a deep queue or a
+// bad link does not hold up the others.
+//
+// A message for a node that is not a neighbor starts with a route header:
+//
+//   | destination (U8) | origin (U8) | hops (U8) | message ... |
+//
+// hops is the number of radio hops the message may still take, a relay
+// takes off the one it came in on and drops the message once none is
+// left. Relays reassemble the whole message before sending it on, so it
+// is forwarded at most once per hop whatever its fragments went through.
+// ======================================================================
+
+#ifndef Components_RFPeerTable_HPP
+#define Components_RFPeerTable_HPP
+
+#include <FpConfig.hpp>
+#include <Fw/Buffer/Buffer.hpp>
+#include <Os/RawTime.hpp>
+
+#include "Components/NRF24Driver/NRF24Registers.hpp"
+#include "Components/RFCommManager/RFFecCodec.hpp"
+#include "Components/RFCommManager/RFFragment.hpp"
+#include "Components/RFCommManager/RFStreamEnumAc.hpp"
+
+namespace Components {
+
+namespace RFRoute {
+
+  //! Node addresses, the size of the peer table
+  static const U32 MAX_NODES = NRF24::MAX_NODES;
+
+  //! Bytes of route header ahead of a routed message
+  static const U32 HEADER_SIZE = 3;
+
+  //! Nodes a message may go through until SET_DESTINATION changes it
+  static const U8 DEFAULT_HOP_LIMIT = 4;
+
+  //! Messages waiting to be forwarded per origin
+  static const U32 FORWARD_DEPTH = 2;
+
+  //! Run ticks without a frame from a neighbor before it is taken as down
+  static const U32 SILENT_TICKS = 10;
+
+}
+
+namespace RFSession {
+
+  //! Messages each stream holds per neighbor waiting to be fragmented
+  static const U32 TX_QUEUE_DEPTH = 4;
+
+  //! A message being fragmented, either a held Fw::Buffer or a copied com packet
+  struct TxMessage {
+    Fw::Buffer buffer; //!< Buffer from comDataIn, bridgeIn or a peer to forward, invalid for com packets
+    const U8* data; //!< Message bytes after the route header
+    FwSizeType size; //!< Route header included
+    U8 route[RFRoute::HEADER_SIZE]; //!< Route header of a message for a node that is not a neighbor
+    U8 routeSize; //!< Bytes of it, 0 when the data starts with its own or needs none
+    bool routed; //!< The message starts with a route header
+    U8 msgId;
+    U8 next; //!< Next fragment index
+    U8 count;
+    Os::RawTime queuedAt;
+    U8 storage[FW_COM_BUFFER_MAX_SIZE]; //!< Com packet bytes
+  };
+
+  //! The messages of one RFStream queued for a neighbor
+  struct TxQueue {
+    TxMessage messages[TX_QUEUE_DEPTH];
+    U32 head;
+    U32 count;
+    U32 deficit; //!< Fragments left in the stream's current turn
+    U8 parity[RFFec::MAX_PARITY][RFFec::SYMBOL_SIZE]; //!< Parity of the head message's block being sent
+    U32 parityRows; //!< Rows of it, 0 when the block goes without
+    bool forwardTurn; //!< A message to forward takes the next room in the queue before a held buffer
+  };
+
+  //! A sequenced frame kept until the neighbor acknowledges it
+  struct ArqTxSlot {
+    bool used; //!< Sent or waiting to be, until acknowledged
+    bool queued; //!< Waiting for a credit to go (back) out
+    U8 radio; //!< Radio of its last transmission
+    U32 handoff; //!< The radio's frames handed at its last transmission
+    U8 pipe;
+    U8 length;
+    U32 tries; //!< Transmissions so far
+    Os::RawTime sentAt; //!< Last transmission
+  };
+
+  //! An ARQ frame received ahead of a missing one
+  struct ArqRxSlot {
+    bool seen;
+    U8 pipe;
+    U8 length;
+  };
+
+  //! The exchange with one neighbor
+  struct Session {
+    TxQueue queues[RFStream::NUM_CONSTANTS];
+    U32 stream; //!< Stream whose turn it is
+    U32 count; //!< Messages queued over all streams
+
+    bool arqSynced; //!< An ACK arrived since ARQ was enabled, SYNC flags are no longer needed
+    U8 sendBase; //!< Oldest unacknowledged sequence number
+    U8 sendNext; //!< Next sequence number to assign
+    ArqTxSlot arqTx[RFFragment::ARQ_MAX_WINDOW];
+    U8 arqTxFrames[RFFragment::ARQ_MAX_WINDOW][NRF24::MAX_PAYLOAD_SIZE];
+    bool rttValid;
+    U32 srttUs;
+    U32 rttVarUs;
+    U32 rtoUs;
+
+    bool receiveSynced; //!< A SYNC frame set the receive window base
+    U8 receiveBase; //!< Next sequence number expected in order
+    ArqRxSlot arqRx[RFFragment::ARQ_MAX_WINDOW];
+    U8 arqRxFrames[RFFragment::ARQ_MAX_WINDOW][NRF24::MAX_PAYLOAD_SIZE];
+    bool ackPending;
+    U32 framesSinceAck;
+  };
+
+}
+
+  class RFPeerTable {
+
+    public:
+
+      RFPeerTable();
+
+      //! Next hop towards a node, the node itself unless a route was set
+      U8 nextHop(U8 node) const;
+
+      //! Send messages for a node through a neighbor, the node itself for a direct link
+      void setRoute(U8 node, U8 nextHop);
+
+      //! Message id the next message to a neighbor takes
+      U8 takeMsgId(U8 neighbor);
+
+      //! Sequence number the next DATA frame to a neighbor takes, for the receiver to put bonded radios back in order
+      U8 takeBondSeq(U8 neighbor);
+
+      //! Remember a message from a neighbor as delivered, so frames coming after it do not deliver it again
+      void markDelivered(U8 neighbor, U8 msgId);
+
+      //! Forget a delivered message, its id was taken by a new one
+      void clearDelivered(U8 neighbor, U8 msgId);
+
+      bool delivered(U8 neighbor, U8 msgId) const;
+
+      //! A frame came from a neighbor
+      //! \return true if it was down
+      bool heard(U8 neighbor);
+
+      //! One run tick went by without a frame from a neighbor
+      //! \return true if it went down with it
+      bool age(U8 neighbor);
+
+      bool up(U8 neighbor) const;
+
+      //! Hold a reassembled message until its stream has room
+      //! \return false if the origin already has FORWARD_DEPTH messages waiting
+      bool queueForward(
+          U8 origin, //!< Node the message started at
+          const Fw::Buffer& buffer, //!< The message, route header included
+          U8 stream //!< RFStream it came on
+      );
+
+      //! Take the next message to forward, origins in turn. An origin whose next message is on a
+      //! stream not in the mask, or whose next hop has no room on it, keeps its turn.
+      //! \return false if no origin has a message that can go
+      bool takeForward(
+          U32 streamMask, //!< Bit s set when stream s takes a message
+          Fw::Buffer& buffer,
+          U8& stream,
+          U8& neighbor //!< Next hop, looked up as the message leaves
+      );
+
+      //! Messages waiting to be forwarded
+      U32 forwardCount() const { return m_forwardCount; }
+
+      //! Session with a neighbor
+      RFSession::Session& session(U8 neighbor);
+
+      //! Put a neighbor at the back of the session turns unless it is in them, a message was queued for it
+      void wakeSession(U8 neighbor);
+
+      //! Take the sessions with nothing queued and nothing unacknowledged out of the turns, the
+      //! others keep their order
+      void dropIdleSessions();
+
+      //! Neighbors taking turns, the one whose turn it is first
+      U32 sessionCount() const { return m_sessionCount; }
+
+      //! Neighbor at a position in the turns
+      U8 sessionAt(U32 position) const;
+
+      //! The session at a position took its turn: it goes to the back, or leaves the turns once
+      //! idle. The ones it passed keep their places ahead of it.
+      void passTurn(U32 position);
+
+    private:
+
+      struct ForwardEntry {
+        Fw::Buffer buffer;
+        U8 stream;
+      };
+
+      struct Peer {
+        U8 nextHop;
+        U8 nextMsgId; //!< Message ids sent to the node as a neighbor
+        U8 nextBondSeq; //!< DATA frames sent to the node as a neighbor
+        U32 delivered[256 / 32]; //!< Message ids from the node as a neighbor delivered lately
+        U8 newestDelivered; //!< Furthest ahead of them, valid once anyDelivered
+        bool anyDelivered;
+        bool up;
+        U32 silence; //!< Run ticks since its last frame
+        ForwardEntry forward[RFRoute::FORWARD_DEPTH];
+        U32 forwardHead;
+        U32 forwardQueued;
+        RFSession::Session session; //!< With the node as a neighbor
+        bool sending; //!< The session is in the turns
+      };
+
+      //! Whether a session has nothing queued and nothing unacknowledged
+      static bool idle(const RFSession::Session& session);
+
+      Peer m_peers[RFRoute::MAX_NODES];
+
+      U8 m_turns[RFRoute::MAX_NODES]; //!< Origins with messages waiting, the next one to forward first
+      U32 m_turnHead;
+      U32 m_turnCount;
+      U32 m_forwardCount;
+
+      U8 m_sessions[RFRoute::MAX_NODES]; //!< Neighbors whose sessions take turns, the next one to send first
+      U32 m_sessionHead;
+      U32 m_sessionCount;
+
+  };
+
+}
+
+#endif
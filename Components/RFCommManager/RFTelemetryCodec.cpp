@@ -0,0 +1,696 @@
+// ======================================================================
+// \title  RFTelemetryCodec.cpp
+// \author mustafa
+// \brief  cpp file for the telemetry encoder and decoder
+// ======================================================================
+
+#include "Components/RFCommManager/RFTelemetryCodec.hpp"
+
+#include <Fw/Types/Assert.hpp>
+
+#include <cstring>
+
+namespace Components {
+
+  namespace {
+
+    static_assert(RFTelemetry::VALUE_BYTES <= 0xFFFF, "Value offsets are U16");
+    static_assert(RFTelemetry::MAX_CHANNELS <= 0xFF, "Table order is kept in U8");
+
+    const I64 US_PER_SECOND = 1000000;
+
+    //! Largest varint of a 64 bit value
+    const U32 MAX_VARINT_SIZE = 10;
+
+    //! 7 bits per byte, least significant first, the top bit set on all but the last byte
+    U32 putVarint(U8* out, U64 value) {
+      U32 length = 0;
+      while (value >= 0x80) {
+        out[length++] = static_cast<U8>(value | 0x80);
+        value >>= 7;
+      }
+      out[length++] = static_cast<U8>(value);
+      return length;
+    }
+
+    bool getVarint(const U8* data, FwSizeType size, FwSizeType& offset, U64& value) {
+      value = 0;
+      for (U32 shift = 0; shift < 7 * MAX_VARINT_SIZE && offset < size; shift += 7) {
+        const U8 byte = data[offset++];
+        value |= static_cast<U64>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    //! Small magnitudes of either sign to small unsigned values: 0, -1, 1, -2 ... to 0, 1, 2, 3 ...
+    U64 zigZag(I64 value) {
+      return (static_cast<U64>(value) << 1) ^ static_cast<U64>(value >> 63);
+    }
+
+    I64 unZigZag(U64 value) {
+      return static_cast<I64>(value >> 1) ^ -static_cast<I64>(value & 1);
+    }
+
+    //! Big-endian word of 1 to 4 bytes
+    U32 getWord(const U8* data, U32 width) {
+      U32 word = 0;
+      for (U32 i = 0; i < width; i++) {
+        word = (word << 8) | data[i];
+      }
+      return word;
+    }
+
+    void putWord(U8* data, U32 width, U32 word) {
+      for (U32 i = width; i > 0; i--) {
+        data[i - 1] = static_cast<U8>(word);
+        word >>= 8;
+      }
+    }
+
+    //! Difference of two words of the given width, sign extended from it
+    I64 wordDelta(U32 current, U32 base, U32 width) {
+      const U32 shift = 32 - 8 * width;
+      return static_cast<I32>((current - base) << shift) >> shift;
+    }
+
+    //! Fw::Time as serialized: time base (U16), context (U8), seconds (U32), microseconds (U32)
+    void putTime(U8* out, const Fw::Time& time) {
+      putWord(&out[0], 2, static_cast<U32>(time.getTimeBase()));
+      out[2] = static_cast<U8>(time.getContext());
+      putWord(&out[3], 4, time.getSeconds());
+      putWord(&out[7], 4, time.getUSeconds());
+    }
+
+    Fw::Time getTime(const U8* data) {
+      return Fw::Time(static_cast<TimeBase>(getWord(&data[0], 2)), data[2], getWord(&data[3], 4), getWord(&data[7], 4));
+    }
+
+    I64 timeUs(const Fw::Time& time) {
+      return static_cast<I64>(time.getSeconds()) * US_PER_SECOND + time.getUSeconds();
+    }
+
+    //! Whether a time tag cannot be given as an offset from the reference
+    bool isRawTime(const Fw::Time& time, const Fw::Time& reference) {
+      return time.getTimeBase() != reference.getTimeBase() || time.getContext() != reference.getContext();
+    }
+
+    //! Time tag of an entry, raw or as an offset from the reference
+    U32 putEntryTime(U8* out, const Fw::Time& time, const Fw::Time& reference) {
+      if (isRawTime(time, reference)) {
+        putTime(out, time);
+        return Fw::Time::SERIALIZED_SIZE;
+      }
+      return putVarint(out, zigZag(timeUs(time) - timeUs(reference)));
+    }
+
+  }
+
+  // ----------------------------------------------------------------------
+  // Table
+  // ----------------------------------------------------------------------
+
+  RFTelemetryTable ::
+    RFTelemetryTable()
+  {
+    this->clear();
+  }
+
+  void RFTelemetryTable ::
+    clear()
+  {
+    m_count = 0;
+    m_bytes = 0;
+  }
+
+  U32 RFTelemetryTable ::
+    find(FwChanIdType id) const
+  {
+    U32 low = 0;
+    U32 high = m_count;
+    while (low < high) {
+      const U32 middle = (low + high) / 2;
+      const FwChanIdType middleId = m_channels[m_order[middle]].id;
+      if (middleId == id) {
+        return m_order[middle];
+      }
+      if (middleId < id) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    return RFTelemetry::MAX_CHANNELS;
+  }
+
+  U32 RFTelemetryTable ::
+    add(FwChanIdType id, U32 size)
+  {
+    if (m_count == RFTelemetry::MAX_CHANNELS || size == 0 || size > RFTelemetry::MAX_VALUE_SIZE ||
+        size > RFTelemetry::VALUE_BYTES - m_bytes) {
+      return RFTelemetry::MAX_CHANNELS;
+    }
+    const U32 index = m_count;
+    m_channels[index].id = id;
+    m_channels[index].offset = static_cast<U16>(m_bytes);
+    m_channels[index].size = static_cast<U8>(size);
+    m_bytes += size;
+
+    // Channels register once, at their first update, so the insertion sort is off the steady path
+    U32 rank = m_count;
+    while (rank > 0 && m_channels[m_order[rank - 1]].id > id) {
+      m_order[rank] = m_order[rank - 1];
+      rank--;
+    }
+    m_order[rank] = static_cast<U8>(index);
+    m_count++;
+    return index;
+  }
+
+  // ----------------------------------------------------------------------
+  // Encoder
+  // ----------------------------------------------------------------------
+
+  RFTelemetryEncoder ::
+    RFTelemetryEncoder() :
+      m_plainBytes(0),
+      m_packs(0),
+      m_priorityCount(0),
+      m_pendingCount(0),
+      m_pendingBytes(0),
+      m_pendingSeq(0),
+      m_pendingValid(false),
+      m_keyframe(false),
+      m_rank(0),
+      m_part(0),
+      m_done(true),
+      m_baseCount(0),
+      m_baseSeq(0),
+      m_baseValid(false),
+      m_seq(0)
+  {
+
+  }
+
+  bool RFTelemetryEncoder ::
+    update(FwChanIdType id, const Fw::Time& time, const U8* value, U32 size)
+  {
+    U32 index = m_table.find(id);
+    if (index == RFTelemetry::MAX_CHANNELS) {
+      index = m_table.add(id, size);
+      if (index == RFTelemetry::MAX_CHANNELS) {
+        return false;
+      }
+      m_priorities[index] = 0;
+      for (U32 i = 0; i < m_priorityCount; i++) {
+        if (m_priorityIds[i] == id) {
+          m_priorities[index] = m_priorityValues[i];
+        }
+      }
+      m_lastPacked[index] = m_packs;
+    } else if (m_table.size(index) != size) {
+      return false;
+    }
+
+    std::memcpy(&m_latest[m_table.offset(index)], value, size);
+    m_latestTimes[index] = time;
+    m_dirty[index] = true;
+    m_plainBytes += static_cast<U32>(sizeof(FwChanIdType)) + Fw::Time::SERIALIZED_SIZE + size;
+    return true;
+  }
+
+  U32 RFTelemetryEncoder ::
+    snapshot(bool keyframe, const Fw::Time& now)
+  {
+    m_pendingCount = m_table.count();
+    m_pendingBytes = m_table.bytes();
+    std::memcpy(m_pending, m_latest, m_pendingBytes);
+    for (U32 rank = 0; rank < m_pendingCount; rank++) {
+      const U32 index = m_table.byRank(rank);
+      m_pendingOrder[rank] = static_cast<U8>(index);
+      m_pendingTimes[index] = m_latestTimes[index];
+    }
+
+    // An acknowledgment of an earlier update comes too late, the peer overwrites it with this one
+    m_seq++;
+    m_pendingSeq = m_seq;
+    m_pendingValid = true;
+    m_keyframe = keyframe || !m_baseValid;
+    m_reference = now;
+    m_rank = 0;
+    m_part = 0;
+    m_done = false;
+
+    const U32 plainBytes = m_plainBytes;
+    m_plainBytes = 0;
+    return plainBytes;
+  }
+
+  U32 RFTelemetryEncoder ::
+    encodePart(U8* part, U32 capacity, U32& channels)
+  {
+    FW_ASSERT(capacity >= RFTelemetry::HEADER_SIZE + RFTelemetry::MAX_ENTRY_SIZE, capacity);
+    channels = 0;
+    if (m_done) {
+      return 0;
+    }
+
+    U32 length = RFTelemetry::HEADER_SIZE;
+    FwChanIdType previous = 0;
+    while (m_rank < m_pendingCount) {
+      const U32 index = m_pendingOrder[m_rank];
+      const U32 offset = m_table.offset(index);
+      if (!m_keyframe && index < m_baseCount &&
+          std::memcmp(&m_pending[offset], &m_base[offset], m_table.size(index)) == 0) {
+        m_rank++;
+        continue;
+      }
+      const U32 entry = this->encodeEntry(index, previous, &part[length], capacity - length);
+      if (entry == 0) {
+        break;
+      }
+      length += entry;
+      previous = m_table.id(index);
+      channels++;
+      m_rank++;
+    }
+
+    const bool last = (m_rank == m_pendingCount);
+    m_done = last;
+    if (channels == 0 && m_part == 0) {
+      // Nothing differs from the base, there is no update to acknowledge
+      m_pendingValid = false;
+      return 0;
+    }
+
+    part[0] = RFTelemetry::MAGIC;
+    part[1] = static_cast<U8>((m_keyframe ? RFTelemetry::FLAG_KEYFRAME : 0) | (last ? RFTelemetry::FLAG_LAST : 0));
+    part[2] = m_pendingSeq;
+    // Without a base a keyframe names itself, the peer drops whatever base it holds
+    part[3] = m_baseValid ? m_baseSeq : m_pendingSeq;
+    part[4] = m_part;
+    putTime(&part[5], m_reference);
+    m_part++;
+    return length;
+  }
+
+  U32 RFTelemetryEncoder ::
+    encodeEntry(U32 index, FwChanIdType previous, U8* out, U32 capacity) const
+  {
+    U8 entry[RFTelemetry::MAX_ENTRY_SIZE];
+    const FwChanIdType id = m_table.id(index);
+    const U32 size = m_table.size(index);
+    const U32 offset = m_table.offset(index);
+    const Fw::Time& time = m_pendingTimes[index];
+    const bool rawValue = m_keyframe || index >= m_baseCount;
+
+    const U64 head = (static_cast<U64>(id - previous) << 2) | (rawValue ? RFTelemetry::RAW_VALUE : 0) |
+                     (isRawTime(time, m_reference) ? RFTelemetry::RAW_TIME : 0);
+    U32 length = putVarint(entry, head);
+    length += putEntryTime(&entry[length], time, m_reference);
+
+    if (rawValue) {
+      entry[length++] = static_cast<U8>(size);
+      std::memcpy(&entry[length], &m_pending[offset], size);
+      length += size;
+    } else {
+      for (U32 word = 0; word < size; word += 4) {
+        const U32 width = (size - word < 4) ? (size - word) : 4;
+        const I64 delta = wordDelta(getWord(&m_pending[offset + word], width), getWord(&m_base[offset + word], width), width);
+        length += putVarint(&entry[length], zigZag(delta));
+      }
+    }
+
+    if (length > capacity) {
+      return 0;
+    }
+    std::memcpy(out, entry, length);
+    return length;
+  }
+
+  bool RFTelemetryEncoder ::
+    setPriority(FwChanIdType id, U8 priority)
+  {
+    const U32 index = m_table.find(id);
+    if (index != RFTelemetry::MAX_CHANNELS) {
+      m_priorities[index] = priority;
+      return true;
+    }
+    for (U32 i = 0; i < m_priorityCount; i++) {
+      if (m_priorityIds[i] == id) {
+        m_priorityValues[i] = priority;
+        return true;
+      }
+    }
+    if (m_priorityCount == RFTelemetry::MAX_PRIORITIES) {
+      return false;
+    }
+    m_priorityIds[m_priorityCount] = id;
+    m_priorityValues[m_priorityCount] = priority;
+    m_priorityCount++;
+    return true;
+  }
+
+  U32 RFTelemetryEncoder ::
+    packFrames(const Fw::Time& now, U8* frames, U32 frameSize, U32 count, U32* sizes, U32& channels, U32& plainBytes)
+  {
+    FW_ASSERT(frameSize >= RFTelemetry::FRAME_HEADER_SIZE && frameSize <= RFTelemetry::MAX_FRAME_SIZE, frameSize);
+    FW_ASSERT(count <= RFTelemetry::MAX_FRAMES, count);
+    m_packs++;
+    m_plainBytes = 0;
+    channels = 0;
+    plainBytes = 0;
+    const Fw::Time reference(now.getTimeBase(), now.getContext(), now.getSeconds(), 0);
+
+    // Updated channels first, most urgent first, then the others sent longest ago first
+    U8 order[RFTelemetry::MAX_CHANNELS];
+    U32 updated = 0;
+    U32 total = 0;
+    for (U32 index = 0; index < m_table.count(); index++) {
+      U32 rank = total;
+      if (m_dirty[index]) {
+        // Clean channels after the updated ones move up by one
+        for (U32 k = total; k > updated; k--) {
+          order[k] = order[k - 1];
+        }
+        rank = updated;
+        while (rank > 0 && this->urgency(order[rank - 1]) < this->urgency(index)) {
+          order[rank] = order[rank - 1];
+          rank--;
+        }
+        updated++;
+      } else {
+        while (rank > updated && m_lastPacked[order[rank - 1]] > m_lastPacked[index]) {
+          order[rank] = order[rank - 1];
+          rank--;
+        }
+      }
+      order[rank] = static_cast<U8>(index);
+      total++;
+    }
+
+    // First fit, with each entry sized for an id gap from 0, the most it can take once the frame
+    // is put in id order. Only updated channels open frames.
+    U32 used[RFTelemetry::MAX_FRAMES];
+    U8 members[RFTelemetry::MAX_FRAMES][RFTelemetry::MAX_FRAME_SIZE / 4];
+    U32 memberCount[RFTelemetry::MAX_FRAMES];
+    U32 opened = 0;
+    U8 entry[RFTelemetry::MAX_ENTRY_SIZE];
+    for (U32 k = 0; k < total; k++) {
+      const U32 index = order[k];
+      const U32 size = this->encodeFrameEntry(index, 0, reference, entry);
+      U32 frame = 0;
+      while (frame < opened && used[frame] + size > frameSize) {
+        frame++;
+      }
+      if (frame == opened) {
+        if (k >= updated || opened == count || RFTelemetry::FRAME_HEADER_SIZE + size > frameSize) {
+          continue;
+        }
+        used[opened] = RFTelemetry::FRAME_HEADER_SIZE;
+        memberCount[opened] = 0;
+        opened++;
+      }
+      used[frame] += size;
+      members[frame][memberCount[frame]++] = static_cast<U8>(index);
+    }
+
+    for (U32 frame = 0; frame < opened; frame++) {
+      U8* const out = &frames[frame * frameSize];
+      U8* const indices = members[frame];
+      for (U32 k = 1; k < memberCount[frame]; k++) {
+        const U8 index = indices[k];
+        U32 rank = k;
+        while (rank > 0 && m_table.id(indices[rank - 1]) > m_table.id(index)) {
+          indices[rank] = indices[rank - 1];
+          rank--;
+        }
+        indices[rank] = index;
+      }
+
+      out[0] = RFTelemetry::FRAME_MAGIC;
+      putWord(&out[1], 2, static_cast<U32>(reference.getTimeBase()));
+      out[3] = static_cast<U8>(reference.getContext());
+      putWord(&out[4], 4, reference.getSeconds());
+      U32 length = RFTelemetry::FRAME_HEADER_SIZE;
+      FwChanIdType previous = 0;
+      for (U32 k = 0; k < memberCount[frame]; k++) {
+        const U32 index = indices[k];
+        length += this->encodeFrameEntry(index, previous, reference, &out[length]);
+        previous = m_table.id(index);
+        m_dirty[index] = false;
+        m_lastPacked[index] = m_packs;
+        plainBytes += static_cast<U32>(sizeof(FwChanIdType)) + Fw::Time::SERIALIZED_SIZE + m_table.size(index);
+      }
+      FW_ASSERT(length <= used[frame], length, used[frame]);
+      sizes[frame] = length;
+      channels += memberCount[frame];
+    }
+    return opened;
+  }
+
+  U32 RFTelemetryEncoder ::
+    encodeFrameEntry(U32 index, FwChanIdType previous, const Fw::Time& reference, U8* out) const
+  {
+    const FwChanIdType id = m_table.id(index);
+    const U32 size = m_table.size(index);
+    const Fw::Time& time = m_latestTimes[index];
+    const U64 head = (static_cast<U64>(id - previous) << 2) | RFTelemetry::RAW_VALUE |
+                     (isRawTime(time, reference) ? RFTelemetry::RAW_TIME : 0);
+    U32 length = putVarint(out, head);
+    length += putEntryTime(&out[length], time, reference);
+    out[length++] = static_cast<U8>(size);
+    std::memcpy(&out[length], &m_latest[m_table.offset(index)], size);
+    return length + size;
+  }
+
+  U32 RFTelemetryEncoder ::
+    urgency(U32 index) const
+  {
+    return m_priorities[index] + (m_packs - m_lastPacked[index]);
+  }
+
+  void RFTelemetryEncoder ::
+    acknowledge(U8 seq)
+  {
+    if (!m_pendingValid || seq != m_pendingSeq) {
+      return;
+    }
+    std::memcpy(m_base, m_pending, m_pendingBytes);
+    m_baseCount = m_pendingCount;
+    m_baseSeq = seq;
+    m_baseValid = true;
+    m_pendingValid = false;
+  }
+
+  // ----------------------------------------------------------------------
+  // Decoder
+  // ----------------------------------------------------------------------
+
+  RFTelemetryDecoder ::
+    RFTelemetryDecoder() :
+      m_baseCount(0),
+      m_baseSeq(0),
+      m_baseValid(false),
+      m_currentSeq(0),
+      m_currentValid(false),
+      m_active(false),
+      m_keyframe(false),
+      m_seq(0),
+      m_nextPart(0),
+      m_last(false),
+      m_frame(false),
+      m_data(nullptr),
+      m_size(0),
+      m_offset(0),
+      m_id(0),
+      m_error(true)
+  {
+
+  }
+
+  RFTelemetryDecoder::Status RFTelemetryDecoder ::
+    start(const U8* part, FwSizeType size)
+  {
+    m_error = true;
+    m_frame = (size >= RFTelemetry::FRAME_HEADER_SIZE && part[0] == RFTelemetry::FRAME_MAGIC);
+    if (m_frame) {
+      // Frames stand on their own, the update in progress is left as it is
+      m_reference = Fw::Time(static_cast<TimeBase>(getWord(&part[1], 2)), part[3], getWord(&part[4], 4), 0);
+      m_data = part;
+      m_size = size;
+      m_offset = RFTelemetry::FRAME_HEADER_SIZE;
+      m_id = 0;
+      m_error = false;
+      return PART_OK;
+    }
+    if (size < RFTelemetry::HEADER_SIZE || part[0] != RFTelemetry::MAGIC) {
+      return MALFORMED;
+    }
+    const bool keyframe = (part[1] & RFTelemetry::FLAG_KEYFRAME) != 0;
+    const U8 seq = part[2];
+    const U8 base = part[3];
+    const U8 number = part[4];
+
+    if (number == 0) {
+      // Once the next update starts, the sender has either taken the last one as its base or never will
+      m_active = false;
+      if (base == seq || ((!m_baseValid || base != m_baseSeq) && (!m_currentValid || base != m_currentSeq))) {
+        if (!keyframe) {
+          m_currentValid = false;
+          return NO_BASE;
+        }
+        // A sender that lost its base, or restarted and may lay its channels out anew
+        m_table.clear();
+        m_baseCount = 0;
+        m_baseValid = false;
+      } else if (!m_baseValid || base != m_baseSeq) {
+        // The sender took the last update as its base
+        std::memcpy(m_base, m_current, m_table.bytes());
+        m_baseCount = m_table.count();
+        m_baseSeq = m_currentSeq;
+        m_baseValid = true;
+      }
+      std::memcpy(m_current, m_base, m_table.bytes());
+      m_currentValid = false;
+      m_active = true;
+      m_keyframe = keyframe;
+      m_seq = seq;
+      m_nextPart = 0;
+    } else if (!m_active || seq != m_seq || number != m_nextPart) {
+      // A part went missing, what came of the update so far stays but it is not acknowledged
+      m_active = false;
+      return NO_BASE;
+    }
+
+    m_nextPart++;
+    m_last = (part[1] & RFTelemetry::FLAG_LAST) != 0;
+    m_reference = getTime(&part[5]);
+    m_data = part;
+    m_size = size;
+    m_offset = RFTelemetry::HEADER_SIZE;
+    m_id = 0;
+    m_error = false;
+    return PART_OK;
+  }
+
+  bool RFTelemetryDecoder ::
+    next(FwChanIdType& id, Fw::Time& time, const U8*& value, U32& size)
+  {
+    if (m_error || m_offset == m_size) {
+      return false;
+    }
+    // Any error leaves the update unacknowledged
+    m_error = true;
+    if (!m_frame) {
+      m_active = false;
+    }
+
+    U64 head = 0;
+    if (!getVarint(m_data, m_size, m_offset, head)) {
+      return false;
+    }
+    const U64 gap = head >> 2;
+    if (gap > static_cast<FwChanIdType>(~static_cast<FwChanIdType>(0) - m_id)) {
+      return false;
+    }
+    id = static_cast<FwChanIdType>(m_id + gap);
+
+    if ((head & RFTelemetry::RAW_TIME) != 0) {
+      if (m_size - m_offset < Fw::Time::SERIALIZED_SIZE) {
+        return false;
+      }
+      time = getTime(&m_data[m_offset]);
+      m_offset += Fw::Time::SERIALIZED_SIZE;
+    } else {
+      U64 encoded = 0;
+      if (!getVarint(m_data, m_size, m_offset, encoded)) {
+        return false;
+      }
+      const I64 us = timeUs(m_reference) + unZigZag(encoded);
+      if (us < 0 || us / US_PER_SECOND > static_cast<I64>(0xFFFFFFFF)) {
+        return false;
+      }
+      time = Fw::Time(m_reference.getTimeBase(), m_reference.getContext(), static_cast<U32>(us / US_PER_SECOND),
+                      static_cast<U32>(us % US_PER_SECOND));
+    }
+
+    if (m_frame) {
+      if ((head & RFTelemetry::RAW_VALUE) == 0 || m_offset == m_size) {
+        return false;
+      }
+      size = m_data[m_offset++];
+      if (m_size - m_offset < size) {
+        return false;
+      }
+      value = &m_data[m_offset];
+      m_offset += size;
+      m_id = id;
+      m_error = false;
+      return true;
+    }
+
+    U32 index = m_table.find(id);
+    if ((head & RFTelemetry::RAW_VALUE) != 0) {
+      if (m_offset == m_size) {
+        return false;
+      }
+      size = m_data[m_offset++];
+      if (m_size - m_offset < size) {
+        return false;
+      }
+      if (index == RFTelemetry::MAX_CHANNELS) {
+        index = m_table.add(id, size);
+      }
+      if (index == RFTelemetry::MAX_CHANNELS || m_table.size(index) != size) {
+        return false;
+      }
+      std::memcpy(&m_current[m_table.offset(index)], &m_data[m_offset], size);
+      m_offset += size;
+    } else {
+      if (m_keyframe || index >= m_baseCount) {
+        return false;
+      }
+      size = m_table.size(index);
+      U8* const current = &m_current[m_table.offset(index)];
+      const U8* const base = &m_base[m_table.offset(index)];
+      for (U32 word = 0; word < size; word += 4) {
+        const U32 width = (size - word < 4) ? (size - word) : 4;
+        U64 encoded = 0;
+        if (!getVarint(m_data, m_size, m_offset, encoded)) {
+          return false;
+        }
+        const U32 delta = static_cast<U32>(unZigZag(encoded));
+        putWord(&current[word], width, getWord(&base[word], width) + delta);
+      }
+    }
+
+    value = &m_current[m_table.offset(index)];
+    m_id = id;
+    m_error = false;
+    m_active = true;
+    return true;
+  }
+
+  RFTelemetryDecoder::Status RFTelemetryDecoder ::
+    finish()
+  {
+    if (m_frame) {
+      return m_error ? MALFORMED : PART_OK;
+    }
+    if (m_error) {
+      m_active = false;
+      return MALFORMED;
+    }
+    if (!m_last) {
+      return PART_OK;
+    }
+    m_active = false;
+    m_currentSeq = m_seq;
+    m_currentValid = true;
+    return UPDATE_DONE;
+  }
+
+}
@@ -0,0 +1,307 @@
+// ======================================================================
+// \title  RFTelemetryCodec.hpp
+// \author mustafa
+// \brief  hpp file for the telemetry encoder and decoder
+//
+// RFCommManager sends telemetry channels as updates against a base, the
+// last update the peer acknowledged with a TLM_ACK frame. Channels whose
+// value equals the base are left out, the others go as differences. An
+// update that does not fit one message is split into parts:
+//
+//   | MAGIC (U8) | flags (U8) | seq (U8) | base (U8) | part (U8) | time (Fw::Time) | entries ... |
+//
+// flags carries FLAG_KEYFRAME on updates that need no base and FLAG_LAST on
+// the last part. base names the sender's base, which a keyframe leaves in
+// place on the receiver; a sender without one gives the update's own seq.
+// time is the reference of the channel time tags. Each
+// entry starts with a varint head, the id gap from the previous entry of
+// the part (from 0 for the first one) shifted left by two over the
+// RAW_VALUE and RAW_TIME flags:
+//
+//   | head (varint) | time | value |
+//
+// time is a zig-zag varint of microseconds from the reference, or with
+// RAW_TIME a full Fw::Time for a tag on another time base or context.
+// value is the size (U8) and the bytes with RAW_VALUE, taken by keyframes
+// and by channels the base does not hold. Otherwise it is one zig-zag
+// varint per 4 byte big-endian word of the value, the last word possibly
+// shorter, holding the difference from the base word. Counters and most
+// scalars change by little between updates and take a byte or two.
+//
+// In frame mode channels are packed into frames of one radio payload each
+// instead, every one decoded on its own so a lost frame only loses its own
+// channels. Entries are as above, always RAW_VALUE, after a short header
+// whose time reference is a whole second:
+//
+//   | FRAME_MAGIC (U8) | time base (U16) | context (U8) | seconds (U32) | entries ... |
+// ======================================================================
+
+#ifndef Components_RFTelemetryCodec_HPP
+#define Components_RFTelemetryCodec_HPP
+
+#include <FpConfig.hpp>
+#include <Fw/Time/Time.hpp>
+
+namespace Components {
+
+namespace RFTelemetry {
+
+  //! First byte of update messages, which share the TELEMETRY pipe with F' frames (0xDE...)
+  static const U8 MAGIC = 0xA5;
+
+  //! First byte of frame mode frames
+  static const U8 FRAME_MAGIC = 0xA6;
+
+  //! Set on updates carrying every channel with its full value
+  static const U8 FLAG_KEYFRAME = 0x01;
+
+  //! Set on the last part of an update
+  static const U8 FLAG_LAST = 0x02;
+
+  //! Entry head flags
+  static const U8 RAW_VALUE = 0x01;
+  static const U8 RAW_TIME = 0x02;
+
+  //! Bytes of part header ahead of the entries
+  static const U32 HEADER_SIZE = 5 + Fw::Time::SERIALIZED_SIZE;
+
+  //! Bytes of frame header ahead of the entries
+  static const U32 FRAME_HEADER_SIZE = 8;
+
+  //! Largest frame, one radio payload
+  static const U32 MAX_FRAME_SIZE = 32;
+
+  //! Most frames packed at once
+  static const U32 MAX_FRAMES = 8;
+
+  //! Channels given a priority ahead of their first update
+  static const U32 MAX_PRIORITIES = 32;
+
+  //! Channels an encoder or decoder keeps
+  static const U32 MAX_CHANNELS = 128;
+
+  //! Value bytes over all channels
+  static const U32 VALUE_BYTES = 2048;
+
+  //! Largest channel value, its size goes on the air as a U8
+  static const U32 MAX_VALUE_SIZE = 255;
+
+  //! Largest entry: head, raw time, and a value as size and bytes or as one 5 byte varint per word
+  static const U32 MAX_ENTRY_SIZE = 10 + Fw::Time::SERIALIZED_SIZE + 1 + 5 * ((MAX_VALUE_SIZE + 3) / 4);
+
+}
+
+  //! Channels by id, each with a fixed place in the value arrays of the snapshots that use the table.
+  //! Channels are only ever added, so a snapshot taken with n channels stays valid for them.
+  class RFTelemetryTable {
+
+    public:
+
+      RFTelemetryTable();
+
+      //! Forget every channel
+      void clear();
+
+      //! Index of a channel, RFTelemetry::MAX_CHANNELS if it is not in the table
+      U32 find(FwChanIdType id) const;
+
+      //! Add a channel
+      //! \return its index, RFTelemetry::MAX_CHANNELS if the table or the value bytes are full
+      U32 add(FwChanIdType id, U32 size);
+
+      //! Channels in the table
+      U32 count() const { return m_count; }
+
+      //! Value bytes the channels take, from the start of a value array
+      U32 bytes() const { return m_bytes; }
+
+      //! Index of the channel of the given rank in id order
+      U32 byRank(U32 rank) const { return m_order[rank]; }
+
+      FwChanIdType id(U32 index) const { return m_channels[index].id; }
+      U32 size(U32 index) const { return m_channels[index].size; }
+      U32 offset(U32 index) const { return m_channels[index].offset; }
+
+    private:
+
+      struct Channel {
+        FwChanIdType id;
+        U16 offset;
+        U8 size;
+      };
+
+      Channel m_channels[RFTelemetry::MAX_CHANNELS];
+      U8 m_order[RFTelemetry::MAX_CHANNELS]; //!< Indices sorted by id
+      U32 m_count;
+      U32 m_bytes; //!< Value bytes handed out
+
+  };
+
+  //! Sending side: the latest value of each channel, the base the peer holds and the update in flight
+  class RFTelemetryEncoder {
+
+    public:
+
+      RFTelemetryEncoder();
+
+      //! Store the latest value of a channel
+      //! \return false if the channel is new and does not fit, or its size changed
+      bool update(FwChanIdType id, const Fw::Time& time, const U8* value, U32 size);
+
+      //! Take the latest values as the next update. Only this and update touch the latest values,
+      //! the caller serializes them; encoding runs on the snapshot.
+      //! \return bytes the updated channels would take as F' telemetry packet entries, since the last snapshot
+      U32 snapshot(
+          bool keyframe, //!< Send every channel in full, whether or not there is a base
+          const Fw::Time& now //!< Reference of the time tags
+      );
+
+      //! Encode the next part of the update
+      //! \return part size, 0 once the update is out or when it carries nothing
+      U32 encodePart(
+          U8* part, //!< Part to fill
+          U32 capacity, //!< At least HEADER_SIZE + MAX_ENTRY_SIZE
+          U32& channels //!< Channels in the part
+      );
+
+      //! The peer applied an update; if it is the last one taken it becomes the base
+      void acknowledge(U8 seq);
+
+      //! Whether the peer holds a base deltas can refer to
+      bool hasBase() const { return m_baseValid; }
+
+      //! Whether the last update went out in full and its acknowledgment is still due
+      bool awaitingAck() const { return m_pendingValid && m_done; }
+
+      //! Set the priority a channel is packed with in frame mode, 0 (the default) first to wait
+      //! \return false if the channel is not known yet and no more priorities can be kept for later
+      bool setPriority(FwChanIdType id, U8 priority);
+
+      //! Pack the latest values into frames. Channels updated since they last went out are taken
+      //! by priority, raised by one for every call they have waited; the space they leave in the
+      //! frames they opened takes the channels sent longest ago. Same serialization as update.
+      //! \return frames packed
+      U32 packFrames(
+          const Fw::Time& now, //!< Reference of the time tags
+          U8* frames, //!< count frames of frameSize bytes each
+          U32 frameSize, //!< FRAME_HEADER_SIZE to MAX_FRAME_SIZE
+          U32 count, //!< Frames to fill at most, up to MAX_FRAMES
+          U32* sizes, //!< Size of each frame packed
+          U32& channels, //!< Channels in the frames
+          U32& plainBytes //!< Bytes the same channels take as F' telemetry packet entries
+      );
+
+      //! Channels the latest values hold
+      U32 channels() const { return m_table.count(); }
+
+    private:
+
+      //! Write one channel of the update, 0 if it does not fit
+      U32 encodeEntry(U32 index, FwChanIdType previous, U8* out, U32 capacity) const;
+
+      //! Write the latest value of one channel as a frame entry
+      U32 encodeFrameEntry(U32 index, FwChanIdType previous, const Fw::Time& reference, U8* out) const;
+
+      //! Order in which frame mode takes a channel, highest first
+      U32 urgency(U32 index) const;
+
+      RFTelemetryTable m_table;
+
+      U8 m_latest[RFTelemetry::VALUE_BYTES];
+      Fw::Time m_latestTimes[RFTelemetry::MAX_CHANNELS];
+      U32 m_plainBytes; //!< Updated channels as packet entries since the last snapshot
+
+      U8 m_priorities[RFTelemetry::MAX_CHANNELS];
+      bool m_dirty[RFTelemetry::MAX_CHANNELS]; //!< Updated since it last went out in a frame
+      U32 m_lastPacked[RFTelemetry::MAX_CHANNELS]; //!< m_packs when it last went out in a frame
+      U32 m_packs; //!< packFrames calls
+      FwChanIdType m_priorityIds[RFTelemetry::MAX_PRIORITIES]; //!< Priorities of channels not seen yet
+      U8 m_priorityValues[RFTelemetry::MAX_PRIORITIES];
+      U32 m_priorityCount;
+
+      U8 m_pending[RFTelemetry::VALUE_BYTES]; //!< The update being sent
+      Fw::Time m_pendingTimes[RFTelemetry::MAX_CHANNELS];
+      U8 m_pendingOrder[RFTelemetry::MAX_CHANNELS];
+      U32 m_pendingCount;
+      U32 m_pendingBytes;
+      U8 m_pendingSeq;
+      bool m_pendingValid; //!< Taken since the base last changed, and not superseded
+      bool m_keyframe;
+      Fw::Time m_reference;
+      U32 m_rank; //!< Next channel to consider, in id order
+      U8 m_part; //!< Next part number
+      bool m_done;
+
+      U8 m_base[RFTelemetry::VALUE_BYTES];
+      U32 m_baseCount; //!< Channels the base holds, the first ones of the table
+      U8 m_baseSeq;
+      bool m_baseValid;
+
+      U8 m_seq;
+
+  };
+
+  //! Receiving side: rebuilds the channels of each update on top of its base
+  class RFTelemetryDecoder {
+
+    public:
+
+      enum Status {
+        PART_OK, //!< Applied, more parts follow
+        UPDATE_DONE, //!< Applied the last part, ackSeq is to be acknowledged
+        NO_BASE, //!< Refers to a base or an earlier part this end does not hold
+        MALFORMED //!< Not a valid update
+      };
+
+      RFTelemetryDecoder();
+
+      //! Check a part's or a frame's header and start reading its entries
+      Status start(const U8* part, FwSizeType size);
+
+      //! Apply the next entry
+      //! \return false at the end of the part, then finish tells how it went
+      bool next(
+          FwChanIdType& id, //!< Channel id
+          Fw::Time& time, //!< Time tag
+          const U8*& value, //!< Value, valid until the next part
+          U32& size //!< Value size
+      );
+
+      //! Status of the part once next returned false
+      Status finish();
+
+      //! Sequence number of the last completed update
+      U8 ackSeq() const { return m_currentSeq; }
+
+    private:
+
+      RFTelemetryTable m_table;
+
+      U8 m_base[RFTelemetry::VALUE_BYTES];
+      U32 m_baseCount;
+      U8 m_baseSeq;
+      bool m_baseValid;
+
+      U8 m_current[RFTelemetry::VALUE_BYTES]; //!< The base with the updates applied
+      U8 m_currentSeq;
+      bool m_currentValid; //!< The last update was applied in full
+
+      bool m_active; //!< An update is being applied part by part
+      bool m_keyframe;
+      U8 m_seq;
+      U8 m_nextPart;
+      bool m_last;
+      Fw::Time m_reference;
+      bool m_frame; //!< The part is a frame mode frame, apart from any update
+
+      const U8* m_data; //!< Part being read
+      FwSizeType m_size;
+      FwSizeType m_offset;
+      FwChanIdType m_id; //!< Id of the last entry read
+      bool m_error;
+
+  };
+
+}
+
+#endif
@@ -0,0 +1,406 @@
+// ======================================================================
+// \title  BenchHarness.cpp
+// \author mustafa
+// \brief  cpp file for BenchHarness component implementation class
+// ======================================================================
+
+#include "RFCommBenchmark/Harness/BenchHarness.hpp"
+
+#include <Fw/Types/Assert.hpp>
+#include <Os/Task.hpp>
+
+#include <cstring>
+
+namespace RFCommBenchmark {
+
+  namespace {
+
+    //! Interval at which command waits look for the response
+    const U32 COMMAND_POLL_MS = 1;
+
+  }
+
+  // ----------------------------------------------------------------------
+  // Component construction and destruction
+  // ----------------------------------------------------------------------
+
+  BenchHarness ::
+    BenchHarness(const char* const compName) :
+      BenchHarnessComponentBase(compName),
+      m_size(0),
+      m_depth(0),
+      m_count(0),
+      m_firstSeq(0),
+      m_nextSeq(0),
+      m_running(false),
+      m_cmdSeq(0),
+      m_cmdDone(false),
+      m_cmdResponse(Fw::CmdResponse::OK),
+      m_ticks(0),
+      m_watchedCount(0)
+  {
+    std::memset(&m_counts, 0, sizeof(m_counts));
+    for (U32 i = 0; i < POOL_BUFFERS; i++) {
+      m_poolBusy[i] = false;
+    }
+    for (U32 port = 0; port < MAX_SENDERS; port++) {
+      m_ready[port] = false;
+      m_sentBy[port] = 0;
+      m_retry[port] = false;
+      m_retrySeq[port] = 0;
+    }
+  }
+
+  BenchHarness ::
+    ~BenchHarness()
+  {
+
+  }
+
+  bool BenchHarness ::
+    command(FwIndexType port, FwOpcodeType opCode, Fw::CmdArgBuffer& args, U32 timeoutMs)
+  {
+    m_lock.lock();
+    m_cmdSeq++;
+    const U32 cmdSeq = m_cmdSeq;
+    m_cmdDone = false;
+    m_lock.unLock();
+
+    // Sync commands answer before cmdOut returns, async ones from the component's thread
+    this->cmdOut_out(port, opCode, cmdSeq, args);
+    for (U32 waitedMs = 0; ; waitedMs += COMMAND_POLL_MS) {
+      m_lock.lock();
+      const bool done = m_cmdDone;
+      const Fw::CmdResponse response = m_cmdResponse;
+      m_lock.unLock();
+      if (done) {
+        return response == Fw::CmdResponse::OK;
+      }
+      if (waitedMs >= timeoutMs) {
+        return false;
+      }
+      Os::Task::delay(Fw::TimeInterval(0, COMMAND_POLL_MS * 1000));
+    }
+  }
+
+  void BenchHarness ::
+    tick()
+  {
+    for (FwIndexType port = 0; port < this->getNum_run_OutputPorts(); port++) {
+      if (this->isConnected_run_OutputPort(port)) {
+        this->run_out(port, m_ticks);
+      }
+    }
+    m_ticks++;
+  }
+
+  void BenchHarness ::
+    watchChannel(FwChanIdType id)
+  {
+    m_lock.lock();
+    FW_ASSERT(m_watchedCount < MAX_WATCHED, m_watchedCount);
+    m_watched[m_watchedCount].id = id;
+    m_watched[m_watchedCount].value = 0;
+    m_watchedCount++;
+    m_lock.unLock();
+  }
+
+  U32 BenchHarness ::
+    channel(FwChanIdType id)
+  {
+    U32 value = 0;
+    m_lock.lock();
+    for (U32 i = 0; i < m_watchedCount; i++) {
+      if (m_watched[i].id == id) {
+        value = m_watched[i].value;
+        break;
+      }
+    }
+    m_lock.unLock();
+    return value;
+  }
+
+  void BenchHarness ::
+    startCase(U32 size, U32 depth, U32 count)
+  {
+    FW_ASSERT(size >= SEQUENCE_SIZE && size <= POOL_BUFFER_SIZE, size);
+    FW_ASSERT(depth > 0);
+    FW_ASSERT(count <= MAX_MESSAGES, count);
+
+    m_lock.lock();
+    m_size = size;
+    m_depth = depth;
+    m_count = count;
+    // Sequence numbers keep counting across cases, so a straggler from the last one is recognized
+    m_firstSeq = m_nextSeq;
+    std::memset(&m_counts, 0, sizeof(m_counts));
+    for (U32 i = 0; i < count; i++) {
+      m_received[i] = false;
+    }
+    for (U32 port = 0; port < MAX_SENDERS; port++) {
+      m_sentBy[port] = 0;
+      // A refused message of the last case is not sent any more
+      m_retry[port] = false;
+    }
+    m_running = true;
+    m_lock.unLock();
+
+    this->sendNext();
+  }
+
+  U32 BenchHarness ::
+    delivered()
+  {
+    m_lock.lock();
+    const U32 delivered = m_counts.delivered;
+    m_lock.unLock();
+    return delivered;
+  }
+
+  BenchHarness::CaseCounts BenchHarness ::
+    finishCase()
+  {
+    m_lock.lock();
+    m_running = false;
+    CaseCounts counts = m_counts;
+    if (counts.delivered > 0) {
+      (void)m_lastDeliveryAt.getDiffUsec(m_sentAt[0], counts.elapsedUs);
+    }
+    m_lock.unLock();
+    return counts;
+  }
+
+  const U32* BenchHarness ::
+    latencies() const
+  {
+    return m_latencyUs;
+  }
+
+  // ----------------------------------------------------------------------
+  // Handler implementations for user-defined typed input ports
+  // ----------------------------------------------------------------------
+
+  void BenchHarness ::
+    dataReady_handler(
+        FwIndexType portNum,
+        const Fw::Success& condition
+    )
+  {
+    FW_ASSERT(portNum >= 0 && static_cast<U32>(portNum) < MAX_SENDERS, portNum);
+    m_lock.lock();
+    m_ready[portNum] = true;
+    m_lock.unLock();
+    this->sendFrom(portNum);
+  }
+
+  void BenchHarness ::
+    dataIn_handler(
+        FwIndexType portNum,
+        Fw::Buffer& recvBuffer,
+        const Drv::RecvStatus& recvStatus
+    )
+  {
+    Os::RawTime now;
+    const bool timed = (now.now() == Os::RawTime::OP_OK);
+    const U8* const data = recvBuffer.getData();
+    const U32 size = static_cast<U32>(recvBuffer.getSize());
+
+    m_lock.lock();
+    if (m_running && recvStatus == Drv::RecvStatus::RECV_OK && data != nullptr && size >= SEQUENCE_SIZE) {
+      const U32 seq = (static_cast<U32>(data[0]) << 24) | (static_cast<U32>(data[1]) << 16) |
+                      (static_cast<U32>(data[2]) << 8) | static_cast<U32>(data[3]);
+      const U32 index = seq - m_firstSeq;
+      if (index < m_count && !m_received[index]) {
+        bool intact = (size == m_size);
+        for (U32 offset = SEQUENCE_SIZE; intact && offset < size; offset++) {
+          intact = (data[offset] == patternByte(seq, offset));
+        }
+        if (intact) {
+          U32 latencyUs = 0;
+          if (timed) {
+            (void)now.getDiffUsec(m_sentAt[index], latencyUs);
+          }
+          m_received[index] = true;
+          m_lastDeliveryAt = now;
+          m_latencyUs[m_counts.delivered] = latencyUs;
+          m_counts.delivered++;
+          m_counts.deliveredFrom[m_sender[index]]++;
+        } else {
+          m_counts.corrupted++;
+        }
+      }
+    }
+    if (data != nullptr) {
+      this->releaseBuffer(recvBuffer);
+    }
+    m_lock.unLock();
+
+    this->sendNext();
+  }
+
+  Fw::Buffer BenchHarness ::
+    allocate_handler(
+        FwIndexType portNum,
+        U32 size
+    )
+  {
+    m_lock.lock();
+    m_counts.allocations++;
+    const U32 index = (size <= POOL_BUFFER_SIZE) ? this->takeBuffer() : POOL_BUFFERS;
+    if (index == POOL_BUFFERS) {
+      m_counts.poolMisses++;
+    }
+    m_lock.unLock();
+
+    if (index == POOL_BUFFERS) {
+      return Fw::Buffer();
+    }
+    return Fw::Buffer(m_pool[index], size, index);
+  }
+
+  void BenchHarness ::
+    deallocate_handler(
+        FwIndexType portNum,
+        Fw::Buffer& fwBuffer
+    )
+  {
+    m_lock.lock();
+    this->releaseBuffer(fwBuffer);
+    m_lock.unLock();
+
+    // A message held for lack of a pool buffer can go now
+    this->sendNext();
+  }
+
+  void BenchHarness ::
+    tlmIn_handler(
+        FwIndexType portNum,
+        FwChanIdType id,
+        Fw::Time& timeTag,
+        Fw::TlmBuffer& val
+    )
+  {
+    m_lock.lock();
+    for (U32 i = 0; i < m_watchedCount; i++) {
+      if (m_watched[i].id == id) {
+        U32 value = 0;
+        val.resetDeser();
+        if (val.deserialize(value) == Fw::FW_SERIALIZE_OK) {
+          m_watched[i].value = value;
+        }
+        break;
+      }
+    }
+    m_lock.unLock();
+  }
+
+  void BenchHarness ::
+    cmdResponseIn_handler(
+        FwIndexType portNum,
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        const Fw::CmdResponse& response
+    )
+  {
+    m_lock.lock();
+    if (cmdSeq == m_cmdSeq) {
+      m_cmdResponse = response;
+      m_cmdDone = true;
+    }
+    m_lock.unLock();
+  }
+
+  // ----------------------------------------------------------------------
+  // Helper functions
+  // ----------------------------------------------------------------------
+
+  void BenchHarness ::
+    sendNext()
+  {
+    for (FwIndexType port = 0; port < this->getNum_dataOut_OutputPorts(); port++) {
+      if (this->isConnected_dataOut_OutputPort(port)) {
+        this->sendFrom(port);
+      }
+    }
+  }
+
+  void BenchHarness ::
+    sendFrom(FwIndexType port)
+  {
+    m_lock.lock();
+    const bool retry = m_retry[port];
+    if (!m_running || !m_ready[port] || (!retry && m_nextSeq - m_firstSeq == m_count) ||
+        m_sentBy[port] - m_counts.deliveredFrom[port] >= m_depth) {
+      m_lock.unLock();
+      return;
+    }
+    const U32 index = this->takeBuffer();
+    if (index == POOL_BUFFERS) {
+      m_lock.unLock();
+      return;
+    }
+
+    // Sequence number first, then a pattern the receiving side checks
+    const U32 seq = retry ? m_retrySeq[port] : m_nextSeq;
+    const U32 sent = seq - m_firstSeq;
+    U8* const data = m_pool[index];
+    data[0] = static_cast<U8>(seq >> 24);
+    data[1] = static_cast<U8>(seq >> 16);
+    data[2] = static_cast<U8>(seq >> 8);
+    data[3] = static_cast<U8>(seq);
+    for (U32 offset = SEQUENCE_SIZE; offset < m_size; offset++) {
+      data[offset] = patternByte(seq, offset);
+    }
+    (void)m_sentAt[sent].now();
+    m_sender[sent] = static_cast<U8>(port);
+    if (!retry) {
+      m_nextSeq++;
+    }
+    m_retry[port] = false;
+    m_counts.sent++;
+    m_sentBy[port]++;
+    m_ready[port] = false;
+    Fw::Buffer buffer(data, m_size, index);
+    m_lock.unLock();
+
+    if (this->dataOut_out(port, buffer) != Drv::SendStatus::SEND_OK) {
+      // Nothing was queued, so no dataReady will follow. Other ports may have taken sequence numbers
+      // meanwhile, so this one keeps its number for the next try.
+      m_lock.lock();
+      this->releaseBuffer(buffer);
+      m_retry[port] = true;
+      m_retrySeq[port] = seq;
+      m_counts.sent--;
+      m_sentBy[port]--;
+      m_ready[port] = true;
+      m_lock.unLock();
+    }
+  }
+
+  U32 BenchHarness ::
+    takeBuffer()
+  {
+    for (U32 index = 0; index < POOL_BUFFERS; index++) {
+      if (!m_poolBusy[index]) {
+        m_poolBusy[index] = true;
+        return index;
+      }
+    }
+    return POOL_BUFFERS;
+  }
+
+  void BenchHarness ::
+    releaseBuffer(const Fw::Buffer& buffer)
+  {
+    const U32 index = buffer.getContext();
+    FW_ASSERT(index < POOL_BUFFERS && buffer.getData() == m_pool[index], index);
+    m_poolBusy[index] = false;
+  }
+
+  U8 BenchHarness ::
+    patternByte(U32 seq, U32 offset)
+  {
+    return static_cast<U8>(seq * 31U + offset);
+  }
+
+}
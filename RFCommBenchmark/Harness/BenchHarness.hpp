@@ -0,0 +1,219 @@
+// ======================================================================
+// \title  BenchHarness.hpp
+// \author mustafa
+// \brief  hpp file for BenchHarness component implementation class
+// ======================================================================
+
+#ifndef RFCommBenchmark_BenchHarness_HPP
+#define RFCommBenchmark_BenchHarness_HPP
+
+#include "RFCommBenchmark/Harness/BenchHarnessComponentAc.hpp"
+
+#include <Os/Mutex.hpp>
+#include <Os/RawTime.hpp>
+
+namespace RFCommBenchmark {
+
+ class BenchHarness :
+   public BenchHarnessComponentBase
+ {
+
+   public:
+
+     //! Buffers in the pool shared by the senders, the receivers and the components under test
+     static const U32 POOL_BUFFERS = 256;
+
+     //! Bytes per pool buffer, the largest message a case can send
+     static const U32 POOL_BUFFER_SIZE = 4096;
+
+     //! Most messages in one case
+     static const U32 MAX_MESSAGES = 20000;
+
+     //! Bytes at the start of each message carrying its sequence number
+     static const U32 SEQUENCE_SIZE = sizeof(U32);
+
+     //! Sending nodes, one per dataOut port
+     static const U32 MAX_SENDERS = 64;
+
+     //! Most telemetry channels watchChannel keeps
+     static const U32 MAX_WATCHED = 128;
+
+     //! Counts of one case
+     struct CaseCounts {
+       U32 sent;        //!< Messages handed to dataOut
+       U32 delivered;   //!< Messages back on dataIn, intact and for the first time
+       U32 corrupted;   //!< Messages back on dataIn with a payload that did not match
+       U32 allocations; //!< Buffers the components under test took from allocate
+       U32 poolMisses;  //!< allocate calls the pool could not serve
+       U32 elapsedUs;   //!< From the first message sent to the last one delivered
+       U32 deliveredFrom[MAX_SENDERS]; //!< Of delivered, the messages sent on each dataOut port
+     };
+
+     // ----------------------------------------------------------------------
+     // Component construction and destruction
+     // ----------------------------------------------------------------------
+
+     //! Construct BenchHarness object
+     BenchHarness(
+         const char* const compName //!< The component name
+     );
+
+     //! Destroy BenchHarness object
+     ~BenchHarness();
+
+     //! Send a command and wait for its response
+     //! \return true when the command completed with OK within the timeout
+     bool command(
+         FwIndexType port, //!< cmdOut port of the component
+         FwOpcodeType opCode, //!< Opcode, including the component's id base
+         Fw::CmdArgBuffer& args, //!< Serialized arguments
+         U32 timeoutMs //!< Time to wait for the response
+     );
+
+     //! Call every connected run port
+     void tick();
+
+     //! Keep the latest value of a U32 telemetry channel coming in on tlmIn
+     void watchChannel(
+         FwChanIdType id //!< Channel id, including the component's id base
+     );
+
+     //! Latest value of a watched channel
+     //! \return the value, 0 until the channel was written
+     U32 channel(
+         FwChanIdType id //!< Channel id given to watchChannel
+     );
+
+     //! Start sending messages on every connected dataOut port, each one's first message goes out
+     //! as soon as its dataReady allows
+     void startCase(
+         U32 size, //!< Message size in bytes, SEQUENCE_SIZE to POOL_BUFFER_SIZE
+         U32 depth, //!< Most messages a port sent and that were not yet delivered
+         U32 count //!< Messages to send over all ports, at most MAX_MESSAGES
+     );
+
+     //! Messages delivered so far in the current case
+     U32 delivered();
+
+     //! End the current case, messages still on their way are ignored when they arrive
+     //! \return the counts of the case
+     CaseCounts finishCase();
+
+     //! Latency of each delivered message in microseconds, in no particular order, valid until the next startCase
+     const U32* latencies() const;
+
+   private:
+
+     // ----------------------------------------------------------------------
+     // Handler implementations for user-defined typed input ports
+     // ----------------------------------------------------------------------
+
+     //! Handler implementation for dataReady
+     void dataReady_handler(
+         FwIndexType portNum, //!< The port number
+         const Fw::Success& condition //!< Condition success/failure
+     ) override;
+
+     //! Handler implementation for dataIn
+     //!
+     //! Check the sequence number and the payload, record the latency and return the buffer
+     void dataIn_handler(
+         FwIndexType portNum, //!< The port number
+         Fw::Buffer& recvBuffer, //!< The received buffer
+         const Drv::RecvStatus& recvStatus //!< Receive status
+     ) override;
+
+     //! Handler implementation for allocate
+     Fw::Buffer allocate_handler(
+         FwIndexType portNum, //!< The port number
+         U32 size //!< The requested size
+     ) override;
+
+     //! Handler implementation for deallocate
+     void deallocate_handler(
+         FwIndexType portNum, //!< The port number
+         Fw::Buffer& fwBuffer //!< The buffer
+     ) override;
+
+     //! Handler implementation for tlmIn
+     void tlmIn_handler(
+         FwIndexType portNum, //!< The port number
+         FwChanIdType id, //!< Telemetry Channel ID
+         Fw::Time& timeTag, //!< Time Tag
+         Fw::TlmBuffer& val //!< Buffer containing serialized telemetry value
+     ) override;
+
+     //! Handler implementation for cmdResponseIn
+     void cmdResponseIn_handler(
+         FwIndexType portNum, //!< The port number
+         FwOpcodeType opCode, //!< Command Op Code
+         U32 cmdSeq, //!< Command Sequence
+         const Fw::CmdResponse& response //!< The command response argument
+     ) override;
+
+     // ----------------------------------------------------------------------
+     // Helper functions
+     // ----------------------------------------------------------------------
+
+     //! Send the next message on every dataOut port that may take one
+     void sendNext();
+
+     //! Send the next message on a dataOut port if its manager is ready and the case allows one
+     //! more in flight there
+     void sendFrom(FwIndexType port);
+
+     //! Take a free pool buffer, called with m_lock held
+     //! \return its index, or POOL_BUFFERS when the pool is empty
+     U32 takeBuffer();
+
+     //! Put a pool buffer back, called with m_lock held
+     void releaseBuffer(const Fw::Buffer& buffer);
+
+     //! Payload byte at offset of the message with sequence number seq
+     static U8 patternByte(U32 seq, U32 offset);
+
+     // ----------------------------------------------------------------------
+     // Member variables
+     // ----------------------------------------------------------------------
+
+     Os::Mutex m_lock;
+
+     U8 m_pool[POOL_BUFFERS][POOL_BUFFER_SIZE];
+     bool m_poolBusy[POOL_BUFFERS];
+
+     U32 m_size;
+     U32 m_depth;
+     U32 m_count;
+     U32 m_firstSeq; //!< Sequence number of the first message of the case
+     U32 m_nextSeq;
+     bool m_running;
+     bool m_ready[MAX_SENDERS]; //!< dataReady answered the last message of the port
+     U32 m_sentBy[MAX_SENDERS]; //!< Messages of the case each port sent
+     bool m_retry[MAX_SENDERS]; //!< The port's last message was refused, m_retrySeq goes out again
+     U32 m_retrySeq[MAX_SENDERS];
+     CaseCounts m_counts;
+     Os::RawTime m_sentAt[MAX_MESSAGES];
+     U8 m_sender[MAX_MESSAGES]; //!< dataOut port of each message of the case
+     Os::RawTime m_lastDeliveryAt;
+     bool m_received[MAX_MESSAGES];
+     U32 m_latencyUs[MAX_MESSAGES];
+
+     U32 m_cmdSeq;
+     bool m_cmdDone;
+     Fw::CmdResponse m_cmdResponse;
+
+     U32 m_ticks;
+
+     //! A channel watchChannel keeps
+     struct Watched {
+       FwChanIdType id;
+       U32 value;
+     };
+     Watched m_watched[MAX_WATCHED];
+     U32 m_watchedCount;
+
+ };
+
+}
+
+#endif
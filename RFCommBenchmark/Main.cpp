@@ -0,0 +1,528 @@
+// ======================================================================
+// \title  Main.cpp
+// \brief  RF stack benchmark. Two NRF24Driver/RFCommManager nodes exchange
+//         messages over NRF24Sim radios; each case of the payload size and
+//         queue depth sweep is reported as one JSON line on stdout. With -m
+//         a gateway, a relay and field nodes share the ether instead, the
+//         far field nodes reaching the gateway through the relay.
+//
+// The simulated radios answer every SPI transfer at once, so the numbers
+// measure the host's cost of running the stack, not the air time.
+// ======================================================================
+#include <Components/NRF24Driver/NRF24Driver.hpp>
+#include <Components/NRF24Sim/NRF24Ether.hpp>
+#include <Components/NRF24Sim/NRF24Sim.hpp>
+#include <Components/RFCommManager/RFCommManager.hpp>
+#include <Fw/Types/Assert.hpp>
+#include <RFCommBenchmark/Harness/BenchHarness.hpp>
+// OSAL initialization
+#include <Os/Os.hpp>
+#include <Os/Task.hpp>
+// Used for command line argument processing
+#include <getopt.h>
+// Used for the process CPU clock
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace {
+
+    //! Heap allocations made anywhere in the process, counted by the operator new below
+    std::atomic<U64> heapAllocations(0);
+
+    //! Run port tick interval, the rate group the managers and drivers would run on
+    const U32 TICK_US = 10000;
+
+    //! Ticks without a delivery before a case gives up on the messages still missing
+    const U32 IDLE_TICKS = 200;
+
+    //! How long a command may take to answer
+    const U32 COMMAND_TIMEOUT_MS = 1000;
+
+    const U32 QUEUE_DEPTH = 64;
+    const U32 MAX_LIST = 16;
+
+    //! Most nodes, one radio each on the ether
+    const U32 MAX_NODES = Components::NRF24Ether::MAX_RADIOS;
+
+    //! Mesh node addresses: the gateway, and the relay the far field nodes reach it through
+    const U8 GATEWAY = 0;
+    const U8 RELAY = 1;
+
+    //! Radio hops the mesh senders' messages may take unless -H sets them
+    const U32 DEFAULT_HOP_LIMIT = 2;
+
+    enum RunPorts { RUN_DRIVER, RUN_MANAGER, RUN_PORTS };
+    enum CmdPorts { CMD_DRIVER, CMD_MANAGER, CMD_SIM, CMD_PORTS };
+
+    //! One NRF24Driver/RFCommManager stack on its simulated radio
+    struct Node {
+        Node(const char* driverName, const char* managerName, const char* simName)
+            : driver(driverName), manager(managerName), sim(simName) {}
+
+        Components::NRF24Driver driver;
+        Components::RFCommManager manager;
+        Components::NRF24Sim sim;
+    };
+
+    //! Without -m node 0 sends and node 1 receives; with it node 0 is the gateway, node 1 the
+    //! relay and the others field nodes, with their index as node address
+    Node* nodes[MAX_NODES];
+    U32 nodeCount = 0;
+    U8 meshHopLimit = DEFAULT_HOP_LIMIT;
+    char nodeNames[MAX_NODES][CMD_PORTS][24];
+    // Out of Node, new does not keep their cache line alignment before C++17
+    Components::NRF24FrameRing radioTxRings[MAX_NODES];
+    Components::NRF24FrameRing radioRxRings[MAX_NODES];
+
+    Components::NRF24Ether ether;
+    RFCommBenchmark::BenchHarness harness("harness");
+
+    bool meshMode() {
+        return nodeCount > 2;
+    }
+
+    //! Field nodes at odd indexes reach the gateway through the relay, the others directly
+    bool farNode(U32 index) {
+        return index > RELAY && (index % 2) == 1;
+    }
+
+    //! The gateway sends its messages to the last far field node, through the relay
+    U8 downlinkNode() {
+        return static_cast<U8>(farNode(nodeCount - 1) ? nodeCount - 1 : nodeCount - 2);
+    }
+
+    FwIndexType cmdPort(U32 index, CmdPorts port) {
+        return static_cast<FwIndexType>(index * CMD_PORTS + port);
+    }
+
+    //! Wire one node the way RFCommSimDeployment does, with the harness as its buffer pool
+    void connectNode(U32 index) {
+        Node& node = *nodes[index];
+        Components::NRF24Driver& driver = node.driver;
+        Components::RFCommManager& manager = node.manager;
+        Components::NRF24Sim& sim = node.sim;
+
+        driver.set_spiOut_OutputPort(0, sim.get_spiIn_InputPort(0));
+        driver.set_cePin_OutputPort(0, sim.get_ceIn_InputPort(0));
+        driver.set_csnPin_OutputPort(0, sim.get_csnIn_InputPort(0));
+        driver.set_irqRead_OutputPort(0, sim.get_irqRead_InputPort(0));
+        sim.set_irqOut_OutputPort(0, driver.get_irqIn_InputPort(0));
+
+        manager.set_txRingDoorbell_OutputPort(0, driver.get_txRingDoorbell_InputPort(0));
+        driver.set_txRingSpace_OutputPort(0, manager.get_txRingSpace_InputPort(0));
+        driver.set_rxRingDoorbell_OutputPort(0, manager.get_rxRingDoorbell_InputPort(0));
+        driver.set_linkStatsOut_OutputPort(0, manager.get_linkStatsIn_InputPort(0));
+        manager.set_tune_OutputPort(0, driver.get_tuneIn_InputPort(0));
+        manager.set_nodeAddress_OutputPort(0, driver.get_nodeAddressIn_InputPort(0));
+
+        driver.set_allocate_OutputPort(0, harness.get_allocate_InputPort(0));
+        driver.set_deallocate_OutputPort(0, harness.get_deallocate_InputPort(0));
+        manager.set_allocate_OutputPort(0, harness.get_allocate_InputPort(0));
+        manager.set_deallocate_OutputPort(0, harness.get_deallocate_InputPort(0));
+
+        driver.set_cmdResponseOut_OutputPort(0, harness.get_cmdResponseIn_InputPort(0));
+        manager.set_cmdResponseOut_OutputPort(0, harness.get_cmdResponseIn_InputPort(0));
+        sim.set_cmdResponseOut_OutputPort(0, harness.get_cmdResponseIn_InputPort(0));
+
+        // Whatever a manager reassembles goes to the harness, which counts the messages of the case
+        manager.set_comDataOut_OutputPort(0, harness.get_dataIn_InputPort(0));
+        if (meshMode()) {
+            manager.set_tlmOut_OutputPort(0, harness.get_tlmIn_InputPort(0));
+        }
+
+        const FwIndexType runPort = static_cast<FwIndexType>(index * RUN_PORTS);
+        harness.set_run_OutputPort(runPort + RUN_DRIVER, driver.get_run_InputPort(0));
+        harness.set_run_OutputPort(runPort + RUN_MANAGER, manager.get_run_InputPort(0));
+        harness.set_cmdOut_OutputPort(cmdPort(index, CMD_DRIVER), driver.get_cmdIn_InputPort(0));
+        harness.set_cmdOut_OutputPort(cmdPort(index, CMD_MANAGER), manager.get_cmdIn_InputPort(0));
+        harness.set_cmdOut_OutputPort(cmdPort(index, CMD_SIM), sim.get_cmdIn_InputPort(0));
+
+        // CSN is framed by the SPI controller's chip select, as on the Pi
+        driver.configure(true);
+        driver.attachRings(radioTxRings[index], radioRxRings[index]);
+        manager.attachRings(radioTxRings[index], radioRxRings[index]);
+        sim.attach(ether);
+    }
+
+    //! Messages go in at a sending manager's comDataIn, paced by its comStatus as Svc.Framer would be
+    void connectSender(U32 index) {
+        Components::RFCommManager& manager = nodes[index]->manager;
+        harness.set_dataOut_OutputPort(static_cast<FwIndexType>(index), manager.get_comDataIn_InputPort(0));
+        manager.set_comStatus_OutputPort(0, harness.get_dataReady_InputPort(static_cast<FwIndexType>(index)));
+    }
+
+    void setup(U32 count) {
+        FW_ASSERT(count >= 2 && count <= MAX_NODES, count);
+        nodeCount = count;
+        harness.init(0);
+        for (U32 index = 0; index < nodeCount; index++) {
+            // The first two keep the names they had before the mesh mode
+            char number[8];
+            (void)snprintf(number, sizeof(number), "%u", index);
+            const char* const tag = (index == 0) ? "" : (index == 1) ? "Peer" : number;
+            char (&names)[CMD_PORTS][24] = nodeNames[index];
+            (void)snprintf(names[CMD_DRIVER], sizeof(names[CMD_DRIVER]), "nrf24Driver%s", tag);
+            (void)snprintf(names[CMD_MANAGER], sizeof(names[CMD_MANAGER]), "rfCommManager%s", tag);
+            (void)snprintf(names[CMD_SIM], sizeof(names[CMD_SIM]), "nrf24Sim%s", tag);
+            nodes[index] = new Node(names[CMD_DRIVER], names[CMD_MANAGER], names[CMD_SIM]);
+            Node& node = *nodes[index];
+            node.driver.init(QUEUE_DEPTH, index);
+            node.manager.init(QUEUE_DEPTH, index);
+            node.sim.init(index);
+            const U32 idBase = 0x5000 + index * 0x400;
+            node.driver.setIdBase(idBase);
+            node.manager.setIdBase(idBase + 0x100);
+            node.sim.setIdBase(idBase + 0x200);
+            connectNode(index);
+        }
+
+        connectSender(0);
+        if (meshMode()) {
+            // Every field node sends uplink to the gateway, the relay only forwards
+            for (U32 index = RELAY + 1; index < nodeCount; index++) {
+                connectSender(index);
+            }
+            for (U32 index = 0; index < nodeCount; index++) {
+                const FwChanIdType idBase = nodes[index]->manager.getIdBase();
+                harness.watchChannel(idBase + Components::RFCommManager::CHANNELID_MESSAGESFORWARDED);
+                harness.watchChannel(idBase + Components::RFCommManager::CHANNELID_FORWARDDROPS);
+            }
+        }
+
+        for (U32 index = 0; index < nodeCount; index++) {
+            nodes[index]->driver.start();
+            nodes[index]->manager.start();
+        }
+    }
+
+    void teardown() {
+        for (U32 index = 0; index < nodeCount; index++) {
+            nodes[index]->driver.exit();
+            nodes[index]->manager.exit();
+        }
+        for (U32 index = 0; index < nodeCount; index++) {
+            (void)nodes[index]->driver.join();
+            (void)nodes[index]->manager.join();
+            delete nodes[index];
+        }
+        nodeCount = 0;
+    }
+
+    //! Send a command without arguments
+    bool command(U32 index, CmdPorts port, FwOpcodeType opCode) {
+        Fw::CmdArgBuffer args;
+        return harness.command(cmdPort(index, port), opCode, args, COMMAND_TIMEOUT_MS);
+    }
+
+    //! Send a command with two U8 arguments
+    bool command(U32 index, CmdPorts port, FwOpcodeType opCode, U8 first, U8 second) {
+        Fw::CmdArgBuffer args;
+        return args.serialize(first) == Fw::FW_SERIALIZE_OK && args.serialize(second) == Fw::FW_SERIALIZE_OK &&
+               harness.command(cmdPort(index, port), opCode, args, COMMAND_TIMEOUT_MS);
+    }
+
+    //! Give a mesh node its address, before INIT so the driver starts out on it
+    bool configureAddress(U32 index) {
+        Fw::CmdArgBuffer args;
+        const FwOpcodeType opCode =
+            nodes[index]->manager.getIdBase() + Components::RFCommManager::OPCODE_SET_NODE_ADDRESS;
+        return args.serialize(static_cast<U8>(index)) == Fw::FW_SERIALIZE_OK &&
+               harness.command(cmdPort(index, CMD_MANAGER), opCode, args, COMMAND_TIMEOUT_MS);
+    }
+
+    //! Routes and destinations of the mesh: near field nodes send to the gateway directly, far ones
+    //! through the relay, and the gateway to the last far field node, also through the relay
+    bool configureRoutes() {
+        const FwOpcodeType setRoute = Components::RFCommManager::OPCODE_SET_ROUTE;
+        const FwOpcodeType setDestination = Components::RFCommManager::OPCODE_SET_DESTINATION;
+        const U8 downlink = downlinkNode();
+        bool ok = command(GATEWAY, CMD_MANAGER, nodes[GATEWAY]->manager.getIdBase() + setRoute, downlink, RELAY) &&
+                  command(GATEWAY, CMD_MANAGER, nodes[GATEWAY]->manager.getIdBase() + setDestination, downlink,
+                          meshHopLimit);
+        for (U32 index = RELAY + 1; ok && index < nodeCount; index++) {
+            const FwOpcodeType idBase = nodes[index]->manager.getIdBase();
+            if (farNode(index)) {
+                ok = command(index, CMD_MANAGER, idBase + setRoute, GATEWAY, RELAY);
+            }
+            ok = ok && command(index, CMD_MANAGER, idBase + setDestination, GATEWAY, meshHopLimit);
+        }
+        return ok;
+    }
+
+    //! Power the radios up listening, enable the ARQ and the loss
+    bool configureLink(U8 arqWindow, U8 lossPercent) {
+        bool ok = true;
+        for (U32 index = 0; ok && meshMode() && index < nodeCount; index++) {
+            ok = configureAddress(index);
+        }
+        for (U32 index = 0; ok && index < nodeCount; index++) {
+            const FwOpcodeType idBase = nodes[index]->driver.getIdBase();
+            ok = command(index, CMD_DRIVER, idBase + Components::NRF24Driver::OPCODE_INIT) &&
+                 command(index, CMD_DRIVER, idBase + Components::NRF24Driver::OPCODE_START_RECEIVE);
+        }
+        ok = ok && (!meshMode() || configureRoutes());
+        // The receiving side always answers ARQ frames, so only managers that send need it; in the
+        // mesh that is every one, the relay sends what it forwards
+        const U32 arqNodes = meshMode() ? nodeCount : 1;
+        for (U32 index = 0; ok && arqWindow > 0 && index < arqNodes; index++) {
+            Fw::CmdArgBuffer args;
+            ok = args.serialize(Fw::Enabled(Fw::Enabled::ENABLED)) == Fw::FW_SERIALIZE_OK &&
+                 args.serialize(arqWindow) == Fw::FW_SERIALIZE_OK &&
+                 harness.command(cmdPort(index, CMD_MANAGER),
+                                 nodes[index]->manager.getIdBase() + Components::RFCommManager::OPCODE_SET_ARQ, args,
+                                 COMMAND_TIMEOUT_MS);
+        }
+        for (U32 index = 0; ok && lossPercent > 0 && index < nodeCount; index++) {
+            Fw::CmdArgBuffer args;
+            ok = args.serialize(lossPercent) == Fw::FW_SERIALIZE_OK &&
+                 harness.command(cmdPort(index, CMD_SIM),
+                                 nodes[index]->sim.getIdBase() + Components::NRF24Sim::OPCODE_SET_RX_LOSS, args,
+                                 COMMAND_TIMEOUT_MS);
+        }
+        return ok;
+    }
+
+    //! A manager channel summed over the nodes, as last reported on tlmIn
+    U32 meshCounter(FwChanIdType channel) {
+        U32 total = 0;
+        for (U32 index = 0; index < nodeCount; index++) {
+            total += harness.channel(nodes[index]->manager.getIdBase() + channel);
+        }
+        return total;
+    }
+
+    U64 cpuTimeUs() {
+        struct timespec now;
+        if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now) != 0) {
+            return 0;
+        }
+        return static_cast<U64>(now.tv_sec) * 1000000 + static_cast<U64>(now.tv_nsec) / 1000;
+    }
+
+    //! Latency at the given fraction of the sorted samples, per mille
+    U32 percentile(const std::vector<U32>& sorted, U32 perMille) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        return sorted[(sorted.size() - 1) * perMille / 1000];
+    }
+
+    //! Print the mesh fields of a case's JSON line: the forwarding counters and what the gateway
+    //! took from each neighbor, the relay standing for the far field nodes behind it
+    void printMesh(const RFCommBenchmark::BenchHarness::CaseCounts& counts, U32 size, F64 seconds, U32 forwarded,
+                   U32 forwardDrops) {
+        // Bytes per second each delivered message adds
+        const F64 perMessage = (seconds > 0.0) ? size / seconds : 0.0;
+        (void)printf(",\"fieldNodes\":%u,\"hopLimit\":%u,\"messagesForwarded\":%u,\"forwardDrops\":%u,"
+                     "\"downlinkBytesPerSecond\":%.1f,\"neighbors\":[",
+                     nodeCount - 2, meshHopLimit, forwarded, forwardDrops,
+                     counts.deliveredFrom[GATEWAY] * perMessage);
+        U32 relayed = 0;
+        for (U32 index = RELAY + 1; index < nodeCount; index++) {
+            if (farNode(index)) {
+                relayed += counts.deliveredFrom[index];
+            } else {
+                (void)printf("{\"node\":%u,\"delivered\":%u,\"bytesPerSecond\":%.1f},", index,
+                             counts.deliveredFrom[index], counts.deliveredFrom[index] * perMessage);
+            }
+        }
+        (void)printf("{\"node\":%u,\"delivered\":%u,\"bytesPerSecond\":%.1f}]", RELAY, relayed,
+                     relayed * perMessage);
+    }
+
+    //! Run one case and print its JSON line
+    void runCase(U32 size, U32 depth, U32 count, U8 arqWindow, U8 lossPercent) {
+        const U32 forwardedBefore = meshCounter(Components::RFCommManager::CHANNELID_MESSAGESFORWARDED);
+        const U32 dropsBefore = meshCounter(Components::RFCommManager::CHANNELID_FORWARDDROPS);
+        const U64 heapBefore = heapAllocations.load();
+        const U64 cpuBefore = cpuTimeUs();
+        harness.startCase(size, depth, count);
+        U32 delivered = 0;
+        for (U32 idle = 0; delivered < count && idle < IDLE_TICKS; idle++) {
+            Os::Task::delay(Fw::TimeInterval(0, TICK_US));
+            harness.tick();
+            const U32 now = harness.delivered();
+            if (now != delivered) {
+                delivered = now;
+                idle = 0;
+            }
+        }
+
+        // The main thread only sleeps and ticks, so the process CPU time is the stack's
+        const U64 cpuUs = cpuTimeUs() - cpuBefore;
+        const U64 heap = heapAllocations.load() - heapBefore;
+        const RFCommBenchmark::BenchHarness::CaseCounts counts = harness.finishCase();
+        if (meshMode()) {
+            // One more run tick, so the managers report what they forwarded up to the end of the case
+            harness.tick();
+            Os::Task::delay(Fw::TimeInterval(0, TICK_US));
+        }
+        const U32 forwarded = meshCounter(Components::RFCommManager::CHANNELID_MESSAGESFORWARDED) - forwardedBefore;
+        const U32 forwardDrops = meshCounter(Components::RFCommManager::CHANNELID_FORWARDDROPS) - dropsBefore;
+
+        std::vector<U32> latencies(harness.latencies(), harness.latencies() + counts.delivered);
+        std::sort(latencies.begin(), latencies.end());
+        const F64 seconds = static_cast<F64>(counts.elapsedUs) / 1000000.0;
+        const F64 packets = (counts.delivered > 0) ? static_cast<F64>(counts.delivered) : 1.0;
+        (void)printf("{\"size\":%u,\"depth\":%u,\"arqWindow\":%u,\"lossPercent\":%u,"
+                     "\"sent\":%u,\"delivered\":%u,\"corrupted\":%u,\"poolMisses\":%u,\"seconds\":%.6f,"
+                     "\"packetsPerSecond\":%.1f,\"bytesPerSecond\":%.1f,"
+                     "\"latencyUs\":{\"p50\":%u,\"p99\":%u,\"p999\":%u,\"max\":%u},"
+                     "\"bufferAllocsPerPacket\":%.3f,\"heapAllocsPerPacket\":%.3f,\"cpuUsPerPacket\":%.2f",
+                     size, depth, arqWindow, lossPercent,
+                     counts.sent, counts.delivered, counts.corrupted, counts.poolMisses, seconds,
+                     (seconds > 0.0) ? counts.delivered / seconds : 0.0,
+                     (seconds > 0.0) ? static_cast<F64>(counts.delivered) * size / seconds : 0.0,
+                     percentile(latencies, 500), percentile(latencies, 990), percentile(latencies, 999),
+                     latencies.empty() ? 0 : latencies.back(),
+                     counts.allocations / packets, static_cast<F64>(heap) / packets, static_cast<F64>(cpuUs) / packets);
+        if (meshMode()) {
+            printMesh(counts, size, seconds, forwarded, forwardDrops);
+        }
+        (void)printf("}\n");
+        (void)fflush(stdout);
+    }
+
+    //! Parse a comma separated list of numbers
+    //! \return entries parsed, 0 on a malformed list
+    U32 parseList(const char* text, U32 (&values)[MAX_LIST]) {
+        U32 count = 0;
+        while (*text != '\0' && count < MAX_LIST) {
+            char* end = nullptr;
+            const unsigned long value = strtoul(text, &end, 10);
+            if (end == text || (*end != ',' && *end != '\0')) {
+                return 0;
+            }
+            values[count] = static_cast<U32>(value);
+            count++;
+            text = (*end == ',') ? end + 1 : end;
+        }
+        return (*text == '\0') ? count : 0;
+    }
+
+}
+
+// Counting replacements for the global allocation functions, the array and sized forms forward to these
+void* operator new(std::size_t size) {
+    heapAllocations++;
+    void* const memory = std::malloc((size > 0) ? size : 1);
+    if (memory == nullptr) {
+        std::abort();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+/**
+ * \brief print command line help message
+ *
+ * @param app: name of application
+ */
+void print_usage(const char* app) {
+    (void)printf("Usage: ./%s [options]\n"
+                 "-n\tmessages per case (default 2000)\n"
+                 "-s\tcomma separated message sizes in bytes (default 16,27,64,256,1024)\n"
+                 "-q\tcomma separated queue depths, messages in flight (default 1,4,16)\n"
+                 "-a\tARQ window, 0 leaves the radio auto-acknowledge alone (default 0)\n"
+                 "-l\tframe loss in percent on every radio (default 0)\n"
+                 "-m\tfield nodes of a gateway/relay mesh, 2 to %u; 0 runs the two node link (default 0)\n"
+                 "-H\thop limit of the mesh senders' messages, 1 drops the relayed ones at the relay (default %u)\n",
+                 app, MAX_NODES - 2, DEFAULT_HOP_LIMIT);
+}
+
+/**
+ * \brief run the payload size and queue depth sweep
+ *
+ * @param argc: argument count supplied to program
+ * @param argv: argument values supplied to program
+ * @return: 0 on success, something else on failure
+ */
+int main(int argc, char* argv[]) {
+    I32 option = 0;
+    U32 count = 2000;
+    U32 sizes[MAX_LIST] = {16, 27, 64, 256, 1024};
+    U32 sizeCount = 5;
+    U32 depths[MAX_LIST] = {1, 4, 16};
+    U32 depthCount = 3;
+    U32 arqWindow = 0;
+    U32 lossPercent = 0;
+    U32 fieldNodes = 0;
+    U32 hopLimit = DEFAULT_HOP_LIMIT;
+    Os::init();
+
+    while ((option = getopt(argc, argv, "hn:s:q:a:l:m:H:")) != -1) {
+        switch (option) {
+            case 'n':
+                count = static_cast<U32>(atoi(optarg));
+                break;
+            case 's':
+                sizeCount = parseList(optarg, sizes);
+                break;
+            case 'q':
+                depthCount = parseList(optarg, depths);
+                break;
+            case 'a':
+                arqWindow = static_cast<U32>(atoi(optarg));
+                break;
+            case 'l':
+                lossPercent = static_cast<U32>(atoi(optarg));
+                break;
+            case 'm':
+                fieldNodes = static_cast<U32>(atoi(optarg));
+                break;
+            case 'H':
+                hopLimit = static_cast<U32>(atoi(optarg));
+                break;
+            // Cascade intended: help output
+            case 'h':
+            case '?':
+            default:
+                print_usage(argv[0]);
+                return (option == 'h') ? 0 : 1;
+        }
+    }
+
+    bool valid = count > 0 && count <= RFCommBenchmark::BenchHarness::MAX_MESSAGES && sizeCount > 0 &&
+                 depthCount > 0 && arqWindow <= Components::RFFragment::ARQ_MAX_WINDOW && lossPercent <= 100 &&
+                 (fieldNodes == 0 || (fieldNodes >= 2 && fieldNodes <= MAX_NODES - 2)) && hopLimit >= 1 &&
+                 hopLimit <= 0xFF;
+    for (U32 i = 0; i < sizeCount; i++) {
+        valid = valid && sizes[i] >= RFCommBenchmark::BenchHarness::SEQUENCE_SIZE &&
+                sizes[i] <= RFCommBenchmark::BenchHarness::POOL_BUFFER_SIZE;
+    }
+    for (U32 i = 0; i < depthCount; i++) {
+        valid = valid && depths[i] > 0;
+    }
+    if (!valid) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    meshHopLimit = static_cast<U8>(hopLimit);
+    setup((fieldNodes > 0) ? fieldNodes + 2 : 2);
+    if (!configureLink(static_cast<U8>(arqWindow), static_cast<U8>(lossPercent))) {
+        (void)fprintf(stderr, "Radio setup commands failed\n");
+        teardown();
+        return 1;
+    }
+    // The first tick opens the sending managers' comStatus
+    harness.tick();
+
+    for (U32 s = 0; s < sizeCount; s++) {
+        for (U32 d = 0; d < depthCount; d++) {
+            runCase(sizes[s], depths[d], count, static_cast<U8>(arqWindow), static_cast<U8>(lossPercent));
+        }
+    }
+
+    teardown();
+    return 0;
+}
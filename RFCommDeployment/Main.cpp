@@ -22,7 +22,7 @@
  * @param app: name of application
  */
 void print_usage(const char* app) {
-    (void)printf("Usage: ./%s [options]\n-a\thostname/IP address\n-p\tport_number\n", app);
+    (void)printf("Usage: ./%s [options]\n-t\ttrace file prefix\n", app);
 }
 
 /**
@@ -49,20 +49,15 @@ static void signalHandler(int signum) {
  */
 int main(int argc, char* argv[]) {
     I32 option = 0;
-    CHAR* hostname = nullptr;
-    U16 port_number = 0;
+    CHAR* trace_prefix = nullptr;
     Os::init();
 
     // Loop while reading the getopt supplied options
-    while ((option = getopt(argc, argv, "hp:a:")) != -1) {
+    while ((option = getopt(argc, argv, "ht:")) != -1) {
         switch (option) {
-            // Handle the -a argument for address/hostname
-            case 'a':
-                hostname = optarg;
-                break;
-            // Handle the -p port number argument
-            case 'p':
-                port_number = static_cast<U16>(atoi(optarg));
+            // Handle the -t trace file prefix argument
+            case 't':
+                trace_prefix = optarg;
                 break;
             // Cascade intended: help output
             case 'h':
@@ -76,8 +71,7 @@ int main(int argc, char* argv[]) {
     }
     // Object for communicating state to the reference topology
     RFCommDeployment::TopologyState inputs;
-    inputs.hostname = hostname;
-    inputs.port = port_number;
+    inputs.tracePrefix = trace_prefix;
 
     // Setup program shutdown via Ctrl-C
     signal(SIGINT, signalHandler);
@@ -86,7 +80,7 @@ int main(int argc, char* argv[]) {
 
     // Setup, cycle, and teardown topology
     RFCommDeployment::setupTopology(inputs);
-    RFCommDeployment::startSimulatedCycle(Fw::TimeInterval(1,0));  // Program loop cycling rate groups at 1Hz
+    RFCommDeployment::startSimulatedCycle(Fw::TimeInterval(0, 1000));  // Program loop cycling rate groups at 1kHz
     RFCommDeployment::teardownTopology(inputs);
     (void)printf("Exiting...\n");
     return 0;
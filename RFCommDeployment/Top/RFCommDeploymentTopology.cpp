@@ -9,19 +9,20 @@
 //#include <RFCommDeployment/Top/RFCommDeploymentPacketsAc.hpp>
 
 // Necessary project-specified types
-#include <Fw/Types/MallocAllocator.hpp>
+#include <Components/BufferPool/ArenaAllocator.hpp>
+#include <Components/BufferPool/BufferPool.hpp>
+#include <Components/RFCommManager/RFFragment.hpp>
 #include <Svc/FramingProtocol/FprimeProtocol.hpp>
+#include <Components/NRF24Driver/NRF24FrameRing.hpp>
 
-// Used for 1Hz synthetic cycling
-#include <Os/Mutex.hpp>
+#include <Os/FileSystem.hpp>
+
+#include <cstdio>
+#include <cstring>
 
 // Allows easy reference to objects in FPP/autocoder required namespaces
 using namespace RFCommDeployment;
 
-// The reference topology uses a malloc-based allocator for components that need to allocate memory during the
-// initialization phase.
-Fw::MallocAllocator mallocator;
-
 // The reference topology uses the F´ packet protocol when communicating with the ground and therefore uses the F´
 // framing and deframing implementations.
 Svc::FprimeFraming framing;
@@ -29,8 +30,15 @@ Svc::FprimeDeframing deframing;
 
 Svc::ComQueue::QueueConfigurationTable configurationTable;
 
-// The reference topology divides the incoming clock signal (1Hz) into sub-signals: 1Hz, 1/2Hz, and 1/4Hz with 0 offset
-Svc::RateGroupDriver::DividerSet rateGroupDivisorsSet{{{1, 0}, {2, 0}, {4, 0}}};
+// Frame rings between RFCommManager and NRF24Driver, one per direction and radio
+Components::NRF24FrameRing radioTxRing;
+Components::NRF24FrameRing radioRxRing;
+Components::NRF24FrameRing radioTxRing2;
+Components::NRF24FrameRing radioRxRing2;
+
+// cycleDriver ticks at 1kHz. rateGroup1 takes every tick to service the radios, rateGroup2 and rateGroup3 run
+// housekeeping at 1Hz and 1/4Hz, so run tick counts and timeouts in the components keep their meaning.
+Svc::RateGroupDriver::DividerSet rateGroupDivisorsSet{{{1, 0}, {1000, 0}, {4000, 0}}};
 
 // Rate groups may supply a context token to each of the attached children whose purpose is set by the project. The
 // reference topology sets each token to zero as these contexts are unused in this project.
@@ -46,20 +54,58 @@ enum TopologyConstants {
     FILE_DOWNLINK_CYCLE_TIME = 1000,
     FILE_DOWNLINK_FILE_QUEUE_DEPTH = 10,
     HEALTH_WATCHDOG_CODE = 0x123,
-    COMM_PRIORITY = 100,
-    // bufferManager constants
+    // Records in each radio's trace file, 20 MiB; the file keeps the latest ones
+    TRACE_RECORDS = 256 * 1024,
+    // Radio wiring on the Raspberry Pi: SPI0 and the BCM GPIO lines of /dev/gpiochip0
+    RADIO_SPI_DEVICE = 0,
+    RADIO_SPI_SELECT = 0,
+    RADIO_CE_GPIO = 22,
+    RADIO_IRQ_GPIO = 24,
+    RADIO2_SPI_SELECT = 1,
+    RADIO2_CE_GPIO = 23,
+    RADIO2_IRQ_GPIO = 25,
+    // The IRQ line's interrupt tasks run ahead of the radio drivers they wake
+    RADIO_IRQ_PRIORITY = 111,
+    // Channel the second radio starts on, well clear of the first one's; the peer's second radio listens there too
+    RADIO2_CHANNEL = 76,
+    // bufferManager bins by increasing size. Radio frames: single fragment messages and received NRF24 payloads.
+    RADIO_FRAME_BUFFER_SIZE = 64,
+    RADIO_FRAME_BUFFER_COUNT = 64,
+    // Messages of a few fragments, most commands and events
+    RADIO_MESSAGE_BUFFER_SIZE = 8 * Components::RFFragment::FRAGMENT_DATA_SIZE,
+    RADIO_MESSAGE_BUFFER_COUNT = 32,
+    // Framed com packets and their reassembly, rounded up to whole fragments
+    PACKET_BUFFER_SIZE = FW_COM_BUFFER_MAX_SIZE + HASH_DIGEST_LENGTH + Svc::FpFrameHeader::SIZE +
+                         Components::RFFragment::FRAGMENT_DATA_SIZE,
+    PACKET_BUFFER_COUNT = 30,
+    // Framed file packets and their reassembly, deframed packets and the ground link driver's receive buffers
     FRAMER_BUFFER_SIZE = FW_MAX(FW_COM_BUFFER_MAX_SIZE, FW_FILE_BUFFER_MAX_SIZE + sizeof(U32)) + HASH_DIGEST_LENGTH + Svc::FpFrameHeader::SIZE,
-    FRAMER_BUFFER_COUNT = 30,
-    DEFRAMER_BUFFER_SIZE = FW_MAX(FW_COM_BUFFER_MAX_SIZE, FW_FILE_BUFFER_MAX_SIZE + sizeof(U32)),
-    DEFRAMER_BUFFER_COUNT = 30,
     COM_DRIVER_BUFFER_SIZE = 3000,
-    COM_DRIVER_BUFFER_COUNT = 30,
-    BUFFER_MANAGER_ID = 200
+    LARGE_BUFFER_SIZE = FW_MAX(FRAMER_BUFFER_SIZE + Components::RFFragment::FRAGMENT_DATA_SIZE, COM_DRIVER_BUFFER_SIZE),
+    LARGE_BUFFER_COUNT = 30,
+    BUFFER_MANAGER_ID = 200,
+    BUFFER_POOL_BYTES = Components::BufferPool::binBytes(RADIO_FRAME_BUFFER_SIZE, RADIO_FRAME_BUFFER_COUNT) +
+                        Components::BufferPool::binBytes(RADIO_MESSAGE_BUFFER_SIZE, RADIO_MESSAGE_BUFFER_COUNT) +
+                        Components::BufferPool::binBytes(PACKET_BUFFER_SIZE, PACKET_BUFFER_COUNT) +
+                        Components::BufferPool::binBytes(LARGE_BUFFER_SIZE, LARGE_BUFFER_COUNT),
+    // comQueue depths, the queues hold copies of com buffers and file buffer descriptors
+    COM_QUEUE_EVENT_DEPTH = 100,
+    COM_QUEUE_TLM_DEPTH = 500,
+    COM_QUEUE_FILE_DEPTH = 100,
+    COM_QUEUE_BYTES = (COM_QUEUE_EVENT_DEPTH + COM_QUEUE_TLM_DEPTH) * sizeof(Fw::ComBuffer) +
+                      COM_QUEUE_FILE_DEPTH * sizeof(Fw::Buffer),
+    // Headroom for alignment and the queues' bookkeeping
+    ARENA_SLACK = 4096,
+    ARENA_SIZE = BUFFER_POOL_BYTES + CMD_SEQ_BUFFER_SIZE + COM_QUEUE_BYTES + ARENA_SLACK
 };
 
+// Memory components take while the topology is set up comes from one static block sized above rather than the heap.
+// The arena is sealed once configured, so nothing allocates while the radios run.
+alignas(Components::ArenaAllocator::ALIGNMENT) U8 arenaStorage[ARENA_SIZE];
+Components::ArenaAllocator arena(arenaStorage, sizeof(arenaStorage));
+
 // Ping entries are autocoded, however; this code is not properly exported. Thus, it is copied here.
 Svc::Health::PingEntry pingEntries[] = {
-    {PingEntries::RFCommDeployment_blockDrv::WARN, PingEntries::RFCommDeployment_blockDrv::FATAL, "blockDrv"},
     {PingEntries::RFCommDeployment_tlmSend::WARN, PingEntries::RFCommDeployment_tlmSend::FATAL, "chanTlm"},
     {PingEntries::RFCommDeployment_cmdDisp::WARN, PingEntries::RFCommDeployment_cmdDisp::FATAL, "cmdDisp"},
     {PingEntries::RFCommDeployment_cmdSeq::WARN, PingEntries::RFCommDeployment_cmdSeq::FATAL, "cmdSeq"},
@@ -73,6 +119,48 @@ Svc::Health::PingEntry pingEntries[] = {
     {PingEntries::RFCommDeployment_rateGroup3::WARN, PingEntries::RFCommDeployment_rateGroup3::FATAL, "rateGroup3"},
 };
 
+// Bulk transfers from the peer land here, an offer names a path below it
+const CHAR BULK_RECEIVE_DIRECTORY[] = "bulk";
+
+// The nRF24L01+ takes SPI mode 0 up to 10 MHz
+const Drv::SpiFrequency RADIO_SPI_FREQUENCY = Drv::SPI_FREQUENCY_10MHZ;
+const CHAR GPIO_CHIP[] = "/dev/gpiochip0";
+
+// A radio whose bus cannot be opened fails every transfer, the ground link with it
+void openRadioSpi(Drv::LinuxSpiDriver& driver, FwIndexType device, FwIndexType select) {
+    if (!driver.open(device, select, RADIO_SPI_FREQUENCY)) {
+        (void)printf("[ERROR] SPI device /dev/spidev%d.%d not opened\n", static_cast<int>(device),
+                     static_cast<int>(select));
+    }
+}
+
+// Outputs start low, so CE holds the radio in standby until its driver powers it up
+void openRadioGpio(Drv::LinuxGpioDriver& driver, U32 gpio, Drv::LinuxGpioDriver::GpioConfiguration configuration) {
+    const Os::File::Status status = driver.open(GPIO_CHIP, gpio, configuration);
+    if (status != Os::File::OP_OK) {
+        (void)printf("[ERROR] GPIO %u of %s not opened: status %d\n", static_cast<unsigned>(gpio), GPIO_CHIP,
+                     static_cast<int>(status));
+    }
+}
+
+// Without its interrupt task a radio's IRQ edges never reach irqIn, only the service poll drains it
+void startRadioIrq(Drv::LinuxGpioDriver& driver, const CHAR* radio) {
+    const Drv::GpioStatus status = driver.start(RADIO_IRQ_PRIORITY, Default::STACK_SIZE);
+    if (status != Drv::GpioStatus::OP_OK) {
+        (void)printf("[ERROR] IRQ task of %s not started: status %d\n", radio, static_cast<int>(status.e));
+    }
+}
+
+// Radios that cannot open their trace file run without one
+void openRadioTrace(Components::NRF24Driver& driver, const CHAR* prefix, const CHAR* radio) {
+    CHAR path[256];
+    (void)snprintf(path, sizeof(path), "%s-%s.trace", prefix, radio);
+    const I32 error = driver.openTrace(path, TRACE_RECORDS);
+    if (error != 0) {
+        (void)printf("Trace file %s not opened: %s\n", path, strerror(error));
+    }
+}
+
 /**
  * \brief configure/setup components in project-specific way
  *
@@ -81,23 +169,26 @@ Svc::Health::PingEntry pingEntries[] = {
  * desired, but is extracted here for clarity.
  */
 void configureTopology(const TopologyState& state) {
-    // Buffer managers need a configured set of buckets and an allocator used to allocate memory for those buckets.
-    Svc::BufferManager::BufferBins upBuffMgrBins;
-    memset(&upBuffMgrBins, 0, sizeof(upBuffMgrBins));
-    upBuffMgrBins.bins[0].bufferSize = FRAMER_BUFFER_SIZE;
-    upBuffMgrBins.bins[0].numBuffers = FRAMER_BUFFER_COUNT;
-    upBuffMgrBins.bins[1].bufferSize = DEFRAMER_BUFFER_SIZE;
-    upBuffMgrBins.bins[1].numBuffers = DEFRAMER_BUFFER_COUNT;
-    upBuffMgrBins.bins[2].bufferSize = COM_DRIVER_BUFFER_SIZE;
-    upBuffMgrBins.bins[2].numBuffers = COM_DRIVER_BUFFER_COUNT;
-    bufferManager.setup(BUFFER_MANAGER_ID, 0, mallocator, upBuffMgrBins);
+    // The buffer pool takes its bins from the arena in one allocation. Bins go by increasing size so each request is
+    // served from the smallest bin that fits it.
+    Components::BufferPool::BufferBins bufferBins;
+    memset(&bufferBins, 0, sizeof(bufferBins));
+    bufferBins.bins[0].bufferSize = RADIO_FRAME_BUFFER_SIZE;
+    bufferBins.bins[0].numBuffers = RADIO_FRAME_BUFFER_COUNT;
+    bufferBins.bins[1].bufferSize = RADIO_MESSAGE_BUFFER_SIZE;
+    bufferBins.bins[1].numBuffers = RADIO_MESSAGE_BUFFER_COUNT;
+    bufferBins.bins[2].bufferSize = PACKET_BUFFER_SIZE;
+    bufferBins.bins[2].numBuffers = PACKET_BUFFER_COUNT;
+    bufferBins.bins[3].bufferSize = LARGE_BUFFER_SIZE;
+    bufferBins.bins[3].numBuffers = LARGE_BUFFER_COUNT;
+    bufferManager.setup(arena, BUFFER_MANAGER_ID, bufferBins);
 
     // Framer and Deframer components need to be passed a protocol handler
     framer.setup(framing);
     deframer.setup(deframing);
 
     // Command sequencer needs to allocate memory to hold contents of command sequences
-    cmdSeq.allocateBuffer(0, mallocator, CMD_SEQ_BUFFER_SIZE);
+    cmdSeq.allocateBuffer(0, arena, CMD_SEQ_BUFFER_SIZE);
 
     // Rate group driver needs a divisor list
     rateGroupDriver.configure(rateGroupDivisorsSet);
@@ -122,16 +213,46 @@ void configureTopology(const TopologyState& state) {
     // tlmSend.setPacketList(RFCommDeploymentPacketsPkts, RFCommDeploymentPacketsIgnore, 1);
 
     // Events (highest-priority)
-    configurationTable.entries[0] = {.depth = 100, .priority = 0};
+    configurationTable.entries[0] = {.depth = COM_QUEUE_EVENT_DEPTH, .priority = 0};
     // Telemetry
-    configurationTable.entries[1] = {.depth = 500, .priority = 2};
+    configurationTable.entries[1] = {.depth = COM_QUEUE_TLM_DEPTH, .priority = 2};
     // File Downlink
-    configurationTable.entries[2] = {.depth = 100, .priority = 1};
-    // Allocation identifier is 0 as the MallocAllocator discards it
-    comQueue.configure(configurationTable, 0, mallocator);
-    if (state.hostname != nullptr && state.port != 0) {
-        comDriver.configure(state.hostname, state.port);
+    configurationTable.entries[2] = {.depth = COM_QUEUE_FILE_DEPTH, .priority = 1};
+    // Allocation identifier is 0 as the ArenaAllocator discards it
+    comQueue.configure(configurationTable, 0, arena);
+
+    // The radio's bus and lines are opened before its driver touches them. CSN is wired to GPIO 8, the SPI0 CE0 line
+    // spidev asserts for every transfer, so the driver skips the CSN GPIO writes and lets the SPI controller frame
+    // each command; gpioDriverCSN stays closed, the line belongs to the SPI controller.
+    openRadioSpi(spiDriver, RADIO_SPI_DEVICE, RADIO_SPI_SELECT);
+    openRadioGpio(gpioDriverCE, RADIO_CE_GPIO, Drv::LinuxGpioDriver::GPIO_OUTPUT);
+    // The radio pulls IRQ low when it has something to report
+    openRadioGpio(gpioDriverIRQ, RADIO_IRQ_GPIO, Drv::LinuxGpioDriver::GPIO_INTERRUPT_FALLING_EDGE);
+    nrf24Driver.configure(true);
+    // The second radio's CSN is SPI0 CE1 the same way
+    openRadioSpi(spiDriver2, RADIO_SPI_DEVICE, RADIO2_SPI_SELECT);
+    openRadioGpio(gpioDriverCE2, RADIO2_CE_GPIO, Drv::LinuxGpioDriver::GPIO_OUTPUT);
+    openRadioGpio(gpioDriverIRQ2, RADIO2_IRQ_GPIO, Drv::LinuxGpioDriver::GPIO_INTERRUPT_FALLING_EDGE);
+    nrf24Driver2.configure(true, RADIO2_CHANNEL);
+
+    // Traces record the configuration, so they are opened after it
+    if (state.tracePrefix != nullptr) {
+        openRadioTrace(nrf24Driver, state.tracePrefix, "radio1");
+        openRadioTrace(nrf24Driver2, state.tracePrefix, "radio2");
     }
+
+    // rfCommManager bonds the radios in the order their rings are attached, the first one hops
+    nrf24Driver.attachRings(radioTxRing, radioRxRing);
+    rfCommManager.attachRings(radioTxRing, radioRxRing);
+    nrf24Driver2.attachRings(radioTxRing2, radioRxRing2);
+    rfCommManager.attachRings(radioTxRing2, radioRxRing2);
+
+    // An existing directory is fine, one that cannot be made leaves the offers refused
+    (void)Os::FileSystem::createDirectory(BULK_RECEIVE_DIRECTORY);
+    rfCommManager.configureBulkReceive(BULK_RECEIVE_DIRECTORY);
+
+    // Every component has its memory now, any later allocation is a bug
+    arena.seal();
 }
 
 // Public functions for use in main program are namespaced with deployment name RFCommDeployment
@@ -153,51 +274,33 @@ void setupTopology(const TopologyState& state) {
     loadParameters();
     // Autocoded task kick-off (active components). Function provided by autocoder.
     startTasks(state);
-    // Initialize socket communication if and only if there is a valid specification
-    if (state.hostname != nullptr && state.port != 0) {
-        Os::TaskString name("ReceiveTask");
-        // Uplink is configured for receive so a socket task is started
-        comDriver.start(name, COMM_PRIORITY, Default::STACK_SIZE);
-    }
+    // The IRQ lines' interrupt tasks, once the drivers they wake are running
+    startRadioIrq(gpioDriverIRQ, "radio1");
+    startRadioIrq(gpioDriverIRQ2, "radio2");
 }
 
-// Variables used for cycle simulation
-Os::Mutex cycleLock;
-volatile bool cycleFlag = true;
-
 void startSimulatedCycle(Fw::TimeInterval interval) {
-    cycleLock.lock();
-    bool cycling = cycleFlag;
-    cycleLock.unLock();
-
-    // Main loop
-    while (cycling) {
-        RFCommDeployment::blockDrv.callIsr();
-        Os::Task::delay(interval);
-
-        cycleLock.lock();
-        cycling = cycleFlag;
-        cycleLock.unLock();
-    }
+    const U32 periodUs = interval.getSeconds() * 1000000 + interval.getUSeconds();
+    cycleDriver.cycle(periodUs);
 }
 
 void stopSimulatedCycle() {
-    cycleLock.lock();
-    cycleFlag = false;
-    cycleLock.unLock();
+    cycleDriver.stop();
 }
 
 void teardownTopology(const TopologyState& state) {
+    // The interrupt tasks go first, no edge may reach a driver that stopped
+    (void)gpioDriverIRQ.stop();
+    (void)gpioDriverIRQ2.stop();
+    gpioDriverIRQ.join();
+    gpioDriverIRQ2.join();
+
     // Autocoded (active component) task clean-up. Functions provided by topology autocoder.
     stopTasks(state);
     freeThreads(state);
 
-    // Other task clean-up.
-    comDriver.stop();
-    (void)comDriver.join();
-
     // Resource deallocation
-    cmdSeq.deallocateBuffer(mallocator);
+    cmdSeq.deallocateBuffer(arena);
     bufferManager.cleanup();
 }
 };  // namespace RFCommDeployment
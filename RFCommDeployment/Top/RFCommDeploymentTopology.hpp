@@ -34,7 +34,7 @@ namespace RFCommDeployment {
  * The state argument carries command line inputs used to setup the topology. For an explanation of the required type
  * RFCommDeployment::TopologyState see: RFCommDeploymentTopologyDefs.hpp.
  *
- * \param state: object shuttling CLI arguments (e.g. hostname/port, or UART baudrate) needed to construct the topology
+ * \param state: object shuttling CLI arguments (e.g. the trace file prefix) needed to construct the topology
  */
 void setupTopology(const TopologyState& state);
 
@@ -60,25 +60,23 @@ void setupTopology(const TopologyState& state);
 void teardownTopology(const TopologyState& state);
 
 /**
- * \brief cycle the rate group driver at a crude rate
+ * \brief cycle the rate group driver from the calling thread
  *
- * The reference topology does not have a true 1Hz input clock for the rate group driver because it is designed to
- * operate across various computing endpoints (e.g. laptops) where a clear 1Hz source may not be easily and generically
- * achieved. This function mimics the cycling via a Task::delay(milliseconds) loop that manually invokes the ISR call
- * to the example block driver.
+ * cycleDriver calls the rate group driver on absolute CLOCK_MONOTONIC deadlines, one period apart, so the time the
+ * cycles take does not add up into drift. How late each cycle starts and how far the overrunning ones run past the
+ * next deadline are published on its CycleJitter and CycleOverruns channels. rateGroupDivisorsSet is laid out for a
+ * 1kHz cycle.
  *
- * This loop is stopped via a startSimulatedCycle call.
+ * This loop is stopped via a stopSimulatedCycle call.
  *
- * Note: projects should replace this with a component that produces an output port call at the appropriate frequency.
- *
- * \param milliseconds: milliseconds to delay for each cycle. Default: 1000 or 1Hz.
+ * \param interval: period of each cycle. Default: 1ms or 1kHz.
  */
-void startSimulatedCycle(Fw::TimeInterval interval = Fw::TimeInterval(1,0));
+void startSimulatedCycle(Fw::TimeInterval interval = Fw::TimeInterval(0, 1000));
 
 /**
  * \brief stop the simulated cycle started by startSimulatedCycle
  *
- * This stops the cycle started by startSimulatedCycle.
+ * This stops the cycle started by startSimulatedCycle. It only sets a flag and is safe to call from a signal handler.
  */
 void stopSimulatedCycle();
 
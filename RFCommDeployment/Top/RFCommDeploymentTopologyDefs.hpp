@@ -6,8 +6,7 @@
 #ifndef RFCOMMDEPLOYMENT_RFCOMMDEPLOYMENTTOPOLOGYDEFS_HPP
 #define RFCOMMDEPLOYMENT_RFCOMMDEPLOYMENTTOPOLOGYDEFS_HPP
 
-#include "Drv/BlockDriver/BlockDriver.hpp"
-#include "Fw/Types/MallocAllocator.hpp"
+#include "Components/BufferPool/ArenaAllocator.hpp"
 #include "RFCommDeployment/Top/FppConstantsAc.hpp"
 #include "Svc/FramingProtocol/FprimeProtocol.hpp"
 #include "Svc/Health/Health.hpp"
@@ -23,8 +22,7 @@ namespace RFCommDeployment {
  * to the definition of the project. Here, they are derived from command line inputs.
  */
 struct TopologyState {
-    const CHAR* hostname;
-    U16 port;
+    const CHAR* tracePrefix;  //!< Radios record <prefix>-<radio>.trace, none without a prefix
 };
 
 /**
@@ -47,9 +45,6 @@ struct TopologyState {
  * ```
  */
 namespace PingEntries {
-namespace RFCommDeployment_blockDrv {
-enum { WARN = 3, FATAL = 5 };
-}
 namespace RFCommDeployment_tlmSend {
 enum { WARN = 3, FATAL = 5 };
 }
@@ -0,0 +1,583 @@
+// ======================================================================
+// \title  ReplayHarness.cpp
+// \author mustafa
+// \brief  cpp file for ReplayHarness component implementation class
+// ======================================================================
+
+#include "RFCommReplay/Harness/ReplayHarness.hpp"
+
+#include <Components/NRF24Driver/NRF24Driver.hpp>
+#include <Fw/Types/Assert.hpp>
+#include <Os/Task.hpp>
+
+#include <cstring>
+#include <thread>
+
+namespace RFCommReplay {
+
+  namespace {
+
+    //! Longest the driver may take to get to an input, or to go through the bus operations the
+    //! trace holds after the last one
+    const U32 STALL_MS = 2000;
+
+    //! Manager service and run periods in trace time, as rateGroup1 and rateGroup2 tick them
+    const U64 SERVICE_US = 1000;
+    const U64 RUN_US = 1000000;
+
+    //! Interval at which a full RX ring is looked at again
+    const U32 RING_POLL_MS = 1;
+
+    //! What a chip answers with nothing to tell: STATUS with the RX FIFO empty and no flags. The
+    //! driver gets it once it left the trace or went past its end.
+    const U8 IDLE_BYTE = 0x0E;
+
+  }
+
+  // ----------------------------------------------------------------------
+  // Component construction and destruction
+  // ----------------------------------------------------------------------
+
+  ReplayHarness ::
+    ReplayHarness(const char* const compName) :
+      ReplayHarnessComponentBase(compName),
+      m_trace(nullptr),
+      m_managerTxRing(nullptr),
+      m_driverTxRing(nullptr),
+      m_driverIdBase(0),
+      m_realTime(false),
+      m_cursor(0),
+      m_taken(0),
+      m_diverged(false),
+      m_firstUs(0),
+      m_nextServiceUs(0),
+      m_nextRunUs(0),
+      m_cmdSeq(0)
+  {
+    std::memset(&m_counts, 0, sizeof(m_counts));
+    m_counts.divergedAt = -1;
+    for (U32 i = 0; i < POOL_BUFFERS; i++) {
+      m_poolBusy[i] = false;
+    }
+  }
+
+  ReplayHarness ::
+    ~ReplayHarness()
+  {
+
+  }
+
+  void ReplayHarness ::
+    configure(const Components::NRF24TraceFile& trace, Components::NRF24FrameRing& managerTxRing, bool realTime)
+  {
+    m_trace = &trace;
+    m_managerTxRing = &managerTxRing;
+    m_realTime = realTime;
+  }
+
+  void ReplayHarness ::
+    attachDriver(Components::NRF24Trace& driverTrace, FwOpcodeType driverIdBase,
+                 Components::NRF24FrameRing& driverTxRing)
+  {
+    m_driverIdBase = driverIdBase;
+    m_driverTxRing = &driverTxRing;
+    driverTrace.setInputHook(&ReplayHarness::inputTaken, this);
+  }
+
+  ReplayHarness::Counts ReplayHarness ::
+    replayDriver()
+  {
+    FW_ASSERT(m_trace != nullptr && m_driverTxRing != nullptr);
+    const U64 count = m_trace->count();
+    this->start();
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    for (U64 next = this->nextInput(0); next < count && !m_diverged; next = this->nextInput(next + 1)) {
+      if (!m_moved.wait_for(lock, std::chrono::milliseconds(STALL_MS),
+                            [this] { return m_diverged || m_taken == m_counts.inputs; })) {
+        this->diverge(m_cursor);
+        break;
+      }
+      if (m_diverged) {
+        break;
+      }
+      m_counts.inputs++;
+      lock.unlock();
+
+      const Components::NRF24TraceRecord& record = m_trace->record(next);
+      this->pace(record.timeUs);
+      const bool issued = this->issue(record);
+
+      lock.lock();
+      if (!issued) {
+        this->diverge(next);
+      }
+    }
+
+    // The trace may end before the bus operations of the last input, the driver goes on past it
+    if (!m_moved.wait_for(lock, std::chrono::milliseconds(STALL_MS),
+                          [this, count] { return m_diverged || (m_taken == m_counts.inputs && m_cursor == count); })) {
+      this->diverge(m_cursor);
+    }
+    lock.unlock();
+    return this->counts();
+  }
+
+  ReplayHarness::Counts ReplayHarness ::
+    replayFrames(Components::NRF24FrameRing& managerRxRing)
+  {
+    FW_ASSERT(m_trace != nullptr);
+    const U64 count = m_trace->count();
+    this->start();
+
+    for (U64 index = 0; index < count; index++) {
+      const Components::NRF24TraceRecord& record = m_trace->record(index);
+      if (record.kind != Components::NRF24TraceRecord::RX_FRAME) {
+        continue;
+      }
+      if (record.length > Components::NRF24::MAX_PAYLOAD_SIZE) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        this->diverge(index);
+        break;
+      }
+      this->pace(record.timeUs);
+
+      // The manager drains the ring on its own thread, a full one is waited out
+      Components::NRF24FrameRing::Slot* slot = managerRxRing.claim();
+      for (U32 waitedMs = 0; slot == nullptr && waitedMs < STALL_MS; waitedMs += RING_POLL_MS) {
+        Os::Task::delay(Fw::TimeInterval(0, RING_POLL_MS * 1000));
+        slot = managerRxRing.claim();
+      }
+      if (slot == nullptr) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        this->diverge(index);
+        break;
+      }
+      slot->pipe = record.pipe;
+      slot->noAck = false;
+      slot->length = record.length;
+      slot->timestamp = Fw::Time(TB_NONE, static_cast<U32>(record.timeUs / 1000000),
+                                 static_cast<U32>(record.timeUs % 1000000));
+      std::memcpy(slot->data, record.data, record.length);
+
+      m_lock.lock();
+      m_counts.frames++;
+      m_cursor = index + 1;
+      m_lock.unlock();
+      if (managerRxRing.publish()) {
+        this->rxRingDoorbell_out(0, 0);
+      }
+    }
+
+    m_lock.lock();
+    if (!m_diverged) {
+      m_cursor = count;
+    }
+    m_lock.unlock();
+    return this->counts();
+  }
+
+  ReplayHarness::Counts ReplayHarness ::
+    counts()
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    Counts counts = m_counts;
+    counts.records = m_cursor;
+    counts.traceUs = (m_cursor > 0) ? m_trace->record(m_cursor - 1).timeUs - m_firstUs : 0;
+    return counts;
+  }
+
+  // ----------------------------------------------------------------------
+  // Handler implementations for user-defined typed input ports
+  // ----------------------------------------------------------------------
+
+  void ReplayHarness ::
+    spiIn_handler(
+        FwIndexType portNum,
+        Fw::Buffer& writeBuffer,
+        Fw::Buffer& readBuffer
+    )
+  {
+    U8* const in = readBuffer.getData();
+    const FwSizeType size = readBuffer.getSize();
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    const Components::NRF24TraceRecord* record = this->busRecord(Components::NRF24TraceRecord::SPI);
+    if (record != nullptr) {
+      if (record->length == size && writeBuffer.getSize() == size &&
+          std::memcmp(record->data, writeBuffer.getData(), size) == 0) {
+        std::memcpy(in, record->data + size, size);
+        this->busDone();
+        return;
+      }
+      this->diverge(m_cursor);
+    }
+    std::memset(in, IDLE_BYTE, size);
+  }
+
+  Drv::GpioStatus ReplayHarness ::
+    ceIn_handler(
+        FwIndexType portNum,
+        const Fw::Logic& state
+    )
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    const Components::NRF24TraceRecord* record = this->busRecord(Components::NRF24TraceRecord::CE);
+    if (record != nullptr) {
+      if (record->value == ((state == Fw::Logic::HIGH) ? 1 : 0)) {
+        this->busDone();
+      } else {
+        this->diverge(m_cursor);
+      }
+    }
+    return Drv::GpioStatus::OP_OK;
+  }
+
+  Drv::GpioStatus ReplayHarness ::
+    csnIn_handler(
+        FwIndexType portNum,
+        const Fw::Logic& state
+    )
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    const Components::NRF24TraceRecord* record = this->busRecord(Components::NRF24TraceRecord::CSN);
+    if (record != nullptr) {
+      if (record->value == ((state == Fw::Logic::HIGH) ? 1 : 0)) {
+        this->busDone();
+      } else {
+        this->diverge(m_cursor);
+      }
+    }
+    return Drv::GpioStatus::OP_OK;
+  }
+
+  Drv::GpioStatus ReplayHarness ::
+    irqRead_handler(
+        FwIndexType portNum,
+        Fw::Logic& state
+    )
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    const Components::NRF24TraceRecord* record = this->busRecord(Components::NRF24TraceRecord::IRQ_LINE);
+    state = (record != nullptr && record->value == 0) ? Fw::Logic::LOW : Fw::Logic::HIGH;
+    if (record != nullptr) {
+      this->busDone();
+    }
+    return Drv::GpioStatus::OP_OK;
+  }
+
+  void ReplayHarness ::
+    txRingSpace_handler(
+        FwIndexType portNum,
+        U32 context
+    )
+  {
+    // The TX ring only ever holds the frames the driver held, it has room for them
+  }
+
+  void ReplayHarness ::
+    cmdResponseIn_handler(
+        FwIndexType portNum,
+        FwOpcodeType opCode,
+        U32 cmdSeq,
+        const Fw::CmdResponse& response
+    )
+  {
+    // Commands fail in the replay as they failed in the trace, the bus tells when it differs
+  }
+
+  void ReplayHarness ::
+    managerTxDoorbell_handler(
+        FwIndexType portNum,
+        U32 context
+    )
+  {
+    FW_ASSERT(m_managerTxRing != nullptr);
+    m_managerTxRing->answerDoorbell();
+    if (m_managerTxRing->release(m_managerTxRing->count())) {
+      this->managerTxSpace_out(0, 0);
+    }
+  }
+
+  void ReplayHarness ::
+    dataIn_handler(
+        FwIndexType portNum,
+        Fw::Buffer& recvBuffer,
+        const Drv::RecvStatus& recvStatus
+    )
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (recvStatus == Drv::RecvStatus::RECV_OK && recvBuffer.getData() != nullptr) {
+      m_counts.delivered++;
+      m_counts.bytes += recvBuffer.getSize();
+    }
+    if (recvBuffer.getData() != nullptr) {
+      this->releaseBuffer(recvBuffer);
+    }
+  }
+
+  Fw::Buffer ReplayHarness ::
+    allocate_handler(
+        FwIndexType portNum,
+        U32 size
+    )
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    const U32 index = (size <= POOL_BUFFER_SIZE) ? this->takeBuffer() : POOL_BUFFERS;
+    if (index == POOL_BUFFERS) {
+      m_counts.poolMisses++;
+      return Fw::Buffer();
+    }
+    return Fw::Buffer(m_pool[index], size, index);
+  }
+
+  void ReplayHarness ::
+    deallocate_handler(
+        FwIndexType portNum,
+        Fw::Buffer& fwBuffer
+    )
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    this->releaseBuffer(fwBuffer);
+  }
+
+  // ----------------------------------------------------------------------
+  // Helper functions
+  // ----------------------------------------------------------------------
+
+  void ReplayHarness ::
+    inputTaken(void* context, Components::NRF24TraceRecord::Input input)
+  {
+    static_cast<ReplayHarness*>(context)->taken(input);
+  }
+
+  void ReplayHarness ::
+    taken(Components::NRF24TraceRecord::Input input)
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (!m_diverged) {
+      // Short of the input the driver did fewer bus operations than the trace holds
+      if (m_cursor == m_trace->count() || m_trace->record(m_cursor).kind != Components::NRF24TraceRecord::INPUT ||
+          m_trace->record(m_cursor).value != input) {
+        this->diverge(m_cursor);
+      } else {
+        m_cursor++;
+        this->passFrames();
+      }
+    }
+    m_taken++;
+    m_moved.notify_all();
+  }
+
+  U64 ReplayHarness ::
+    nextInput(U64 index) const
+  {
+    const U64 count = m_trace->count();
+    while (index < count && m_trace->record(index).kind != Components::NRF24TraceRecord::INPUT) {
+      index++;
+    }
+    return index;
+  }
+
+  const Components::NRF24TraceRecord* ReplayHarness ::
+    busRecord(Components::NRF24TraceRecord::Kind kind)
+  {
+    if (m_diverged || m_cursor == m_trace->count()) {
+      return nullptr;
+    }
+    const Components::NRF24TraceRecord& record = m_trace->record(m_cursor);
+    if (record.kind != kind) {
+      this->diverge(m_cursor);
+      return nullptr;
+    }
+    return &record;
+  }
+
+  void ReplayHarness ::
+    busDone()
+  {
+    m_cursor++;
+    m_counts.busOps++;
+    this->passFrames();
+    m_moved.notify_all();
+  }
+
+  void ReplayHarness ::
+    passFrames()
+  {
+    const U64 count = m_trace->count();
+    while (m_cursor < count) {
+      const Components::NRF24TraceRecord& record = m_trace->record(m_cursor);
+      if (record.kind == Components::NRF24TraceRecord::TX_FRAME) {
+        // A ring fuller than the driver's was is a divergence too, it took frames off it the trace did not
+        Components::NRF24FrameRing::Slot* slot = m_driverTxRing->claim();
+        if (slot == nullptr || record.length > Components::NRF24::MAX_PAYLOAD_SIZE) {
+          this->diverge(m_cursor);
+          return;
+        }
+        slot->pipe = record.pipe;
+        slot->node = record.node;
+        slot->noAck = (record.noAck != 0);
+        slot->length = record.length;
+        (void)slot->queuedAt.now();
+        std::memcpy(slot->data, record.data, record.length);
+        // The doorbell is rung from the trace
+        (void)m_driverTxRing->publish();
+      } else if (record.kind != Components::NRF24TraceRecord::RX_FRAME) {
+        return;
+      }
+      // RX frames the driver drains on its own from the bytes the trace clocks in
+      m_counts.frames++;
+      m_cursor++;
+    }
+  }
+
+  void ReplayHarness ::
+    diverge(U64 index)
+  {
+    if (!m_diverged) {
+      m_diverged = true;
+      m_counts.divergedAt = static_cast<I64>(index);
+    }
+    m_moved.notify_all();
+  }
+
+  bool ReplayHarness ::
+    issue(const Components::NRF24TraceRecord& record)
+  {
+    switch (record.value) {
+      case Components::NRF24TraceRecord::RUN:
+        this->run_out(RUN_DRIVER, 0);
+        return true;
+      case Components::NRF24TraceRecord::IRQ: {
+        Os::RawTime now;
+        (void)now.now();
+        this->irqOut_out(0, now);
+        return true;
+      }
+      case Components::NRF24TraceRecord::SERVICE:
+        this->service_out(0, 0);
+        return true;
+      case Components::NRF24TraceRecord::BUFFER_SEND: {
+        m_lock.lock();
+        const U32 index = this->takeBuffer();
+        m_lock.unlock();
+        if (index == POOL_BUFFERS) {
+          return false;
+        }
+        std::memcpy(m_pool[index], record.data, record.length);
+        const U32 context = ((static_cast<U32>(record.pipe) << Components::NRF24::TX_CONTEXT_PIPE_SHIFT) & Components::NRF24::TX_CONTEXT_PIPE_MASK) |
+                            ((static_cast<U32>(record.node) << Components::NRF24::TX_CONTEXT_NODE_SHIFT) & Components::NRF24::TX_CONTEXT_NODE_MASK) |
+                            ((record.noAck != 0) ? Components::NRF24::TX_CONTEXT_NO_ACK : 0);
+        Fw::Buffer buffer(m_pool[index], record.length, context);
+        this->bufferSend_out(0, buffer);
+        return true;
+      }
+      case Components::NRF24TraceRecord::TX_DOORBELL:
+        this->txRingDoorbell_out(0, 0);
+        return true;
+      case Components::NRF24TraceRecord::SURVEY:
+        this->survey_out(0, record.data[0]);
+        return true;
+      case Components::NRF24TraceRecord::TUNE:
+        this->tune_out(0, record.data[0],
+                       Components::NRF24DataRate(static_cast<Components::NRF24DataRate::T>(record.data[1])),
+                       record.data[2]);
+        return true;
+      case Components::NRF24TraceRecord::NODE_ADDRESS:
+        this->nodeAddress_out(0, record.data[0]);
+        return true;
+      default:
+        return this->command(record);
+    }
+  }
+
+  bool ReplayHarness ::
+    command(const Components::NRF24TraceRecord& record)
+  {
+    Fw::CmdArgBuffer args;
+    FwOpcodeType opCode = 0;
+    Fw::SerializeStatus status = Fw::FW_SERIALIZE_OK;
+    switch (record.value) {
+      case Components::NRF24TraceRecord::INIT:
+        opCode = Components::NRF24Driver::OPCODE_INIT;
+        break;
+      case Components::NRF24TraceRecord::START_RECEIVE:
+        opCode = Components::NRF24Driver::OPCODE_START_RECEIVE;
+        break;
+      case Components::NRF24TraceRecord::CONFIGURE:
+        opCode = Components::NRF24Driver::OPCODE_CONFIGURE;
+        status = args.serialize(record.data[0]);
+        status = (status == Fw::FW_SERIALIZE_OK) ? args.serialize(record.data[1]) : status;
+        break;
+      case Components::NRF24TraceRecord::SET_STREAMING:
+        opCode = Components::NRF24Driver::OPCODE_SET_STREAMING;
+        status = args.serialize(Fw::Enabled((record.data[0] != 0) ? Fw::Enabled::ENABLED : Fw::Enabled::DISABLED));
+        status = (status == Fw::FW_SERIALIZE_OK) ? args.serialize(record.data[1] != 0) : status;
+        break;
+      case Components::NRF24TraceRecord::SURVEY_CHANNELS:
+        opCode = Components::NRF24Driver::OPCODE_SURVEY_CHANNELS;
+        status = args.serialize(record.data[0]);
+        break;
+      case Components::NRF24TraceRecord::SET_DATA_RATE:
+        opCode = Components::NRF24Driver::OPCODE_SET_DATA_RATE;
+        status = args.serialize(Components::NRF24DataRate(static_cast<Components::NRF24DataRate::T>(record.data[0])));
+        break;
+      default:
+        return false;
+    }
+    FW_ASSERT(status == Fw::FW_SERIALIZE_OK, status);
+    m_cmdSeq++;
+    this->cmdOut_out(0, m_driverIdBase + opCode, m_cmdSeq, args);
+    return true;
+  }
+
+  void ReplayHarness ::
+    start()
+  {
+    m_startedAt = std::chrono::steady_clock::now();
+    m_firstUs = (m_trace->count() > 0) ? m_trace->record(0).timeUs : 0;
+    m_nextServiceUs = m_firstUs;
+    m_nextRunUs = m_firstUs + RUN_US;
+  }
+
+  void ReplayHarness ::
+    pace(U64 timeUs)
+  {
+    if (m_realTime) {
+      std::this_thread::sleep_until(m_startedAt + std::chrono::microseconds(timeUs - m_firstUs));
+    }
+    // At most one tick each per record, a quiet stretch of the trace does not flood the manager's queue
+    if (timeUs >= m_nextServiceUs) {
+      this->managerService_out(0, 0);
+      m_nextServiceUs = timeUs + SERVICE_US;
+    }
+    if (timeUs >= m_nextRunUs) {
+      this->run_out(RUN_MANAGER, 0);
+      m_nextRunUs = timeUs + RUN_US;
+    }
+  }
+
+  U32 ReplayHarness ::
+    takeBuffer()
+  {
+    for (U32 index = 0; index < POOL_BUFFERS; index++) {
+      if (!m_poolBusy[index]) {
+        m_poolBusy[index] = true;
+        return index;
+      }
+    }
+    return POOL_BUFFERS;
+  }
+
+  void ReplayHarness ::
+    releaseBuffer(const Fw::Buffer& buffer)
+  {
+    // The context of a buffer from bufferSend carries the driver's TX flags, the address tells the slot
+    const FwSizeType offset = static_cast<FwSizeType>(buffer.getData() - m_pool[0]);
+    const U32 index = static_cast<U32>(offset / POOL_BUFFER_SIZE);
+    FW_ASSERT(buffer.getData() >= m_pool[0] && index < POOL_BUFFERS && buffer.getData() == m_pool[index], index);
+    m_poolBusy[index] = false;
+  }
+
+}
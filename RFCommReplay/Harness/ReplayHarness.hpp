@@ -0,0 +1,244 @@
+// ======================================================================
+// \title  ReplayHarness.hpp
+// \author mustafa
+// \brief  hpp file for ReplayHarness component implementation class
+// ======================================================================
+
+#ifndef RFCommReplay_ReplayHarness_HPP
+#define RFCommReplay_ReplayHarness_HPP
+
+#include "RFCommReplay/Harness/ReplayHarnessComponentAc.hpp"
+
+#include <Components/NRF24Driver/NRF24FrameRing.hpp>
+#include <Components/NRF24Driver/NRF24Trace.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace RFCommReplay {
+
+ class ReplayHarness :
+   public ReplayHarnessComponentBase
+ {
+
+   public:
+
+     //! Buffers in the pool shared by the driver, the manager and the replayed bufferSendIn calls
+     static const U32 POOL_BUFFERS = 64;
+
+     //! Bytes per pool buffer
+     static const U32 POOL_BUFFER_SIZE = 4096;
+
+     //! Run port indices
+     enum RunPorts { RUN_DRIVER, RUN_MANAGER };
+
+     //! Counts of one replay
+     struct Counts {
+       U64 records;     //!< Records of the trace gone through
+       U32 inputs;      //!< Inputs issued to the driver
+       U64 busOps;      //!< SPI transfers, CE and CSN writes and IRQ line reads answered from the trace
+       U64 frames;      //!< TX and RX frames gone through
+       I64 divergedAt;  //!< Record at which the components left the trace, -1 when they did not
+       U32 delivered;   //!< Messages the manager reassembled
+       U64 bytes;       //!< Their bytes
+       U32 poolMisses;  //!< allocate calls the pool could not serve
+       U64 traceUs;     //!< Time the records gone through span in the trace
+     };
+
+     // ----------------------------------------------------------------------
+     // Component construction and destruction
+     // ----------------------------------------------------------------------
+
+     //! Construct ReplayHarness object
+     ReplayHarness(
+         const char* const compName //!< The component name
+     );
+
+     //! Destroy ReplayHarness object
+     ~ReplayHarness();
+
+     //! Set up a replay
+     void configure(
+         const Components::NRF24TraceFile& trace, //!< Trace to replay, open for as long as the harness runs
+         Components::NRF24FrameRing& managerTxRing, //!< TX ring attached to the manager, emptied by the harness
+         bool realTime //!< Issue every input at its time in the trace rather than as soon as the last one was taken
+     );
+
+     //! Stand in for the radio and the manager of a driver, before the driver starts
+     void attachDriver(
+         Components::NRF24Trace& driverTrace, //!< The driver's trace, its input hook tells when inputs are taken up
+         FwOpcodeType driverIdBase, //!< The driver's id base, for the commands
+         Components::NRF24FrameRing& driverTxRing //!< TX ring attached to the driver, filled with the trace's TX frames
+     );
+
+     //! Replay the trace through the attached driver. Its bus is answered from the trace and its
+     //! inputs are issued in the recorded order, each one once the driver took up the one before, so
+     //! the queue never holds two and their priorities do not reorder them. Needs a trace that holds
+     //! everything from where it was opened.
+     //! \return the counts of the replay
+     Counts replayDriver();
+
+     //! Replay only the frames the driver received, straight into the manager's RX ring
+     //! \return the counts of the replay
+     Counts replayFrames(
+         Components::NRF24FrameRing& managerRxRing //!< RX ring attached to the manager
+     );
+
+     //! Counts so far, including messages the manager delivered after the replay returned
+     Counts counts();
+
+   private:
+
+     // ----------------------------------------------------------------------
+     // Handler implementations for user-defined typed input ports
+     // ----------------------------------------------------------------------
+
+     //! Handler implementation for spiIn
+     void spiIn_handler(
+         FwIndexType portNum, //!< The port number
+         Fw::Buffer& writeBuffer, //!< Bytes clocked out by the driver
+         Fw::Buffer& readBuffer //!< Filled with the bytes clocked in
+     ) override;
+
+     //! Handler implementation for ceIn
+     Drv::GpioStatus ceIn_handler(
+         FwIndexType portNum, //!< The port number
+         const Fw::Logic& state //!< CE level
+     ) override;
+
+     //! Handler implementation for csnIn
+     Drv::GpioStatus csnIn_handler(
+         FwIndexType portNum, //!< The port number
+         const Fw::Logic& state //!< CSN level
+     ) override;
+
+     //! Handler implementation for irqRead
+     Drv::GpioStatus irqRead_handler(
+         FwIndexType portNum, //!< The port number
+         Fw::Logic& state //!< IRQ line level
+     ) override;
+
+     //! Handler implementation for txRingSpace
+     void txRingSpace_handler(
+         FwIndexType portNum, //!< The port number
+         U32 context //!< The call order
+     ) override;
+
+     //! Handler implementation for cmdResponseIn
+     void cmdResponseIn_handler(
+         FwIndexType portNum, //!< The port number
+         FwOpcodeType opCode, //!< Command Op Code
+         U32 cmdSeq, //!< Command Sequence
+         const Fw::CmdResponse& response //!< The command response argument
+     ) override;
+
+     //! Handler implementation for managerTxDoorbell
+     //!
+     //! Take every frame off the manager's TX ring, nothing transmits them
+     void managerTxDoorbell_handler(
+         FwIndexType portNum, //!< The port number
+         U32 context //!< The call order
+     ) override;
+
+     //! Handler implementation for dataIn
+     void dataIn_handler(
+         FwIndexType portNum, //!< The port number
+         Fw::Buffer& recvBuffer, //!< The received buffer
+         const Drv::RecvStatus& recvStatus //!< Receive status
+     ) override;
+
+     //! Handler implementation for allocate
+     Fw::Buffer allocate_handler(
+         FwIndexType portNum, //!< The port number
+         U32 size //!< The requested size
+     ) override;
+
+     //! Handler implementation for deallocate
+     void deallocate_handler(
+         FwIndexType portNum, //!< The port number
+         Fw::Buffer& fwBuffer //!< The buffer
+     ) override;
+
+     // ----------------------------------------------------------------------
+     // Helper functions
+     // ----------------------------------------------------------------------
+
+     //! Input hook of the driver's trace
+     static void inputTaken(void* context, Components::NRF24TraceRecord::Input input);
+
+     //! The driver took up an input: the input at the cursor has to be the same one. Its frames go
+     //! into the TX ring before the driver looks at it.
+     void taken(Components::NRF24TraceRecord::Input input);
+
+     //! Index of the first INPUT record at or after an index, count() when there is none
+     U64 nextInput(U64 index) const;
+
+     //! The bus operation at the cursor, called with m_lock held
+     //! \return nullptr past the end of the trace, or once the driver left it; a record of
+     //! another kind is a divergence
+     const Components::NRF24TraceRecord* busRecord(Components::NRF24TraceRecord::Kind kind);
+
+     //! Move past the bus operation at the cursor and the frames that follow it, called with m_lock held
+     void busDone();
+
+     //! Move past the frames at the cursor, TX frames go into the driver's TX ring; called with m_lock held
+     void passFrames();
+
+     //! Stop the replay at a record, called with m_lock held
+     void diverge(U64 index);
+
+     //! Issue an INPUT record to the driver
+     //! \return false for an input it does not know, or when the pool had no buffer for a bufferSendIn call
+     bool issue(const Components::NRF24TraceRecord& record);
+
+     //! Issue a command INPUT record to the driver
+     //! \return false for an input it does not know
+     bool command(const Components::NRF24TraceRecord& record);
+
+     //! Note the start of the replay
+     void start();
+
+     //! Wait for the time of a record when replaying in real time, and tick the manager on the way
+     void pace(U64 timeUs);
+
+     //! Take a free pool buffer, called with m_lock held
+     //! \return its index, or POOL_BUFFERS when the pool is empty
+     U32 takeBuffer();
+
+     //! Put a pool buffer back, called with m_lock held
+     void releaseBuffer(const Fw::Buffer& buffer);
+
+     // ----------------------------------------------------------------------
+     // Member variables
+     // ----------------------------------------------------------------------
+
+     //! Guards the cursor and the counts. The driver's bus operations move the cursor on its
+     //! thread and wake the replay loop through m_moved.
+     std::mutex m_lock;
+     std::condition_variable m_moved;
+
+     const Components::NRF24TraceFile* m_trace;
+     Components::NRF24FrameRing* m_managerTxRing;
+     Components::NRF24FrameRing* m_driverTxRing; //!< nullptr without the driver
+     FwOpcodeType m_driverIdBase;
+     bool m_realTime;
+     U64 m_cursor; //!< Next record
+     U32 m_taken; //!< Inputs the driver took up
+     bool m_diverged;
+     Counts m_counts;
+
+     std::chrono::steady_clock::time_point m_startedAt; //!< Start of the replay, the first record's time in real time
+     U64 m_firstUs; //!< Trace time of the first record
+     U64 m_nextServiceUs; //!< Trace time the manager's service is due again
+     U64 m_nextRunUs; //!< Trace time the manager's run is due again
+     U32 m_cmdSeq;
+
+     U8 m_pool[POOL_BUFFERS][POOL_BUFFER_SIZE];
+     bool m_poolBusy[POOL_BUFFERS];
+
+ };
+
+}
+
+#endif
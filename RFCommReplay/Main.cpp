@@ -0,0 +1,223 @@
+// ======================================================================
+// \title  Main.cpp
+// \brief  Replay of an NRF24Driver trace. The recorded inputs are fed to a
+//         driver again and its bus is answered from the trace, the frames
+//         it drains go on to an RFCommManager; the counts of the replay are
+//         reported as one JSON line on stdout.
+//
+// The driver goes through the steps it went through when it was traced,
+// so a field problem can be stepped through in a debugger and the stack
+// profiled with the traffic it really saw. A trace whose oldest records
+// were overwritten no longer starts at INIT; only its received frames are
+// replayed then, straight into the manager.
+// ======================================================================
+#include <Components/NRF24Driver/NRF24Driver.hpp>
+#include <Components/RFCommManager/RFCommManager.hpp>
+#include <RFCommReplay/Harness/ReplayHarness.hpp>
+// OSAL initialization
+#include <Os/Os.hpp>
+// Used for command line argument processing
+#include <getopt.h>
+// Used for the process CPU clock
+#include <time.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+    const U32 QUEUE_DEPTH = 64;
+
+    Components::NRF24Driver nrf24Driver("nrf24Driver");
+    Components::RFCommManager rfCommManager("rfCommManager");
+    RFCommReplay::ReplayHarness harness("harness");
+
+    Components::NRF24FrameRing driverTxRing;
+    Components::NRF24FrameRing driverRxRing;
+    Components::NRF24FrameRing managerTxRing;
+    Components::NRF24FrameRing frameRxRing; //!< The manager's RX ring when only the frames are replayed
+
+    //! The manager, with the harness as its radio's TX side and buffer pool
+    void connectManager() {
+        rfCommManager.init(QUEUE_DEPTH, 0);
+        rfCommManager.setIdBase(0x5100);
+
+        rfCommManager.set_txRingDoorbell_OutputPort(0, harness.get_managerTxDoorbell_InputPort(0));
+        harness.set_managerTxSpace_OutputPort(0, rfCommManager.get_txRingSpace_InputPort(0));
+        rfCommManager.set_comDataOut_OutputPort(0, harness.get_dataIn_InputPort(0));
+        rfCommManager.set_allocate_OutputPort(0, harness.get_allocate_InputPort(0));
+        rfCommManager.set_deallocate_OutputPort(0, harness.get_deallocate_InputPort(0));
+        rfCommManager.set_cmdResponseOut_OutputPort(0, harness.get_cmdResponseIn_InputPort(0));
+
+        harness.set_run_OutputPort(RFCommReplay::ReplayHarness::RUN_MANAGER, rfCommManager.get_run_InputPort(0));
+        harness.set_managerService_OutputPort(0, rfCommManager.get_service_InputPort(0));
+    }
+
+    //! The driver, with the harness as its radio and the source of its inputs. Its tunes, surveys
+    //! and node addresses come from the trace, the manager's own are left unconnected.
+    void connectDriver(const Components::NRF24TraceHeader& header) {
+        nrf24Driver.init(QUEUE_DEPTH, 0);
+        nrf24Driver.setIdBase(0x5000);
+
+        nrf24Driver.set_spiOut_OutputPort(0, harness.get_spiIn_InputPort(0));
+        nrf24Driver.set_cePin_OutputPort(0, harness.get_ceIn_InputPort(0));
+        nrf24Driver.set_csnPin_OutputPort(0, harness.get_csnIn_InputPort(0));
+        nrf24Driver.set_irqRead_OutputPort(0, harness.get_irqRead_InputPort(0));
+        harness.set_irqOut_OutputPort(0, nrf24Driver.get_irqIn_InputPort(0));
+
+        nrf24Driver.set_rxRingDoorbell_OutputPort(0, rfCommManager.get_rxRingDoorbell_InputPort(0));
+        nrf24Driver.set_linkStatsOut_OutputPort(0, rfCommManager.get_linkStatsIn_InputPort(0));
+        nrf24Driver.set_surveyOut_OutputPort(0, rfCommManager.get_surveyIn_InputPort(0));
+        nrf24Driver.set_txRingSpace_OutputPort(0, harness.get_txRingSpace_InputPort(0));
+        nrf24Driver.set_allocate_OutputPort(0, harness.get_allocate_InputPort(0));
+        nrf24Driver.set_deallocate_OutputPort(0, harness.get_deallocate_InputPort(0));
+        nrf24Driver.set_cmdResponseOut_OutputPort(0, harness.get_cmdResponseIn_InputPort(0));
+
+        harness.set_run_OutputPort(RFCommReplay::ReplayHarness::RUN_DRIVER, nrf24Driver.get_run_InputPort(0));
+        harness.set_service_OutputPort(0, nrf24Driver.get_service_InputPort(0));
+        harness.set_bufferSend_OutputPort(0, nrf24Driver.get_bufferSendIn_InputPort(0));
+        harness.set_txRingDoorbell_OutputPort(0, nrf24Driver.get_txRingDoorbell_InputPort(0));
+        harness.set_survey_OutputPort(0, nrf24Driver.get_surveyIn_InputPort(0));
+        harness.set_tune_OutputPort(0, nrf24Driver.get_tuneIn_InputPort(0));
+        harness.set_nodeAddress_OutputPort(0, nrf24Driver.get_nodeAddressIn_InputPort(0));
+        harness.set_cmdOut_OutputPort(0, nrf24Driver.get_cmdIn_InputPort(0));
+
+        nrf24Driver.configure(header.hardwareChipSelect != 0, header.channel);
+        nrf24Driver.attachRings(driverTxRing, driverRxRing);
+        rfCommManager.attachRings(managerTxRing, driverRxRing);
+    }
+
+    U64 cpuTimeUs() {
+        struct timespec now;
+        if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now) != 0) {
+            return 0;
+        }
+        return static_cast<U64>(now.tv_sec) * 1000000 + static_cast<U64>(now.tv_nsec) / 1000;
+    }
+
+    U64 wallTimeUs() {
+        struct timespec now;
+        if (clock_gettime(CLOCK_MONOTONIC, &now) != 0) {
+            return 0;
+        }
+        return static_cast<U64>(now.tv_sec) * 1000000 + static_cast<U64>(now.tv_nsec) / 1000;
+    }
+
+}
+
+/**
+ * \brief print command line help message
+ *
+ * @param app: name of application
+ */
+void print_usage(const char* app) {
+    (void)printf("Usage: ./%s [options] trace\n"
+                 "-f\treplay only the received frames into the manager, without the driver\n"
+                 "-r\tissue the inputs at their recorded times rather than as fast as the driver takes them\n"
+                 "-o\ttrace the replaying driver into this file, to compare with the original\n",
+                 app);
+}
+
+/**
+ * \brief replay a trace and print its counts
+ *
+ * @param argc: argument count supplied to program
+ * @param argv: argument values supplied to program
+ * @return: 0 when the replay went through the whole trace, something else otherwise
+ */
+int main(int argc, char* argv[]) {
+    I32 option = 0;
+    bool framesOnly = false;
+    bool realTime = false;
+    const char* replayTrace = nullptr;
+    Os::init();
+
+    while ((option = getopt(argc, argv, "hfro:")) != -1) {
+        switch (option) {
+            case 'f':
+                framesOnly = true;
+                break;
+            case 'r':
+                realTime = true;
+                break;
+            case 'o':
+                replayTrace = optarg;
+                break;
+            // Cascade intended: help output
+            case 'h':
+            case '?':
+            default:
+                print_usage(argv[0]);
+                return (option == 'h') ? 0 : 1;
+        }
+    }
+    if (optind != argc - 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    Components::NRF24TraceFile trace;
+    const I32 error = trace.open(argv[optind]);
+    if (error != 0) {
+        (void)fprintf(stderr, "Trace file %s not opened: %s\n", argv[optind], strerror(error));
+        return 1;
+    }
+    if (trace.header().channel > Components::NRF24::MAX_CHANNEL) {
+        (void)fprintf(stderr, "Trace file %s has no valid channel\n", argv[optind]);
+        return 1;
+    }
+    // The driver has to start from the INIT the trace starts with
+    if (!framesOnly && trace.wrapped()) {
+        (void)fprintf(stderr, "Trace file %s wrapped, replaying its received frames only\n", argv[optind]);
+        framesOnly = true;
+    }
+
+    harness.init(0);
+    harness.configure(trace, managerTxRing, realTime);
+    connectManager();
+    if (framesOnly) {
+        harness.set_rxRingDoorbell_OutputPort(0, rfCommManager.get_rxRingDoorbell_InputPort(0));
+        rfCommManager.attachRings(managerTxRing, frameRxRing);
+    } else {
+        connectDriver(trace.header());
+        if (replayTrace != nullptr) {
+            const I32 traceError = nrf24Driver.openTrace(replayTrace, trace.header().capacity);
+            if (traceError != 0) {
+                (void)fprintf(stderr, "Trace file %s not opened: %s\n", replayTrace, strerror(traceError));
+            }
+        }
+        harness.attachDriver(nrf24Driver.trace(), nrf24Driver.getIdBase(), driverTxRing);
+        nrf24Driver.start();
+    }
+    rfCommManager.start();
+
+    const U64 cpuBefore = cpuTimeUs();
+    const U64 wallBefore = wallTimeUs();
+    (void)(framesOnly ? harness.replayFrames(frameRxRing) : harness.replayDriver());
+
+    // The components empty their queues before they exit, what they deliver on the way is counted
+    if (!framesOnly) {
+        nrf24Driver.exit();
+        (void)nrf24Driver.join();
+    }
+    rfCommManager.exit();
+    (void)rfCommManager.join();
+    const U64 cpuUs = cpuTimeUs() - cpuBefore;
+    const U64 wallUs = wallTimeUs() - wallBefore;
+    const RFCommReplay::ReplayHarness::Counts counts = harness.counts();
+
+    const F64 records = (counts.records > 0) ? static_cast<F64>(counts.records) : 1.0;
+    (void)printf("{\"mode\":\"%s\",\"records\":%llu,\"inputs\":%u,\"busOps\":%llu,\"frames\":%llu,"
+                 "\"divergedAt\":%lld,\"delivered\":%u,\"bytes\":%llu,\"poolMisses\":%u,"
+                 "\"traceSeconds\":%.6f,\"seconds\":%.6f,\"cpuUsPerRecord\":%.3f}\n",
+                 framesOnly ? "frames" : "driver", static_cast<unsigned long long>(counts.records), counts.inputs,
+                 static_cast<unsigned long long>(counts.busOps), static_cast<unsigned long long>(counts.frames),
+                 static_cast<long long>(counts.divergedAt), counts.delivered,
+                 static_cast<unsigned long long>(counts.bytes), counts.poolMisses,
+                 static_cast<F64>(counts.traceUs) / 1000000.0, static_cast<F64>(wallUs) / 1000000.0,
+                 static_cast<F64>(cpuUs) / records);
+    (void)fflush(stdout);
+    return (counts.divergedAt < 0) ? 0 : 2;
+}
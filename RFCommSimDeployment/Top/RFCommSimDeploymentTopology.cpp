@@ -0,0 +1,287 @@
+// ======================================================================
+// \title  RFCommSimDeploymentTopology.cpp
+// \brief cpp file containing the topology instantiation code
+//
+// ======================================================================
+// Provides access to autocoded functions
+#include <RFCommSimDeployment/Top/RFCommSimDeploymentTopologyAc.hpp>
+// Note: Uncomment when using Svc:TlmPacketizer
+//#include <RFCommSimDeployment/Top/RFCommSimDeploymentPacketsAc.hpp>
+
+// Necessary project-specified types
+#include <Components/BufferPool/ArenaAllocator.hpp>
+#include <Components/BufferPool/BufferPool.hpp>
+#include <Components/RFCommManager/RFFragment.hpp>
+#include <Svc/FramingProtocol/FprimeProtocol.hpp>
+#include <Components/NRF24Sim/NRF24Ether.hpp>
+#include <Components/NRF24Driver/NRF24FrameRing.hpp>
+
+#include <Os/FileSystem.hpp>
+
+#include <cstdio>
+#include <cstring>
+
+// Allows easy reference to objects in FPP/autocoder required namespaces
+using namespace RFCommSimDeployment;
+
+// The reference topology uses the F´ packet protocol when communicating with the ground and therefore uses the F´
+// framing and deframing implementations.
+Svc::FprimeFraming framing;
+Svc::FprimeDeframing deframing;
+
+Svc::ComQueue::QueueConfigurationTable configurationTable;
+
+// Virtual RF channel linking the simulated radios of both nodes. Frames only reach radios tuned to the same channel,
+// data rate and address, exactly as on the air.
+Components::NRF24Ether ether;
+
+// Frame rings between each RFCommManager and its NRF24Drivers, one per direction and radio
+Components::NRF24FrameRing radioTxRing;
+Components::NRF24FrameRing radioRxRing;
+Components::NRF24FrameRing radioTxRingPeer;
+Components::NRF24FrameRing radioRxRingPeer;
+Components::NRF24FrameRing radioTxRing2;
+Components::NRF24FrameRing radioRxRing2;
+Components::NRF24FrameRing radioTxRingPeer2;
+Components::NRF24FrameRing radioRxRingPeer2;
+
+// cycleDriver ticks at 1kHz. rateGroup1 takes every tick to service the radios, rateGroup2 and rateGroup3 run
+// housekeeping at 1Hz and 1/4Hz, so run tick counts and timeouts in the components keep their meaning.
+Svc::RateGroupDriver::DividerSet rateGroupDivisorsSet{{{1, 0}, {1000, 0}, {4000, 0}}};
+
+// Rate groups may supply a context token to each of the attached children whose purpose is set by the project. The
+// reference topology sets each token to zero as these contexts are unused in this project.
+NATIVE_INT_TYPE rateGroup1Context[Svc::ActiveRateGroup::CONNECTION_COUNT_MAX] = {};
+NATIVE_INT_TYPE rateGroup2Context[Svc::ActiveRateGroup::CONNECTION_COUNT_MAX] = {};
+NATIVE_INT_TYPE rateGroup3Context[Svc::ActiveRateGroup::CONNECTION_COUNT_MAX] = {};
+
+// A number of constants are needed for construction of the topology. These are specified here.
+enum TopologyConstants {
+    CMD_SEQ_BUFFER_SIZE = 5 * 1024,
+    FILE_DOWNLINK_TIMEOUT = 1000,
+    FILE_DOWNLINK_COOLDOWN = 1000,
+    FILE_DOWNLINK_CYCLE_TIME = 1000,
+    FILE_DOWNLINK_FILE_QUEUE_DEPTH = 10,
+    HEALTH_WATCHDOG_CODE = 0x123,
+    // Records in each radio's trace file, 20 MiB; the file keeps the latest ones
+    TRACE_RECORDS = 256 * 1024,
+    COMM_PRIORITY = 100,
+    // Channel the second radios start on, well clear of the first ones'
+    RADIO2_CHANNEL = 76,
+    // bufferManager bins by increasing size. Radio frames: single fragment messages and received NRF24 payloads.
+    RADIO_FRAME_BUFFER_SIZE = 64,
+    RADIO_FRAME_BUFFER_COUNT = 64,
+    // Messages of a few fragments, most commands and events
+    RADIO_MESSAGE_BUFFER_SIZE = 8 * Components::RFFragment::FRAGMENT_DATA_SIZE,
+    RADIO_MESSAGE_BUFFER_COUNT = 32,
+    // Framed com packets and their reassembly, rounded up to whole fragments
+    PACKET_BUFFER_SIZE = FW_COM_BUFFER_MAX_SIZE + HASH_DIGEST_LENGTH + Svc::FpFrameHeader::SIZE +
+                         Components::RFFragment::FRAGMENT_DATA_SIZE,
+    PACKET_BUFFER_COUNT = 30,
+    // Framed file packets and their reassembly, deframed packets and the ground link driver's receive buffers
+    FRAMER_BUFFER_SIZE = FW_MAX(FW_COM_BUFFER_MAX_SIZE, FW_FILE_BUFFER_MAX_SIZE + sizeof(U32)) + HASH_DIGEST_LENGTH + Svc::FpFrameHeader::SIZE,
+    COM_DRIVER_BUFFER_SIZE = 3000,
+    LARGE_BUFFER_SIZE = FW_MAX(FRAMER_BUFFER_SIZE + Components::RFFragment::FRAGMENT_DATA_SIZE, COM_DRIVER_BUFFER_SIZE),
+    LARGE_BUFFER_COUNT = 30,
+    BUFFER_MANAGER_ID = 200,
+    BUFFER_POOL_BYTES = Components::BufferPool::binBytes(RADIO_FRAME_BUFFER_SIZE, RADIO_FRAME_BUFFER_COUNT) +
+                        Components::BufferPool::binBytes(RADIO_MESSAGE_BUFFER_SIZE, RADIO_MESSAGE_BUFFER_COUNT) +
+                        Components::BufferPool::binBytes(PACKET_BUFFER_SIZE, PACKET_BUFFER_COUNT) +
+                        Components::BufferPool::binBytes(LARGE_BUFFER_SIZE, LARGE_BUFFER_COUNT),
+    // comQueue depths, the queues hold copies of com buffers and file buffer descriptors
+    COM_QUEUE_EVENT_DEPTH = 100,
+    COM_QUEUE_TLM_DEPTH = 500,
+    COM_QUEUE_FILE_DEPTH = 100,
+    COM_QUEUE_BYTES = (COM_QUEUE_EVENT_DEPTH + COM_QUEUE_TLM_DEPTH) * sizeof(Fw::ComBuffer) +
+                      COM_QUEUE_FILE_DEPTH * sizeof(Fw::Buffer),
+    // Headroom for alignment and the queues' bookkeeping
+    ARENA_SLACK = 4096,
+    ARENA_SIZE = BUFFER_POOL_BYTES + CMD_SEQ_BUFFER_SIZE + COM_QUEUE_BYTES + ARENA_SLACK
+};
+
+// Memory components take while the topology is set up comes from one static block sized above rather than the heap.
+// The arena is sealed once configured, so nothing allocates while the radios run.
+alignas(Components::ArenaAllocator::ALIGNMENT) U8 arenaStorage[ARENA_SIZE];
+Components::ArenaAllocator arena(arenaStorage, sizeof(arenaStorage));
+
+// Ping entries are autocoded, however; this code is not properly exported. Thus, it is copied here.
+Svc::Health::PingEntry pingEntries[] = {
+    {PingEntries::RFCommSimDeployment_tlmSend::WARN, PingEntries::RFCommSimDeployment_tlmSend::FATAL, "chanTlm"},
+    {PingEntries::RFCommSimDeployment_cmdDisp::WARN, PingEntries::RFCommSimDeployment_cmdDisp::FATAL, "cmdDisp"},
+    {PingEntries::RFCommSimDeployment_cmdSeq::WARN, PingEntries::RFCommSimDeployment_cmdSeq::FATAL, "cmdSeq"},
+    {PingEntries::RFCommSimDeployment_eventLogger::WARN, PingEntries::RFCommSimDeployment_eventLogger::FATAL, "eventLogger"},
+    {PingEntries::RFCommSimDeployment_fileDownlink::WARN, PingEntries::RFCommSimDeployment_fileDownlink::FATAL, "fileDownlink"},
+    {PingEntries::RFCommSimDeployment_fileManager::WARN, PingEntries::RFCommSimDeployment_fileManager::FATAL, "fileManager"},
+    {PingEntries::RFCommSimDeployment_fileUplink::WARN, PingEntries::RFCommSimDeployment_fileUplink::FATAL, "fileUplink"},
+    {PingEntries::RFCommSimDeployment_prmDb::WARN, PingEntries::RFCommSimDeployment_prmDb::FATAL, "prmDb"},
+    {PingEntries::RFCommSimDeployment_rateGroup1::WARN, PingEntries::RFCommSimDeployment_rateGroup1::FATAL, "rateGroup1"},
+    {PingEntries::RFCommSimDeployment_rateGroup2::WARN, PingEntries::RFCommSimDeployment_rateGroup2::FATAL, "rateGroup2"},
+    {PingEntries::RFCommSimDeployment_rateGroup3::WARN, PingEntries::RFCommSimDeployment_rateGroup3::FATAL, "rateGroup3"},
+};
+
+// Bulk transfers from the peer land here, an offer names a path below it
+const CHAR BULK_RECEIVE_DIRECTORY[] = "bulk";
+
+// Radios that cannot open their trace file run without one
+void openRadioTrace(Components::NRF24Driver& driver, const CHAR* prefix, const CHAR* radio) {
+    CHAR path[256];
+    (void)snprintf(path, sizeof(path), "%s-%s.trace", prefix, radio);
+    const I32 error = driver.openTrace(path, TRACE_RECORDS);
+    if (error != 0) {
+        (void)printf("Trace file %s not opened: %s\n", path, strerror(error));
+    }
+}
+
+/**
+ * \brief configure/setup components in project-specific way
+ *
+ * This is a *helper* function which configures/sets up each component requiring project specific input. This includes
+ * allocating resources, passing-in arguments, etc. This function may be inlined into the topology setup function if
+ * desired, but is extracted here for clarity.
+ */
+void configureTopology(const TopologyState& state) {
+    // The buffer pool takes its bins from the arena in one allocation. Bins go by increasing size so each request is
+    // served from the smallest bin that fits it.
+    Components::BufferPool::BufferBins bufferBins;
+    memset(&bufferBins, 0, sizeof(bufferBins));
+    bufferBins.bins[0].bufferSize = RADIO_FRAME_BUFFER_SIZE;
+    bufferBins.bins[0].numBuffers = RADIO_FRAME_BUFFER_COUNT;
+    bufferBins.bins[1].bufferSize = RADIO_MESSAGE_BUFFER_SIZE;
+    bufferBins.bins[1].numBuffers = RADIO_MESSAGE_BUFFER_COUNT;
+    bufferBins.bins[2].bufferSize = PACKET_BUFFER_SIZE;
+    bufferBins.bins[2].numBuffers = PACKET_BUFFER_COUNT;
+    bufferBins.bins[3].bufferSize = LARGE_BUFFER_SIZE;
+    bufferBins.bins[3].numBuffers = LARGE_BUFFER_COUNT;
+    bufferManager.setup(arena, BUFFER_MANAGER_ID, bufferBins);
+
+    // Framer and Deframer components need to be passed a protocol handler
+    framer.setup(framing);
+    deframer.setup(deframing);
+
+    // Command sequencer needs to allocate memory to hold contents of command sequences
+    cmdSeq.allocateBuffer(0, arena, CMD_SEQ_BUFFER_SIZE);
+
+    // Rate group driver needs a divisor list
+    rateGroupDriver.configure(rateGroupDivisorsSet);
+
+    // Rate groups require context arrays.
+    rateGroup1.configure(rateGroup1Context, FW_NUM_ARRAY_ELEMENTS(rateGroup1Context));
+    rateGroup2.configure(rateGroup2Context, FW_NUM_ARRAY_ELEMENTS(rateGroup2Context));
+    rateGroup3.configure(rateGroup3Context, FW_NUM_ARRAY_ELEMENTS(rateGroup3Context));
+
+    // File downlink requires some project-derived properties.
+    fileDownlink.configure(FILE_DOWNLINK_TIMEOUT, FILE_DOWNLINK_COOLDOWN, FILE_DOWNLINK_CYCLE_TIME,
+                           FILE_DOWNLINK_FILE_QUEUE_DEPTH);
+
+    // Parameter database is configured with a database file name, and that file must be initially read.
+    prmDb.configure("PrmDb.dat");
+    prmDb.readParamFile();
+
+    // Health is supplied a set of ping entires.
+    health.setPingEntries(pingEntries, FW_NUM_ARRAY_ELEMENTS(pingEntries), HEALTH_WATCHDOG_CODE);
+
+    // Note: Uncomment when using Svc:TlmPacketizer
+    // tlmSend.setPacketList(RFCommSimDeploymentPacketsPkts, RFCommSimDeploymentPacketsIgnore, 1);
+
+    // Events (highest-priority)
+    configurationTable.entries[0] = {.depth = COM_QUEUE_EVENT_DEPTH, .priority = 0};
+    // Telemetry
+    configurationTable.entries[1] = {.depth = COM_QUEUE_TLM_DEPTH, .priority = 2};
+    // File Downlink
+    configurationTable.entries[2] = {.depth = COM_QUEUE_FILE_DEPTH, .priority = 1};
+    // Allocation identifier is 0 as the ArenaAllocator discards it
+    comQueue.configure(configurationTable, 0, arena);
+    if (state.hostname != nullptr && state.port != 0) {
+        comDriver.configure(state.hostname, state.port);
+    }
+
+    // CSN is framed by the SPI controller's chip select, as on the Pi, so the driver skips the CSN GPIO writes
+    nrf24Driver.configure(true);
+    nrf24DriverPeer.configure(true);
+    // The second radios pair up on a channel of their own
+    nrf24Driver2.configure(true, RADIO2_CHANNEL);
+    nrf24DriverPeer2.configure(true, RADIO2_CHANNEL);
+
+    // Traces record the configuration, so they are opened after it
+    if (state.tracePrefix != nullptr) {
+        openRadioTrace(nrf24Driver, state.tracePrefix, "radio1");
+        openRadioTrace(nrf24Driver2, state.tracePrefix, "radio2");
+        openRadioTrace(nrf24DriverPeer, state.tracePrefix, "peer1");
+        openRadioTrace(nrf24DriverPeer2, state.tracePrefix, "peer2");
+    }
+
+    // Each RFCommManager bonds its radios in the order their rings are attached, the first one hops
+    nrf24Driver.attachRings(radioTxRing, radioRxRing);
+    rfCommManager.attachRings(radioTxRing, radioRxRing);
+    nrf24Driver2.attachRings(radioTxRing2, radioRxRing2);
+    rfCommManager.attachRings(radioTxRing2, radioRxRing2);
+    nrf24DriverPeer.attachRings(radioTxRingPeer, radioRxRingPeer);
+    rfCommManagerPeer.attachRings(radioTxRingPeer, radioRxRingPeer);
+    nrf24DriverPeer2.attachRings(radioTxRingPeer2, radioRxRingPeer2);
+    rfCommManagerPeer.attachRings(radioTxRingPeer2, radioRxRingPeer2);
+
+    // All simulated radios share one virtual medium, each pair hears the other on its channel
+    nrf24Sim.attach(ether);
+    nrf24SimPeer.attach(ether);
+    nrf24Sim2.attach(ether);
+    nrf24SimPeer2.attach(ether);
+
+    // An existing directory is fine, one that cannot be made leaves the offers refused
+    (void)Os::FileSystem::createDirectory(BULK_RECEIVE_DIRECTORY);
+    rfCommManager.configureBulkReceive(BULK_RECEIVE_DIRECTORY);
+    rfCommManagerPeer.configureBulkReceive(BULK_RECEIVE_DIRECTORY);
+
+    // Every component has its memory now, any later allocation is a bug
+    arena.seal();
+}
+
+// Public functions for use in main program are namespaced with deployment name RFCommSimDeployment
+namespace RFCommSimDeployment {
+void setupTopology(const TopologyState& state) {
+    // Autocoded initialization. Function provided by autocoder.
+    initComponents(state);
+    // Autocoded id setup. Function provided by autocoder.
+    setBaseIds();
+    // Autocoded connection wiring. Function provided by autocoder.
+    connectComponents();
+    // Autocoded configuration. Function provided by autocoder.
+    configComponents(state);
+    // Deployment-specific component configuration. Function provided above. May be inlined, if desired.
+    configureTopology(state);
+    // Autocoded command registration. Function provided by autocoder.
+    regCommands();
+    // Autocoded parameter loading. Function provided by autocoder.
+    loadParameters();
+    // Autocoded task kick-off (active components). Function provided by autocoder.
+    startTasks(state);
+    // Initialize socket communication if and only if there is a valid specification
+    if (state.hostname != nullptr && state.port != 0) {
+        Os::TaskString name("ReceiveTask");
+        // Uplink is configured for receive so a socket task is started
+        comDriver.start(name, COMM_PRIORITY, Default::STACK_SIZE);
+    }
+}
+
+void startSimulatedCycle(Fw::TimeInterval interval) {
+    const U32 periodUs = interval.getSeconds() * 1000000 + interval.getUSeconds();
+    cycleDriver.cycle(periodUs);
+}
+
+void stopSimulatedCycle() {
+    cycleDriver.stop();
+}
+
+void teardownTopology(const TopologyState& state) {
+    // Autocoded (active component) task clean-up. Functions provided by topology autocoder.
+    stopTasks(state);
+    freeThreads(state);
+
+    // Other task clean-up.
+    comDriver.stop();
+    (void)comDriver.join();
+
+    // Resource deallocation
+    cmdSeq.deallocateBuffer(arena);
+    bufferManager.cleanup();
+}
+};  // namespace RFCommSimDeployment
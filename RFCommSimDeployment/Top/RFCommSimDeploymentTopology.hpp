@@ -0,0 +1,84 @@
+// ======================================================================
+// \title  RFCommSimDeploymentTopology.hpp
+// \brief header file containing the topology instantiation definitions
+//
+// ======================================================================
+#ifndef RFCOMMSIMDEPLOYMENT_RFCOMMSIMDEPLOYMENTTOPOLOGY_HPP
+#define RFCOMMSIMDEPLOYMENT_RFCOMMSIMDEPLOYMENTTOPOLOGY_HPP
+// Included for access to RFCommSimDeployment::TopologyState and RFCommSimDeployment::ConfigObjects::pingEntries. These definitions are required by the
+// autocoder, but are also used in this hand-coded topology.
+#include <RFCommSimDeployment/Top/RFCommSimDeploymentTopologyDefs.hpp>
+
+// Remove unnecessary RFCommSimDeployment:: qualifications
+using namespace RFCommSimDeployment;
+namespace RFCommSimDeployment {
+/**
+ * \brief initialize and run the F´ topology
+ *
+ * Initializes, configures, and runs the F´ topology. This is performed through a series of steps, some provided via
+ * autocoded functions, and others provided via the functions implementation. These steps are:
+ *
+ *   1. Call the autocoded `initComponents()` function initializing each component via the `component.init` method
+ *   2. Call the autocoded `setBaseIds()` function to set the base IDs (offset) for each component instance
+ *   3. Call the autocoded `connectComponents()` function to wire-together the topology of components
+ *   4. Configure components requiring custom configuration
+ *   5. Call the autocoded `loadParameters()` function to cause each component to load initial parameter values
+ *   6. Call the autocoded `startTasks()` function to start the active component tasks
+ *   7. Start tasks not owned by active components
+ *
+ * Step 4 and step 7 are custom and supplied by the project. The ordering of steps 1, 2, 3, 5, and 6 are critical for
+ * F´ topologies to function. Configuration (step 4) typically assumes a connect but not started topology and is thus
+ * inserted between step 3 and 5. Step 7 may come before or after the active component initializations. Since these
+ * custom tasks often start radio communication it is convenient to start them last.
+ *
+ * The state argument carries command line inputs used to setup the topology. For an explanation of the required type
+ * RFCommSimDeployment::TopologyState see: RFCommSimDeploymentTopologyDefs.hpp.
+ *
+ * \param state: object shuttling CLI arguments (e.g. hostname/port, or UART baudrate) needed to construct the topology
+ */
+void setupTopology(const TopologyState& state);
+
+/**
+ * \brief teardown the F´ topology
+ *
+ * Tears down the F´ topology in preparation for shutdown. This is done via a series of steps, some provided by
+ * autocoded functions, and others provided via the function implementation. These steps are:
+ *
+ *   1. Call the autocoded `stopTasks()` function to stop the tasks started by `startTasks()` (active components)
+ *   2. Call the autocoded `freeThreads()` function to join to the tasks started by `startTasks()`
+ *   3. Stop the tasks not owned by active components
+ *   4. Join to the tasks not owned by active components
+ *   5. Deallocate other resources
+ *
+ * Step 1, 2, 3, and 4 must occur in-order as the tasks must be stopped before being joined. These tasks must be stopped
+ * and joined before any active resources may be deallocated.
+ *
+ * For an explanation of the required type RFCommSimDeployment::TopologyState see: RFCommSimDeploymentTopologyDefs.hpp.
+ *
+ * \param state: state object provided to setupTopology
+ */
+void teardownTopology(const TopologyState& state);
+
+/**
+ * \brief cycle the rate group driver from the calling thread
+ *
+ * cycleDriver calls the rate group driver on absolute CLOCK_MONOTONIC deadlines, one period apart, so the time the
+ * cycles take does not add up into drift. How late each cycle starts and how far the overrunning ones run past the
+ * next deadline are published on its CycleJitter and CycleOverruns channels. rateGroupDivisorsSet is laid out for a
+ * 1kHz cycle.
+ *
+ * This loop is stopped via a stopSimulatedCycle call.
+ *
+ * \param interval: period of each cycle. Default: 1ms or 1kHz.
+ */
+void startSimulatedCycle(Fw::TimeInterval interval = Fw::TimeInterval(0, 1000));
+
+/**
+ * \brief stop the simulated cycle started by startSimulatedCycle
+ *
+ * This stops the cycle started by startSimulatedCycle. It only sets a flag and is safe to call from a signal handler.
+ */
+void stopSimulatedCycle();
+
+} // namespace RFCommSimDeployment
+#endif
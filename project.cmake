@@ -3,3 +3,6 @@
 
 add_fprime_subdirectory("${CMAKE_CURRENT_LIST_DIR}/Components")
 add_fprime_subdirectory("${CMAKE_CURRENT_LIST_DIR}/RFCommDeployment/")
+add_fprime_subdirectory("${CMAKE_CURRENT_LIST_DIR}/RFCommSimDeployment/")
+add_fprime_subdirectory("${CMAKE_CURRENT_LIST_DIR}/RFCommBenchmark/")
+add_fprime_subdirectory("${CMAKE_CURRENT_LIST_DIR}/RFCommReplay/")